@@ -2,9 +2,8 @@
 #define CHATMESSAGE_H
 
 #include "INetworkSerializable.h"
+#include "WireFormat.h"
 #include <QString>
-#include <QDataStream>
-#include <QHostAddress>
 
 /**
  * @brief Represents a chat message that can be serialized and transmitted over the network.
@@ -22,24 +21,37 @@ struct ChatMessage : public INetworkSerializable {
      */
     ChatMessage(const QString &from, const QString &msg) : sender(from), message(msg) {}
 
+    using INetworkSerializable::deserialize;
+
+    /**
+     * @brief Returns the serialized size of the chat message.
+     * @return The size in bytes.
+     */
+    int serializedSize() const override {
+        return WireFormat::stringSize(sender) + WireFormat::stringSize(message);
+    }
+
     /**
-     * @brief Serializes the chat message into a QByteArray for network transmission.
-     * @return Serialized data.
+     * @brief Appends the chat message to a buffer for network transmission.
+     * @param buffer The buffer to append to.
      */
-    QByteArray serialize() const override {
-        QByteArray data;
-        QDataStream out(&data, QIODevice::WriteOnly);
-        out << sender << message;
-        return data;
+    void serializeInto(QByteArray &buffer) const override {
+        WireFormat::Writer out(buffer, serializedSize());
+        out.writeString(sender);
+        out.writeString(message);
     }
 
     /**
-     * @brief Deserializes a QByteArray into a ChatMessage object.
+     * @brief Deserializes the chat message from borrowed bytes.
      * @param data The serialized message data.
+     * @param size The number of available bytes.
+     * @return False if the data is truncated.
      */
-    void deserialize(const QByteArray &data) override {
-        QDataStream in(data);
-        in >> sender >> message;
+    bool deserialize(const char *data, qsizetype size) override {
+        WireFormat::Reader in(data, size);
+        sender = in.readString();
+        message = in.readString();
+        return in.ok();
     }
 };
 
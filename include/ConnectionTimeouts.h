@@ -0,0 +1,21 @@
+#ifndef CONNECTIONTIMEOUTS_H
+#define CONNECTIONTIMEOUTS_H
+
+/**
+ * @brief Liveness settings of the TCP connections between players and a server.
+ *
+ * Both sides send a heartbeat (an empty frame) at a fixed interval, so a
+ * connection that stays silent for longer than the idle timeout belongs to a
+ * dead or hung peer and is closed. The move timeout bounds how long a round
+ * waits for a player's move; players who miss it are disconnected so the
+ * round can be resolved without them. While a move is expected from a
+ * player, only the move timeout applies to that player's connection, so a
+ * move timeout longer than the idle timeout is honoured.
+ */
+struct ConnectionTimeouts {
+    int heartbeatIntervalMs = 5000; ///< Interval between heartbeats; 0 disables them.
+    int idleTimeoutMs = 15000;      ///< Silence after which a connection is closed; 0 disables the check.
+    int moveTimeoutMs = 30000;      ///< Time a player has to answer a round start; 0 waits forever.
+};
+
+#endif // CONNECTIONTIMEOUTS_H
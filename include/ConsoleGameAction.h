@@ -6,7 +6,7 @@
 
 /**
  * @brief Console-based implementation of the game action menu.
- *        Allows the player to choose Rock, Paper, or Scissors.
+ *        Allows the player to choose Rock, Paper, or Scissors, or to chat with the lobby.
  */
 class ConsoleGameAction : public IGameActionMenu {
     Q_OBJECT
@@ -19,21 +19,52 @@ public:
     explicit ConsoleGameAction(QObject *parent = nullptr);
 
     /**
-     * @brief Displays the console menu and processes user input.
-     *        Players choose Rock, Paper, or Scissors.
+     * @brief Displays the console menu; the input is read without blocking the event loop.
+     *        Players choose Rock, Paper, or Scissors, or send chat messages until they move.
      */
     void showMenu() override;
 
     /**
      * @brief Displays the result of the game.
-     *        Waits for player input before closing the game.
+     *        The game closes once the player presses Enter.
      * @param result The result message (Win/Lose/Draw).
      */
     void showResult(QString result) override;
 
+    /**
+     * @brief Displays the result of a game that is followed by another one.
+     *        Returns right away, since the next round starts on its own.
+     * @param result The result message, including the match score.
+     */
+    void showRoundResult(QString result) override;
+
+    /**
+     * @brief Prints a chat message of the lobby.
+     * @param sender The name of the sender.
+     * @param text The message text.
+     */
+    void showChat(QString sender, QString text) override;
+
+private slots:
+    /**
+     * @brief Handles a line typed on the console.
+     * @param line The typed line.
+     */
+    void onLineRead(const QString &line);
+
 private:
-    QTextStream in;  ///< Input stream for reading user input.
-    QTextStream out; ///< Output stream for displaying options.
+    /**
+     * @brief What the console input is currently used for.
+     */
+    enum class State {
+        Hidden,        ///< No menu is shown; typed lines are ignored.
+        ChoosingMove,  ///< The move menu waits for an option.
+        WritingChat,   ///< The next line is sent as a chat message.
+        WaitingForExit ///< The final result waits for Enter.
+    };
+
+    QTextStream out;             ///< Output stream for displaying options.
+    State state = State::Hidden; ///< Current use of the console input.
 };
 
 #endif // CONSOLEGAMEACTION_H
@@ -0,0 +1,41 @@
+#ifndef CONSOLEINPUT_H
+#define CONSOLEINPUT_H
+
+#include <QObject>
+#include <QString>
+
+/**
+ * @brief Reads lines from standard input without blocking the event loop.
+ *
+ * A reader thread blocks on stdin and hands every line to the main thread
+ * through lineRead(), so sockets, heartbeats and timers keep running while
+ * a console menu waits for the user. The console menus share the single
+ * instance and each acts only on lines that arrive while it is shown.
+ *
+ * The reader thread cannot be woken from its blocking read, so the instance
+ * and its thread live until the process exits.
+ */
+class ConsoleInput : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Returns the shared instance, starting the reader thread on first use.
+     * @return The instance.
+     */
+    static ConsoleInput *instance();
+
+signals:
+    /**
+     * @brief Emitted for every line read from standard input.
+     * @param line The line without its line break.
+     */
+    void lineRead(const QString &line);
+
+private:
+    /**
+     * @brief Constructs the instance and starts the reader thread.
+     */
+    ConsoleInput();
+};
+
+#endif // CONSOLEINPUT_H
@@ -19,13 +19,20 @@ public:
     explicit ConsoleMainMenu(QObject *parent = nullptr);
 
     /**
-     * @brief Displays the console menu and processes user input.
+     * @brief Displays the console menu; the selection is read without blocking the event loop.
      */
     void showMenu() override;
 
+private slots:
+    /**
+     * @brief Handles a line typed on the console.
+     * @param line The typed line.
+     */
+    void onLineRead(const QString &line);
+
 private:
-    QTextStream in;  ///< Input stream for reading user input.
-    QTextStream out; ///< Output stream for displaying menu options.
+    QTextStream out;    ///< Output stream for displaying menu options.
+    bool shown = false; ///< True while the menu waits for a selection.
 };
 
 #endif // CONSOLEMAINMENU_H
@@ -0,0 +1,372 @@
+#ifndef DEDICATEDSERVER_H
+#define DEDICATEDSERVER_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <memory>
+#include "PlayerConnection.h"
+#include "LobbyInfo.h"
+#include "LobbyTable.h"
+#include "LanTcpServer.h"
+#include "UdpBroadcaster.h"
+#include "MatchLog.h"
+#include "RatingService.h"
+#include "MatchmakingQueue.h"
+#include "PingResponder.h"
+#include "Protocol.h"
+#include "Metrics.h"
+#include "TournamentBracket.h"
+#include "SpectatorHub.h"
+
+/**
+ * @brief Hosts many lobbies behind a single TCP listener and a single UDP broadcaster.
+ *
+ * Clients announce the lobby they want with a Join handshake right after
+ * connecting; lobby ID 0 asks for any open lobby. Lobby state lives in a compact
+ * LobbyTable rather than in one ServerLobby object per match, and every finished
+ * lobby is emptied and reopened for new players.
+ *
+ * Players who do not answer a round start within the move timeout are
+ * disconnected, and the round is resolved among the remaining players.
+ *
+ * With matchmaking enabled, the server announces a single entry instead of
+ * every lobby, and every Join puts the player into a MatchmakingQueue. Every
+ * MATCH_TICK_MS the queue is matched in one batch by rating and by the
+ * round-trip time measured with a Ping when the player was queued, and each
+ * group is seated in a free lobby and starts right away.
+ *
+ * In tournament mode, joining players register for the next event, which
+ * starts once enough players have registered. Every ready match of the
+ * TournamentBracket is seated in a free two-seat lobby at once, its games are
+ * replayed in the same lobby until the match is decided, and the players who
+ * stay in the event wait connected for their next match.
+ *
+ * Connections that send Spectate with a lobby ID instead of Join watch that
+ * lobby's rounds through a SpectatorHub without taking a seat.
+ */
+class DedicatedServer : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int MATCH_TICK_MS = 100;        ///< Interval between matchmaking passes.
+    static constexpr int STATS_INTERVAL_MS = 10000;  ///< Interval between matchmaking queue reports.
+
+    /**
+     * @brief Constructs a dedicated server.
+     * @param lobbyNamePrefix The prefix of the announced lobby names.
+     * @param lobbyCount The number of lobbies hosted by the server.
+     * @param maxPlayers The number of players in a full lobby.
+     * @param serverPort The TCP port shared by all lobbies.
+     * @param broadcastPort The UDP port for lobby broadcasting.
+     * @param workerThreads The number of socket worker threads of the TCP server.
+     * @param discovery The channels used to announce the lobbies.
+     * @param parent The parent QObject (optional).
+     */
+    DedicatedServer(const QString &lobbyNamePrefix, int lobbyCount, int maxPlayers,
+                    quint16 serverPort, quint16 broadcastPort, int workerThreads,
+                    const DiscoveryConfig &discovery = DiscoveryConfig(), QObject *parent = nullptr);
+
+    /**
+     * @brief Starts accepting players and announcing the open lobbies.
+     * @return True if the TCP server started successfully, otherwise false.
+     */
+    bool start();
+
+    /**
+     * @brief Stops the broadcast and disconnects every player.
+     */
+    void stop();
+
+    /**
+     * @brief Sets the heartbeat, idle and move timeouts of the player connections.
+     * @param timeouts The connection timeouts.
+     */
+    void setTimeouts(const ConnectionTimeouts &timeouts);
+
+    /**
+     * @brief Sets the limits of the per-connection send queues and the policy for slow consumers.
+     * @param limits The send queue limits.
+     */
+    void setSendQueueLimits(const SendQueueLimits &limits);
+
+    /**
+     * @brief Returns the depth and loss counters of the send queues of all connections.
+     * @return The counters.
+     */
+    SendQueue::Stats sendQueueStats() const;
+
+    /**
+     * @brief Records traffic, round timing and lobby metrics.
+     * @param newMetrics The metrics, which must outlive the server; nullptr stops recording.
+     */
+    void setMetrics(Metrics *newMetrics);
+
+    /**
+     * @brief Records every resolved round in a match history log.
+     * @param log The log, which must outlive the server; nullptr stops recording.
+     */
+    void setMatchLog(MatchLog *log);
+
+    /**
+     * @brief Updates player ratings after every resolved round.
+     * @param service The rating service, which must outlive the server; nullptr stops rating.
+     */
+    void setRatingService(RatingService *service);
+
+    /**
+     * @brief Places joining players with a matchmaking queue instead of the lobby they ask for.
+     *
+     * Must be called before start(). Ratings are taken from the rating service, if one is set.
+     *
+     * @param config The matching tolerances.
+     */
+    void setMatchmaking(const MatchmakingConfig &config);
+
+    /**
+     * @brief Returns the queue depth and wait time counters of the matchmaking queue.
+     * @return The counters; all zero if matchmaking is disabled.
+     */
+    MatchmakingQueue::Stats matchmakingStats() const;
+
+    /**
+     * @brief Runs tournaments instead of letting players pick a lobby.
+     *
+     * Must be called before start() on a server with two seats per lobby.
+     * Players are seeded by rating if a rating service is set, otherwise by
+     * registration order. Players who join while an event runs register for
+     * the next one.
+     *
+     * @param config The bracket format, field size and match length.
+     */
+    void setTournament(const TournamentConfig &config);
+
+public slots:
+    /**
+     * @brief Samples the seated players, spectators, matchmaking queue and send queues into the metrics gauges.
+     */
+    void onMetricsScrape();
+
+private slots:
+    /**
+     * @brief Handles a new connection; the player is seated only after the join handshake.
+     * @param player The connected player.
+     */
+    void onPlayerConnected(const PlayerConnection &player);
+
+    /**
+     * @brief Removes a disconnected player from its lobby.
+     * @param player The disconnected player.
+     */
+    void onPlayerDisconnected(const PlayerConnection &player);
+
+    /**
+     * @brief Routes a message to the join handshake or to the sender's lobby.
+     * @param player The sender of the message.
+     * @param msg The received message.
+     */
+    void onMessageReceived(const PlayerConnection &player, const QByteArray &msg);
+
+    /**
+     * @brief Seats the groups found by one matchmaking pass and reports the queue periodically.
+     */
+    void onMatchTick();
+
+private:
+    std::unique_ptr<LanTcpServer> server;        ///< TCP listener shared by all lobbies.
+    std::unique_ptr<UdpBroadcaster> broadcaster; ///< UDP broadcaster announcing all open lobbies.
+    std::unique_ptr<PingResponder> pingResponder; ///< Answers the latency probes of choosing clients.
+    std::unique_ptr<SpectatorHub> spectators;    ///< Streams the rounds of watched lobbies to spectators.
+
+    const QString namePrefix; ///< Prefix of the announced lobby names.
+    const quint16 tcpPort;    ///< TCP port shared by all lobbies.
+
+    /**
+     * @brief Location of a seated player in the lobby table.
+     */
+    struct SeatRef {
+        int lobby = -1; ///< The lobby index.
+        int seat = -1;  ///< The seat index within the lobby.
+        quint32 playerKey = 0; ///< Stable key of the player for the match log.
+    };
+
+    LobbyTable lobbies;                   ///< State of every hosted lobby.
+    QHash<quint32, SeatRef> seatOfSession; ///< Seat of every seated player, keyed by session ID.
+    QHash<quint32, quint32> identityOfSession; ///< Key sent by the Identify handshake, keyed by session ID.
+    QVector<quint8> outcomes;              ///< Reused per-seat outcome buffer of the round being resolved.
+    QVector<quint32> playerKeys;           ///< Reused per-seat player key buffer for the match log and ratings.
+    MatchLog *matchLog = nullptr;          ///< Log of resolved rounds; not owned.
+    RatingService *ratings = nullptr;      ///< Ratings updated after every round; not owned.
+    Metrics *metrics = nullptr;            ///< Traffic and timing metrics; not owned.
+    QVector<qint64> fillStartUs;           ///< Per lobby, time its first player was seated by a join; -1 if none.
+    QVector<qint64> roundStartUs;          ///< Per lobby, time its current round started; -1 if none.
+
+    std::unique_ptr<MatchmakingQueue> queue; ///< Players waiting for a match; null without matchmaking.
+    MatchmakingConfig matchConfig;           ///< Matching tolerances of the queue.
+    QHash<quint32, quint32> queuedKeys;      ///< Player key of every queued player, keyed by session ID.
+    QVector<int> freeLobbies;                ///< Empty lobbies available to the matchmaker.
+    QVector<quint32> matchedSessions;        ///< Reused output buffer of a matchmaking pass.
+    QTimer matchTimer;                       ///< Drives the matchmaking passes.
+    QElapsedTimer clock;                     ///< Time base of the queue and the Ping probes.
+    qint64 lastStatsMs = 0;                  ///< Time of the last queue report.
+
+    std::unique_ptr<TournamentBracket> bracket; ///< The running event; null while players register.
+    TournamentConfig tournamentConfig;          ///< Format of the events.
+    bool tournamentMode = false;                ///< True if the server runs tournaments.
+    QVector<quint32> entrantSessions;           ///< Session ID of every entrant, in seed order once the event runs.
+    QVector<quint32> entrantKeys;               ///< Player key of every entrant.
+    QHash<quint32, int> entrantOfSession;       ///< Entrant index of every entrant, keyed by session ID.
+    QVector<quint32> waitingSessions;           ///< Players registered for the next event while one runs.
+    QVector<quint32> waitingKeys;               ///< Player key of every waiting player.
+    QVector<int> matchOfLobby;                  ///< Bracket match played in every lobby; -1 if none.
+    QVector<int> readyMatches;                  ///< Reused output buffer of the bracket.
+
+    /**
+     * @brief Frees the seat of a player and reindexes the player moved into it.
+     * @param seatRef The seat to free.
+     */
+    void removeFromSeat(const SeatRef &seatRef);
+
+    /**
+     * @brief Seats a player in the requested lobby, or disconnects it if the lobby is unavailable.
+     * @param player The player who sent the handshake.
+     * @param lobbyId The requested lobby ID; 0 selects any open lobby.
+     */
+    void joinLobby(const PlayerConnection &player, quint32 lobbyId);
+
+    /**
+     * @brief Makes a connection that is not playing a spectator of a lobby.
+     * @param player The connection that sent the request.
+     * @param lobbyId The ID of the lobby to watch.
+     */
+    void watchLobby(const PlayerConnection &player, quint32 lobbyId);
+
+    /**
+     * @brief Puts a player into the matchmaking queue and probes its round-trip time.
+     * @param player The player who sent the handshake.
+     */
+    void enqueuePlayer(const PlayerConnection &player);
+
+    /**
+     * @brief Records the round-trip time of a queued player from its Pong.
+     * @param player The player who answered.
+     * @param sentMs The send time of the Ping, echoed by the player.
+     */
+    void playerPong(const PlayerConnection &player, quint32 sentMs);
+
+    /**
+     * @brief Seats a matched group in a free lobby and starts its round.
+     * @param sessions The session IDs of the group, one per seat.
+     */
+    void seatGroup(const quint32 *sessions);
+
+    /**
+     * @brief Registers a player for the next event and starts it once the field is complete.
+     * @param sessionId The session ID of the player.
+     * @param playerKey The player key of the player.
+     */
+    void registerEntrant(quint32 sessionId, quint32 playerKey);
+
+    /**
+     * @brief Seeds the registered players and starts the event.
+     */
+    void startTournament();
+
+    /**
+     * @brief Seats as many ready bracket matches as there are free lobbies.
+     */
+    void seatTournamentMatches();
+
+    /**
+     * @brief Records a game of a bracket match and replays, continues or ends the match.
+     * @param lobby The lobby index.
+     */
+    void finishTournamentGame(int lobby);
+
+    /**
+     * @brief Removes a disconnected player from the registration, the waiting list or the running event.
+     * @param sessionId The session ID of the player.
+     * @return True if the player took part in a tournament.
+     */
+    bool leaveTournament(quint32 sessionId);
+
+    /**
+     * @brief Returns the bracket slot of a player in a match.
+     * @param match The match index.
+     * @param sessionId The session ID of the player.
+     * @return 0 or 1.
+     */
+    int slotOf(int match, quint32 sessionId) const;
+
+    /**
+     * @brief Sends a player the result of a tournament game.
+     * @param sessionId The session ID of the player.
+     * @param match The match index.
+     * @param outcome The Win, Lose or Draw opcode of the game.
+     * @param continues True if the player has games left in the event.
+     */
+    void sendTournamentResult(quint32 sessionId, int match, Protocol::Opcode outcome, bool continues);
+
+    /**
+     * @brief Seats the next matches, or ends the event once its final is decided.
+     */
+    void advanceTournament();
+
+    /**
+     * @brief Reports the champion and registers the waiting players for the next event.
+     */
+    void endTournament();
+
+    /**
+     * @brief Announces the registration of the next event.
+     */
+    void announceTournament();
+
+    /**
+     * @brief Records a player's move and resolves the round once all moves are in.
+     * @param player The player who made the move.
+     * @param choice The move (1 = Rock, 2 = Paper, 3 = Scissors).
+     */
+    void playerMove(const PlayerConnection &player, int choice);
+
+    /**
+     * @brief Starts the round of a full lobby.
+     * @param lobby The lobby index.
+     */
+    void startRound(int lobby);
+
+    /**
+     * @brief Sends the results of a round and reopens the lobby.
+     * @param lobby The lobby index.
+     */
+    void resolveRound(int lobby);
+
+    /**
+     * @brief Empties a lobby and announces it again.
+     * @param lobby The lobby index.
+     */
+    void resetLobby(int lobby);
+
+    /**
+     * @brief Returns the time on the server clock in microseconds.
+     * @return The elapsed time.
+     */
+    qint64 elapsedUs() const;
+
+    /**
+     * @brief Returns the stable key of a player for the ratings and the match log.
+     * @param player The player.
+     * @return The key sent by its Identify handshake, or the key of its address.
+     */
+    quint32 playerKeyOf(const PlayerConnection &player) const;
+
+    /**
+     * @brief Announces an open lobby or withdraws the announcement of an unavailable one.
+     * @param lobby The lobby index.
+     */
+    void announceLobby(int lobby);
+};
+
+#endif // DEDICATEDSERVER_H
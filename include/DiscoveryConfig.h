@@ -0,0 +1,80 @@
+#ifndef DISCOVERYCONFIG_H
+#define DISCOVERYCONFIG_H
+
+#include <QHostAddress>
+#include <QList>
+#include <QNetworkInterface>
+#include <QString>
+#include <QStringList>
+
+/**
+ * @brief Selects how lobby announcements travel between hosts and clients.
+ *
+ * Broadcast reaches every host of the local subnets and needs one datagram per
+ * interface. Multicast sends one datagram to a group; only hosts that joined
+ * the group receive it, and a TTL above 1 lets it cross routers into other
+ * segments that forward the group.
+ */
+struct DiscoveryConfig {
+    /**
+     * @brief Transport used for announcements.
+     */
+    enum class Mode {
+        Broadcast, ///< Subnet broadcast on every interface.
+        Multicast, ///< Multicast to the configured group.
+        Both       ///< Announce on both channels; listen on both.
+    };
+
+    static constexpr const char *DEFAULT_GROUP = "239.255.50.5"; ///< Organization-local multicast group.
+
+    Mode mode = Mode::Broadcast;                         ///< Transport used for announcements.
+    QHostAddress multicastGroup{QString(DEFAULT_GROUP)}; ///< Multicast group of the announcements.
+    int multicastTtl = 1;                                ///< Hop limit of multicast announcements; 1 stays on the local segment.
+    QStringList interfaceNames;                          ///< Interfaces used for multicast; empty uses the system default.
+
+    /**
+     * @brief Indicates whether announcements are broadcast.
+     * @return True for Broadcast and Both.
+     */
+    bool usesBroadcast() const { return mode != Mode::Multicast; }
+
+    /**
+     * @brief Indicates whether announcements are multicast.
+     * @return True for Multicast and Both.
+     */
+    bool usesMulticast() const { return mode != Mode::Broadcast; }
+
+    /**
+     * @brief Resolves the configured interface names.
+     *
+     * Unknown interfaces and interfaces that cannot carry multicast are skipped.
+     *
+     * @return The interfaces to join or send on; empty means the system default.
+     */
+    QList<QNetworkInterface> multicastInterfaces() const {
+        QList<QNetworkInterface> interfaces;
+        for (const QString &name : interfaceNames) {
+            const QNetworkInterface interface = QNetworkInterface::interfaceFromName(name);
+            if (interface.isValid() && interface.flags().testFlag(QNetworkInterface::CanMulticast)) {
+                interfaces.append(interface);
+            }
+        }
+        return interfaces;
+    }
+
+    /**
+     * @brief Parses a mode name given on the command line.
+     * @param name "broadcast", "multicast" or "both".
+     * @param ok Receives false if the name is unknown.
+     * @return The parsed mode; Broadcast if the name is unknown.
+     */
+    static Mode parseMode(const QString &name, bool *ok = nullptr) {
+        if (ok) *ok = true;
+        if (name == "multicast") return Mode::Multicast;
+        if (name == "both") return Mode::Both;
+        if (name != "broadcast" && ok) *ok = false;
+        return Mode::Broadcast;
+    }
+};
+
+#endif // DISCOVERYCONFIG_H
@@ -2,8 +2,8 @@
 #define GAMEACTION_H
 
 #include "INetworkSerializable.h"
-#include <QDataStream>
-#include <QHostAddress>
+#include "WireFormat.h"
+#include <QString>
 
 /**
  * @brief Enum representing possible game actions (Rock, Paper, Scissors).
@@ -30,26 +30,37 @@ struct GameAction : public INetworkSerializable {
      */
     GameAction(ActionType act, const QString &name) : action(act), playerName(name) {}
 
+    using INetworkSerializable::deserialize;
+
+    /**
+     * @brief Returns the serialized size of the game action.
+     * @return The size in bytes.
+     */
+    int serializedSize() const override {
+        return 4 + WireFormat::stringSize(playerName);
+    }
+
     /**
-     * @brief Serializes the game action into a QByteArray for network transmission.
-     * @return Serialized data.
+     * @brief Appends the game action to a buffer for network transmission.
+     * @param buffer The buffer to append to.
      */
-    QByteArray serialize() const override {
-        QByteArray data;
-        QDataStream out(&data, QIODevice::WriteOnly);
-        out << static_cast<int>(action) << playerName;
-        return data;
+    void serializeInto(QByteArray &buffer) const override {
+        WireFormat::Writer out(buffer, serializedSize());
+        out.writeI32(static_cast<qint32>(action));
+        out.writeString(playerName);
     }
 
     /**
-     * @brief Deserializes a QByteArray into a GameAction object.
+     * @brief Deserializes the game action from borrowed bytes.
      * @param data The serialized game action data.
+     * @param size The number of available bytes.
+     * @return False if the data is truncated.
      */
-    void deserialize(const QByteArray &data) override {
-        QDataStream in(data);
-        int actionInt;
-        in >> actionInt >> playerName;
-        action = static_cast<ActionType>(actionInt);
+    bool deserialize(const char *data, qsizetype size) override {
+        WireFormat::Reader in(data, size);
+        action = static_cast<ActionType>(in.readI32());
+        playerName = in.readString();
+        return in.ok();
     }
 };
 
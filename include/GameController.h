@@ -25,6 +25,30 @@ public:
      */
     void invokeMainMenu();
 
+    /**
+     * @brief Selects the channels used to discover and announce lobbies.
+     * @param config The discovery settings.
+     */
+    void setDiscoveryConfig(const DiscoveryConfig &config);
+
+    /**
+     * @brief Records the rounds of hosted lobbies in a match history log.
+     * @param log The log, which must outlive the controller.
+     */
+    void setMatchLog(MatchLog *log);
+
+    /**
+     * @brief Rates the players of hosted lobbies.
+     * @param service The rating service, which must outlive the controller.
+     */
+    void setRatingService(RatingService *service);
+
+    /**
+     * @brief Records the traffic and round timing of hosted lobbies.
+     * @param metrics The metrics, which must outlive the controller.
+     */
+    void setMetrics(Metrics *metrics);
+
 private:
     IMainMenu *mainMenu;      ///< Pointer to the main menu interface.
     IGameActionMenu *gameActionMenu; ///< Pointer to the game action menu interface.
@@ -52,6 +76,12 @@ private slots:
      */
     void onPlayerMadeChoice(int choice);
 
+    /**
+     * @brief Handles a chat message written by the player.
+     * @param text The message text.
+     */
+    void onPlayerSentChat(QString text);
+
     /**
      * @brief Displays the game action menu when invoked by the server.
      */
@@ -62,6 +92,19 @@ private slots:
      * @param result The result message (Win/Lose/Draw).
      */
     void onInvokeResult(QString result);
+
+    /**
+     * @brief Displays the result of a game that is followed by another one.
+     * @param result The result message, including the match score.
+     */
+    void onInvokeRoundResult(QString result);
+
+    /**
+     * @brief Displays a chat message received from the lobby.
+     * @param sender The name of the sender.
+     * @param text The message text.
+     */
+    void onInvokeChat(QString sender, QString text);
 };
 
 #endif // GAMECONTROLLER_H
@@ -0,0 +1,49 @@
+#ifndef GAMERULES_H
+#define GAMERULES_H
+
+/**
+ * @brief Rock-Paper-Scissors rules shared by every server implementation.
+ */
+namespace GameRules {
+
+/**
+ * @brief Player moves as they travel over the network.
+ */
+enum Choice : int {
+    None = 0,     ///< The player has not chosen yet.
+    Rock = 1,     ///< Rock.
+    Paper = 2,    ///< Paper.
+    Scissors = 3  ///< Scissors.
+};
+
+/**
+ * @brief Checks whether a value received from a player is a valid move.
+ * @param choice The received value.
+ * @return True for Rock, Paper or Scissors.
+ */
+inline bool isValidChoice(int choice) {
+    return choice >= Rock && choice <= Scissors;
+}
+
+/**
+ * @brief Determines the winning move of a round from the moves that were played.
+ *
+ * A round is a draw when all three moves or only one move were played.
+ *
+ * @param rock True if at least one player chose Rock.
+ * @param paper True if at least one player chose Paper.
+ * @param scissors True if at least one player chose Scissors.
+ * @return The winning move, or None if the round is a draw.
+ */
+inline int winningChoice(bool rock, bool paper, bool scissors) {
+    const int distinctChoices = int(rock) + int(paper) + int(scissors);
+    if (distinctChoices != 2) return None;
+
+    if (rock && scissors) return Rock;
+    if (paper && rock) return Paper;
+    return Scissors;
+}
+
+} // namespace GameRules
+
+#endif // GAMERULES_H
@@ -23,6 +23,12 @@ signals:
      */
     void playerMadeChoice(int choice);
 
+    /**
+     * @brief Emitted when the player writes a chat message.
+     * @param text The message text.
+     */
+    void playerSentChat(QString text);
+
     /**
      * @brief Emitted when the game should be closed.
      */
@@ -40,6 +46,19 @@ public:
      */
     virtual void showResult(QString result) = 0;
 
+    /**
+     * @brief Displays the result of a game that is followed by another one (must be implemented in derived classes).
+     * @param result The result message, including the match score.
+     */
+    virtual void showRoundResult(QString result) = 0;
+
+    /**
+     * @brief Displays a chat message of the lobby (must be implemented in derived classes).
+     * @param sender The name of the sender.
+     * @param text The message text.
+     */
+    virtual void showChat(QString sender, QString text) = 0;
+
     /**
      * @brief Virtual destructor to ensure proper cleanup in derived classes.
      */
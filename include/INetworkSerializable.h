@@ -5,23 +5,56 @@
 
 /**
  * @brief Interface for serializing and deserializing objects for network transmission.
+ *
+ * Implementations provide the size-aware, allocation-free primitives
+ * (serializedSize, serializeInto and the view-based deserialize); the
+ * QByteArray-based convenience overloads are built on top of them.
  */
 class INetworkSerializable {
 public:
     virtual ~INetworkSerializable() = default;
 
+    /**
+     * @brief Returns the exact number of bytes serializeInto() will append.
+     * @return The serialized size in bytes.
+     */
+    virtual int serializedSize() const = 0;
+
+    /**
+     * @brief Appends the serialized object to a caller-owned buffer.
+     *
+     * Reusing the same buffer across calls avoids an allocation per message.
+     *
+     * @param buffer The buffer to append to.
+     */
+    virtual void serializeInto(QByteArray &buffer) const = 0;
+
+    /**
+     * @brief Deserializes an object from borrowed bytes without copying them.
+     * @param data The first byte of the serialized data.
+     * @param size The number of available bytes.
+     * @return False if the data is truncated or malformed.
+     */
+    virtual bool deserialize(const char *data, qsizetype size) = 0;
+
     /**
      * @brief Serializes the object into a QByteArray for network transmission.
      * @return Serialized byte array.
      */
-    virtual QByteArray serialize() const = 0;
+    virtual QByteArray serialize() const {
+        QByteArray data;
+        data.reserve(serializedSize());
+        serializeInto(data);
+        return data;
+    }
 
     /**
      * @brief Deserializes an object from a QByteArray.
      * @param data The serialized data.
      */
-    virtual void deserialize(const QByteArray& data) = 0;
+    virtual void deserialize(const QByteArray& data) {
+        deserialize(data.constData(), data.size());
+    }
 };
 
 #endif // INETWORKSERIALIZABLE_H
-
@@ -3,13 +3,20 @@
 
 #include <QTcpSocket>
 #include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "LobbyInfo.h"
+#include "MessageFramer.h"
+#include "ConnectionTimeouts.h"
 
 /**
  * @brief The LanTcpClient class handles TCP communication with a game server.
  *
  * This class provides methods to connect to a server, send messages, and handle
  * incoming data. It also emits signals for connection status and received messages.
+ *
+ * While connected, the client sends heartbeats and closes the connection with
+ * an error if the server stays silent for longer than the idle timeout.
  */
 class LanTcpClient : public QObject {
     Q_OBJECT
@@ -34,8 +41,9 @@ public:
      *
      * @param hostAdress The IP address of the server.
      * @param info The lobby information containing the server's TCP port.
+     * @return True if a connection attempt was started, false if the client is already busy.
      */
-    void connectToServer(const QHostAddress &hostAdress, const LobbyInfo &info);
+    bool connectToServer(const QHostAddress &hostAdress, const LobbyInfo &info);
 
     /**
      * @brief Disconnects from the currently connected server.
@@ -44,14 +52,40 @@ public:
      */
     void disconnectFromServer();
 
+    /**
+     * @brief Checks whether the client is connected or connecting.
+     * @return True unless the socket is unconnected.
+     */
+    bool isBusy() const;
+
     /**
      * @brief Sends a message to the connected server.
      *
      * If the client is connected, the provided message is transmitted.
+     * Empty messages are refused, since an empty frame is a heartbeat.
      *
      * @param message The data to be sent.
+     * @return False if the message is empty or the client is not connected.
+     */
+    bool sendMessage(const QByteArray &message);
+
+    /**
+     * @brief Sends several messages to the connected server in a single write.
+     *
+     * Each message is framed separately, so the server receives them one by one.
+     *
+     * @param messages The messages to be sent.
      */
-    void sendMessage(const QByteArray &message);
+    void sendMessages(const QList<QByteArray> &messages);
+
+    /**
+     * @brief Sets the heartbeat interval and the idle timeout.
+     *
+     * Takes effect with the next connection.
+     *
+     * @param newTimeouts The connection timeouts; the move timeout is ignored.
+     */
+    void setTimeouts(const ConnectionTimeouts &newTimeouts);
 
 signals:
     /**
@@ -65,8 +99,8 @@ signals:
     void disconnected();
 
     /**
-     * @brief Emitted when a message is received from the server.
-     * @param message The received data.
+     * @brief Emitted once for every complete frame received from the server.
+     * @param message The payload of the received frame.
      */
     void messageReceived(const QByteArray &message);
 
@@ -94,12 +128,22 @@ private slots:
     /**
      * @brief Reads incoming data from the server.
      *
-     * Emits the `messageReceived` signal with the received data.
+     * Emits the `messageReceived` signal for every complete frame.
      */
     void onReadyRead();
 
+    /**
+     * @brief Sends a heartbeat and closes the connection if the server went silent.
+     */
+    void onHeartbeat();
+
 private:
     QTcpSocket *socket; ///< The TCP socket used for communication.
+    MessageFramer framer; ///< Reassembly buffer for partially received frames.
+
+    ConnectionTimeouts timeouts; ///< Heartbeat interval and idle timeout.
+    QTimer heartbeatTimer;       ///< Sends heartbeats and checks for silence while connected.
+    QElapsedTimer lastReceive;   ///< Time since data was last received from the server.
 };
 
 #endif // LANTCPCLIENT_H
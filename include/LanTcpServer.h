@@ -3,30 +3,63 @@
 
 #include <QTcpServer>
 #include <QTcpSocket>
-#include <QMap>
+#include <QThread>
+#include <QList>
+#include <QHash>
+#include <QVector>
 #include "PlayerConnection.h"
+#include "MessageFramer.h"
+#include "LanTcpWorker.h"
+#include "ConnectionTimeouts.h"
+#include "SendQueue.h"
+#include "Metrics.h"
 
 /**
  * @brief A TCP server class for managing player connections in a LAN game.
  *
  * LanTcpServer listens for incoming player connections, manages connected clients,
  * and facilitates message exchange between players.
+ *
+ * Accepted connections are handed to socket workers. By default a single worker
+ * runs in the server's own thread; optionally the server spawns several worker
+ * threads, each with its own event loop, and assigns every new connection to the
+ * least-loaded one. Worker signals reach the server's thread in emission order.
+ *
+ * Every connection receives a session ID at accept time. The server indexes
+ * the owning worker by session ID and each worker indexes its sockets the same
+ * way, so sending to or disconnecting a player costs constant time.
+ *
+ * Each worker sends heartbeats and closes connections that stay silent for
+ * longer than the idle timeout, see ConnectionTimeouts.
+ *
+ * Frames that a slow peer cannot take yet wait in a bounded send queue per
+ * connection, see SendQueueLimits; the server never buffers more than the
+ * limits allow for any one client.
  */
 class LanTcpServer : public QTcpServer {
     Q_OBJECT
 public:
     /**
-     * @brief Constructs a LanTcpServer instance.
+     * @brief Constructs a LanTcpServer instance that services all sockets in its own thread.
      *
      * @param port The port on which the server will listen for connections.
      * @param parent The parent QObject (default is nullptr).
      */
     explicit LanTcpServer(quint16 port, QObject *parent = nullptr);
 
+    /**
+     * @brief Constructs a LanTcpServer instance with dedicated socket worker threads.
+     *
+     * @param port The port on which the server will listen for connections.
+     * @param workerThreads The number of worker threads; 0 keeps all sockets in the server's thread.
+     * @param parent The parent QObject (default is nullptr).
+     */
+    LanTcpServer(quint16 port, int workerThreads, QObject *parent = nullptr);
+
     /**
      * @brief Destructor for LanTcpServer.
      *
-     * Stops the server and disconnects all players.
+     * Stops the server, disconnects all players and joins the worker threads.
      */
     ~LanTcpServer();
 
@@ -57,6 +90,13 @@ public:
      */
     void disconnectPlayer(const PlayerConnection &player);
 
+    /**
+     * @brief Disconnects the player of a session.
+     *
+     * @param sessionId The session ID of the player.
+     */
+    void disconnectPlayer(quint32 sessionId);
+
     /**
      * @brief Sends a message to all connected players.
      *
@@ -72,6 +112,110 @@ public:
      */
     void sendMessageToPlayer(const PlayerConnection &player, const QByteArray &message);
 
+    /**
+     * @brief Sends a message to the player of a session.
+     *
+     * @param sessionId The session ID of the recipient.
+     * @param message The message to send.
+     */
+    void sendMessageToPlayer(quint32 sessionId, const QByteArray &message);
+
+    /**
+     * @brief Sends the same message to the players of several sessions.
+     *
+     * The message is framed once and the immutable frame is shared by reference
+     * with every recipient, so a fan-out costs one encode plus one cheap enqueue
+     * per worker instead of one copy per player.
+     *
+     * @param sessionIds The session IDs of the recipients.
+     * @param message The message to send.
+     */
+    void sendMessageToPlayers(const QVector<quint32> &sessionIds, const QByteArray &message);
+
+    /**
+     * @brief Sends a state snapshot that supersedes every earlier one to the players of several sessions.
+     *
+     * Like sendMessageToPlayers(), the snapshot is framed once and shared.
+     * Recipients that read too slowly skip snapshots instead of buffering
+     * them, see SendQueue; they always receive the newest one eventually.
+     *
+     * @param sessionIds The session IDs of the recipients.
+     * @param message The snapshot to send.
+     */
+    void sendSnapshotToPlayers(const QVector<quint32> &sessionIds, const QByteArray &message);
+
+    /**
+     * @brief Sends a low-priority message, such as chat, to the players of several sessions.
+     *
+     * Like sendMessageToPlayers(), the message is framed once and shared.
+     * Each recipient receives it only once everything else sent to it has
+     * been written, see SendQueue.
+     *
+     * @param sessionIds The session IDs of the recipients.
+     * @param message The message to send.
+     */
+    void sendLowPriorityToPlayers(const QVector<quint32> &sessionIds, const QByteArray &message);
+
+    /**
+     * @brief Sets the heartbeat, idle and move timeouts.
+     *
+     * Heartbeat and idle settings are applied by every worker; the move
+     * timeout is only stored for the game logic, see expectMessage().
+     *
+     * @param newTimeouts The connection timeouts.
+     */
+    void setTimeouts(const ConnectionTimeouts &newTimeouts);
+
+    /**
+     * @brief Returns the connection timeouts.
+     * @return The current timeouts.
+     */
+    const ConnectionTimeouts &timeouts() const;
+
+    /**
+     * @brief Sets the limits of the per-connection send queues and the policy for slow consumers.
+     * @param limits The send queue limits.
+     */
+    void setSendQueueLimits(const SendQueueLimits &limits);
+
+    /**
+     * @brief Returns the depth and loss counters of the send queues of all workers.
+     *
+     * The counters are read without stopping the workers, so the sums may be
+     * slightly out of date.
+     *
+     * @return The counters.
+     */
+    SendQueue::Stats sendQueueStats() const;
+
+    /**
+     * @brief Records connection, traffic and per-opcode message counters.
+     *
+     * Received messages and bytes are counted by the workers; sent messages
+     * are counted per recipient when they are handed to the workers.
+     *
+     * @param newMetrics The metrics, which must outlive the server; nullptr stops recording.
+     */
+    void setMetrics(Metrics *newMetrics);
+
+    /**
+     * @brief Requires a message from each of several sessions within a deadline.
+     *
+     * The deadline of a session is met when the game layer accepts its
+     * message and calls fulfilMessage(). Sessions that miss it are
+     * disconnected and reported through playerDisconnected().
+     *
+     * @param sessionIds The session IDs of the players.
+     * @param timeoutMs The deadline in milliseconds.
+     */
+    void expectMessage(const QVector<quint32> &sessionIds, int timeoutMs);
+
+    /**
+     * @brief Meets the pending deadline of a session.
+     * @param sessionId The session ID of the player.
+     */
+    void fulfilMessage(quint32 sessionId);
+
 signals:
     /**
      * @brief Emitted when a new player connects.
@@ -86,15 +230,15 @@ signals:
     void playerDisconnected(const PlayerConnection &player);
 
     /**
-     * @brief Emitted when a message is received from a player.
+     * @brief Emitted once for every complete frame received from a player.
      * @param player The sender of the message.
-     * @param message The received message.
+     * @param message The payload of the received frame.
      */
     void messageReceived(const PlayerConnection &player, const QByteArray &message);
 
 protected:
     /**
-     * @brief Handles new incoming player connections.
+     * @brief Hands a new incoming connection to the least-loaded worker.
      *
      * @param socketDescriptor The descriptor of the incoming connection.
      */
@@ -102,34 +246,49 @@ protected:
 
 private slots:
     /**
-     * @brief Reads incoming messages from clients.
+     * @brief Indexes a connection accepted by a worker and forwards the signal.
+     * @param player The connected player.
      */
-    void onReadyRead();
+    void onWorkerPlayerConnected(const PlayerConnection &player);
 
     /**
-     * @brief Handles client disconnection events.
+     * @brief Drops the index entry of a closed connection and forwards the signal.
+     * @param player The disconnected player.
      */
-    void onClientDisconnected();
+    void onWorkerPlayerDisconnected(const PlayerConnection &player);
 
 private:
-    quint16 serverPort; ///< The port on which the server listens.
+    quint16 listenPort; ///< The configured listening port; 0 picks a free port, see serverPort().
     bool acceptingPlayers = true; ///< Indicates whether new players can join.
 
-    /// Stores connected players with their sockets.
-    QMap<QTcpSocket*, PlayerConnection> players;
+    QList<LanTcpWorker*> workers; ///< Socket workers that own the player connections.
+    QList<QThread*> workerThreads; ///< Threads running the workers; empty in single-threaded mode.
+    int nextWorker = 0; ///< Round-robin start index used to break ties between equally loaded workers.
+
+    quint32 nextSessionId = 1; ///< Session ID assigned to the next accepted connection.
+    QHash<quint32, LanTcpWorker*> workerOfSession; ///< Owning worker of every connected session.
+
+    ConnectionTimeouts connectionTimeouts; ///< Heartbeat, idle and move timeouts.
+    Metrics *metrics = nullptr;           ///< Traffic and message counters; not owned.
+
+    /**
+     * @brief Creates the socket workers and, if requested, their threads.
+     * @param threadCount The number of worker threads; 0 creates one worker in the server's thread.
+     */
+    void createWorkers(int threadCount);
 
     /**
-     * @brief Creates a PlayerConnection object from a socket.
-     * @param socket The player's socket.
-     * @return The corresponding PlayerConnection.
+     * @brief Selects the worker with the fewest connections.
+     * @return The selected worker.
      */
-    PlayerConnection createPlayerFromSocket(QTcpSocket *socket);
+    LanTcpWorker *selectWorker();
 
     /**
-     * @brief Removes a client from the server and cleans up resources.
-     * @param socket The socket of the player to remove.
+     * @brief Groups sessions by the worker that owns them.
+     * @param sessionIds The session IDs; unknown sessions are skipped.
+     * @return The sessions of every involved worker.
      */
-    void removeClient(QTcpSocket *socket);
+    QHash<LanTcpWorker*, QVector<quint32>> groupByWorker(const QVector<quint32> &sessionIds) const;
 };
 
 #endif // LANTCPSERVER_H
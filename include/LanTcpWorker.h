@@ -0,0 +1,296 @@
+#ifndef LANTCPWORKER_H
+#define LANTCPWORKER_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <atomic>
+#include "PlayerConnection.h"
+#include "MessageFramer.h"
+#include "ConnectionTimeouts.h"
+#include "TimerWheel.h"
+#include "SendQueue.h"
+#include "Metrics.h"
+
+/**
+ * @brief Owns a subset of the server's player sockets and services them in its own thread.
+ *
+ * LanTcpServer hands accepted socket descriptors to its workers. Each worker lives
+ * in the thread it was moved to, so all socket I/O for its players runs on that
+ * thread's event loop. Results are reported back through signals, which Qt queues
+ * to the server's thread in emission order.
+ *
+ * Heartbeats, idle timeouts and message deadlines of all the worker's
+ * connections share one TimerWheel driven by a single QTimer, so the cost
+ * per tick does not grow with the number of connections.
+ *
+ * Outgoing frames are handed to a socket only while its unsent backlog
+ * stays below WRITE_WATERMARK_BYTES. The rest wait in a bounded SendQueue per
+ * connection, which orders them by priority class: control messages, then
+ * the newest snapshot, then bulk traffic such as chat. A peer that reads too
+ * slowly loses queued frames or is disconnected according to the
+ * SendQueueLimits, so one stalled client cannot grow the server's memory.
+ */
+class LanTcpWorker : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int TIMER_TICK_MS = 100; ///< Resolution of the connection timers.
+    static constexpr qint64 WRITE_WATERMARK_BYTES = 16 * 1024; ///< Unsent socket bytes above which frames are queued.
+
+    /**
+     * @brief Constructs a LanTcpWorker instance.
+     * @param parent The parent QObject (default is nullptr).
+     */
+    explicit LanTcpWorker(QObject *parent = nullptr);
+
+    /**
+     * @brief Returns the number of connections assigned to this worker.
+     *
+     * Safe to call from any thread; used by the server for load balancing.
+     *
+     * @return The number of assigned connections.
+     */
+    int connectionCount() const;
+
+    /**
+     * @brief Reserves a connection slot before a descriptor is handed to the worker.
+     *
+     * Called from the server's thread so that consecutive connections see the
+     * updated load even before the worker has processed them.
+     */
+    void reserveConnection();
+
+    /**
+     * @brief Returns the depth and loss counters of the send queues of this worker.
+     *
+     * Safe to call from any thread.
+     *
+     * @return The counters.
+     */
+    SendQueue::Stats sendQueueStats() const;
+
+public slots:
+    /**
+     * @brief Takes ownership of an accepted connection.
+     * @param socketDescriptor The descriptor of the accepted connection.
+     * @param sessionId The session ID assigned to the connection by the server.
+     */
+    void addConnection(qintptr socketDescriptor, quint32 sessionId);
+
+    /**
+     * @brief Disconnects the player of a session.
+     * @param sessionId The session ID of the player.
+     */
+    void disconnectPlayer(quint32 sessionId);
+
+    /**
+     * @brief Writes an already framed message to every socket of this worker.
+     * @param frame The framed message.
+     */
+    void sendFrameToAll(const QByteArray &frame);
+
+    /**
+     * @brief Writes an already framed message to the player of a session.
+     * @param sessionId The session ID of the recipient.
+     * @param frame The framed message.
+     */
+    void sendFrameToPlayer(quint32 sessionId, const QByteArray &frame);
+
+    /**
+     * @brief Writes an already framed message to the players of several sessions.
+     * @param sessionIds The session IDs of the recipients owned by this worker.
+     * @param frame The framed message, shared by all recipients.
+     */
+    void sendFrameToPlayers(const QVector<quint32> &sessionIds, const QByteArray &frame);
+
+    /**
+     * @brief Sends a framed snapshot that supersedes earlier ones to the players of several sessions.
+     * @param sessionIds The session IDs of the recipients owned by this worker.
+     * @param frame The framed snapshot, shared by all recipients.
+     */
+    void sendSnapshotToPlayers(const QVector<quint32> &sessionIds, const QByteArray &frame);
+
+    /**
+     * @brief Sends a framed low-priority message to the players of several sessions.
+     * @param sessionIds The session IDs of the recipients owned by this worker.
+     * @param frame The framed message, shared by all recipients.
+     */
+    void sendLowPriorityToPlayers(const QVector<quint32> &sessionIds, const QByteArray &frame);
+
+    /**
+     * @brief Applies new heartbeat and idle settings.
+     *
+     * Existing connections pick the settings up when their timers next fire.
+     *
+     * @param newTimeouts The connection timeouts.
+     */
+    void setTimeouts(const ConnectionTimeouts &newTimeouts);
+
+    /**
+     * @brief Applies new send queue limits to every connection.
+     * @param limits The limits.
+     */
+    void setSendQueueLimits(const SendQueueLimits &limits);
+
+    /**
+     * @brief Records connection, traffic and message counters.
+     * @param newMetrics The metrics, which must outlive the worker; nullptr stops recording.
+     */
+    void setMetrics(Metrics *newMetrics);
+
+    /**
+     * @brief Requires a message from each of several sessions within a deadline.
+     *
+     * The deadline of a session is met only by fulfilMessage(); received
+     * frames do not count, because only the game layer knows which messages
+     * are the expected ones. Sessions that miss it are disconnected.
+     *
+     * @param sessionIds The session IDs owned by this worker.
+     * @param timeoutMs The deadline in milliseconds.
+     */
+    void expectMessage(const QVector<quint32> &sessionIds, int timeoutMs);
+
+    /**
+     * @brief Marks the expected message of a session as received and cancels its deadline.
+     * @param sessionId The session ID owned by this worker.
+     */
+    void fulfilMessage(quint32 sessionId);
+
+    /**
+     * @brief Disconnects and releases every socket owned by this worker.
+     */
+    void closeAll();
+
+signals:
+    /**
+     * @brief Emitted when a new player connects.
+     * @param player The connected player.
+     */
+    void playerConnected(const PlayerConnection &player);
+
+    /**
+     * @brief Emitted when a player disconnects.
+     * @param player The disconnected player.
+     */
+    void playerDisconnected(const PlayerConnection &player);
+
+    /**
+     * @brief Emitted once for every complete frame received from a player.
+     * @param player The sender of the message.
+     * @param message The payload of the received frame.
+     */
+    void messageReceived(const PlayerConnection &player, const QByteArray &message);
+
+private slots:
+    /**
+     * @brief Reads incoming data from clients and extracts complete frames.
+     */
+    void onReadyRead();
+
+    /**
+     * @brief Handles client disconnection events.
+     */
+    void onClientDisconnected();
+
+    /**
+     * @brief Counts the written bytes and writes queued frames once a socket's backlog drains.
+     * @param bytes The number of bytes written.
+     */
+    void onBytesWritten(qint64 bytes);
+
+    /**
+     * @brief Advances the timer wheel and handles the expired connection timers.
+     */
+    void onTimerTick();
+
+private:
+    /**
+     * @brief Kinds of timers kept per connection.
+     */
+    enum class TimerKind : quint8 {
+        Heartbeat, ///< Sends the next heartbeat.
+        Idle,      ///< Checks whether the peer has been silent for too long.
+        Deadline   ///< Checks whether an expected message arrived.
+    };
+
+    /**
+     * @brief State kept for every socket owned by the worker.
+     */
+    struct Connection {
+        PlayerConnection player;      ///< The player using the socket.
+        MessageFramer framer;         ///< Reassembly buffer for partially received frames.
+        qint64 lastReceiveMs = 0;     ///< Worker clock time of the last received data.
+        bool awaitingMessage = false; ///< True while a message deadline is pending.
+        SendQueue sendQueue;          ///< Frames waiting for the socket's backlog to drain.
+        bool overflowed = false;      ///< True once the connection is closed for reading too slowly.
+    };
+
+    /**
+     * @brief Writes a frame to a socket, or queues it while the socket's backlog is too large.
+     * @param socket The socket.
+     * @param connection The state of the socket.
+     * @param priority The priority class of the frame.
+     * @param frame The framed message.
+     */
+    void send(QTcpSocket *socket, Connection &connection, SendQueue::Priority priority, const QByteArray &frame);
+
+    /**
+     * @brief Writes queued frames to a socket until its backlog reaches the watermark.
+     * @param socket The socket.
+     * @param connection The state of the socket.
+     */
+    void flush(QTcpSocket *socket, Connection &connection);
+
+    /**
+     * @brief Builds the timer wheel key of a connection timer.
+     * @param kind The kind of timer.
+     * @param sessionId The session ID of the connection.
+     * @return The key.
+     */
+    static quint64 timerKey(TimerKind kind, quint32 sessionId);
+
+    /**
+     * @brief Starts the heartbeat and idle timers of a new connection.
+     * @param sessionId The session ID of the connection.
+     */
+    void startTimers(quint32 sessionId);
+
+    /**
+     * @brief Cancels every timer of a connection.
+     * @param sessionId The session ID of the connection.
+     */
+    void cancelTimers(quint32 sessionId);
+
+    /**
+     * @brief Handles one expired connection timer.
+     * @param key The key of the expired timer.
+     */
+    void handleTimer(quint64 key);
+
+    QHash<QTcpSocket*, Connection> connectionsBySocket; ///< Per-socket state of every connected player.
+    QHash<quint32, QTcpSocket*> socketsBySession;        ///< Sockets indexed by session ID.
+
+    std::atomic<int> connections{0}; ///< Number of connections assigned to this worker.
+
+    ConnectionTimeouts timeouts;  ///< Heartbeat and idle settings.
+    TimerWheel timers;            ///< Heartbeat, idle and deadline timers of every connection.
+    QTimer tickTimer;             ///< Drives the timer wheel while the worker has connections.
+    QElapsedTimer clock;          ///< Time base of the timer wheel.
+    QVector<quint64> expiredKeys; ///< Reused buffer of the timers expired in one tick.
+    SendQueueLimits sendLimits;   ///< Limits of the send queues of every connection.
+    SendQueue::Counters sendCounters; ///< Depth and loss counters of the send queues.
+    Metrics *metrics = nullptr;   ///< Connection and traffic counters; not owned.
+
+    /**
+     * @brief Creates a PlayerConnection object from a socket.
+     * @param socket The player's socket.
+     * @param sessionId The session ID assigned to the connection.
+     * @return The corresponding PlayerConnection.
+     */
+    PlayerConnection createPlayerFromSocket(QTcpSocket *socket, quint32 sessionId);
+};
+
+#endif // LANTCPWORKER_H
@@ -0,0 +1,110 @@
+#ifndef LOADBOT_H
+#define LOADBOT_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <memory>
+#include "LanTcpClient.h"
+
+/**
+ * @brief A headless simulated player used to put load on a server.
+ *
+ * The bot speaks the same protocol as LobbyClient over a LanTcpClient: it
+ * sends a Join handshake after connecting, answers every Start with a random
+ * move after a configurable think time and joins again after each result.
+ * It measures the time to connect and the latency from its move to the result.
+ */
+class LoadBot : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Constructs a bot.
+     * @param host The address of the server.
+     * @param port The TCP port of the server.
+     * @param lobbyId The lobby to join after every round; 0 joins any open lobby.
+     * @param thinkTimeMs The maximum random delay between a Start and the bot's move.
+     * @param rounds The number of rounds to play; 0 plays until stopped.
+     * @param parent The parent QObject (optional).
+     */
+    LoadBot(const QHostAddress &host, quint16 port, quint32 lobbyId, int thinkTimeMs, int rounds,
+            QObject *parent = nullptr);
+
+    /**
+     * @brief Connects to the server and starts playing.
+     */
+    void start();
+
+    /**
+     * @brief Disconnects from the server.
+     */
+    void stop();
+
+signals:
+    /**
+     * @brief Emitted when the bot has connected to the server.
+     * @param connectTimeUs The time from the connection attempt to the connection, in microseconds.
+     */
+    void connected(qint64 connectTimeUs);
+
+    /**
+     * @brief Emitted when the result of a round arrives.
+     * @param latencyUs The time from sending the move to receiving the result, in microseconds.
+     */
+    void roundFinished(qint64 latencyUs);
+
+    /**
+     * @brief Emitted once when the bot has played all its rounds or lost its connection.
+     */
+    void finished();
+
+    /**
+     * @brief Emitted when the connection could not be established or broke.
+     * @param error A description of the error.
+     */
+    void failed(const QString &error);
+
+private slots:
+    /**
+     * @brief Sends the join handshake.
+     */
+    void onConnected();
+
+    /**
+     * @brief Reacts to a message from the server.
+     * @param msg The received message.
+     */
+    void onMessageReceived(const QByteArray &msg);
+
+    /**
+     * @brief Reports the end of the bot's session.
+     */
+    void onDisconnected();
+
+    /**
+     * @brief Sends a random move to the server.
+     */
+    void makeChoice();
+
+private:
+    /**
+     * @brief Marks the bot as finished and emits finished() once.
+     */
+    void finish();
+
+    std::unique_ptr<LanTcpClient> client; ///< Connection to the server.
+
+    QHostAddress serverAddress; ///< Address of the server.
+    quint16 serverPort;         ///< TCP port of the server.
+    quint32 joinLobbyId;        ///< Lobby requested in every join handshake.
+    quint32 playerKey;          ///< Random key that tells this bot apart from the others of its host.
+    int thinkTime;              ///< Maximum delay before a move, in milliseconds.
+    int roundsLeft;             ///< Rounds still to play; negative means unlimited.
+
+    QElapsedTimer connectTimer; ///< Measures the connection setup.
+    QElapsedTimer choiceTimer;  ///< Measures the time from a move to its result.
+    bool stopping = false;      ///< Set when the disconnect was requested by stop().
+    bool done = false;          ///< Set once finished() has been emitted.
+};
+
+#endif // LOADBOT_H
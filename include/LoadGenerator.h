@@ -0,0 +1,121 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <QObject>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+#include "LoadBot.h"
+
+/**
+ * @brief Runs many LoadBot instances in one process and reports their throughput.
+ *
+ * Bots are spawned gradually at a configurable rate. Every report interval the
+ * generator prints connects per second, rounds per second and percentiles of
+ * the move-to-result latency; a summary over the whole run is printed at the end.
+ */
+class LoadGenerator : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Settings of a load run.
+     */
+    struct Config {
+        QHostAddress host = QHostAddress::LocalHost; ///< Address of the server under test.
+        quint16 port = 50505;                        ///< TCP port of the server under test.
+        quint32 lobbyId = 0;                         ///< Lobby joined by every bot; 0 joins any open lobby.
+        int bots = 100;                              ///< Number of simulated players.
+        int spawnRate = 500;                         ///< New bots started per second.
+        int thinkTimeMs = 100;                       ///< Maximum delay between a round start and a bot's move.
+        int rounds = 0;                              ///< Rounds played by every bot; 0 plays until the run ends.
+        int durationSec = 30;                        ///< Length of the run in seconds; 0 runs until every bot finished.
+        int reportIntervalMs = 1000;                 ///< Interval between progress reports.
+    };
+
+    /**
+     * @brief Constructs a load generator.
+     * @param config The settings of the run.
+     * @param parent The parent QObject (optional).
+     */
+    explicit LoadGenerator(const Config &config, QObject *parent = nullptr);
+
+    /**
+     * @brief Starts spawning bots and reporting.
+     */
+    void start();
+
+    /**
+     * @brief Stops every bot and prints the summary of the run.
+     */
+    void stop();
+
+    /**
+     * @brief Returns a percentile of a set of samples.
+     *
+     * The samples are partially reordered.
+     *
+     * @param samples The samples.
+     * @param fraction The percentile as a fraction between 0 and 1.
+     * @return The sample at the percentile, or 0 if there are no samples.
+     */
+    static qint64 percentile(QVector<qint64> &samples, double fraction);
+
+signals:
+    /**
+     * @brief Emitted when the run is over.
+     */
+    void finished();
+
+private slots:
+    /**
+     * @brief Starts the next batch of bots.
+     */
+    void onSpawnBots();
+
+    /**
+     * @brief Prints the statistics of the last report interval.
+     */
+    void onReport();
+
+    /**
+     * @brief Counts a finished bot and ends the run when the last one is done.
+     */
+    void onBotFinished();
+
+private:
+    /**
+     * @brief Prints one line of statistics.
+     * @param label The label of the line.
+     * @param seconds The length of the measured period.
+     * @param connects The number of connects in the period.
+     * @param rounds The number of rounds in the period.
+     * @param latencies The move-to-result latencies of the period, in microseconds.
+     */
+    void printStats(const QString &label, double seconds, qint64 connects, qint64 rounds,
+                    QVector<qint64> &latencies) const;
+
+    Config config; ///< Settings of the run.
+
+    QTimer spawnTimer;  ///< Drives the gradual spawning of bots.
+    QTimer reportTimer; ///< Drives the progress reports.
+    QTimer durationTimer; ///< Ends a run with a fixed duration.
+
+    QElapsedTimer runTimer;      ///< Measures the whole run.
+    QElapsedTimer intervalTimer; ///< Measures the current report interval.
+
+    QVector<LoadBot*> bots; ///< Started bots, owned through the QObject tree.
+    int finishedBots = 0;   ///< Bots that played all their rounds or lost their connection.
+    bool running = false;   ///< True between start() and stop().
+
+    qint64 intervalConnects = 0; ///< Connects in the current report interval.
+    qint64 intervalRounds = 0;   ///< Rounds in the current report interval.
+    qint64 totalConnects = 0;    ///< Connects since the start of the run.
+    qint64 totalRounds = 0;      ///< Rounds since the start of the run.
+    qint64 failures = 0;         ///< Failed connections since the start of the run.
+
+    QVector<qint64> intervalLatencies; ///< Latencies of the current report interval, in microseconds.
+    QVector<qint64> totalLatencies;    ///< Latencies since the start of the run, in microseconds.
+};
+
+#endif // LOADGENERATOR_H
@@ -0,0 +1,47 @@
+#ifndef LOBBYANNOUNCEMENT_H
+#define LOBBYANNOUNCEMENT_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QVector>
+#include "LobbyInfo.h"
+
+/**
+ * @brief Datagram layout of UDP lobby announcements.
+ *
+ * A host merges the announcements of all its lobbies into as few datagrams as
+ * possible. A merged datagram starts with BATCH_MARKER, a version byte and a
+ * 16-bit record count, followed by one 16-bit length and one serialized
+ * LobbyInfo per record. BATCH_MARKER can never start a bare LobbyInfo, so
+ * single-record datagrams of older hosts are still decoded.
+ */
+namespace LobbyAnnouncement {
+
+constexpr quint32 BATCH_MARKER = 0xFFFFFFFE; ///< First four bytes of a merged datagram.
+constexpr quint8 VERSION = 1;                ///< Version of the merged layout.
+constexpr int HEADER_SIZE = 4 + 1 + 2;       ///< Size of the merged datagram header.
+constexpr int MAX_DATAGRAM_SIZE = 1200;      ///< Largest merged datagram; stays below common path MTUs.
+
+/**
+ * @brief Packs serialized lobby announcements into merged datagrams.
+ *
+ * Records are added in order until a datagram would exceed MAX_DATAGRAM_SIZE.
+ * A record that is larger on its own gets a datagram of its own.
+ *
+ * @param records The serialized LobbyInfo of every announced lobby.
+ * @return The datagrams to send.
+ */
+QList<QByteArray> pack(const QMap<quint32, QByteArray> &records);
+
+/**
+ * @brief Decodes a received announcement datagram.
+ * @param datagram The datagram payload.
+ * @param lobbies Receives the announced lobbies; cleared first.
+ * @return False if the datagram is malformed.
+ */
+bool unpack(const QByteArray &datagram, QVector<LobbyInfo> &lobbies);
+
+} // namespace LobbyAnnouncement
+
+#endif // LOBBYANNOUNCEMENT_H
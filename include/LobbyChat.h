@@ -0,0 +1,113 @@
+#ifndef LOBBYCHAT_H
+#define LOBBYCHAT_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "PlayerConnection.h"
+#include "LanTcpServer.h"
+
+/**
+ * @brief Relays the chat of a lobby between its members.
+ *
+ * Every accepted message is serialized once, with the sender set to the
+ * name of its connection, and kept in a ring buffer of the last
+ * HISTORY_SIZE messages. Messages posted within one tick are sent as a
+ * single chat frame shared by all members; members that join later receive
+ * the history in one frame. Chat goes through
+ * LanTcpServer::sendLowPriorityToPlayers(), so it never delays round traffic.
+ *
+ * Each member has a token bucket of BURST_MESSAGES messages that refills by
+ * one message every REFILL_MS; messages beyond it are dropped.
+ */
+class LobbyChat : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int TICK_MS = 100;           ///< Interval between two chat frames.
+    static constexpr int HISTORY_SIZE = 64;       ///< Messages kept for members that join later.
+    static constexpr int MAX_TEXT_LENGTH = 256;   ///< Characters kept of a message text.
+    static constexpr int BURST_MESSAGES = 5;      ///< Messages a member may send at once.
+    static constexpr int REFILL_MS = 1000;        ///< Time in which a member earns one more message.
+
+    /**
+     * @brief Constructs a chat sending through a server.
+     * @param server The server of the member connections, which must outlive the chat.
+     * @param parent The parent QObject (optional).
+     */
+    explicit LobbyChat(LanTcpServer *server, QObject *parent = nullptr);
+
+    /**
+     * @brief Makes a connection a member of the chat and sends it the history.
+     * @param sessionId The session ID of the new member.
+     */
+    void addMember(quint32 sessionId);
+
+    /**
+     * @brief Removes a connection from the chat.
+     * @param sessionId The session ID of the member.
+     * @return True if the connection was a member.
+     */
+    bool removeMember(quint32 sessionId);
+
+    /**
+     * @brief Returns the number of members.
+     * @return The number of members.
+     */
+    int memberCount() const;
+
+    /**
+     * @brief Accepts the chat messages of a received chat frame.
+     * @param player The sender, which must be a member.
+     * @param frame The payload of the received chat frame.
+     */
+    void post(const PlayerConnection &player, const QByteArray &frame);
+
+    /**
+     * @brief Removes every member and forgets the history.
+     */
+    void clear();
+
+private slots:
+    /**
+     * @brief Sends the messages posted since the last tick to every member.
+     */
+    void onTick();
+
+private:
+    /**
+     * @brief Chat state of a member.
+     */
+    struct Member {
+        int index = 0;                 ///< Index in memberSessions.
+        int tokens = BURST_MESSAGES;   ///< Messages the member may still send.
+        qint64 refilledMs = 0;         ///< Clock time up to which tokens were refilled.
+    };
+
+    /**
+     * @brief Takes one token of a member's bucket.
+     * @param member The member.
+     * @return False if the bucket is empty.
+     */
+    bool takeToken(Member &member);
+
+    /**
+     * @brief Appends a serialized message to the history, replacing the oldest one when full.
+     * @param record The serialized message.
+     */
+    void remember(const QByteArray &record);
+
+    LanTcpServer *server;               ///< Server of the member connections; not owned.
+    QHash<quint32, Member> members;     ///< Members keyed by session ID.
+    QVector<quint32> memberSessions;    ///< Session IDs of all members, the recipients of a chat frame.
+    QVector<QByteArray> history;        ///< Ring buffer of serialized messages.
+    int historyStart = 0;               ///< Index of the oldest message in the ring.
+    int historyCount = 0;               ///< Number of messages in the ring.
+    QByteArray pending;                 ///< Serialized messages posted since the last tick.
+    int pendingCount = 0;               ///< Number of messages in `pending`; they are the newest of the ring.
+    QElapsedTimer clock;                ///< Time base of the token buckets.
+    QTimer tickTimer;                   ///< Drives the chat frames while messages are pending.
+};
+
+#endif // LOBBYCHAT_H
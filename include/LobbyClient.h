@@ -2,12 +2,22 @@
 #define LOBBYCLIENT_H
 
 #include <QObject>
+#include <QTimer>
+#include <QVector>
 #include "ServerLobby.h"
 #include "UdpBroadcastListener.h"
 #include "LanTcpClient.h"
+#include "LobbyProber.h"
 
 /**
  * @brief Manages the client's connection to game lobbies, including searching, joining, and hosting functionality.
+ *
+ * Lobbies are not joined as soon as the first one is heard of: announcements
+ * are collected for SELECTION_WINDOW_MS, every candidate host is probed in
+ * parallel by a LobbyProber, and the lobby with the lowest score wins. The
+ * score is the round-trip time plus FREE_SEAT_COST_US for every seat that
+ * still has to fill after joining, so a nearby lobby that is about to start
+ * beats an empty one. A player who hosts a lobby always joins their own.
  */
 class LobbyClient : public QObject {
     Q_OBJECT
@@ -23,6 +33,33 @@ public:
      */
     ~LobbyClient() = default;
 
+    static constexpr quint16 SERVER_PORT = 50505;              ///< TCP server port for communication.
+    static constexpr quint16 BROADCAST_PORT = 50005;           ///< UDP broadcast port for discovering lobbies.
+
+    /**
+     * @brief Selects the channels used to discover and announce lobbies.
+     * @param config The discovery settings; applies to lobbies found or hosted afterwards.
+     */
+    void setDiscoveryConfig(const DiscoveryConfig &config);
+
+    /**
+     * @brief Records the rounds of hosted lobbies in a match history log.
+     * @param log The log, which must outlive the client; nullptr stops recording.
+     */
+    void setMatchLog(MatchLog *log);
+
+    /**
+     * @brief Rates the players of hosted lobbies.
+     * @param service The rating service, which must outlive the client; nullptr stops rating.
+     */
+    void setRatingService(RatingService *service);
+
+    /**
+     * @brief Records the traffic and round timing of hosted lobbies.
+     * @param newMetrics The metrics, which must outlive the client; nullptr stops recording.
+     */
+    void setMetrics(Metrics *newMetrics);
+
 signals:
     /**
      * @brief Emitted when the game action menu should be displayed.
@@ -35,9 +72,22 @@ signals:
      */
     void invokeResults(QString result);
 
+    /**
+     * @brief Emitted for the result of a game that is followed by another one, e.g. in a tournament.
+     * @param result The result message, including the match score.
+     */
+    void invokeRoundResults(QString result);
+
+    /**
+     * @brief Emitted for every chat message received from the lobby.
+     * @param sender The name of the sender.
+     * @param text The message text.
+     */
+    void invokeChat(QString sender, QString text);
+
 public slots:
     /**
-     * @brief Starts searching for available lobbies and connects to the first one found.
+     * @brief Starts searching for available lobbies and connects to the best one found.
      */
     void onConnectToFirstFindedServer();
 
@@ -58,26 +108,70 @@ public slots:
     void onPlayerMadeChoice(int choice);
 
     /**
-     * @brief Handles a found lobby by attempting to connect to it.
+     * @brief Sends a chat message to the lobby.
+     * @param text The message text.
+     */
+    void onPlayerSentChat(const QString &text);
+
+    /**
+     * @brief Adds a found lobby to the candidates of the selection window.
      * @param hostAdress The IP address of the found lobby.
      * @param info Information about the found lobby.
      */
     void onLobbyFinded(const QHostAddress &hostAdress, const LobbyInfo &info);
 
+private slots:
+    /**
+     * @brief Probes the lobbies collected during the selection window.
+     */
+    void onSelectionWindowClosed();
+
+    /**
+     * @brief Joins the best-scoring lobby once the probe is done.
+     * @param targets The probed hosts with their round-trip times.
+     */
+    void onProbeFinished(const QVector<LobbyProber::Target> &targets);
+
 private:
+    static constexpr int SELECTION_WINDOW_MS = 300;     ///< Time spent collecting lobbies before probing them.
+    static constexpr qint64 FREE_SEAT_COST_US = 20000;  ///< Score penalty of every seat left to fill.
+
+    /**
+     * @brief A lobby found during the selection window.
+     */
+    struct Candidate {
+        QHostAddress host;  ///< The address of the host.
+        LobbyInfo info;     ///< The announced lobby information.
+    };
+
     static constexpr const char* LOBBY_NAME = "DefaultLobby";  ///< Default lobby name.
     static constexpr int MAX_PLAYERS = 2;                      ///< Maximum number of players allowed in the lobby.
-    static constexpr quint16 SERVER_PORT = 50505;              ///< TCP server port for communication.
-    static constexpr quint16 BROADCAST_PORT = 50005;           ///< UDP broadcast port for discovering lobbies.
 
     /**
      * @brief Initializes the TCP client for connecting to lobbies.
      */
     void initClient();
 
+    /**
+     * @brief Reports a result as final or, after a Next message, as one game of a longer session.
+     * @param result The result message.
+     */
+    void showResult(const QString &result);
+
     std::unique_ptr<ServerLobby> serverLobby;             ///< Manages server-side lobby hosting.
     std::unique_ptr<UdpBroadcastListener> broadcastListener; ///< Listens for available lobbies via UDP broadcast.
     std::unique_ptr<LanTcpClient> client;                 ///< Handles client-side TCP connections.
+    quint32 joinLobbyId = 0;                              ///< Lobby requested in the join handshake.
+    quint32 playerKey = 0;                                ///< Stable key of this player, sent before every join.
+    bool resultContinues = false;                         ///< True if the next result is followed by another game.
+    quint32 matchScore = 0;                               ///< Score announced with the last Next message.
+    QVector<Candidate> candidates;                        ///< Lobbies found during the selection window.
+    QTimer selectionTimer;                                ///< Ends the selection window.
+    std::unique_ptr<LobbyProber> prober;                  ///< Measures the round-trip time to the candidates.
+    DiscoveryConfig discovery;                            ///< Channels used to discover and announce lobbies.
+    MatchLog *matchLog = nullptr;                         ///< Log of rounds in hosted lobbies; not owned.
+    Metrics *metrics = nullptr;                           ///< Metrics of hosted lobbies; not owned.
+    RatingService *ratings = nullptr;                     ///< Ratings of players in hosted lobbies; not owned.
 };
 
 #endif // LOBBYCLIENT_H
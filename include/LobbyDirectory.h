@@ -0,0 +1,139 @@
+#ifndef LOBBYDIRECTORY_H
+#define LOBBYDIRECTORY_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <QTimer>
+#include "LobbyInfo.h"
+#include "UdpBroadcaster.h"
+
+/**
+ * @brief Cache of the lobbies currently announced on the network.
+ *
+ * Entries are keyed by the announcing host, the lobby's TCP port and its
+ * lobby ID (a dedicated server announces many lobbies behind one port).
+ * Repeated announcements only refresh an entry's age; signals are emitted
+ * when a lobby appears, when one of its fields really changes and when it
+ * has not been announced for longer than the time-to-live.
+ */
+class LobbyDirectory : public QObject {
+    Q_OBJECT
+public:
+    /// Default time-to-live: three times the longest interval between repeated announcements.
+    static constexpr int DEFAULT_TTL_MS = 3 * UdpBroadcaster::MAX_INTERVAL_MS;
+
+    /**
+     * @brief A lobby seen on the network.
+     */
+    struct Entry {
+        QHostAddress host;      ///< Address of the announcing host.
+        LobbyInfo info;         ///< Latest announced lobby information.
+        qint64 firstSeenMs = 0; ///< Directory time of the first announcement.
+        qint64 lastSeenMs = 0;  ///< Directory time of the latest announcement.
+
+        /**
+         * @brief Returns the number of free seats.
+         * @return The free seats; never negative.
+         */
+        int freeSlots() const { return qMax(0, info.maxPlayers - info.currentPlayers); }
+    };
+
+    /**
+     * @brief Constructs an empty directory.
+     * @param ttlMs Time after the last announcement at which a lobby expires.
+     * @param parent The parent QObject (optional).
+     */
+    explicit LobbyDirectory(int ttlMs = DEFAULT_TTL_MS, QObject *parent = nullptr);
+
+    /**
+     * @brief Records an announcement.
+     * @param host The address of the announcing host.
+     * @param info The announced lobby information.
+     * @return True if the lobby is new or one of its fields changed.
+     */
+    bool update(const QHostAddress &host, const LobbyInfo &info);
+
+    /**
+     * @brief Drops every entry without emitting signals.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of known lobbies.
+     * @return The number of entries.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns every known lobby.
+     * @return The entries in no particular order.
+     */
+    QList<Entry> entries() const;
+
+    /**
+     * @brief Returns the lobbies with at least one free seat.
+     * @return The entries, fullest lobby first, so games start sooner.
+     */
+    QList<Entry> openLobbies() const;
+
+    /**
+     * @brief Returns the lobbies whose name contains a text.
+     * @param text The text to search for, case-insensitively.
+     * @return The matching entries.
+     */
+    QList<Entry> findByName(const QString &text) const;
+
+    /**
+     * @brief Returns the time since an entry was last announced.
+     * @param entry An entry returned by this directory.
+     * @return The age in milliseconds.
+     */
+    qint64 ageOf(const Entry &entry) const;
+
+signals:
+    /**
+     * @brief Emitted when a lobby is announced for the first time.
+     * @param host The address of the announcing host.
+     * @param info The lobby information.
+     */
+    void lobbyAdded(const QHostAddress &host, const LobbyInfo &info);
+
+    /**
+     * @brief Emitted when an announcement changes a known lobby.
+     * @param host The address of the announcing host.
+     * @param info The new lobby information.
+     */
+    void lobbyChanged(const QHostAddress &host, const LobbyInfo &info);
+
+    /**
+     * @brief Emitted when a lobby was not announced within the time-to-live.
+     * @param host The address of the announcing host.
+     * @param info The last known lobby information.
+     */
+    void lobbyExpired(const QHostAddress &host, const LobbyInfo &info);
+
+private slots:
+    /**
+     * @brief Removes entries older than the time-to-live.
+     */
+    void onExpire();
+
+private:
+    /**
+     * @brief Builds the key of a lobby.
+     * @param host The address of the announcing host.
+     * @param info The lobby information.
+     * @return The key.
+     */
+    static QByteArray keyOf(const QHostAddress &host, const LobbyInfo &info);
+
+    const int ttl;              ///< Time-to-live of an entry in milliseconds.
+    QElapsedTimer clock;        ///< Time base of firstSeenMs and lastSeenMs.
+    QTimer expiryTimer;         ///< Periodic sweep for expired entries.
+    QHash<QByteArray, Entry> lobbies; ///< Known lobbies keyed by host, port and lobby ID.
+};
+
+#endif // LOBBYDIRECTORY_H
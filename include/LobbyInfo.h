@@ -2,8 +2,8 @@
 #define LOBBYINFO_H
 
 #include "INetworkSerializable.h"
+#include "WireFormat.h"
 #include <QString>
-#include <QDataStream>
 #include <QHostAddress>
 
 /**
@@ -14,6 +14,7 @@ struct LobbyInfo : public INetworkSerializable {
     int maxPlayers;     ///< Maximum number of players allowed.
     int currentPlayers; ///< Current number of players in the lobby.
     quint16 tcpPort;    ///< TCP port used for the lobby connection.
+    quint32 lobbyId = 0; ///< Identifier of the lobby on its host; 0 for a single-lobby host.
 
     LobbyInfo() = default;
 
@@ -23,28 +24,67 @@ struct LobbyInfo : public INetworkSerializable {
      * @param max The maximum number of players.
      * @param current The current number of players.
      * @param port The TCP port of the lobby.
+     * @param id The identifier of the lobby on its host.
      */
-    LobbyInfo(const QString &name, int max, int current, quint16 port)
-        : lobbyName(name), maxPlayers(max), currentPlayers(current), tcpPort(port) {}
+    LobbyInfo(const QString &name, int max, int current, quint16 port, quint32 id = 0)
+        : lobbyName(name), maxPlayers(max), currentPlayers(current), tcpPort(port), lobbyId(id) {}
 
     /**
-     * @brief Serializes the lobby information into a QByteArray for network transmission.
-     * @return Serialized data.
+     * @brief Compares two lobby announcements field by field.
+     * @param other The other lobby information.
+     * @return True if every field is equal.
      */
-    QByteArray serialize() const override {
-        QByteArray data;
-        QDataStream out(&data, QIODevice::WriteOnly);
-        out << lobbyName << maxPlayers << currentPlayers << tcpPort;
-        return data;
+    bool operator==(const LobbyInfo &other) const {
+        return lobbyId == other.lobbyId && tcpPort == other.tcpPort && maxPlayers == other.maxPlayers
+               && currentPlayers == other.currentPlayers && lobbyName == other.lobbyName;
     }
 
     /**
-     * @brief Deserializes a QByteArray into a LobbyInfo object.
+     * @brief Compares two lobby announcements field by field.
+     * @param other The other lobby information.
+     * @return True if any field differs.
+     */
+    bool operator!=(const LobbyInfo &other) const {
+        return !(*this == other);
+    }
+
+    using INetworkSerializable::deserialize;
+
+    /**
+     * @brief Returns the serialized size of the lobby information.
+     * @return The size in bytes.
+     */
+    int serializedSize() const override {
+        return WireFormat::stringSize(lobbyName) + 4 + 4 + 2 + 4;
+    }
+
+    /**
+     * @brief Appends the lobby information to a buffer for network transmission.
+     * @param buffer The buffer to append to.
+     */
+    void serializeInto(QByteArray &buffer) const override {
+        WireFormat::Writer out(buffer, serializedSize());
+        out.writeString(lobbyName);
+        out.writeI32(maxPlayers);
+        out.writeI32(currentPlayers);
+        out.writeU16(tcpPort);
+        out.writeU32(lobbyId);
+    }
+
+    /**
+     * @brief Deserializes the lobby information from borrowed bytes.
      * @param data The serialized lobby information data.
+     * @param size The number of available bytes.
+     * @return False if the data is truncated.
      */
-    void deserialize(const QByteArray &data) override {
-        QDataStream in(data);
-        in >> lobbyName >> maxPlayers >> currentPlayers >> tcpPort;
+    bool deserialize(const char *data, qsizetype size) override {
+        WireFormat::Reader in(data, size);
+        lobbyName = in.readString();
+        maxPlayers = in.readI32();
+        currentPlayers = in.readI32();
+        tcpPort = in.readU16();
+        lobbyId = in.readU32();
+        return in.ok();
     }
 };
 
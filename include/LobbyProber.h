@@ -0,0 +1,96 @@
+#ifndef LOBBYPROBER_H
+#define LOBBYPROBER_H
+
+#include <QObject>
+#include <QUdpSocket>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+
+/**
+ * @brief Measures the round-trip time to many lobby hosts in parallel.
+ *
+ * Every target receives PROBE_COUNT probes PROBE_SPACING_MS apart from one
+ * UDP socket, answered by the host's PingResponder; the fastest answer is
+ * the target's round-trip time, which filters out a single delayed datagram.
+ * The probe finishes when every probe is answered or TIMEOUT_MS after the
+ * last round was sent, whichever comes first.
+ */
+class LobbyProber : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int PROBE_COUNT = 3;        ///< Probes sent to every target.
+    static constexpr int PROBE_SPACING_MS = 20;  ///< Delay between two rounds of probes.
+    static constexpr int TIMEOUT_MS = 250;       ///< Wait for answers after the last round.
+    static constexpr int MAX_TARGETS = 4096;     ///< Targets beyond this are not probed.
+
+    /**
+     * @brief A probed host and its measured round-trip time.
+     */
+    struct Target {
+        QHostAddress host;  ///< The address of the host.
+        quint16 port = 0;   ///< The port of the host's PingResponder.
+        qint64 rttUs = -1;  ///< The fastest round-trip time; -1 if no probe was answered.
+    };
+
+    /**
+     * @brief Constructs an idle prober.
+     * @param parent The parent QObject (optional).
+     */
+    explicit LobbyProber(QObject *parent = nullptr);
+
+    /**
+     * @brief Starts probing; a probe that is still running is cancelled.
+     * @param targets The hosts to probe.
+     */
+    void probe(const QVector<Target> &targets);
+
+    /**
+     * @brief Stops a running probe without reporting it.
+     */
+    void cancel();
+
+    /**
+     * @brief Checks whether a probe is running.
+     * @return True between probe() and finished().
+     */
+    bool isRunning() const;
+
+signals:
+    /**
+     * @brief Emitted when a probe completes.
+     * @param targets The probed hosts with their round-trip times.
+     */
+    void finished(const QVector<LobbyProber::Target> &targets);
+
+private slots:
+    /**
+     * @brief Sends the next round of probes to every target.
+     */
+    void onSendRound();
+
+    /**
+     * @brief Records the answers to the probes.
+     */
+    void onReadyRead();
+
+    /**
+     * @brief Reports the probe, including unanswered targets.
+     */
+    void finish();
+
+private:
+    QUdpSocket udpSocket;        ///< Socket sending the probes and receiving the answers.
+    QTimer roundTimer;           ///< Spaces the rounds of probes.
+    QTimer timeoutTimer;         ///< Ends the probe after the last round.
+    QElapsedTimer clock;         ///< Time base of the send times.
+
+    QVector<Target> targets;     ///< The hosts of the running probe.
+    QVector<qint64> sentNs;      ///< Send time of every probe, indexed by target * PROBE_COUNT + round.
+    int round = 0;               ///< Number of rounds sent.
+    int answers = 0;             ///< Number of answered probes.
+    quint32 generation = 0;      ///< Tags the nonces of a probe so stale answers are ignored.
+    bool running = false;        ///< True while a probe is running.
+};
+
+#endif // LOBBYPROBER_H
@@ -0,0 +1,216 @@
+#ifndef LOBBYTABLE_H
+#define LOBBYTABLE_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Compact state table for many lobbies hosted by one dedicated server.
+ *
+ * Instead of one QObject tree per match, every lobby is a small row, and the
+ * session IDs and moves of all seats are stored in flat arrays indexed by
+ * `lobby * seatsPerLobby + seat`. Occupied seats of a lobby are always packed
+ * at the front of its range.
+ *
+ * Open lobbies are additionally kept in intrusive lists, one per player
+ * count, so findOpenLobby() costs O(seatsPerLobby) instead of a scan of
+ * every lobby.
+ */
+class LobbyTable {
+public:
+    /**
+     * @brief Lifecycle state of a lobby.
+     */
+    enum class State : quint8 {
+        Waiting, ///< The lobby accepts players.
+        Playing  ///< A round is in progress.
+    };
+
+    /**
+     * @brief Constructs a table of empty lobbies.
+     * @param lobbyCount The number of lobbies.
+     * @param seatsPerLobby The number of players in a full lobby.
+     */
+    LobbyTable(int lobbyCount, int seatsPerLobby);
+
+    /**
+     * @brief Returns the number of lobbies in the table.
+     * @return The number of lobbies.
+     */
+    int lobbyCount() const;
+
+    /**
+     * @brief Returns the number of players in a full lobby.
+     * @return The number of seats per lobby.
+     */
+    int seatsPerLobby() const;
+
+    /**
+     * @brief Converts a lobby index into the ID announced to clients.
+     * @param lobby The lobby index.
+     * @return The lobby ID; IDs start at 1.
+     */
+    quint32 lobbyId(int lobby) const;
+
+    /**
+     * @brief Converts a lobby ID received from a client into a lobby index.
+     * @param lobbyId The lobby ID.
+     * @return The lobby index, or -1 if the ID is unknown.
+     */
+    int indexOf(quint32 lobbyId) const;
+
+    /**
+     * @brief Finds a waiting lobby with a free seat, preferring the fullest one.
+     * @return The lobby index, or -1 if every lobby is full or playing.
+     */
+    int findOpenLobby() const;
+
+    /**
+     * @brief Returns the state of a lobby.
+     * @param lobby The lobby index.
+     * @return The lobby state.
+     */
+    State state(int lobby) const;
+
+    /**
+     * @brief Changes the state of a lobby.
+     * @param lobby The lobby index.
+     * @param newState The new state.
+     */
+    void setState(int lobby, State newState);
+
+    /**
+     * @brief Returns the number of seated players in a lobby.
+     * @param lobby The lobby index.
+     * @return The number of players.
+     */
+    int playerCount(int lobby) const;
+
+    /**
+     * @brief Checks whether a waiting lobby can take another player.
+     * @param lobby The lobby index.
+     * @return True if the lobby is waiting and has a free seat.
+     */
+    bool isOpen(int lobby) const;
+
+    /**
+     * @brief Checks whether every seat of a lobby is taken.
+     * @param lobby The lobby index.
+     * @return True if the lobby is full.
+     */
+    bool isFull(int lobby) const;
+
+    /**
+     * @brief Seats a player in a lobby.
+     * @param lobby The lobby index.
+     * @param sessionId The session ID of the player to seat.
+     * @return The seat index, or -1 if the lobby is full.
+     */
+    int addPlayer(int lobby, quint32 sessionId);
+
+    /**
+     * @brief Removes a player and moves the last seated player into the freed seat.
+     * @param lobby The lobby index.
+     * @param seat The seat to free.
+     * @return The session ID of the player moved into the freed seat, or 0 if no one moved.
+     */
+    quint32 removePlayer(int lobby, int seat);
+
+    /**
+     * @brief Returns the session ID of the player in a seat.
+     * @param lobby The lobby index.
+     * @param seat The seat index.
+     * @return The session ID of the seated player.
+     */
+    quint32 player(int lobby, int seat) const;
+
+    /**
+     * @brief Records the move of a seated player.
+     * @param lobby The lobby index.
+     * @param seat The seat index.
+     * @param choice The move (1 = Rock, 2 = Paper, 3 = Scissors).
+     */
+    void setChoice(int lobby, int seat, int choice);
+
+    /**
+     * @brief Returns the move of a seated player.
+     * @param lobby The lobby index.
+     * @param seat The seat index.
+     * @return The move, or 0 if the player has not chosen yet.
+     */
+    int choice(int lobby, int seat) const;
+
+    /**
+     * @brief Returns the packed moves of a lobby, one byte per occupied seat.
+     * @param lobby The lobby index.
+     * @return Pointer to playerCount(lobby) moves.
+     */
+    const quint8 *choiceData(int lobby) const;
+
+    /**
+     * @brief Returns the session IDs of a lobby, one per occupied seat.
+     * @param lobby The lobby index.
+     * @return Pointer to playerCount(lobby) session IDs.
+     */
+    const quint32 *playerData(int lobby) const;
+
+    /**
+     * @brief Checks whether every seated player has made a move.
+     * @param lobby The lobby index.
+     * @return True if all moves are in.
+     */
+    bool allChosen(int lobby) const;
+
+    /**
+     * @brief Forgets the moves of a lobby so its players can play another round.
+     * @param lobby The lobby index.
+     */
+    void clearChoices(int lobby);
+
+    /**
+     * @brief Empties a lobby and puts it back into the waiting state.
+     * @param lobby The lobby index.
+     */
+    void clearLobby(int lobby);
+
+private:
+    /**
+     * @brief Per-lobby bookkeeping.
+     */
+    struct Row {
+        State state = State::Waiting; ///< Lifecycle state.
+        quint16 players = 0;          ///< Number of occupied seats.
+        quint16 choices = 0;          ///< Number of seated players who made a move.
+        int prevOpen = -1;            ///< Previous lobby in the open list of the same player count.
+        int nextOpen = -1;            ///< Next lobby in the open list of the same player count.
+        bool linked = false;          ///< True while the lobby is in an open list.
+    };
+
+    /**
+     * @brief Removes a lobby from its open list, if it is in one.
+     * @param lobby The lobby index.
+     */
+    void unlinkOpen(int lobby);
+
+    /**
+     * @brief Adds a lobby to the open list of its player count if it is open.
+     * @param lobby The lobby index.
+     */
+    void linkOpen(int lobby);
+
+    /**
+     * @brief Returns the flat index of a seat.
+     * @param lobby The lobby index.
+     * @param seat The seat index.
+     * @return The index into the seat and move arrays.
+     */
+    int slot(int lobby, int seat) const;
+
+    const int seatCount;               ///< Number of seats per lobby.
+    QVector<Row> rows;                 ///< One row per lobby.
+    QVector<quint32> seats;            ///< Session IDs of the seated players of all lobbies.
+    QVector<quint8> choices;           ///< Moves of all seats; 0 means no move yet.
+    QVector<int> openHead;             ///< First open lobby per player count; -1 if none.
+};
+
+#endif // LOBBYTABLE_H
@@ -0,0 +1,116 @@
+#ifndef MATCHLOG_H
+#define MATCHLOG_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include "MatchRecord.h"
+
+class MatchLogWriter;
+
+/**
+ * @brief Append-only binary log of every resolved round.
+ *
+ * Rounds are recorded on the game thread by copying fixed-size records into
+ * a pending buffer. The buffer is handed to a writer thread every
+ * FLUSH_INTERVAL_MS or as soon as it exceeds FLUSH_THRESHOLD bytes, so file
+ * I/O never runs on the thread that serves the players.
+ *
+ * Use MatchLogReader to analyse a log.
+ */
+class MatchLog : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int FLUSH_INTERVAL_MS = 200;       ///< Longest time a record waits in memory.
+    static constexpr int FLUSH_THRESHOLD = 64 * 1024;   ///< Pending bytes that trigger an immediate hand-off.
+
+    /**
+     * @brief Constructs a closed log.
+     * @param parent The parent QObject (optional).
+     */
+    explicit MatchLog(QObject *parent = nullptr);
+
+    /**
+     * @brief Flushes the pending records and stops the writer thread.
+     *
+     * Records still pending are only written if the log is destroyed, so
+     * the process must leave through the event loop rather than exit().
+     */
+    ~MatchLog();
+
+    /**
+     * @brief Opens a log for appending, creating it if needed.
+     *
+     * The round numbering continues after the last round of an existing log.
+     *
+     * @param path The file path.
+     * @return False if the file cannot be opened or is not a match log.
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief Writes the pending records and closes the file.
+     */
+    void close();
+
+    /**
+     * @brief Checks whether the log is open.
+     * @return True between a successful open() and close().
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Appends the records of one resolved round.
+     *
+     * All arrays hold one entry per player.
+     *
+     * @param lobbyId The lobby the round was played in.
+     * @param count The number of players.
+     * @param sessions The session IDs of the players.
+     * @param playerKeys The stable keys of the players, see playerKey().
+     * @param choices The moves of the players.
+     * @param outcomes The results as Protocol::Opcode values.
+     */
+    void recordRound(quint32 lobbyId, int count, const quint32 *sessions, const quint32 *playerKeys,
+                     const quint8 *choices, const quint8 *outcomes);
+
+    /**
+     * @brief Hands the pending records to the writer thread.
+     */
+    void flush();
+
+    /**
+     * @brief Derives the stable key of a player from its address.
+     *
+     * IPv4 addresses are used as they are; other addresses are hashed with FNV-1a.
+     *
+     * @param address The player's address.
+     * @return The key.
+     */
+    static quint32 playerKey(const QHostAddress &address);
+
+    /**
+     * @brief Returns the stable key of a player.
+     *
+     * Players behind one address are told apart by the key their client sent
+     * with Protocol::Opcode::Identify; clients that sent none fall back to
+     * the key of their address.
+     *
+     * @param identity The key sent by the client; 0 if none.
+     * @param address The player's address.
+     * @return The key.
+     */
+    static quint32 playerKey(quint32 identity, const QHostAddress &address);
+
+private:
+    QThread writerThread;          ///< Runs the file writes.
+    MatchLogWriter *writer = nullptr; ///< Owns the file; lives in writerThread.
+    QTimer flushTimer;             ///< Hands off pending records after FLUSH_INTERVAL_MS.
+    QByteArray pending;            ///< Records not yet handed to the writer.
+    quint32 nextRound = 1;         ///< Number of the next recorded round.
+};
+
+#endif // MATCHLOG_H
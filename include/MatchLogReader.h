@@ -0,0 +1,114 @@
+#ifndef MATCHLOGREADER_H
+#define MATCHLOGREADER_H
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <limits>
+#include "MatchRecord.h"
+
+/**
+ * @brief Read-only view of a match history log for analytics.
+ *
+ * The records are memory-mapped rather than read, so opening a large log is
+ * cheap and a scan runs at memory speed. A record torn by a crash at the end
+ * of the file is ignored. The reader can be used while a server keeps
+ * appending; records written later become visible after reopening.
+ */
+class MatchLogReader {
+public:
+    /**
+     * @brief Aggregated results of one player.
+     */
+    struct PlayerStats {
+        qint64 rounds = 0; ///< Rounds played.
+        qint64 wins = 0;   ///< Rounds won.
+        qint64 losses = 0; ///< Rounds lost.
+        qint64 draws = 0;  ///< Rounds drawn.
+
+        /**
+         * @brief Returns the share of won rounds.
+         * @return Wins divided by rounds, or 0 without rounds.
+         */
+        double winRate() const { return rounds > 0 ? double(wins) / double(rounds) : 0.0; }
+    };
+
+    /**
+     * @brief How often each move was played and how often it won.
+     *
+     * Both arrays are indexed by the move (0 = none, 1 = Rock, 2 = Paper, 3 = Scissors).
+     */
+    struct ChoiceStats {
+        qint64 picks[4] = {}; ///< Number of times each move was played.
+        qint64 wins[4] = {};  ///< Number of times each move won.
+    };
+
+    /**
+     * @brief Constructs a reader without a log.
+     */
+    MatchLogReader() = default;
+
+    /**
+     * @brief Unmaps the log.
+     */
+    ~MatchLogReader();
+
+    MatchLogReader(const MatchLogReader &) = delete;
+    MatchLogReader &operator=(const MatchLogReader &) = delete;
+
+    /**
+     * @brief Maps a log into memory.
+     * @param path The file path.
+     * @return False if the file cannot be mapped or is not a match log.
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief Unmaps the log.
+     */
+    void close();
+
+    /**
+     * @brief Returns the number of complete records.
+     * @return The record count.
+     */
+    qint64 recordCount() const;
+
+    /**
+     * @brief Returns the mapped records.
+     * @return Pointer to recordCount() records, or nullptr without a log.
+     */
+    const MatchLogFormat::MatchRecord *records() const;
+
+    /**
+     * @brief Returns the creation time of the log.
+     * @return Milliseconds since the Unix epoch.
+     */
+    qint64 createdMs() const;
+
+    /**
+     * @brief Aggregates the results of every player within a time range.
+     * @param fromMs The start of the range, inclusive.
+     * @param toMs The end of the range, exclusive.
+     * @return The statistics keyed by player key.
+     */
+    QHash<quint32, PlayerStats> playerStats(qint64 fromMs = 0,
+                                            qint64 toMs = std::numeric_limits<qint64>::max()) const;
+
+    /**
+     * @brief Counts the moves and winning moves within a time range.
+     * @param fromMs The start of the range, inclusive.
+     * @param toMs The end of the range, exclusive.
+     * @return The distribution of moves.
+     */
+    ChoiceStats choiceStats(qint64 fromMs = 0, qint64 toMs = std::numeric_limits<qint64>::max()) const;
+
+private:
+    QFile file;                                    ///< The mapped log file.
+    uchar *mapped = nullptr;                       ///< Start of the mapping.
+    const MatchLogFormat::FileHeader *header = nullptr;  ///< Header of the log.
+    const MatchLogFormat::MatchRecord *first = nullptr;  ///< First record.
+    qint64 count = 0;                              ///< Number of complete records.
+};
+
+#endif // MATCHLOGREADER_H
@@ -0,0 +1,50 @@
+#ifndef MATCHRECORD_H
+#define MATCHRECORD_H
+
+#include <QtGlobal>
+
+/**
+ * @brief On-disk layout of the match history log.
+ *
+ * The log starts with a FileHeader followed by fixed-size MatchRecord entries,
+ * one per player and round, so the N-th record is found by arithmetic and a
+ * scan is a linear pass over memory. All fields are little-endian.
+ */
+namespace MatchLogFormat {
+
+constexpr quint32 MAGIC = 0x4D535052; ///< "RPSM" read as a little-endian integer.
+constexpr quint16 VERSION = 1;        ///< Version of the record layout.
+
+/**
+ * @brief Header at the start of every log file.
+ */
+struct FileHeader {
+    quint32 magic = MAGIC;           ///< Identifies a match log.
+    quint16 version = VERSION;       ///< Version of the record layout.
+    quint16 recordSize = 0;          ///< Size of one record in bytes.
+    qint64 createdMs = 0;            ///< Creation time in milliseconds since the Unix epoch.
+};
+
+/**
+ * @brief The move and outcome of one player in one round.
+ *
+ * Records of the same round are written together and share the round number.
+ */
+struct MatchRecord {
+    qint64 timestampMs = 0;  ///< Time the round was resolved, in milliseconds since the Unix epoch.
+    quint32 round = 0;       ///< Round number, counted over the whole log.
+    quint32 lobbyId = 0;     ///< The lobby the round was played in.
+    quint32 sessionId = 0;   ///< The player's session; unique per connection.
+    quint32 playerKey = 0;   ///< Stable key of the player, see MatchLog::playerKey().
+    quint16 playerCount = 0; ///< Number of players in the round.
+    quint8 choice = 0;       ///< The player's move (0 = none, 1 = Rock, 2 = Paper, 3 = Scissors).
+    quint8 outcome = 0;      ///< The result as a Protocol::Opcode value (Win, Lose or Draw).
+    quint32 reserved = 0;    ///< Padding; always 0.
+};
+
+static_assert(sizeof(FileHeader) == 16, "FileHeader layout must stay fixed");
+static_assert(sizeof(MatchRecord) == 32, "MatchRecord layout must stay fixed");
+
+} // namespace MatchLogFormat
+
+#endif // MATCHRECORD_H
@@ -0,0 +1,152 @@
+#ifndef MATCHMAKINGQUEUE_H
+#define MATCHMAKINGQUEUE_H
+
+#include <QHash>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Matching tolerances of a MatchmakingQueue.
+ */
+struct MatchmakingConfig {
+    int ratingWindow = 100;          ///< Accepted rating difference of a new player.
+    int ratingWindowGrowth = 50;     ///< Widening of the rating window per second of waiting.
+    int rttWindowMs = 30;            ///< Accepted round-trip time difference of a new player.
+    int rttWindowGrowthMs = 20;      ///< Widening of the round-trip time window per second of waiting.
+    int maxWaitMs = 10000;           ///< Wait after which any partners are accepted.
+};
+
+/**
+ * @brief Queue of players waiting for a match, grouped by rating and round-trip time.
+ *
+ * Players are not placed when they arrive; their owner calls match()
+ * periodically, and every call places as many groups as it can in one batch.
+ * Each pass sorts the queue by rating once, then lets the longest-waiting
+ * players pick the closest-rated compatible partners. The accepted rating and
+ * round-trip time spreads widen with the wait, and a player who has waited
+ * longer than MatchmakingConfig::maxWaitMs is matched with the nearest-rated
+ * players regardless of both, so the wait is bounded whenever enough players are queued.
+ *
+ * The queue does not own a clock: times are passed in by the caller.
+ */
+class MatchmakingQueue {
+public:
+    static constexpr int MAX_SCAN = 64; ///< Candidates examined per player and pass.
+
+    /**
+     * @brief Queue depth and wait time counters.
+     */
+    struct Stats {
+        int depth = 0;            ///< Number of queued players.
+        qint64 oldestWaitMs = 0;  ///< Wait of the longest-queued player.
+        qint64 placed = 0;        ///< Players placed since the queue was created.
+        qint64 totalWaitMs = 0;   ///< Sum of the waits of all placed players.
+        qint64 maxWaitMs = 0;     ///< Longest wait of a placed player.
+    };
+
+    /**
+     * @brief Constructs an empty queue.
+     * @param groupSize The number of players in a match.
+     * @param config The matching tolerances.
+     */
+    explicit MatchmakingQueue(int groupSize, const MatchmakingConfig &config = MatchmakingConfig());
+
+    /**
+     * @brief Returns the number of queued players.
+     * @return The queue depth.
+     */
+    int size() const;
+
+    /**
+     * @brief Checks whether a player is queued.
+     * @param sessionId The session ID of the player.
+     * @return True if the player is waiting for a match.
+     */
+    bool contains(quint32 sessionId) const;
+
+    /**
+     * @brief Adds a player to the queue.
+     * @param sessionId The session ID of the player.
+     * @param rating The rating of the player.
+     * @param nowMs The current time in milliseconds.
+     * @return False if the player is already queued.
+     */
+    bool enqueue(quint32 sessionId, double rating, qint64 nowMs);
+
+    /**
+     * @brief Removes a player from the queue.
+     * @param sessionId The session ID of the player.
+     * @return True if the player was queued.
+     */
+    bool remove(quint32 sessionId);
+
+    /**
+     * @brief Records the measured round-trip time of a queued player.
+     *
+     * Players without a measurement are compatible with any round-trip time.
+     *
+     * @param sessionId The session ID of the player.
+     * @param rttMs The round-trip time in milliseconds.
+     */
+    void setRtt(quint32 sessionId, int rttMs);
+
+    /**
+     * @brief Places as many groups as possible and removes them from the queue.
+     * @param nowMs The current time in milliseconds.
+     * @param maxGroups The largest number of groups to place.
+     * @param groups Receives groupSize session IDs per placed group.
+     * @return The number of placed groups.
+     */
+    int match(qint64 nowMs, int maxGroups, QVector<quint32> &groups);
+
+    /**
+     * @brief Returns the queue depth and wait time counters.
+     * @param nowMs The current time in milliseconds.
+     * @return The counters.
+     */
+    Stats stats(qint64 nowMs) const;
+
+private:
+    /**
+     * @brief A queued player.
+     */
+    struct Entry {
+        quint32 sessionId = 0;  ///< The session ID of the player.
+        float rating = 0;       ///< The rating when the player was queued.
+        qint32 rttMs = -1;      ///< Measured round-trip time; -1 if unknown.
+        qint64 enqueuedMs = 0;  ///< Time the player was queued.
+    };
+
+    /**
+     * @brief Checks whether two players may share a match.
+     * @param anchor The longest-waiting player of the candidate group.
+     * @param candidate The candidate partner.
+     * @param rttWindow The accepted round-trip time difference.
+     * @return True if the round-trip times are compatible.
+     */
+    static bool rttCompatible(const Entry &anchor, const Entry &candidate, qint64 rttWindow);
+
+    /**
+     * @brief Removes the placed entries and rebuilds the session index.
+     */
+    void compact();
+
+    const int groupSize;                ///< Number of players in a match.
+    const MatchmakingConfig config;     ///< Matching tolerances.
+    QVector<Entry> entries;             ///< Queued players in no particular order.
+    QHash<quint32, int> indexOfSession; ///< Index into entries, keyed by session ID.
+
+    QVector<int> byRating;   ///< Scratch: entry indices sorted by rating.
+    QVector<int> byWait;     ///< Scratch: entry indices sorted by enqueue time.
+    QVector<int> positionOf; ///< Scratch: position of every entry in byRating.
+    QVector<int> prev;       ///< Scratch: previous unplaced position in byRating, or -1.
+    QVector<int> next;       ///< Scratch: next unplaced position in byRating, or size.
+    QVector<quint8> placed;  ///< Scratch: 1 for entries placed by the current pass.
+    QVector<int> group;      ///< Scratch: positions of the group being built.
+
+    qint64 placedTotal = 0;  ///< Players placed since construction.
+    qint64 waitTotalMs = 0;  ///< Sum of the waits of all placed players.
+    qint64 waitMaxMs = 0;    ///< Longest wait of a placed player.
+};
+
+#endif // MATCHMAKINGQUEUE_H
@@ -0,0 +1,94 @@
+#ifndef MESSAGEFRAMER_H
+#define MESSAGEFRAMER_H
+
+#include <QByteArray>
+#include <QIODevice>
+
+/**
+ * @brief Length-prefixed framing codec shared by the TCP server and client.
+ *
+ * Every message on the wire is preceded by a 4-byte big-endian payload length.
+ * Incoming bytes are accumulated in a reassembly buffer whose memory is reused
+ * between reads, and complete frames are extracted one at a time, so merged or
+ * split TCP segments never corrupt message boundaries.
+ */
+class MessageFramer {
+public:
+    static constexpr int HEADER_SIZE = 4;                     ///< Size of the length prefix in bytes.
+    static constexpr quint32 MAX_FRAME_SIZE = 1024 * 1024;    ///< Largest accepted payload size.
+    static constexpr int INITIAL_CAPACITY = 4096;             ///< Initial capacity of the reassembly buffer.
+
+    /**
+     * @brief Constructs an empty framer with a preallocated reassembly buffer.
+     */
+    MessageFramer();
+
+    /**
+     * @brief Wraps a single payload into a frame.
+     * @param payload The message to frame.
+     * @return The framed message ready to be written to a socket.
+     */
+    static QByteArray frame(const QByteArray &payload);
+
+    /**
+     * @brief Appends a framed payload to an output buffer.
+     *
+     * Allows several messages to be batched into one socket write.
+     *
+     * @param out The buffer receiving the frame.
+     * @param payload The message to frame.
+     */
+    static void appendFrame(QByteArray &out, const QByteArray &payload);
+
+    /**
+     * @brief Returns the heartbeat frame, a frame with an empty payload.
+     *
+     * The returned buffer is shared, so sending it does not allocate.
+     *
+     * @return The framed heartbeat.
+     */
+    static const QByteArray &heartbeatFrame();
+
+    /**
+     * @brief Reads all currently available bytes from a device into the reassembly buffer.
+     * @param device The device to read from.
+     * @return False if reading failed, otherwise true.
+     */
+    bool readFrom(QIODevice *device);
+
+    /**
+     * @brief Appends raw bytes to the reassembly buffer.
+     * @param data The received bytes.
+     */
+    void append(const QByteArray &data);
+
+    /**
+     * @brief Extracts the next complete frame from the reassembly buffer.
+     * @param payload Receives the payload of the frame.
+     * @return True if a complete frame was extracted, otherwise false.
+     */
+    bool nextFrame(QByteArray &payload);
+
+    /**
+     * @brief Indicates whether the peer sent a frame larger than MAX_FRAME_SIZE.
+     * @return True if the stream is corrupted and the connection should be closed.
+     */
+    bool hasError() const;
+
+    /**
+     * @brief Discards all buffered data and resets the error state.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief Moves unread bytes to the front of the buffer, keeping its capacity.
+     */
+    void compact();
+
+    QByteArray buffer;    ///< Reassembly buffer holding received but unprocessed bytes.
+    qsizetype readPos = 0; ///< Offset of the first unprocessed byte in the buffer.
+    bool error = false;   ///< Set when an oversized frame header is received.
+};
+
+#endif // MESSAGEFRAMER_H
@@ -0,0 +1,139 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <atomic>
+
+/**
+ * @brief Lock-free counters, gauges and histograms of a server process.
+ *
+ * Every metric is a fixed slot of relaxed atomics, so recording costs one
+ * uncontended atomic add and may happen on any thread, including the socket
+ * workers. Counters live on their own cache lines so that workers updating
+ * different counters do not slow each other down.
+ *
+ * Histograms record durations in microseconds into fixed buckets from 10 µs
+ * to 60 s. render() produces the Prometheus text exposition format, with
+ * durations converted to seconds.
+ */
+class Metrics {
+public:
+    /**
+     * @brief Monotonic counters recorded on the hot paths.
+     */
+    enum class Counter : quint8 {
+        ConnectionsAccepted, ///< TCP connections handed to a worker.
+        ConnectionsClosed,   ///< TCP connections that ended.
+        BytesReceived,       ///< Bytes read from player sockets.
+        BytesSent,           ///< Bytes written to player sockets.
+        BroadcastDatagrams,  ///< Lobby announcement datagrams sent.
+        RoundsResolved,      ///< Rounds resolved by any lobby.
+        Count                ///< Number of counters; not a counter.
+    };
+
+    /**
+     * @brief Values sampled from the server state when the metrics are scraped.
+     */
+    enum class Gauge : quint8 {
+        SeatedPlayers,           ///< Players seated in a lobby.
+        Spectators,              ///< Connections watching a lobby.
+        MatchmakingQueued,       ///< Players waiting in the matchmaking queue.
+        SendQueueBytes,          ///< Bytes waiting in send queues.
+        SendQueueFrames,         ///< Frames waiting in send queues.
+        SendQueueDroppedFrames,  ///< Frames dropped by send queues so far.
+        SlowConsumerDisconnects, ///< Connections closed for reading too slowly so far.
+        Count                    ///< Number of gauges; not a gauge.
+    };
+
+    /**
+     * @brief Duration histograms.
+     */
+    enum class Histogram : quint8 {
+        RoundResolution, ///< Time to resolve a round and send its results.
+        MoveWait,        ///< Time from a round start to the last move.
+        LobbyFill,       ///< Time from the first seated player to a full lobby.
+        Count            ///< Number of histograms; not a histogram.
+    };
+
+    /**
+     * @brief Direction of a counted protocol message.
+     */
+    enum class Direction : quint8 {
+        Received, ///< From a player to the server.
+        Sent      ///< From the server to a player.
+    };
+
+    static constexpr int BUCKET_COUNT = 14; ///< Finite histogram buckets; one more counts the overflow.
+
+    Metrics() = default;
+    Metrics(const Metrics &) = delete;
+    Metrics &operator=(const Metrics &) = delete;
+
+    /**
+     * @brief Adds to a counter.
+     * @param counter The counter.
+     * @param value The amount to add.
+     */
+    void add(Counter counter, quint64 value = 1) {
+        counters[static_cast<int>(counter)].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets a gauge.
+     * @param gauge The gauge.
+     * @param value The current value.
+     */
+    void set(Gauge gauge, qint64 value) {
+        gauges[static_cast<int>(gauge)].store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Counts a protocol message by its opcode.
+     *
+     * Only the first message of a batch is looked at; payloads that are not
+     * protocol messages are not counted.
+     *
+     * @param direction Whether the message was received or sent.
+     * @param payload The payload of the frame.
+     * @param recipients The number of copies sent.
+     */
+    void countMessage(Direction direction, const QByteArray &payload, quint64 recipients = 1);
+
+    /**
+     * @brief Records a duration in a histogram.
+     * @param histogram The histogram.
+     * @param micros The duration in microseconds.
+     */
+    void observe(Histogram histogram, qint64 micros);
+
+    /**
+     * @brief Renders every metric in the Prometheus text exposition format.
+     * @return The rendered metrics.
+     */
+    QByteArray render() const;
+
+private:
+    /**
+     * @brief An atomic counter on its own cache line.
+     */
+    struct alignas(64) PaddedCounter {
+        std::atomic<quint64> value{0}; ///< The counter value.
+    };
+
+    /**
+     * @brief Buckets, sum and count of a histogram.
+     */
+    struct HistogramData {
+        std::atomic<quint64> buckets[BUCKET_COUNT + 1] = {}; ///< Observations per bucket; the last one is unbounded.
+        std::atomic<quint64> sumMicros{0};                   ///< Sum of all observations.
+    };
+
+    static const qint64 BUCKET_BOUNDS_US[BUCKET_COUNT]; ///< Upper bounds of the finite buckets.
+
+    PaddedCounter counters[static_cast<int>(Counter::Count)];                 ///< Counter values.
+    std::atomic<qint64> gauges[static_cast<int>(Gauge::Count)] = {};          ///< Gauge values.
+    HistogramData histograms[static_cast<int>(Histogram::Count)];             ///< Histogram values.
+    std::atomic<quint64> messages[2][256] = {};                               ///< Messages per direction and opcode.
+};
+
+#endif // METRICS_H
@@ -0,0 +1,77 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include "Metrics.h"
+
+/**
+ * @brief Serves the metrics of a process over HTTP for Prometheus.
+ *
+ * The server listens on the loopback interface only and answers
+ * `GET /metrics` with Metrics::render() and `GET /trace` with the spans
+ * recorded so far as Chrome trace JSON; every other request gets a 404.
+ * Each connection carries one request and is closed after the answer.
+ * Before rendering, scrapeRequested() lets the owners of pull-style values
+ * update their gauges.
+ */
+class MetricsServer : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int MAX_REQUEST_BYTES = 8192; ///< Request header size above which a connection is dropped.
+
+    /**
+     * @brief Constructs a server exporting a set of metrics.
+     * @param metrics The metrics, which must outlive the server.
+     * @param port The local TCP port to listen on.
+     * @param parent The parent QObject (optional).
+     */
+    MetricsServer(Metrics *metrics, quint16 port, QObject *parent = nullptr);
+
+    /**
+     * @brief Starts listening for scrapes.
+     * @return False if the port could not be bound.
+     */
+    bool start();
+
+    /**
+     * @brief Stops listening and closes every open connection.
+     */
+    void stop();
+
+signals:
+    /**
+     * @brief Emitted before the metrics are rendered for a scrape.
+     */
+    void scrapeRequested();
+
+private slots:
+    /**
+     * @brief Accepts the pending scrape connections.
+     */
+    void onNewConnection();
+
+    /**
+     * @brief Reads a request and answers it once its header is complete.
+     */
+    void onReadyRead();
+
+private:
+    /**
+     * @brief Writes an HTTP response and closes the connection.
+     * @param socket The connection.
+     * @param status The status line after the protocol version, e.g. "200 OK".
+     * @param contentType The content type of the body.
+     * @param body The body.
+     */
+    static void respond(QTcpSocket *socket, const char *status, const char *contentType, const QByteArray &body);
+
+    Metrics *metrics;                        ///< The exported metrics; not owned.
+    const quint16 port;                      ///< The local TCP port.
+    QTcpServer tcpServer;                    ///< Listener for scrape connections.
+    QHash<QTcpSocket*, QByteArray> requests; ///< Partially received requests, keyed by connection.
+};
+
+#endif // METRICSSERVER_H
@@ -0,0 +1,51 @@
+#ifndef PINGRESPONDER_H
+#define PINGRESPONDER_H
+
+#include <QObject>
+#include <QUdpSocket>
+
+/**
+ * @brief Answers UDP latency probes sent by clients choosing a lobby.
+ *
+ * The responder listens on the UDP port with the same number as the host's
+ * TCP port, so a client that found a lobby already knows where to probe it.
+ * A probe is PACKET_SIZE bytes: the MAGIC value and a nonce, both big-endian.
+ * It is sent back unchanged, so the answer is never larger than the request,
+ * and anything that is not a well-formed probe is dropped.
+ */
+class PingResponder : public QObject {
+    Q_OBJECT
+public:
+    static constexpr quint32 MAGIC = 0x52505350; ///< "RPSP": identifies a latency probe.
+    static constexpr int PACKET_SIZE = 8;        ///< Size of a probe and of its answer.
+
+    /**
+     * @brief Constructs a responder.
+     * @param port The UDP port to answer on; the host's TCP port.
+     * @param parent The parent QObject (optional).
+     */
+    explicit PingResponder(quint16 port, QObject *parent = nullptr);
+
+    /**
+     * @brief Starts answering probes.
+     * @return False if the port could not be bound.
+     */
+    bool start();
+
+    /**
+     * @brief Stops answering probes.
+     */
+    void stop();
+
+private slots:
+    /**
+     * @brief Echoes every pending well-formed probe to its sender.
+     */
+    void onReadyRead();
+
+private:
+    QUdpSocket udpSocket; ///< Socket receiving the probes.
+    const quint16 port;   ///< The UDP port answered on.
+};
+
+#endif // PINGRESPONDER_H
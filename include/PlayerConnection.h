@@ -2,8 +2,8 @@
 #define PLAYERCONNECTION_H
 
 #include "INetworkSerializable.h"
+#include "WireFormat.h"
 #include <QString>
-#include <QDataStream>
 #include <QHostAddress>
 
 /**
@@ -13,6 +13,7 @@ struct PlayerConnection : public INetworkSerializable {
     QString playerName; ///< Name of the player.
     QHostAddress ipAddress; ///< IP address of the player.
     bool isHost = false; ///< Indicates if the player is the host.
+    quint32 sessionId = 0; ///< Server-assigned ID, unique for every connection; 0 means unassigned.
 
     /**
      * @brief Default constructor.
@@ -24,30 +25,49 @@ struct PlayerConnection : public INetworkSerializable {
      * @param name Player's name.
      * @param ip Player's IP address.
      * @param host Whether the player is the host.
+     * @param session The server-assigned session ID.
      */
-    PlayerConnection(const QString &name, const QHostAddress &ip, bool host)
-        : playerName(name), ipAddress(ip), isHost(host) {}
+    PlayerConnection(const QString &name, const QHostAddress &ip, bool host, quint32 session = 0)
+        : playerName(name), ipAddress(ip), isHost(host), sessionId(session) {}
+
+    using INetworkSerializable::deserialize;
+
+    /**
+     * @brief Returns the serialized size of the PlayerConnection object.
+     * @return The size in bytes.
+     */
+    int serializedSize() const override {
+        return WireFormat::stringSize(playerName) + WireFormat::addressSize(ipAddress) + 1 + 4;
+    }
 
     /**
-     * @brief Serializes the PlayerConnection object into a QByteArray.
-     * @return Serialized data.
+     * @brief Appends the PlayerConnection object to a buffer.
+     *
+     * The IP address is written as raw bytes rather than as text.
+     *
+     * @param buffer The buffer to append to.
      */
-    QByteArray serialize() const override {
-        QByteArray data;
-        QDataStream out(&data, QIODevice::WriteOnly);
-        out << playerName << ipAddress.toString() << isHost;
-        return data;
+    void serializeInto(QByteArray &buffer) const override {
+        WireFormat::Writer out(buffer, serializedSize());
+        out.writeString(playerName);
+        out.writeAddress(ipAddress);
+        out.writeBool(isHost);
+        out.writeU32(sessionId);
     }
 
     /**
-     * @brief Deserializes the PlayerConnection object from a QByteArray.
+     * @brief Deserializes the PlayerConnection object from borrowed bytes.
      * @param data Serialized data.
+     * @param size The number of available bytes.
+     * @return False if the data is truncated.
      */
-    void deserialize(const QByteArray &data) override {
-        QDataStream in(data);
-        QString ipString;
-        in >> playerName >> ipString >> isHost;
-        ipAddress = QHostAddress(ipString);
+    bool deserialize(const char *data, qsizetype size) override {
+        WireFormat::Reader in(data, size);
+        playerName = in.readString();
+        ipAddress = in.readAddress();
+        isHost = in.readBool();
+        sessionId = in.readU32();
+        return in.ok();
     }
 };
 
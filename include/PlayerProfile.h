@@ -2,9 +2,8 @@
 #define PLAYERPROFILE_H
 
 #include "INetworkSerializable.h"
+#include "WireFormat.h"
 #include <QString>
-#include <QDataStream>
-#include <QHostInfo>
 
 /**
  * @brief Represents a player's profile.
@@ -18,24 +17,35 @@ struct PlayerProfile : public INetworkSerializable {
      */
     PlayerProfile(const QString &name) : playerName(name) {}
 
+    using INetworkSerializable::deserialize;
+
+    /**
+     * @brief Returns the serialized size of the PlayerProfile object.
+     * @return The size in bytes.
+     */
+    int serializedSize() const override {
+        return WireFormat::stringSize(playerName);
+    }
+
     /**
-     * @brief Serializes the PlayerProfile object into a QByteArray.
-     * @return Serialized data.
+     * @brief Appends the PlayerProfile object to a buffer.
+     * @param buffer The buffer to append to.
      */
-    QByteArray serialize() const override {
-        QByteArray data;
-        QDataStream out(&data, QIODevice::WriteOnly);
-        out << playerName;
-        return data;
+    void serializeInto(QByteArray &buffer) const override {
+        WireFormat::Writer out(buffer, serializedSize());
+        out.writeString(playerName);
     }
 
     /**
-     * @brief Deserializes the PlayerProfile object from a QByteArray.
+     * @brief Deserializes the PlayerProfile object from borrowed bytes.
      * @param data Serialized data.
+     * @param size The number of available bytes.
+     * @return False if the data is truncated.
      */
-    void deserialize(const QByteArray &data) override {
-        QDataStream in(data);
-        in >> playerName;
+    bool deserialize(const char *data, qsizetype size) override {
+        WireFormat::Reader in(data, size);
+        playerName = in.readString();
+        return in.ok();
     }
 };
 
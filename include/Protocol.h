@@ -0,0 +1,140 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <QByteArray>
+#include <QVector>
+#include "ChatMessage.h"
+
+/**
+ * @brief Binary wire protocol spoken between LobbyClient and the servers.
+ *
+ * Every message is a fixed-size record carried in one frame:
+ * a protocol version byte, a one-byte opcode and a 4-byte big-endian payload.
+ * Decoding is a bounds check and a switch, without building any QString.
+ *
+ * Chat frames are the exception to the fixed size: a version byte, the Chat
+ * opcode and one or more serialized ChatMessage records, told apart from
+ * other messages by isChat(). Text-protocol peers cannot parse them, so
+ * builds with RPS_TEXT_PROTOCOL refuse to encode or decode chat.
+ *
+ * Spectators receive snapshots of a lobby: several messages packed into one
+ * frame by encodeBatch(), so a snapshot always arrives whole.
+ *
+ * When the project is built with `RPS_TEXT_PROTOCOL`, messages are encoded as
+ * the legacy text commands (`/start`, `/choice N`, ...) instead, and both
+ * encodings are accepted by the decoder.
+ */
+namespace Protocol {
+
+constexpr quint8 VERSION = 1;     ///< Version byte written in front of every binary message.
+constexpr int MESSAGE_SIZE = 6;   ///< Size of a binary message in bytes.
+
+/**
+ * @brief Message types of the protocol.
+ */
+enum class Opcode : quint8 {
+    Join = 0x01,   ///< Client -> server: join the lobby given in the payload (0 = any lobby).
+    Choice = 0x02, ///< Client -> server: the player's move in the payload (1 = Rock, 2 = Paper, 3 = Scissors).
+    Pong = 0x03,   ///< Client -> server: answer to a Ping, echoing its payload.
+    Spectate = 0x04, ///< Client -> server: watch the lobby given in the payload instead of joining it.
+    Chat = 0x05,   ///< Both directions: variable-size frame of ChatMessage records, see encodeChat().
+    Identify = 0x06, ///< Client -> server: the player's stable key in the payload, sent before Join (0 = none).
+    Start = 0x10,  ///< Server -> client: the round has started.
+    Win = 0x11,    ///< Server -> client: the player won the round.
+    Lose = 0x12,   ///< Server -> client: the player lost the round.
+    Draw = 0x13,   ///< Server -> client: the round ended in a draw.
+    Ping = 0x14,   ///< Server -> client: round-trip time probe; the payload is echoed in a Pong.
+    Next = 0x15,   ///< Server -> client: the next result does not end the session; the payload is the
+                   ///< match score (own wins << 16 | opponent wins).
+    Round = 0x16,  ///< Server -> spectator: first message of a snapshot; round number << 16 | seated players.
+    Moves = 0x17,  ///< Server -> spectator: moves of the resolved round; choice << 24 | players who chose it.
+    Result = 0x18  ///< Server -> spectator: result of the resolved round; winning choice << 24 | winners.
+};
+
+/**
+ * @brief A decoded protocol message.
+ */
+struct Message {
+    Opcode opcode = Opcode::Join; ///< The message type.
+    quint32 value = 0;            ///< The fixed-width payload.
+};
+
+/**
+ * @brief Encodes a message.
+ * @param opcode The message type.
+ * @param value The payload.
+ * @return The encoded message, ready to be framed; empty for Chat, see encodeChat().
+ */
+QByteArray encode(Opcode opcode, quint32 value = 0);
+
+/**
+ * @brief Decodes a message.
+ * @param data The payload of a received frame.
+ * @param message Receives the decoded message.
+ * @return False if the data is not a valid message of a supported version; chat frames are rejected.
+ */
+bool decode(const QByteArray &data, Message &message);
+
+/**
+ * @brief Encodes several messages into the payload of one frame.
+ * @param messages The messages.
+ * @param count The number of messages.
+ * @return The encoded messages, ready to be framed.
+ */
+QByteArray encodeBatch(const Message *messages, int count);
+
+/**
+ * @brief Decodes the payload of a frame holding one or more messages.
+ * @param data The payload of a received frame.
+ * @param messages Receives the decoded messages, replacing its content.
+ * @return False if any message is invalid.
+ */
+bool decodeBatch(const QByteArray &data, QVector<Message> &messages);
+
+/**
+ * @brief Reads the opcode of the first message of a frame payload without decoding the rest.
+ * @param data The payload of a frame.
+ * @param opcode Receives the opcode.
+ * @return False if the payload does not start with a known message.
+ */
+bool peekOpcode(const QByteArray &data, Opcode &opcode);
+
+/**
+ * @brief Returns the lowercase name of an opcode, as used in the text protocol.
+ * @param opcode The opcode.
+ * @return The name, e.g. "choice"; "unknown" for unsupported values.
+ */
+const char *opcodeName(Opcode opcode);
+
+/**
+ * @brief Checks whether a frame payload is a chat frame.
+ * @param data The payload of a received frame.
+ * @return True if the payload starts with the chat header.
+ */
+bool isChat(const QByteArray &data);
+
+/**
+ * @brief Encodes one chat message as a chat frame payload.
+ * @param message The chat message.
+ * @return The encoded frame payload; empty if the build does not support chat.
+ */
+QByteArray encodeChat(const ChatMessage &message);
+
+/**
+ * @brief Encodes already serialized chat messages as one chat frame payload.
+ * @param records Concatenated ChatMessage records.
+ * @return The encoded frame payload; empty if the build does not support chat.
+ */
+QByteArray encodeChatRecords(const QByteArray &records);
+
+/**
+ * @brief Decodes a chat frame payload.
+ * @param data The payload of a received frame.
+ * @param messages Receives the chat messages, replacing its content.
+ * @return False if the payload is not a well-formed chat frame or the build does not support chat.
+ */
+bool decodeChat(const QByteArray &data, QVector<ChatMessage> &messages);
+
+} // namespace Protocol
+
+#endif // PROTOCOL_H
@@ -0,0 +1,203 @@
+#ifndef RATINGSERVICE_H
+#define RATINGSERVICE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * @brief Elo ratings and leaderboard of every player seen by a server.
+ *
+ * Ratings are updated incrementally after each round: every winner is scored
+ * against the average rating of the losers and every loser against the
+ * average of the winners, each weighted by the share of opponents on the other
+ * side, so a round costs O(players). In a drawn round all players are scored
+ * 0.5 against the average of the others.
+ *
+ * Players are indexed by their rating rounded to an integer in a Fenwick tree
+ * over RATING_BUCKETS buckets, which answers rank queries in O(log R) and
+ * top-K queries in O(K log R) without sorting all players.
+ *
+ * The ratings can be loaded from and periodically saved to a snapshot file;
+ * snapshots are serialized on the calling thread and written by a background thread.
+ */
+class RatingService : public QObject {
+    Q_OBJECT
+public:
+    static constexpr double INITIAL_RATING = 1500.0; ///< Rating of a new player.
+    static constexpr double K_FACTOR = 32.0;         ///< Largest rating change of one round.
+    static constexpr int RATING_BUCKETS = 4096;      ///< Ratings are clamped to [0, RATING_BUCKETS - 1].
+
+    /**
+     * @brief Rating and record of one player.
+     */
+    struct PlayerRating {
+        quint32 playerKey = 0;           ///< Stable key of the player, see MatchLog::playerKey().
+        double rating = INITIAL_RATING;  ///< Current Elo rating.
+        quint32 rounds = 0;              ///< Rounds played.
+        quint32 wins = 0;                ///< Rounds won.
+        quint32 losses = 0;              ///< Rounds lost.
+        quint32 draws = 0;               ///< Rounds drawn.
+    };
+
+    /**
+     * @brief Constructs an empty rating service.
+     * @param parent The parent QObject (optional).
+     */
+    explicit RatingService(QObject *parent = nullptr);
+
+    /**
+     * @brief Saves a final snapshot if snapshots are enabled.
+     *
+     * Only a graceful shutdown destroys the service; a process ended by
+     * exit() or a fatal signal loses the changes since the last snapshot.
+     */
+    ~RatingService();
+
+    /**
+     * @brief Updates the ratings after a round.
+     * @param count The number of players.
+     * @param playerKeys The stable keys of the players.
+     * @param outcomes The results as Protocol::Opcode values (Win, Lose or Draw).
+     */
+    void recordRound(int count, const quint32 *playerKeys, const quint8 *outcomes);
+
+    /**
+     * @brief Returns the number of rated players.
+     * @return The player count.
+     */
+    int playerCount() const;
+
+    /**
+     * @brief Returns the rating of a player.
+     * @param playerKey The key of the player.
+     * @return The rating; a new player's rating if the player is unknown.
+     */
+    PlayerRating rating(quint32 playerKey) const;
+
+    /**
+     * @brief Returns the rank of a player.
+     *
+     * Players with the same rounded rating share a rank.
+     *
+     * @param playerKey The key of the player.
+     * @return 1 for the best player, or 0 if the player is unknown.
+     */
+    int rank(quint32 playerKey) const;
+
+    /**
+     * @brief Returns the best players.
+     * @param k The number of players.
+     * @return Up to k players, best first.
+     */
+    QVector<PlayerRating> top(int k) const;
+
+    /**
+     * @brief Replaces all ratings with the contents of a snapshot.
+     * @param path The snapshot file.
+     * @return False if the file is missing or not a rating snapshot.
+     */
+    bool loadSnapshot(const QString &path);
+
+    /**
+     * @brief Writes a snapshot of all ratings.
+     *
+     * The file is replaced atomically by a background thread; a snapshot
+     * requested while another one is still being written is skipped.
+     *
+     * @param path The snapshot file.
+     * @return False if a snapshot is already being written.
+     */
+    bool saveSnapshot(const QString &path);
+
+    /**
+     * @brief Saves a snapshot periodically while ratings change.
+     * @param path The snapshot file; empty disables snapshots.
+     * @param intervalMs The interval between snapshots.
+     */
+    void setSnapshotFile(const QString &path, int intervalMs = 60000);
+
+private slots:
+    /**
+     * @brief Saves a snapshot if ratings changed since the last one.
+     */
+    void onSnapshotTimer();
+
+private:
+    /**
+     * @brief A rated player and its place in its bucket.
+     */
+    struct Entry {
+        PlayerRating player; ///< The rating and record.
+        int bucket = -1;     ///< The rating bucket the player is indexed in.
+        int position = -1;   ///< The index of the player within the bucket.
+    };
+
+    /**
+     * @brief Returns the bucket of a rating.
+     * @param rating The rating.
+     * @return The bucket index.
+     */
+    static int bucketOf(double rating);
+
+    /**
+     * @brief Returns the entry of a player, creating it if needed.
+     * @param playerKey The key of the player.
+     * @return The entry.
+     */
+    Entry &entryOf(quint32 playerKey);
+
+    /**
+     * @brief Moves an entry into the bucket matching its rating.
+     * @param entry The entry.
+     */
+    void reindex(Entry &entry);
+
+    /**
+     * @brief Adds to the player count of a bucket.
+     * @param bucket The bucket index.
+     * @param delta The change of the count.
+     */
+    void addToIndex(int bucket, int delta);
+
+    /**
+     * @brief Counts the players in buckets up to and including a bucket.
+     * @param bucket The bucket index.
+     * @return The number of players.
+     */
+    int countUpTo(int bucket) const;
+
+    /**
+     * @brief Finds the lowest bucket whose cumulative player count reaches a target.
+     * @param target The cumulative count, between 1 and playerCount().
+     * @return The bucket index.
+     */
+    int findBucket(int target) const;
+
+    /**
+     * @brief Removes all players.
+     */
+    void clear();
+
+    /**
+     * @brief Serializes all ratings into the snapshot layout and clears the dirty flag.
+     * @return The serialized snapshot.
+     */
+    QByteArray serializeSnapshot();
+
+    QHash<quint32, Entry> entries;          ///< Every rated player, keyed by player key.
+    QVector<QVector<quint32>> buckets;      ///< Player keys of every rating bucket.
+    QVector<int> tree;                      ///< Fenwick tree over the bucket sizes, 1-based.
+    QVector<double> scratchRatings;         ///< Reused copy of the pre-round ratings.
+
+    QString snapshotPath;                   ///< Snapshot file; empty if snapshots are disabled.
+    QTimer snapshotTimer;                   ///< Drives the periodic snapshots.
+    bool dirty = false;                     ///< True if ratings changed since the last snapshot.
+    QThread *snapshotThread = nullptr;      ///< Thread writing the current snapshot, or nullptr.
+};
+
+#endif // RATINGSERVICE_H
@@ -0,0 +1,53 @@
+#ifndef ROUNDRESOLVER_H
+#define ROUNDRESOLVER_H
+
+#include <QtGlobal>
+#include "GameRules.h"
+#include "Protocol.h"
+
+/**
+ * @brief Resolves a round over the packed moves of any number of players.
+ *
+ * Moves are read from a byte array indexed by player slot (0 = no move,
+ * 1 = Rock, 2 = Paper, 3 = Scissors) and the outcome of every slot is written
+ * to a parallel byte buffer as the Protocol opcode to send (Win, Lose or Draw).
+ * Both passes are branch-free loops over bytes, which compilers vectorize, so
+ * lobbies with thousands of players resolve in microseconds.
+ */
+namespace RoundResolver {
+
+/**
+ * @brief Summary of a resolved round.
+ */
+struct Result {
+    int rock = 0;                         ///< Number of players who chose Rock.
+    int paper = 0;                        ///< Number of players who chose Paper.
+    int scissors = 0;                     ///< Number of players who chose Scissors.
+    int winningChoice = GameRules::None;  ///< The winning move, or None for a draw.
+    int winners = 0;                      ///< Number of slots whose outcome is Win.
+};
+
+/**
+ * @brief Counts the moves of a round.
+ * @param choices The packed moves, one byte per player slot.
+ * @param count The number of player slots.
+ * @return The move counts and the winning move; winners is left at 0.
+ */
+Result tally(const quint8 *choices, int count);
+
+/**
+ * @brief Resolves a round and writes the outcome of every player slot.
+ *
+ * On a draw every slot receives Draw; otherwise slots holding the winning move
+ * receive Win and all other slots, including players without a move, receive Lose.
+ *
+ * @param choices The packed moves, one byte per player slot.
+ * @param count The number of player slots.
+ * @param outcomes Receives one Protocol::Opcode byte per slot; must hold count bytes.
+ * @return The summary of the round.
+ */
+Result resolve(const quint8 *choices, int count, quint8 *outcomes);
+
+} // namespace RoundResolver
+
+#endif // ROUNDRESOLVER_H
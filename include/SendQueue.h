@@ -0,0 +1,157 @@
+#ifndef SENDQUEUE_H
+#define SENDQUEUE_H
+
+#include <QByteArray>
+#include <QQueue>
+#include <atomic>
+#include "SendQueueLimits.h"
+
+/**
+ * @brief Bounded queue of the frames waiting to be written to one connection.
+ *
+ * Frames belong to one of three priority classes. Control frames (game
+ * messages and heartbeats) are written first, in order. A snapshot
+ * supersedes the previous one, so at most one is queued. Bulk frames such as
+ * chat are written last, and only once the socket has nothing else left to
+ * send, so they never delay the other classes.
+ *
+ * The queue never holds more than SendQueueLimits::maxBytes and maxFrames.
+ * A frame that does not fit first discards queued frames of lower priority,
+ * oldest first. A control frame that still does not fit reports an overflow
+ * under every policy, because losing a game message would desynchronize the
+ * peer. For a snapshot or bulk frame, Drop discards the new frame, Coalesce
+ * the oldest frames of its own class, and Disconnect reports an overflow.
+ *
+ * The queue is used by a single thread. Its depth is also added to shared
+ * Counters, which other threads may read.
+ */
+class SendQueue {
+public:
+    /**
+     * @brief Priority classes of outgoing frames, highest first.
+     */
+    enum class Priority : quint8 {
+        Control,  ///< Game messages and heartbeats.
+        Snapshot, ///< State that supersedes the previous state.
+        Bulk      ///< Chat and other traffic that may wait.
+    };
+
+    /**
+     * @brief Outcome of queueing a frame.
+     */
+    enum class Result : quint8 {
+        Queued,  ///< The frame was queued.
+        Dropped, ///< The frame was discarded.
+        Overflow ///< The frame does not fit and the connection should be closed.
+    };
+
+    /**
+     * @brief Depth and loss counters shared by the queues of one thread.
+     */
+    struct Counters {
+        std::atomic<qint64> queuedBytes{0};             ///< Bytes queued by all queues.
+        std::atomic<qint64> queuedFrames{0};            ///< Frames queued by all queues.
+        std::atomic<qint64> droppedFrames{0};           ///< Frames discarded or superseded so far.
+        std::atomic<qint64> slowConsumerDisconnects{0}; ///< Connections closed because of an overflow.
+    };
+
+    /**
+     * @brief Snapshot of the counters of one or more threads.
+     */
+    struct Stats {
+        qint64 queuedBytes = 0;             ///< Bytes waiting in send queues.
+        qint64 queuedFrames = 0;            ///< Frames waiting in send queues.
+        qint64 droppedFrames = 0;           ///< Frames discarded or superseded so far.
+        qint64 slowConsumerDisconnects = 0; ///< Connections closed because of an overflow.
+    };
+
+    /**
+     * @brief Constructs an empty queue.
+     * @param limits The limits, which must outlive the queue; nullptr leaves the queue unbounded.
+     * @param counters The shared counters, which must outlive the queue; nullptr counts nothing.
+     */
+    explicit SendQueue(const SendQueueLimits *limits = nullptr, Counters *counters = nullptr);
+
+    /**
+     * @brief Queues a frame.
+     * @param priority The priority class of the frame.
+     * @param frame The framed message; shared, not copied.
+     * @return Whether the frame was queued, discarded or overflowed the queue.
+     */
+    Result push(Priority priority, const QByteArray &frame);
+
+    /**
+     * @brief Takes the next frame to write.
+     * @param frame Receives the frame.
+     * @param socketIdle True if the socket has no unsent data; bulk frames wait for that.
+     * @return False if no frame may be written now.
+     */
+    bool pop(QByteArray &frame, bool socketIdle);
+
+    /**
+     * @brief Checks whether the queue is empty.
+     * @return True if no frame is queued.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Returns the number of queued bytes.
+     * @return The total size of the queued frames.
+     */
+    qint64 bytes() const;
+
+    /**
+     * @brief Returns the number of queued frames.
+     * @return The number of queued frames.
+     */
+    int frames() const;
+
+    /**
+     * @brief Discards every queued frame without counting it as dropped.
+     */
+    void clear();
+
+private:
+    /**
+     * @brief Checks whether a frame fits within the limits.
+     * @param size The size of the frame.
+     * @return True if the frame can be queued without exceeding a limit.
+     */
+    bool fits(qint64 size) const;
+
+    /**
+     * @brief Discards the oldest queued frame of a lower priority class.
+     * @param priority The priority class of the frame that needs room.
+     * @return False if there was no such frame.
+     */
+    bool shedBelow(Priority priority);
+
+    /**
+     * @brief Discards the oldest frame of a queue and counts it as dropped.
+     * @param queue The queue.
+     */
+    void dropOldest(QQueue<QByteArray> &queue);
+
+    /**
+     * @brief Adds to the depth of this queue and of the shared counters.
+     * @param bytes The change of the queued bytes.
+     * @param frames The change of the queued frames.
+     */
+    void account(qint64 bytes, int frames);
+
+    /**
+     * @brief Counts discarded frames in the shared counters.
+     * @param frames The number of discarded frames.
+     */
+    void countDropped(int frames);
+
+    const SendQueueLimits *limits; ///< Limits of the queue; not owned.
+    Counters *counters;            ///< Shared counters; not owned.
+    QQueue<QByteArray> control;    ///< Queued control frames, oldest first.
+    QByteArray snapshot;           ///< Queued snapshot; empty if none.
+    QQueue<QByteArray> bulk;       ///< Queued bulk frames, oldest first.
+    qint64 queuedBytes = 0;        ///< Total size of the queued frames.
+    int queuedFrames = 0;          ///< Number of queued frames.
+};
+
+#endif // SENDQUEUE_H
@@ -0,0 +1,45 @@
+#ifndef SENDQUEUELIMITS_H
+#define SENDQUEUELIMITS_H
+
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Bounds of the send queue of every connection to a server.
+ *
+ * A connection whose peer reads slower than the server writes queues its
+ * outgoing frames. Once the queue would exceed either limit, lower-priority
+ * frames are discarded first. If that is not enough, a control frame always
+ * closes the connection, since the game cannot continue without it; for
+ * snapshot and bulk frames the policy decides, see SendQueue.
+ */
+struct SendQueueLimits {
+    /**
+     * @brief Treatment of a snapshot or bulk frame that does not fit a queue full of frames of the same or higher priority.
+     */
+    enum class Policy {
+        Drop,       ///< Discard the new frame.
+        Coalesce,   ///< Discard the oldest queued frames of the same priority.
+        Disconnect  ///< Close the connection.
+    };
+
+    qint64 maxBytes = 256 * 1024; ///< Queued bytes per connection.
+    int maxFrames = 1024;         ///< Queued frames per connection.
+    Policy policy = Policy::Disconnect; ///< Treatment of slow consumers.
+
+    /**
+     * @brief Parses a policy name given on the command line.
+     * @param name "drop", "coalesce" or "disconnect".
+     * @param ok Receives false if the name is unknown.
+     * @return The parsed policy; Disconnect if the name is unknown.
+     */
+    static Policy parsePolicy(const QString &name, bool *ok = nullptr) {
+        if (ok) *ok = true;
+        if (name == "drop") return Policy::Drop;
+        if (name == "coalesce") return Policy::Coalesce;
+        if (name != "disconnect" && ok) *ok = false;
+        return Policy::Disconnect;
+    }
+};
+
+#endif // SENDQUEUELIMITS_H
@@ -3,14 +3,34 @@
 
 #include <QObject>
 #include <QString>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
 #include "PlayerConnection.h"
 #include "LobbyInfo.h"
 #include "LanTcpServer.h"
 #include "UdpBroadcaster.h"
+#include "RoundResolver.h"
+#include "MatchLog.h"
+#include "RatingService.h"
+#include "PingResponder.h"
+#include "SpectatorHub.h"
+#include "LobbyChat.h"
+#include "Metrics.h"
 
 /**
  * @brief Manages the game lobby, including player connections, server operations,
  *        and UDP broadcasting for lobby discovery.
+ *
+ * Players who do not answer the game start within the move timeout of the
+ * TCP server are disconnected, and the round is resolved among the rest.
+ *
+ * Connections are seated by their Join handshake. Connections that send
+ * Spectate instead watch the round through a SpectatorHub and do not count
+ * against the player limit, so they are accepted even when the lobby is full.
+ *
+ * Seated players share a LobbyChat; a player who takes a seat receives the
+ * recent chat history.
  */
 class ServerLobby : public QObject {
     Q_OBJECT
@@ -21,9 +41,11 @@ public:
      * @param maxPlayers The maximum number of players allowed in the lobby.
      * @param serverPort The TCP port for player connections.
      * @param broadcastPort The UDP port for broadcasting lobby availability.
+     * @param discovery The channels used to announce the lobby.
      * @param parent The parent QObject (optional).
      */
-    explicit ServerLobby(QString lobbyName, int maxPlayers, quint16 serverPort, quint16 broadcastPort, QObject *parent = nullptr);
+    explicit ServerLobby(QString lobbyName, int maxPlayers, quint16 serverPort, quint16 broadcastPort,
+                         const DiscoveryConfig &discovery = DiscoveryConfig(), QObject *parent = nullptr);
 
     /**
      * @brief Starts the TCP server to accept player connections.
@@ -43,7 +65,7 @@ public:
     bool resumeLobbySearch();
 
     /**
-     * @brief Pauses player search by stopping new connections and halting the broadcast.
+     * @brief Pauses player search by halting the broadcast; spectators can still connect.
      */
     void pauseLobbySearch();
 
@@ -62,6 +84,24 @@ public:
      */
     void startGame();
 
+    /**
+     * @brief Records every resolved round in a match history log.
+     * @param log The log, which must outlive the lobby; nullptr stops recording.
+     */
+    void setMatchLog(MatchLog *log);
+
+    /**
+     * @brief Updates player ratings after every resolved round.
+     * @param service The rating service, which must outlive the lobby; nullptr stops rating.
+     */
+    void setRatingService(RatingService *service);
+
+    /**
+     * @brief Records traffic, round timing and lobby metrics.
+     * @param newMetrics The metrics, which must outlive the lobby; nullptr stops recording.
+     */
+    void setMetrics(Metrics *newMetrics);
+
 signals:
     /**
      * @brief Emitted when lobby information is updated.
@@ -110,15 +150,36 @@ private slots:
 private:
     std::unique_ptr<LanTcpServer> server;  ///< TCP server that manages player connections.
     std::unique_ptr<UdpBroadcaster> broadcaster;  ///< UDP broadcaster for lobby discovery.
+    std::unique_ptr<PingResponder> pingResponder; ///< Answers the latency probes of choosing clients.
+    std::unique_ptr<SpectatorHub> spectators; ///< Streams the round to spectator connections.
+    std::unique_ptr<LobbyChat> chat; ///< Relays the chat of the seated players.
 
     const QString lobbyName;  ///< The name of the lobby.
     const int maxPlayers;  ///< Maximum number of players allowed in the lobby.
     const quint16 tcpPort;  ///< TCP port used for player connections.
     const quint16 udpPort;  ///< UDP port used for broadcasting lobby information.
+    const DiscoveryConfig discovery;  ///< Channels used to announce the lobby.
 
     LobbyInfo lobbyInfo;  ///< Stores the current lobby information.
-    QList<PlayerConnection> players;  ///< List of currently connected players.
-    QMap<int, int> playerChoices; ///< Stores player choices in the game.
+    QList<PlayerConnection> players;  ///< List of currently connected players; the position is the player ID.
+    QHash<quint32, int> playerIdOfSession; ///< Player ID of every seated session.
+    QHash<quint32, quint32> identityOfSession; ///< Key sent by the Identify handshake, keyed by session ID.
+    QVector<quint8> playerChoices; ///< Packed moves indexed by player ID; 0 means no move yet.
+    int chosenCount = 0;           ///< Number of players who made a move.
+    bool roundInProgress = false;  ///< True from the game start until the round is resolved.
+    QVector<quint8> outcomes;      ///< Reused per-player outcome buffer of the last resolved round.
+    MatchLog *matchLog = nullptr;  ///< Log of resolved rounds; not owned.
+    RatingService *ratings = nullptr; ///< Ratings updated after every round; not owned.
+    Metrics *metrics = nullptr;    ///< Traffic and timing metrics; not owned.
+    QElapsedTimer clock;           ///< Time base of the timing metrics.
+    qint64 fillStartUs = -1;       ///< Time the first player of an empty lobby was seated; -1 if none.
+    qint64 roundStartUs = -1;      ///< Time the current round started; -1 if none.
+
+    /**
+     * @brief Seats a player who sent the join handshake, or disconnects it if the lobby is full.
+     * @param player The player.
+     */
+    void seatPlayer(const PlayerConnection &player);
 
     /**
      * @brief Checks if there is space available in the lobby.
@@ -132,11 +193,11 @@ private:
     void refreshLobbyInfo();
 
     /**
-     * @brief Retrieves a player's unique ID based on their connection information.
+     * @brief Retrieves a player's unique ID based on their session ID.
      * @param player The player whose ID needs to be determined.
      * @return The player's ID, or -1 if not found.
      */
-    int getPlayerId(const PlayerConnection &player);
+    int getPlayerId(const PlayerConnection &player) const;
 
     /**
      * @brief Registers the player's move in the game.
@@ -152,9 +213,14 @@ private:
 
     /**
      * @brief Sends game results (win/loss/draw) to players.
-     * @param winners A list of player IDs who won the round.
+     * @param result The summary of the resolved round; per-player outcomes are in `outcomes`.
+     */
+    void sendWinnersAndLosers(const RoundResolver::Result &result);
+
+    /**
+     * @brief Updates the seated player and spectator gauges.
      */
-    void sendWinnersAndLosers(const QList<int> &winners);
+    void updateGauges();
 };
 
 #endif // SERVERLOBBY_H
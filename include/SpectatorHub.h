@@ -0,0 +1,141 @@
+#ifndef SPECTATORHUB_H
+#define SPECTATORHUB_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QTimer>
+#include "LanTcpServer.h"
+#include "RoundResolver.h"
+
+/**
+ * @brief Streams the rounds of watched lobbies to read-only spectator connections.
+ *
+ * Spectators are not seated and do not count against a lobby's player limit.
+ * Round events only update the state of the watched lobby; every TICK_MS the
+ * hub encodes one snapshot per changed lobby and fans it out to all of its
+ * spectators with LanTcpServer::sendSnapshotToPlayers(). Several events
+ * within a tick therefore cost one message, and spectators that read too
+ * slowly skip snapshots instead of being buffered without limit.
+ *
+ * A snapshot is a Round message (round number and seated players), followed
+ * by three Moves messages and a Result message once the round is resolved.
+ * Moves are revealed only with the result, so spectators cannot leak them.
+ * Events of lobbies without spectators cost one hash lookup.
+ */
+class SpectatorHub : public QObject {
+    Q_OBJECT
+public:
+    static constexpr int TICK_MS = 100; ///< Interval between two snapshots of a changing lobby.
+
+    /**
+     * @brief Constructs a hub sending through a server.
+     * @param server The server of the spectator connections, which must outlive the hub.
+     * @param parent The parent QObject (optional).
+     */
+    explicit SpectatorHub(LanTcpServer *server, QObject *parent = nullptr);
+
+    /**
+     * @brief Makes a connection a spectator of a lobby.
+     *
+     * A spectator who already watches another lobby switches to the new one.
+     * The current state of the lobby is sent with the next tick. The first
+     * spectator of a lobby seeds its state from the round in progress, since
+     * the hub does not follow lobbies nobody watches.
+     *
+     * @param sessionId The session ID of the spectator.
+     * @param lobbyId The ID of the watched lobby.
+     * @param roundPlayers The seated players of the round in progress; 0 if no round is running.
+     */
+    void addSpectator(quint32 sessionId, quint32 lobbyId, int roundPlayers = 0);
+
+    /**
+     * @brief Stops streaming to a connection.
+     * @param sessionId The session ID of the spectator.
+     * @return True if the connection was a spectator.
+     */
+    bool removeSpectator(quint32 sessionId);
+
+    /**
+     * @brief Checks whether a connection is a spectator.
+     * @param sessionId The session ID of the connection.
+     * @return True if the connection watches a lobby.
+     */
+    bool isSpectator(quint32 sessionId) const;
+
+    /**
+     * @brief Returns the number of spectators.
+     * @return The number of spectators of all lobbies.
+     */
+    int spectatorCount() const;
+
+    /**
+     * @brief Records the start of a round.
+     * @param lobbyId The ID of the lobby.
+     * @param players The number of seated players.
+     */
+    void roundStarted(quint32 lobbyId, int players);
+
+    /**
+     * @brief Records the moves and the result of a round.
+     * @param lobbyId The ID of the lobby.
+     * @param result The resolved round.
+     */
+    void roundResolved(quint32 lobbyId, const RoundResolver::Result &result);
+
+    /**
+     * @brief Stops streaming to every spectator.
+     */
+    void clear();
+
+private slots:
+    /**
+     * @brief Sends one snapshot of every changed lobby and of every lobby with new spectators.
+     */
+    void onTick();
+
+private:
+    /**
+     * @brief Latest state and spectators of a watched lobby.
+     */
+    struct Channel {
+        QVector<quint32> spectators;    ///< Spectators that received a snapshot.
+        QVector<quint32> newSpectators; ///< Spectators waiting for their first snapshot.
+        quint32 round = 0;              ///< Rounds started since the lobby was first watched.
+        int players = 0;                ///< Seated players of the current round.
+        RoundResolver::Result result;   ///< Moves and result of the current round.
+        bool resolved = false;          ///< True once the current round is resolved.
+        bool changed = false;           ///< True if the state changed since the last snapshot.
+        bool queued = false;            ///< True if the channel is in the pending list.
+    };
+
+    /**
+     * @brief Location of a spectator.
+     */
+    struct SpectatorRef {
+        quint32 lobbyId = 0; ///< The watched lobby.
+        int index = -1;      ///< Index in Channel::spectators; -1 while in Channel::newSpectators.
+    };
+
+    /**
+     * @brief Queues a channel for the next tick.
+     * @param lobbyId The ID of the lobby.
+     * @param channel The channel of the lobby.
+     */
+    void markPending(quint32 lobbyId, Channel &channel);
+
+    /**
+     * @brief Encodes the snapshot of a channel.
+     * @param channel The channel.
+     * @return The encoded snapshot.
+     */
+    static QByteArray snapshot(const Channel &channel);
+
+    LanTcpServer *server;                         ///< Server of the spectator connections; not owned.
+    QHash<quint32, Channel> channels;             ///< Watched lobbies, keyed by lobby ID.
+    QHash<quint32, SpectatorRef> spectatorOfSession; ///< Location of every spectator, keyed by session ID.
+    QVector<quint32> pendingChannels;             ///< Lobbies to send with the next tick.
+    QTimer tickTimer;                             ///< Drives the snapshots while lobbies are pending.
+};
+
+#endif // SPECTATORHUB_H
@@ -0,0 +1,130 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QHash>
+#include <QVector>
+
+/**
+ * @brief Hierarchical timing wheel holding many timeouts behind a single clock.
+ *
+ * Timers are identified by a 64-bit key. Scheduling, rescheduling and
+ * cancelling cost constant time, and advancing by one tick only touches the
+ * slot that expires, so the cost per tick does not depend on the number of
+ * pending timers. Timers due within SLOTS ticks live on the first level; later
+ * timers wait on coarser levels and cascade down as their time approaches.
+ *
+ * The wheel does not own a clock: its owner calls advanceTo() with the current
+ * time, typically from one periodic QTimer.
+ */
+class TimerWheel {
+public:
+    static constexpr int SLOT_BITS = 6;              ///< Bits of the tick consumed by one level.
+    static constexpr int SLOTS = 1 << SLOT_BITS;     ///< Slots per level.
+    static constexpr int LEVELS = 4;                 ///< Number of levels; covers SLOTS^LEVELS ticks.
+
+    /**
+     * @brief Constructs an empty wheel.
+     * @param tickMs The resolution of the wheel in milliseconds.
+     */
+    explicit TimerWheel(int tickMs = 100);
+
+    /**
+     * @brief Returns the resolution of the wheel.
+     * @return The length of one tick in milliseconds.
+     */
+    int tickMs() const;
+
+    /**
+     * @brief Returns the number of pending timers.
+     * @return The number of scheduled keys.
+     */
+    int size() const;
+
+    /**
+     * @brief Checks whether a timer is pending.
+     * @param key The key of the timer.
+     * @return True if the key is scheduled.
+     */
+    bool contains(quint64 key) const;
+
+    /**
+     * @brief Schedules a timer, replacing a pending timer with the same key.
+     *
+     * The delay is rounded up to whole ticks and counted from the time of the
+     * last advanceTo() call.
+     *
+     * @param key The key of the timer.
+     * @param delayMs The delay in milliseconds.
+     */
+    void schedule(quint64 key, qint64 delayMs);
+
+    /**
+     * @brief Cancels a pending timer.
+     * @param key The key of the timer.
+     * @return True if the timer was pending.
+     */
+    bool cancel(quint64 key);
+
+    /**
+     * @brief Cancels every pending timer.
+     */
+    void clear();
+
+    /**
+     * @brief Advances the wheel to a point in time and collects the expired timers.
+     *
+     * Expired timers are removed before they are reported, so they can be
+     * scheduled again right away.
+     *
+     * @param nowMs The current time in milliseconds, on the owner's clock.
+     * @param expired Receives the keys of the expired timers; existing entries are kept.
+     */
+    void advanceTo(qint64 nowMs, QVector<quint64> &expired);
+
+private:
+    /**
+     * @brief A scheduled timer, linked into the list of its slot.
+     */
+    struct Node {
+        quint64 key = 0;   ///< The key of the timer.
+        qint64 expiry = 0; ///< The tick at which the timer expires.
+        int prev = -1;     ///< Previous node in the slot, or -1.
+        int next = -1;     ///< Next node in the slot, or -1; links the free list for unused nodes.
+        int slot = -1;     ///< Index of the slot in heads.
+    };
+
+    /**
+     * @brief Links a node into the slot matching its expiry.
+     * @param index The node index.
+     */
+    void link(int index);
+
+    /**
+     * @brief Removes a node from its slot.
+     * @param index The node index.
+     */
+    void unlink(int index);
+
+    /**
+     * @brief Moves every node of a slot down to the levels matching its remaining time.
+     * @param level The level of the slot.
+     * @param slot The slot within the level.
+     */
+    void cascade(int level, int slot);
+
+    /**
+     * @brief Returns a node to the free list.
+     * @param index The node index.
+     */
+    void release(int index);
+
+    const int tick;          ///< Length of one tick in milliseconds.
+    qint64 currentTick = 0;  ///< The tick the wheel has advanced to.
+
+    QVector<int> heads;          ///< First node of every slot, level by level; -1 if empty.
+    QVector<Node> nodes;         ///< Node pool; freed nodes are reused.
+    int freeList = -1;           ///< First unused node, or -1.
+    QHash<quint64, int> nodeOfKey; ///< Node index of every scheduled key.
+};
+
+#endif // TIMERWHEEL_H
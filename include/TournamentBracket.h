@@ -0,0 +1,221 @@
+#ifndef TOURNAMENTBRACKET_H
+#define TOURNAMENTBRACKET_H
+
+#include <QQueue>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Compact single- or double-elimination bracket of best-of-N matches.
+ *
+ * Players are indexed 0..playerCount-1 in seed order and placed with the
+ * standard seeding, so the top seeds receive the byes of a field that is not
+ * a power of two. Every match is a small fixed-size record that knows where
+ * its winner and its loser go next; there is no per-round bookkeeping, so a
+ * match becomes ready the moment both of its players are known and all ready
+ * matches of the event can be played at the same time.
+ *
+ * Byes and withdrawn players are resolved as soon as they are placed, draws
+ * are replayed, and a double-elimination grand final is followed by a reset
+ * match only if the player from the losers' bracket wins it.
+ */
+class TournamentBracket {
+public:
+    static constexpr int NONE = -1; ///< Player index of an empty slot.
+
+    /**
+     * @brief Bracket format.
+     */
+    enum class Format : quint8 {
+        SingleElimination, ///< One loss eliminates a player.
+        DoubleElimination  ///< Two losses eliminate a player.
+    };
+
+    /**
+     * @brief Effect of one game on its match.
+     */
+    enum class GameOutcome : quint8 {
+        Rematch,     ///< The game was a draw and is replayed.
+        NextGame,    ///< The match continues with another game.
+        MatchDecided ///< One player has won enough games.
+    };
+
+    /**
+     * @brief Builds the bracket of an event.
+     * @param format The bracket format.
+     * @param playerCount The number of players, at least 2.
+     * @param bestOf The maximum number of decided games per match; a player needs bestOf / 2 + 1 wins.
+     */
+    TournamentBracket(Format format, int playerCount, int bestOf);
+
+    /**
+     * @brief Returns the bracket format.
+     * @return The format.
+     */
+    Format format() const;
+
+    /**
+     * @brief Returns the number of players.
+     * @return The number of players in the bracket.
+     */
+    int playerCount() const;
+
+    /**
+     * @brief Returns the number of matches, including byes.
+     * @return The number of matches.
+     */
+    int matchCount() const;
+
+    /**
+     * @brief Hands out matches whose players are known and marks them as playing.
+     * @param maxMatches The largest number of matches to hand out.
+     * @param matches Receives the match indices.
+     * @return The number of matches handed out.
+     */
+    int takeReadyMatches(int maxMatches, QVector<int> &matches);
+
+    /**
+     * @brief Returns a player of a match.
+     * @param match The match index.
+     * @param slot The slot, 0 or 1.
+     * @return The player index, or NONE if the slot is empty or not decided yet.
+     */
+    int player(int match, int slot) const;
+
+    /**
+     * @brief Returns the games a player has won in a match.
+     * @param match The match index.
+     * @param slot The slot, 0 or 1.
+     * @return The number of won games.
+     */
+    int wins(int match, int slot) const;
+
+    /**
+     * @brief Records the result of a game of a playing match.
+     * @param match The match index.
+     * @param winnerSlot The slot of the game's winner, or -1 for a draw.
+     * @return The effect of the game on the match.
+     */
+    GameOutcome recordGame(int match, int winnerSlot);
+
+    /**
+     * @brief Ends a playing match in favour of the opponent of a player who left.
+     * @param match The match index.
+     * @param slot The slot of the player who left.
+     */
+    void forfeit(int match, int slot);
+
+    /**
+     * @brief Removes a player who is not in a playing match from the event.
+     *
+     * The player's future matches are resolved as byes.
+     *
+     * @param player The player index.
+     */
+    void withdraw(int player);
+
+    /**
+     * @brief Checks whether a player has no matches left.
+     * @param player The player index.
+     * @return True if the player was eliminated or withdrew, or the event is over.
+     */
+    bool isOut(int player) const;
+
+    /**
+     * @brief Checks whether the final match has been decided.
+     * @return True if the event is over.
+     */
+    bool isFinished() const;
+
+    /**
+     * @brief Returns the winner of the event.
+     * @return The player index, or NONE while the event runs or if every finalist withdrew.
+     */
+    int champion() const;
+
+private:
+    /**
+     * @brief Lifecycle of a match.
+     */
+    enum class State : quint8 {
+        Pending, ///< At least one player is not known yet.
+        Ready,   ///< Both players are known; waiting for a lobby.
+        Playing, ///< Handed out by takeReadyMatches().
+        Done     ///< Decided.
+    };
+
+    /**
+     * @brief One match; 24 bytes.
+     */
+    struct Match {
+        qint32 players[2] = {NONE, NONE}; ///< Player indices of the two slots.
+        qint32 winnerTo = -1;             ///< match * 2 + slot receiving the winner; -1 for the final.
+        qint32 loserTo = -1;              ///< match * 2 + slot receiving the loser; -1 eliminates the loser.
+        quint8 wins[2] = {0, 0};          ///< Games won per slot.
+        quint8 filled = 0;                ///< Number of slots whose player is known.
+        State state = State::Pending;     ///< Lifecycle state.
+        bool resetMatch = false;          ///< Played only if the grand final before it was won from slot 1.
+    };
+
+    /**
+     * @brief Appends an unwired match.
+     * @return The new match index.
+     */
+    int addMatch();
+
+    /**
+     * @brief Places a player into a match slot and resolves the match if it needs no play.
+     * @param target match * 2 + slot.
+     * @param player The player index, or NONE.
+     */
+    void place(int target, int player);
+
+    /**
+     * @brief Resolves a match whose players are both known without playing it, if possible.
+     * @param match The match index.
+     * @return True if the match was resolved.
+     */
+    bool resolveWithoutPlay(int match);
+
+    /**
+     * @brief Decides a match and moves its players on.
+     * @param match The match index.
+     * @param winnerSlot The slot of the winner.
+     */
+    void decide(int match, int winnerSlot);
+
+    /**
+     * @brief Returns the standard seed order of a bracket.
+     * @param size The number of first-round slots, a power of two.
+     * @return The seed placed in every slot, so seeds 0 and 1 can only meet in the final.
+     */
+    static QVector<int> seedOrder(int size);
+
+    /**
+     * @brief Progress of a player.
+     */
+    enum class PlayerState : quint8 {
+        Active,     ///< The player has matches left.
+        Eliminated, ///< The player lost too often.
+        Withdrawn   ///< The player left the event.
+    };
+
+    const Format bracketFormat;          ///< Single or double elimination.
+    const int winsNeeded;                ///< Game wins that decide a match.
+    QVector<Match> matches;              ///< All matches of the event.
+    QVector<PlayerState> players;        ///< Progress of every player.
+    QQueue<int> readyMatches;            ///< Matches waiting to be handed out, oldest first.
+    int winner = NONE;                   ///< The champion once the event is over.
+    bool finished = false;               ///< True once the final match is decided.
+};
+
+/**
+ * @brief Settings of the tournaments run by a dedicated server.
+ */
+struct TournamentConfig {
+    TournamentBracket::Format format = TournamentBracket::Format::SingleElimination; ///< Bracket format.
+    int players = 8; ///< Registered players that start an event.
+    int bestOf = 3;  ///< Maximum number of decided games per match.
+};
+
+#endif // TOURNAMENTBRACKET_H
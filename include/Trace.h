@@ -0,0 +1,111 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QByteArray>
+#include <QString>
+#include <atomic>
+
+/**
+ * @brief Records timed spans of the game and server code for the Chrome trace viewer.
+ *
+ * Spans are opened with TRACE_SCOPE(category, name) and recorded when the
+ * scope ends. Every thread writes into its own ring buffer of BUFFER_EVENTS
+ * spans, so recording takes no lock and a busy thread overwrites only its
+ * own oldest spans. The buffer of a thread is allocated by its first span.
+ *
+ * exportChromeJson() copies the spans of all threads without stopping them
+ * and produces the Chrome trace event format, which chrome://tracing and
+ * the Perfetto UI open directly.
+ *
+ * Tracing is off until setEnabled(true); a disabled scope costs one relaxed
+ * atomic load. Builds without RPS_TRACING compile TRACE_SCOPE to nothing.
+ */
+class Trace {
+public:
+    static constexpr int BUFFER_EVENTS = 16384; ///< Spans kept per thread.
+
+    /**
+     * @brief Starts or stops recording spans.
+     * @param enable True to record spans.
+     */
+    static void setEnabled(bool enable);
+
+    /**
+     * @brief Checks whether spans are recorded.
+     * @return True if tracing is enabled.
+     */
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the time on the trace clock.
+     * @return Microseconds since the first use of the clock.
+     */
+    static qint64 nowUs();
+
+    /**
+     * @brief Records a finished span in the buffer of the calling thread.
+     * @param category The category of the span; must be a string literal.
+     * @param name The name of the span; must be a string literal.
+     * @param startUs The start of the span on the trace clock.
+     * @param durationUs The duration of the span in microseconds.
+     */
+    static void record(const char *category, const char *name, qint64 startUs, qint64 durationUs);
+
+    /**
+     * @brief Exports the recorded spans of all threads.
+     * @return A Chrome trace event JSON document.
+     */
+    static QByteArray exportChromeJson();
+
+    /**
+     * @brief Writes the recorded spans of all threads to a file.
+     * @param fileName The path of the JSON file.
+     * @return False if the file could not be written.
+     */
+    static bool writeChromeJson(const QString &fileName);
+
+private:
+    static std::atomic<bool> enabled; ///< True while spans are recorded.
+};
+
+/**
+ * @brief Records the duration of the enclosing scope as a trace span.
+ *
+ * The start time is taken only if tracing is enabled when the scope opens.
+ */
+class TraceScope {
+public:
+    /**
+     * @brief Opens a span.
+     * @param category The category of the span; must be a string literal.
+     * @param name The name of the span; must be a string literal.
+     */
+    TraceScope(const char *category, const char *name)
+        : category(category), name(name), startUs(Trace::isEnabled() ? Trace::nowUs() : -1) {}
+
+    /**
+     * @brief Records the span if it was opened while tracing was enabled.
+     */
+    ~TraceScope() {
+        if (startUs >= 0) Trace::record(category, name, startUs, Trace::nowUs() - startUs);
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *category; ///< Category of the span.
+    const char *name;     ///< Name of the span.
+    qint64 startUs;       ///< Start of the span; -1 if it is not recorded.
+};
+
+#ifdef RPS_TRACING
+#define RPS_TRACE_CONCAT_(a, b) a##b
+#define RPS_TRACE_CONCAT(a, b) RPS_TRACE_CONCAT_(a, b)
+/// Records the rest of the enclosing scope as a span of a category.
+#define TRACE_SCOPE(category, name) TraceScope RPS_TRACE_CONCAT(traceScope_, __LINE__)(category, name)
+#else
+#define TRACE_SCOPE(category, name) do {} while (false)
+#endif
+
+#endif // TRACE_H
@@ -0,0 +1,80 @@
+#ifndef UDPBATCHIO_H
+#define UDPBATCHIO_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QList>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Batched UDP receive and send on a socket descriptor.
+ *
+ * On Linux, many datagrams are moved per system call with recvmmsg and
+ * sendmmsg, using message headers and receive buffers that are allocated once
+ * and reused as a ring. On other platforms isSupported() returns false and the
+ * callers keep using QUdpSocket's per-datagram calls.
+ *
+ * The descriptor stays owned by its QUdpSocket; this class only performs I/O on it.
+ */
+class UdpBatchIo {
+public:
+    static constexpr int BATCH_SIZE = 64;           ///< Datagrams moved per system call.
+    static constexpr int MAX_DATAGRAM_SIZE = 2048;  ///< Receive buffer size; larger datagrams are dropped.
+
+    /**
+     * @brief Callback invoked for every received datagram.
+     *
+     * The data is only valid during the call.
+     */
+    using DatagramHandler = std::function<void(const char *data, int size, const QHostAddress &sender)>;
+
+    /**
+     * @brief Checks whether batched I/O is available on this platform.
+     * @return True on Linux.
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Preallocates the buffer ring and message headers.
+     */
+    UdpBatchIo();
+
+    /**
+     * @brief Releases the buffer ring.
+     */
+    ~UdpBatchIo();
+
+    UdpBatchIo(const UdpBatchIo &) = delete;
+    UdpBatchIo &operator=(const UdpBatchIo &) = delete;
+
+    /**
+     * @brief Reads every pending datagram from a non-blocking socket.
+     * @param socketDescriptor The descriptor of a bound UDP socket.
+     * @param handler Called once for every datagram.
+     * @return The number of datagrams delivered, or -1 if batched receive failed.
+     */
+    int receiveAll(qintptr socketDescriptor, const DatagramHandler &handler);
+
+    /**
+     * @brief Sends every datagram to every IPv4 address.
+     *
+     * Pairs are sent address by address, each address receiving every datagram
+     * in order, so the returned count identifies the first pair not sent.
+     *
+     * @param socketDescriptor The descriptor of a bound IPv4 UDP socket.
+     * @param datagrams The datagrams to send.
+     * @param addresses The IPv4 destination addresses.
+     * @param port The destination port.
+     * @return The number of (datagram, address) pairs sent; the caller should
+     *         send the rest through QUdpSocket.
+     */
+    int sendToAll(qintptr socketDescriptor, const QList<QByteArray> &datagrams,
+                   const QList<QHostAddress> &addresses, quint16 port);
+
+private:
+    struct Buffers;
+    std::unique_ptr<Buffers> d; ///< Platform-specific message headers and receive buffers.
+};
+
+#endif // UDPBATCHIO_H
@@ -3,14 +3,23 @@
 
 #include <QObject>
 #include <QUdpSocket>
+#include <QVector>
+#include <memory>
 #include "LobbyInfo.h"
+#include "DiscoveryConfig.h"
+#include "LobbyDirectory.h"
+#include "UdpBatchIo.h"
 
 /**
  * @brief A class for listening to UDP broadcast messages within a local network.
  *
  * This class listens for incoming UDP broadcast messages on a specified port,
- * extracts lobby information from the received data, and emits a signal when
- * a new lobby is detected.
+ * extracts lobby information from the received data and keeps it in a
+ * LobbyDirectory. Signals are emitted only when a lobby appears, changes or
+ * expires, not for every repeated announcement.
+ *
+ * Where supported, datagrams are drained with UdpBatchIo so a burst of
+ * announcements costs a few system calls instead of one per datagram.
  */
 class UdpBroadcastListener : public QObject {
     Q_OBJECT
@@ -25,11 +34,21 @@ public:
      */
     explicit UdpBroadcastListener(quint16 listenPort, QObject *parent = nullptr);
 
+    /**
+     * @brief Selects whether broadcast, multicast or both channels are received.
+     *
+     * Takes effect with the next call to startListening().
+     *
+     * @param config The discovery settings.
+     */
+    void setDiscoveryConfig(const DiscoveryConfig &config);
+
     /**
      * @brief Starts listening for UDP broadcast messages.
      *
-     * Binds the UDP socket to the specified port and connects its `readyRead`
-     * signal to process incoming messages.
+     * Binds the UDP socket to the specified port, joins the multicast group on
+     * the configured interfaces if multicast is enabled, and connects its
+     * `readyRead` signal to process incoming messages.
      */
     void startListening();
 
@@ -40,31 +59,58 @@ public:
      */
     void stopListening();
 
+    /**
+     * @brief Returns the lobbies currently announced on the network.
+     * @return The lobby directory fed by this listener.
+     */
+    const LobbyDirectory &lobbyDirectory() const;
+
 signals:
     /**
-     * @brief Emitted when a new lobby is detected.
+     * @brief Emitted when a new lobby is detected or a known lobby changes.
      *
-     * This signal is triggered whenever a valid lobby information packet
-     * is received from a broadcast message.
+     * Repeated announcements of an unchanged lobby do not trigger this signal.
      *
      * @param senderIp The IP address of the sender.
      * @param info The received lobby information.
      */
     void lobbyFound(const QHostAddress &senderIp, const LobbyInfo &info);
 
+    /**
+     * @brief Emitted when a lobby has not been announced within the directory's time-to-live.
+     * @param senderIp The IP address of the host that announced it.
+     * @param info The last known lobby information.
+     */
+    void lobbyLost(const QHostAddress &senderIp, const LobbyInfo &info);
+
 private slots:
     /**
      * @brief Processes incoming UDP broadcast messages.
      *
      * Reads available datagrams, extracts the sender’s IP address,
-     * deserializes the lobby information, and emits the `lobbyFound` signal.
+     * decodes the merged lobby announcements, and emits the `lobbyFound` signal for each.
      */
     void onProcessPendingDatagrams();
 
 private:
+    /**
+     * @brief Decodes one announcement datagram and records its lobbies.
+     * @param data The datagram payload.
+     * @param senderIp The address of the sender.
+     */
+    void handleDatagram(const QByteArray &data, const QHostAddress &senderIp);
+
     QUdpSocket udpSocket; ///< UDP socket used for receiving data.
 
     quint16 port; ///< The port used for listening to UDP messages.
+
+    DiscoveryConfig discovery; ///< Selected discovery channels.
+
+    QVector<LobbyInfo> lobbies; ///< Lobbies decoded from the current datagram; reused between datagrams.
+
+    LobbyDirectory directory; ///< Deduplicated lobbies seen on the network.
+
+    std::unique_ptr<UdpBatchIo> batchIo; ///< Batched receive path; null where unsupported.
 };
 
 #endif // UDPBROADCASTLISTENER_H
@@ -4,14 +4,28 @@
 #include <QObject>
 #include <QUdpSocket>
 #include <QTimer>
-#include <QDataStream>
+#include <QMap>
+#include <memory>
 #include "LobbyInfo.h"
+#include "DiscoveryConfig.h"
+#include "UdpBatchIo.h"
+#include "Metrics.h"
 
 /**
  * @brief A class for broadcasting UDP messages within a local network.
  *
- * This class periodically sends lobby information using a UDP socket
- * to all detected broadcast addresses in the network.
+ * This class sends lobby information using a UDP socket to all detected
+ * broadcast addresses in the network. A single broadcaster can announce
+ * several lobbies of the same host, keyed by their lobby ID; their
+ * announcements are merged into as few datagrams as possible.
+ *
+ * Announcements are change-driven: a change is sent almost immediately
+ * (bursts of changes are coalesced for CHANGE_DELAY_MS), after which the
+ * interval between repeats doubles from MIN_INTERVAL_MS up to MAX_INTERVAL_MS
+ * while nothing changes.
+ *
+ * Where supported, every datagram for every destination of a pass is handed
+ * to the kernel in one UdpBatchIo call; QUdpSocket remains the fallback.
  */
 class UdpBroadcaster : public QObject {
     Q_OBJECT
@@ -28,16 +42,57 @@ public:
      */
     explicit UdpBroadcaster(const quint16 broadcastPort, QObject *parent = nullptr);
 
+    static constexpr int CHANGE_DELAY_MS = 20;    ///< Delay that coalesces a burst of changes into one send.
+    static constexpr int MIN_INTERVAL_MS = 500;   ///< First repeat interval after a change.
+    static constexpr int MAX_INTERVAL_MS = 4000;  ///< Longest repeat interval of a stable lobby set.
+
+    /**
+     * @brief Selects broadcast, multicast or both as the announcement channel.
+     *
+     * Takes effect with the next announcement.
+     *
+     * @param config The discovery settings.
+     */
+    void setDiscoveryConfig(const DiscoveryConfig &config);
+
+    /**
+     * @brief Counts the sent announcement datagrams.
+     * @param newMetrics The metrics, which must outlive the broadcaster; nullptr stops counting.
+     */
+    void setMetrics(Metrics *newMetrics);
+
     /**
-     * @brief Starts periodic broadcasting of lobby information.
+     * @brief Starts broadcasting lobby information.
      *
-     * Serializes the provided lobby information and stores it for repeated transmission.
-     * If the broadcast timer is not already running, it starts sending messages.
+     * Serializes the provided lobby information and stores it for repeated transmission,
+     * then starts sending announcements.
      *
      * @param lobbyInfo The lobby information to be broadcasted.
      */
     void startBroadcast(const LobbyInfo &lobbyInfo);
 
+    /**
+     * @brief Starts broadcasting all stored lobby announcements.
+     *
+     * The first announcement is sent right away.
+     */
+    void startBroadcast();
+
+    /**
+     * @brief Adds or replaces the announcement of a lobby.
+     *
+     * An announcement that actually changed is sent right away and resets the backoff.
+     *
+     * @param lobbyInfo The lobby information, identified by its lobby ID.
+     */
+    void updateLobby(const LobbyInfo &lobbyInfo);
+
+    /**
+     * @brief Stops announcing a lobby.
+     * @param lobbyId The ID of the lobby to remove.
+     */
+    void removeLobby(quint32 lobbyId);
+
     /**
      * @brief Stops broadcasting messages.
      *
@@ -54,7 +109,7 @@ public slots:
 
 private slots:
     /**
-     * @brief Sends the stored UDP broadcast message.
+     * @brief Sends the merged announcement datagrams and schedules the next repeat.
      *
      * Attempts to send the current data to all known broadcast addresses.
      * If any transmission fails, the list of addresses is updated.
@@ -70,15 +125,56 @@ private:
      */
     void updateAddresses();
 
+    /**
+     * @brief Schedules a prompt announcement after a change and resets the backoff.
+     */
+    void scheduleChange();
+
+    /**
+     * @brief Sends the announcement datagrams to the multicast group.
+     *
+     * Sends once per configured interface, or once on the default interface.
+     *
+     * @return False if a datagram could not be sent.
+     */
+    bool sendMulticast();
+
+    /**
+     * @brief Sends every announcement datagram to every address.
+     *
+     * Uses one batched call where supported, otherwise one QUdpSocket write per datagram.
+     *
+     * @param addresses The destination addresses.
+     * @return False if a datagram could not be sent.
+     */
+    bool sendDatagrams(const QList<QHostAddress> &addresses);
+
+    /**
+     * @brief Binds the socket to IPv4 and applies the multicast TTL if it is not bound yet.
+     * @return False if the socket could not be bound.
+     */
+    bool ensureBound();
+
     QList<QHostAddress> broadcastAddresses; ///< List of currently available broadcast addresses.
 
     QUdpSocket udpSocket; ///< UDP socket used for sending data.
 
-    QTimer broadcastTimer; ///< Timer for scheduling periodic broadcasts.
+    std::unique_ptr<UdpBatchIo> batchIo; ///< Batched send path; null where unsupported.
+
+    QTimer broadcastTimer; ///< Single-shot timer scheduling the next announcement.
 
     const quint16 port; ///< The port used for broadcasting messages.
 
-    QByteArray currentData; ///< The latest lobby information to be sent in broadcasts.
+    QMap<quint32, QByteArray> announcements; ///< Serialized lobby information to be sent in broadcasts, keyed by lobby ID.
+    QList<QByteArray> datagrams;             ///< Merged announcement datagrams, rebuilt after a change.
+    QByteArray scratch;                      ///< Reused serialization buffer for change detection.
+    bool changed = true;                     ///< True if the datagrams must be rebuilt before the next send.
+    bool active = false;                     ///< True between startBroadcast() and stopBroadcast().
+    int interval = MIN_INTERVAL_MS;          ///< Delay before the next repeat of an unchanged lobby set.
+
+    DiscoveryConfig discovery;                     ///< Selected announcement channels.
+    QList<QNetworkInterface> multicastInterfaces;  ///< Resolved multicast interfaces; empty uses the default one.
+    Metrics *metrics = nullptr;                    ///< Datagram counter; not owned.
 };
 
 #endif // UDPBROADCASTER_H
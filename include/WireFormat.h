@@ -0,0 +1,229 @@
+#ifndef WIREFORMAT_H
+#define WIREFORMAT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QHostAddress>
+#include <QtEndian>
+#include <cstring>
+
+/**
+ * @brief Allocation-free primitives for the binary layout of INetworkSerializable types.
+ *
+ * Integers are big-endian and strings use the QDataStream layout (a 32-bit byte
+ * length followed by UTF-16BE code units, 0xFFFFFFFF for a null string), so the
+ * bytes match what QDataStream used to produce for the same fields.
+ */
+namespace WireFormat {
+
+constexpr quint32 NULL_STRING = 0xFFFFFFFF; ///< Length marker of a null QString.
+
+/**
+ * @brief Returns the encoded size of a string.
+ * @param value The string.
+ * @return The number of bytes written by Writer::writeString.
+ */
+inline int stringSize(const QString &value) {
+    return 4 + (value.isNull() ? 0 : static_cast<int>(value.size()) * 2);
+}
+
+/**
+ * @brief Returns the encoded size of an IP address.
+ * @param address The address.
+ * @return The number of bytes written by Writer::writeAddress.
+ */
+inline int addressSize(const QHostAddress &address) {
+    switch (address.protocol()) {
+    case QAbstractSocket::IPv4Protocol: return 1 + 4;
+    case QAbstractSocket::IPv6Protocol: return 1 + 16;
+    default: return 1;
+    }
+}
+
+/**
+ * @brief Writes fields into a region appended to a caller-owned buffer.
+ *
+ * The region is reserved up front from the known serialized size, so writing
+ * never reallocates; a buffer reused across calls keeps its capacity.
+ */
+class Writer {
+public:
+    /**
+     * @brief Appends a region of the given size to the buffer.
+     * @param buffer The buffer to write into.
+     * @param size The number of bytes that will be written.
+     */
+    Writer(QByteArray &buffer, int size) {
+        const int offset = static_cast<int>(buffer.size());
+        buffer.resize(offset + size);
+        pos = buffer.data() + offset;
+    }
+
+    /** @brief Writes an unsigned 8-bit integer. */
+    void writeU8(quint8 value) { *pos++ = static_cast<char>(value); }
+
+    /** @brief Writes a boolean as one byte. */
+    void writeBool(bool value) { writeU8(value ? 1 : 0); }
+
+    /** @brief Writes an unsigned 16-bit integer. */
+    void writeU16(quint16 value) { qToBigEndian<quint16>(value, pos); pos += 2; }
+
+    /** @brief Writes an unsigned 32-bit integer. */
+    void writeU32(quint32 value) { qToBigEndian<quint32>(value, pos); pos += 4; }
+
+    /** @brief Writes a signed 32-bit integer. */
+    void writeI32(qint32 value) { writeU32(static_cast<quint32>(value)); }
+
+    /**
+     * @brief Writes a string in the QDataStream layout.
+     * @param value The string.
+     */
+    void writeString(const QString &value) {
+        if (value.isNull()) {
+            writeU32(NULL_STRING);
+            return;
+        }
+
+        writeU32(static_cast<quint32>(value.size()) * 2);
+        const QChar *chars = value.constData();
+        for (int i = 0; i < value.size(); ++i) {
+            writeU16(chars[i].unicode());
+        }
+    }
+
+    /**
+     * @brief Writes an IP address as a family byte (0, 4 or 6) followed by its raw bytes.
+     * @param address The address.
+     */
+    void writeAddress(const QHostAddress &address) {
+        switch (address.protocol()) {
+        case QAbstractSocket::IPv4Protocol:
+            writeU8(4);
+            writeU32(address.toIPv4Address());
+            break;
+        case QAbstractSocket::IPv6Protocol: {
+            writeU8(6);
+            const Q_IPV6ADDR ipv6 = address.toIPv6Address();
+            std::memcpy(pos, ipv6.c, 16);
+            pos += 16;
+            break;
+        }
+        default:
+            writeU8(0);
+            break;
+        }
+    }
+
+private:
+    char *pos; ///< Next byte to write.
+};
+
+/**
+ * @brief Reads fields from a borrowed byte range without copying it.
+ *
+ * Every read is bounds-checked; after an overrun all further reads return
+ * zero values and ok() reports false.
+ */
+class Reader {
+public:
+    /**
+     * @brief Constructs a reader over a byte range.
+     * @param data The first byte.
+     * @param size The number of readable bytes.
+     */
+    Reader(const char *data, qsizetype size) : pos(data), end(data + size) {}
+
+    /**
+     * @brief Indicates whether every read so far stayed within the range.
+     * @return True if no read overran the data.
+     */
+    bool ok() const { return valid; }
+
+    /** @brief Reads an unsigned 8-bit integer. */
+    quint8 readU8() {
+        if (!take(1)) return 0;
+        return static_cast<quint8>(pos[-1]);
+    }
+
+    /** @brief Reads a boolean stored as one byte. */
+    bool readBool() { return readU8() != 0; }
+
+    /** @brief Reads an unsigned 16-bit integer. */
+    quint16 readU16() {
+        if (!take(2)) return 0;
+        return qFromBigEndian<quint16>(pos - 2);
+    }
+
+    /** @brief Reads an unsigned 32-bit integer. */
+    quint32 readU32() {
+        if (!take(4)) return 0;
+        return qFromBigEndian<quint32>(pos - 4);
+    }
+
+    /** @brief Reads a signed 32-bit integer. */
+    qint32 readI32() { return static_cast<qint32>(readU32()); }
+
+    /**
+     * @brief Reads a string stored in the QDataStream layout.
+     * @return The string; null if it was written as null or the data is truncated.
+     */
+    QString readString() {
+        const quint32 bytes = readU32();
+        if (!valid || bytes == NULL_STRING) return QString();
+        if ((bytes & 1) != 0 || !take(bytes)) {
+            valid = false;
+            return QString();
+        }
+
+        const int length = static_cast<int>(bytes / 2);
+        QString value(length, Qt::Uninitialized);
+        QChar *chars = value.data();
+        const char *source = pos - bytes;
+        for (int i = 0; i < length; ++i) {
+            chars[i] = QChar(qFromBigEndian<quint16>(source + i * 2));
+        }
+        return value;
+    }
+
+    /**
+     * @brief Reads an IP address written by Writer::writeAddress.
+     * @return The address; null for family 0 or malformed data.
+     */
+    QHostAddress readAddress() {
+        switch (readU8()) {
+        case 4:
+            return QHostAddress(readU32());
+        case 6: {
+            if (!take(16)) return QHostAddress();
+            Q_IPV6ADDR ipv6;
+            std::memcpy(ipv6.c, pos - 16, 16);
+            return QHostAddress(ipv6);
+        }
+        default:
+            return QHostAddress();
+        }
+    }
+
+private:
+    /**
+     * @brief Consumes bytes if enough remain.
+     * @param count The number of bytes to consume.
+     * @return False if the range is exhausted.
+     */
+    bool take(quint64 count) {
+        if (!valid || count > static_cast<quint64>(end - pos)) {
+            valid = false;
+            return false;
+        }
+        pos += count;
+        return true;
+    }
+
+    const char *pos;    ///< Next byte to read.
+    const char *end;    ///< One past the last readable byte.
+    bool valid = true;  ///< False after an overrun.
+};
+
+} // namespace WireFormat
+
+#endif // WIREFORMAT_H
@@ -1,23 +1,238 @@
 #include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QThread>
+#include <QDebug>
+#include <QFile>
+#include <QTimer>
+#include <csignal>
 #include "GameController.h"
 #include "ConsoleMainMenu.h"
 #include "ConsoleGameAction.h"
+#include "DedicatedServer.h"
+#include "MetricsServer.h"
+#include "Trace.h"
+
+namespace {
+
+volatile std::sig_atomic_t quitRequested = 0; ///< Set by the signal handler, polled by the event loop.
+
+/**
+ * @brief Records a termination request; only async-signal-safe work is done here.
+ * @param signal The received signal.
+ */
+void onQuitSignal(int signal) {
+    Q_UNUSED(signal);
+    quitRequested = 1;
+}
+
+/**
+ * @brief Quits the event loop on SIGINT or SIGTERM instead of killing the process.
+ *
+ * Returning from main() runs the destructors that write the trace, the
+ * ratings snapshot and the buffered match log.
+ *
+ * @param application The application.
+ */
+void quitOnTerminationSignals(QCoreApplication &application) {
+    std::signal(SIGINT, onQuitSignal);
+    std::signal(SIGTERM, onQuitSignal);
+
+    auto *poll = new QTimer(&application);
+    QObject::connect(poll, &QTimer::timeout, &application, [] {
+        if (quitRequested) QCoreApplication::quit();
+    });
+    poll->start(200);
+}
+
+} // namespace
 
 /**
  * @brief Entry point of the application.
  *
  * This initializes the Qt core application and sets up the game menus and controller.
+ * With `--dedicated`, the process instead runs a headless server hosting many lobbies.
  */
 int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
 
+    // Parse the command line options of the dedicated server mode.
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption dedicatedOption("dedicated", "Run a headless server hosting many lobbies.");
+    QCommandLineOption lobbiesOption("lobbies", "Number of lobbies hosted by the dedicated server.", "count", "100");
+    QCommandLineOption playersOption("players", "Number of players in each lobby.", "count", "2");
+    QCommandLineOption workersOption("workers", "Number of socket worker threads.", "count",
+                                     QString::number(QThread::idealThreadCount()));
+    QCommandLineOption discoveryOption("discovery", "Lobby discovery channel: broadcast, multicast or both.",
+                                       "mode", "broadcast");
+    QCommandLineOption groupOption("multicast-group", "Multicast group of the lobby announcements.", "address",
+                                   DiscoveryConfig::DEFAULT_GROUP);
+    QCommandLineOption ttlOption("multicast-ttl", "Hop limit of multicast announcements.", "hops", "1");
+    QCommandLineOption interfacesOption("interfaces", "Comma-separated interfaces used for multicast.", "names");
+    QCommandLineOption heartbeatOption("heartbeat", "Interval between connection heartbeats; 0 disables them.",
+                                       "ms", QString::number(ConnectionTimeouts().heartbeatIntervalMs));
+    QCommandLineOption idleOption("idle-timeout", "Silence after which a player is disconnected; 0 disables it.",
+                                  "ms", QString::number(ConnectionTimeouts().idleTimeoutMs));
+    QCommandLineOption moveOption("move-timeout", "Time a player has to make a move; 0 waits forever.",
+                                  "ms", QString::number(ConnectionTimeouts().moveTimeoutMs));
+    QCommandLineOption sendQueueBytesOption("send-queue-bytes", "Bytes queued for a slow player before the slow-consumer policy applies.",
+                                            "bytes", QString::number(SendQueueLimits().maxBytes));
+    QCommandLineOption sendQueueFramesOption("send-queue-frames", "Messages queued for a slow player before the slow-consumer policy applies.",
+                                             "count", QString::number(SendQueueLimits().maxFrames));
+    QCommandLineOption slowConsumerOption("slow-consumer", "Treatment of players who read too slowly: drop, coalesce or disconnect.",
+                                          "policy", "disconnect");
+    QCommandLineOption matchLogOption("match-log", "Append every resolved round to a match history log.", "file");
+    QCommandLineOption ratingsOption("ratings", "Rate players and keep the ratings in a snapshot file.", "file");
+    QCommandLineOption matchmakingOption("matchmaking", "Place players by rating and latency instead of letting them pick a lobby.");
+    QCommandLineOption maxWaitOption("max-queue-wait", "Queue wait after which any opponents are accepted.",
+                                     "ms", QString::number(MatchmakingConfig().maxWaitMs));
+    QCommandLineOption tournamentOption("tournament", "Run tournaments: single or double elimination.", "format");
+    QCommandLineOption entrantsOption("entrants", "Number of players that start a tournament.", "count",
+                                      QString::number(TournamentConfig().players));
+    QCommandLineOption bestOfOption("best-of", "Maximum number of decided games per tournament match.", "games",
+                                    QString::number(TournamentConfig().bestOf));
+    QCommandLineOption metricsPortOption("metrics-port", "Serve Prometheus metrics on this local port.", "port");
+    QCommandLineOption traceOption("trace", "Record trace spans and write them as Chrome trace JSON on exit.", "file");
+    parser.addOptions({matchLogOption, ratingsOption, metricsPortOption, traceOption, dedicatedOption, lobbiesOption, playersOption, workersOption,
+                       discoveryOption, groupOption, ttlOption, interfacesOption,
+                       heartbeatOption, idleOption, moveOption, sendQueueBytesOption, sendQueueFramesOption,
+                       slowConsumerOption, matchmakingOption, maxWaitOption,
+                       tournamentOption, entrantsOption, bestOfOption});
+    parser.process(a);
+
+    // Parse the lobby discovery settings shared by both modes.
+    DiscoveryConfig discovery;
+    bool modeOk = false;
+    discovery.mode = DiscoveryConfig::parseMode(parser.value(discoveryOption), &modeOk);
+    discovery.multicastGroup = QHostAddress(parser.value(groupOption));
+    discovery.multicastTtl = qBound(1, parser.value(ttlOption).toInt(), 255);
+    if (parser.isSet(interfacesOption)) {
+        discovery.interfaceNames = parser.value(interfacesOption).split(',', Qt::SkipEmptyParts);
+    }
+    if (!modeOk || (discovery.usesMulticast() && !discovery.multicastGroup.isMulticast())) {
+        qCritical() << "Invalid discovery settings";
+        return 1;
+    }
+
+    // Open the match history log shared by both modes.
+    MatchLog matchLog;
+    if (parser.isSet(matchLogOption) && !matchLog.open(parser.value(matchLogOption))) {
+        qCritical() << "Cannot open the match log";
+        return 1;
+    }
+
+    // Load the player ratings; they are saved every minute and by the RatingService destructor when
+    // main() returns, which the Exit option and SIGINT/SIGTERM on a dedicated server lead to.
+    RatingService ratings;
+    if (parser.isSet(ratingsOption)) {
+        const QString ratingsFile = parser.value(ratingsOption);
+        if (QFile::exists(ratingsFile) && !ratings.loadSnapshot(ratingsFile)) {
+            qCritical() << "Cannot read the ratings snapshot";
+            return 1;
+        }
+        ratings.setSnapshotFile(ratingsFile);
+        qDebug() << "Loaded ratings of" << ratings.playerCount() << "players";
+    }
+
+    // Serve the metrics of both modes when a port is given.
+    Metrics metrics;
+    std::unique_ptr<MetricsServer> metricsServer;
+    if (parser.isSet(metricsPortOption)) {
+        const quint16 metricsPort = static_cast<quint16>(parser.value(metricsPortOption).toUInt());
+        metricsServer = std::make_unique<MetricsServer>(&metrics, metricsPort);
+        if (!metricsServer->start()) {
+            qCritical() << "Cannot start the metrics server";
+            return 1;
+        }
+    }
+
+    // Record trace spans; they can also be fetched from the metrics endpoint at /trace.
+    if (parser.isSet(traceOption)) {
+#ifndef RPS_TRACING
+        qWarning() << "Built without RPS_TRACING; the trace will be empty";
+#endif
+        const QString traceFile = parser.value(traceOption);
+        Trace::setEnabled(true);
+        QObject::connect(&a, &QCoreApplication::aboutToQuit, [traceFile] {
+            if (!Trace::writeChromeJson(traceFile)) qWarning() << "Cannot write the trace";
+        });
+    }
+
+    if (parser.isSet(dedicatedOption)) {
+        quitOnTerminationSignals(a);
+
+        // Tournament matches are played one on one, and every first-round match gets its own lobby.
+        TournamentConfig tournament;
+        int lobbyCount = qMax(1, parser.value(lobbiesOption).toInt());
+        int playerCount = qMax(1, parser.value(playersOption).toInt());
+        if (parser.isSet(tournamentOption)) {
+            const QString format = parser.value(tournamentOption);
+            if (format != "single" && format != "double") {
+                qCritical() << "Invalid tournament format";
+                return 1;
+            }
+            tournament.format = format == "double" ? TournamentBracket::Format::DoubleElimination
+                                                   : TournamentBracket::Format::SingleElimination;
+            tournament.players = qMax(2, parser.value(entrantsOption).toInt());
+            tournament.bestOf = qMax(1, parser.value(bestOfOption).toInt());
+            playerCount = 2;
+            lobbyCount = qMax(lobbyCount, tournament.players / 2);
+        }
+
+        DedicatedServer server("Lobby", lobbyCount, playerCount,
+                               LobbyClient::SERVER_PORT, LobbyClient::BROADCAST_PORT,
+                               qMax(0, parser.value(workersOption).toInt()),
+                               discovery);
+
+        ConnectionTimeouts timeouts;
+        timeouts.heartbeatIntervalMs = qMax(0, parser.value(heartbeatOption).toInt());
+        timeouts.idleTimeoutMs = qMax(0, parser.value(idleOption).toInt());
+        timeouts.moveTimeoutMs = qMax(0, parser.value(moveOption).toInt());
+        server.setTimeouts(timeouts);
+
+        SendQueueLimits sendLimits;
+        bool policyOk = false;
+        sendLimits.maxBytes = qMax<qint64>(0, parser.value(sendQueueBytesOption).toLongLong());
+        sendLimits.maxFrames = qMax(0, parser.value(sendQueueFramesOption).toInt());
+        sendLimits.policy = SendQueueLimits::parsePolicy(parser.value(slowConsumerOption), &policyOk);
+        if (!policyOk) {
+            qCritical() << "Invalid slow-consumer policy";
+            return 1;
+        }
+        server.setSendQueueLimits(sendLimits);
+        if (matchLog.isOpen()) server.setMatchLog(&matchLog);
+        if (parser.isSet(ratingsOption)) server.setRatingService(&ratings);
+        if (metricsServer) {
+            server.setMetrics(&metrics);
+            QObject::connect(metricsServer.get(), &MetricsServer::scrapeRequested,
+                             &server, &DedicatedServer::onMetricsScrape);
+        }
+        if (parser.isSet(tournamentOption)) {
+            server.setTournament(tournament);
+        } else if (parser.isSet(matchmakingOption)) {
+            MatchmakingConfig matchmaking;
+            matchmaking.maxWaitMs = qMax(0, parser.value(maxWaitOption).toInt());
+            server.setMatchmaking(matchmaking);
+        }
+
+        if (!server.start()) {
+            qCritical() << "Server not started";
+            return 1;
+        }
+        return a.exec();
+    }
+
     // Create instances of the main menu and game action menu.
     ConsoleMainMenu mainMenu;
     ConsoleGameAction gameActionMenu;
 
     // Initialize the game controller with the menus.
     GameController gameController(&mainMenu, &gameActionMenu);
+    gameController.setDiscoveryConfig(discovery);
+    if (matchLog.isOpen()) gameController.setMatchLog(&matchLog);
+    if (parser.isSet(ratingsOption)) gameController.setRatingService(&ratings);
+    if (metricsServer) gameController.setMetrics(&metrics);
 
     // Start the main menu.
     gameController.invokeMainMenu();
@@ -25,4 +240,3 @@ int main(int argc, char *argv[])
     // Execute the Qt event loop.
     return a.exec();
 }
-
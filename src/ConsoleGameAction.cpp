@@ -1,55 +1,35 @@
 #include "ConsoleGameAction.h"
+#include "ConsoleInput.h"
 
 /**
  * @brief Constructs the ConsoleGameAction.
- *        Initializes input and output streams.
+ *        Initializes the output stream and listens to the console input.
  * @param parent Parent QObject.
  */
 ConsoleGameAction::ConsoleGameAction(QObject *parent)
-    : IGameActionMenu(parent), in(stdin), out(stdout) {}
+    : IGameActionMenu(parent), out(stdout) {
+    connect(ConsoleInput::instance(), &ConsoleInput::lineRead, this, &ConsoleGameAction::onLineRead);
+}
 
 /**
- * @brief Displays the console menu and handles user selection.
- *        Triggers the corresponding signal based on the player's choice.
+ * @brief Displays the console menu.
+ *        The player's choice arrives through onLineRead().
  */
 void ConsoleGameAction::showMenu() {
-    while (true) {
-        // Display available options
-        out << "\n=== Choose your move ===\n"
-            << "1. Rock\n"
-            << "2. Paper\n"
-            << "3. Scissors\n"
-            << "Choice Option: ";
-        out.flush();
-
-        int choice;
-        in >> choice; // Read user input
-
-        if (choice >= 1 && choice <= 3) {
-            // Convert numerical choice into move name
-            QString moveName;
-            switch (choice) {
-            case 1: moveName = "Rock"; break;
-            case 2: moveName = "Paper"; break;
-            case 3: moveName = "Scissors"; break;
-            }
-
-            // Display the player's choice
-            out << "You chose: " << moveName << "\n";
-            out.flush();
-
-            emit playerMadeChoice(choice); // Emit signal with player's choice
-            return;
-        } else {
-            out << "Invalid choice. Please enter 1, 2, or 3.\n";
-            out.flush();
-        }
-    }
+    // Display available options
+    out << "\n=== Choose your move ===\n"
+        << "1. Rock\n"
+        << "2. Paper\n"
+        << "3. Scissors\n"
+        << "4. Chat\n"
+        << "Choice Option: ";
+    out.flush();
+    state = State::ChoosingMove;
 }
 
 /**
  * @brief Displays the game result message.
- *        Waits for player input before closing the game.
+ *        The game closes once the player presses Enter.
  * @param result The result message (e.g., "You won!", "You lost.", "It's a draw.").
  */
 void ConsoleGameAction::showResult(QString result) {
@@ -57,10 +37,80 @@ void ConsoleGameAction::showResult(QString result) {
     out << result << "\n";
     out << "Thank you for playing!\nPress Enter to exit...\n";
     out.flush();
+    state = State::WaitingForExit;
+}
 
-    // Pause execution until the user presses Enter
-    in.readLine(); // Clears any remaining input
-    in.readLine(); // Waits for the Enter key press
+/**
+ * @brief Displays the result of a game that is followed by another one.
+ * @param result The result message, including the match score.
+ */
+void ConsoleGameAction::showRoundResult(QString result) {
+    out << result << "\n";
+    out << "Waiting for the next game...\n";
+    out.flush();
+    state = State::Hidden;
+}
 
-    emit closeGame(); // Emit signal to close the game
+/**
+ * @brief Prints a chat message of the lobby.
+ *        The prompt of the open menu is repeated below the message.
+ * @param sender The name of the sender.
+ * @param text The message text.
+ */
+void ConsoleGameAction::showChat(QString sender, QString text) {
+    out << "\n[" << sender << "] " << text << "\n";
+    if (state == State::ChoosingMove) out << "Choice Option: ";
+    else if (state == State::WritingChat) out << "Message: ";
+    out.flush();
+}
+
+/**
+ * @brief Handles a line typed while the menu or the result is shown.
+ *        Triggers the corresponding signal based on the player's choice.
+ * @param line The typed line.
+ */
+void ConsoleGameAction::onLineRead(const QString &line) {
+    switch (state) {
+    case State::Hidden:
+        return;
+    case State::WritingChat:
+        emit playerSentChat(line);
+        showMenu();
+        return;
+    case State::WaitingForExit:
+        state = State::Hidden;
+        emit closeGame(); // Emit signal to close the game
+        return;
+    case State::ChoosingMove:
+        break;
+    }
+
+    const int choice = line.trimmed().toInt();
+    if (choice == 4) {
+        out << "Message: ";
+        out.flush();
+        state = State::WritingChat;
+        return;
+    }
+
+    if (choice >= 1 && choice <= 3) {
+        // Convert numerical choice into move name
+        QString moveName;
+        switch (choice) {
+        case 1: moveName = "Rock"; break;
+        case 2: moveName = "Paper"; break;
+        case 3: moveName = "Scissors"; break;
+        }
+
+        // Display the player's choice
+        out << "You chose: " << moveName << "\n";
+        out.flush();
+
+        state = State::Hidden;
+        emit playerMadeChoice(choice); // Emit signal with player's choice
+    } else {
+        out << "Invalid choice. Please enter 1, 2, 3, or 4.\n";
+        out.flush();
+        showMenu();
+    }
 }
@@ -0,0 +1,30 @@
+#include "ConsoleInput.h"
+#include <QTextStream>
+#include <QThread>
+
+/**
+ * @brief Returns the shared instance, starting the reader thread on first use.
+ * @return The instance.
+ */
+ConsoleInput *ConsoleInput::instance() {
+    static ConsoleInput *input = new ConsoleInput(); // Outlives the reader thread, see the class comment
+    return input;
+}
+
+/**
+ * @brief Constructs the instance and starts the reader thread.
+ *
+ * The signal is emitted from the reader thread; receivers in the main
+ * thread get the lines through queued connections.
+ */
+ConsoleInput::ConsoleInput() {
+    QThread *reader = QThread::create([this] {
+        QTextStream in(stdin);
+        QString line;
+        while (in.readLineInto(&line)) {
+            emit lineRead(line);
+        }
+    });
+    reader->setObjectName("ConsoleInput");
+    reader->start();
+}
@@ -1,16 +1,19 @@
 #include "ConsoleMainMenu.h"
+#include "ConsoleInput.h"
 
 /**
  * @brief Constructs the console main menu.
- *        Initializes input and output streams.
+ *        Initializes the output stream and listens to the console input.
  * @param parent Parent QObject.
  */
 ConsoleMainMenu::ConsoleMainMenu(QObject *parent)
-    : IMainMenu(parent), in(stdin), out(stdout) {}
+    : IMainMenu(parent), out(stdout) {
+    connect(ConsoleInput::instance(), &ConsoleInput::lineRead, this, &ConsoleMainMenu::onLineRead);
+}
 
 /**
- * @brief Displays the console menu and handles user selection.
- *        Triggers corresponding signals based on the user's choice.
+ * @brief Displays the console menu.
+ *        The user's selection arrives through onLineRead().
  */
 void ConsoleMainMenu::showMenu() {
     // Display menu options
@@ -20,18 +23,28 @@ void ConsoleMainMenu::showMenu() {
         << "3. Exit Game\n"
         << "Choice Option: ";
     out.flush();
+    shown = true;
+}
 
-    int choice;
-    in >> choice; // Read user input
+/**
+ * @brief Handles a line typed while the menu is shown.
+ *        Triggers corresponding signals based on the user's choice.
+ * @param line The typed line.
+ */
+void ConsoleMainMenu::onLineRead(const QString &line) {
+    if (!shown) return;
 
-    switch (choice) {
+    switch (line.trimmed().toInt()) {
     case 1:
+        shown = false;
         emit connectToFirstFindedServer(); // Signal to connect to the first available server
         return;
     case 2:
+        shown = false;
         emit hostOwnLocalTcpServer(); // Signal to host a game
         return;
     case 3:
+        shown = false;
         emit closeGame(); // Signal to close the game
         return;
     default:
@@ -39,6 +52,6 @@ void ConsoleMainMenu::showMenu() {
         out << "Incorrect input\n"
             << "Try Again\n";
         out.flush();
+        showMenu();
     }
 }
-
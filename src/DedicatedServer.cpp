@@ -0,0 +1,874 @@
+#include "DedicatedServer.h"
+#include "GameRules.h"
+#include "RoundResolver.h"
+#include "Protocol.h"
+#include "Trace.h"
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+
+/**
+ * @brief Constructs a dedicated server hosting a fixed number of lobbies.
+ * @param lobbyNamePrefix The prefix of the announced lobby names.
+ * @param lobbyCount The number of lobbies hosted by the server.
+ * @param maxPlayers The number of players in a full lobby.
+ * @param serverPort The TCP port shared by all lobbies.
+ * @param broadcastPort The UDP port for lobby broadcasting.
+ * @param workerThreads The number of socket worker threads of the TCP server.
+ * @param discovery The channels used to announce the lobbies.
+ * @param parent The parent QObject.
+ */
+DedicatedServer::DedicatedServer(const QString &lobbyNamePrefix, int lobbyCount, int maxPlayers,
+                                 quint16 serverPort, quint16 broadcastPort, int workerThreads,
+                                 const DiscoveryConfig &discovery, QObject *parent)
+    : QObject(parent),
+      server(std::make_unique<LanTcpServer>(serverPort, workerThreads, this)),
+      broadcaster(std::make_unique<UdpBroadcaster>(broadcastPort, this)),
+      pingResponder(std::make_unique<PingResponder>(serverPort, this)),
+      spectators(std::make_unique<SpectatorHub>(server.get(), this)),
+      namePrefix(lobbyNamePrefix), tcpPort(serverPort), lobbies(lobbyCount, maxPlayers) {
+
+    broadcaster->setDiscoveryConfig(discovery);
+
+    connect(server.get(), &LanTcpServer::playerConnected, this, &DedicatedServer::onPlayerConnected);
+    connect(server.get(), &LanTcpServer::playerDisconnected, this, &DedicatedServer::onPlayerDisconnected);
+    connect(server.get(), &LanTcpServer::messageReceived, this, &DedicatedServer::onMessageReceived);
+    connect(&matchTimer, &QTimer::timeout, this, &DedicatedServer::onMatchTick);
+    clock.start();
+    fillStartUs.fill(-1, lobbyCount);
+    roundStartUs.fill(-1, lobbyCount);
+}
+
+/**
+ * @brief Starts accepting players and announcing the open lobbies.
+ * @return True if the TCP server started successfully, otherwise false.
+ */
+bool DedicatedServer::start() {
+    if (!server->startListening()) return false;
+    pingResponder->start(); // Optional for clients, so a busy UDP port is not fatal
+
+    if (tournamentMode) {
+        freeLobbies.clear();
+        for (int lobby = lobbies.lobbyCount() - 1; lobby >= 0; --lobby) {
+            freeLobbies.append(lobby);
+        }
+        matchOfLobby.fill(-1, lobbies.lobbyCount());
+        announceTournament();
+    } else if (queue) {
+        // One entry leads every player to the queue; lobby 0 means any lobby
+        broadcaster->updateLobby(LobbyInfo(namePrefix, lobbies.seatsPerLobby(), 0, tcpPort, 0));
+
+        freeLobbies.clear();
+        for (int lobby = lobbies.lobbyCount() - 1; lobby >= 0; --lobby) {
+            freeLobbies.append(lobby);
+        }
+        lastStatsMs = clock.elapsed();
+        matchTimer.start(MATCH_TICK_MS);
+    } else {
+        for (int lobby = 0; lobby < lobbies.lobbyCount(); ++lobby) {
+            announceLobby(lobby);
+        }
+    }
+    broadcaster->startBroadcast();
+
+    qDebug() << "Dedicated server hosting" << lobbies.lobbyCount() << "lobbies on port" << tcpPort;
+    return true;
+}
+
+/**
+ * @brief Stops the broadcast and disconnects every player.
+ */
+void DedicatedServer::stop() {
+    broadcaster->stopBroadcast();
+    server->stopListening();
+    pingResponder->stop();
+    spectators->clear();
+    matchTimer.stop();
+
+    if (queue) {
+        queue = std::make_unique<MatchmakingQueue>(lobbies.seatsPerLobby(), matchConfig);
+        queuedKeys.clear();
+    }
+
+    bracket.reset();
+    entrantSessions.clear();
+    entrantKeys.clear();
+    entrantOfSession.clear();
+    waitingSessions.clear();
+    waitingKeys.clear();
+    matchOfLobby.fill(-1);
+
+    for (int lobby = 0; lobby < lobbies.lobbyCount(); ++lobby) {
+        lobbies.clearLobby(lobby);
+    }
+    seatOfSession.clear();
+    identityOfSession.clear();
+}
+
+/**
+ * @brief Sets the heartbeat, idle and move timeouts of the player connections.
+ * @param timeouts The connection timeouts.
+ */
+void DedicatedServer::setTimeouts(const ConnectionTimeouts &timeouts) {
+    server->setTimeouts(timeouts);
+}
+
+/**
+ * @brief Sets the limits of the per-connection send queues.
+ * @param limits The send queue limits.
+ */
+void DedicatedServer::setSendQueueLimits(const SendQueueLimits &limits) {
+    server->setSendQueueLimits(limits);
+}
+
+/**
+ * @brief Returns the depth and loss counters of the send queues of all connections.
+ * @return The counters.
+ */
+SendQueue::Stats DedicatedServer::sendQueueStats() const {
+    return server->sendQueueStats();
+}
+
+/**
+ * @brief Records traffic, round timing and lobby metrics.
+ * @param newMetrics The metrics; nullptr stops recording.
+ */
+void DedicatedServer::setMetrics(Metrics *newMetrics) {
+    metrics = newMetrics;
+    server->setMetrics(metrics);
+    broadcaster->setMetrics(metrics);
+}
+
+/**
+ * @brief Samples the seated players, spectators, matchmaking queue and send queues into the metrics gauges.
+ */
+void DedicatedServer::onMetricsScrape() {
+    if (!metrics) return;
+
+    const SendQueue::Stats sendStats = server->sendQueueStats();
+    metrics->set(Metrics::Gauge::SeatedPlayers, seatOfSession.size());
+    metrics->set(Metrics::Gauge::Spectators, spectators->spectatorCount());
+    metrics->set(Metrics::Gauge::MatchmakingQueued, matchmakingStats().depth);
+    metrics->set(Metrics::Gauge::SendQueueBytes, sendStats.queuedBytes);
+    metrics->set(Metrics::Gauge::SendQueueFrames, sendStats.queuedFrames);
+    metrics->set(Metrics::Gauge::SendQueueDroppedFrames, sendStats.droppedFrames);
+    metrics->set(Metrics::Gauge::SlowConsumerDisconnects, sendStats.slowConsumerDisconnects);
+}
+
+/**
+ * @brief Records every resolved round in a match history log.
+ * @param log The log; nullptr stops recording.
+ */
+void DedicatedServer::setMatchLog(MatchLog *log) {
+    matchLog = log;
+}
+
+/**
+ * @brief Updates player ratings after every resolved round.
+ * @param service The rating service; nullptr stops rating.
+ */
+void DedicatedServer::setRatingService(RatingService *service) {
+    ratings = service;
+}
+
+/**
+ * @brief Places joining players with a matchmaking queue.
+ * @param config The matching tolerances.
+ */
+void DedicatedServer::setMatchmaking(const MatchmakingConfig &config) {
+    matchConfig = config;
+    queue = std::make_unique<MatchmakingQueue>(lobbies.seatsPerLobby(), config);
+}
+
+/**
+ * @brief Returns the queue depth and wait time counters of the matchmaking queue.
+ * @return The counters.
+ */
+MatchmakingQueue::Stats DedicatedServer::matchmakingStats() const {
+    return queue ? queue->stats(clock.elapsed()) : MatchmakingQueue::Stats();
+}
+
+/**
+ * @brief Runs tournaments instead of letting players pick a lobby.
+ * @param config The bracket format, field size and match length.
+ */
+void DedicatedServer::setTournament(const TournamentConfig &config) {
+    tournamentConfig = config;
+    tournamentConfig.players = qMax(2, config.players);
+    tournamentMode = true;
+}
+
+/**
+ * @brief Handles a new connection.
+ *
+ * Nothing is allocated until the player sends its join handshake.
+ *
+ * @param player The connected player.
+ */
+void DedicatedServer::onPlayerConnected(const PlayerConnection &player) {
+    qDebug() << player.playerName << "@" << player.ipAddress.toString() << "connected";
+}
+
+/**
+ * @brief Removes a disconnected player from its lobby.
+ *
+ * A running round is resolved as soon as the remaining players have all moved.
+ *
+ * @param player The disconnected player.
+ */
+void DedicatedServer::onPlayerDisconnected(const PlayerConnection &player) {
+    identityOfSession.remove(player.sessionId);
+    if (spectators->removeSpectator(player.sessionId)) return;
+    if (tournamentMode && leaveTournament(player.sessionId)) return;
+
+    if (queue && queue->remove(player.sessionId)) {
+        queuedKeys.remove(player.sessionId);
+        return;
+    }
+
+    const SeatRef seatRef = seatOfSession.take(player.sessionId);
+    if (seatRef.lobby < 0) return;
+
+    const int lobby = seatRef.lobby;
+    removeFromSeat(seatRef);
+
+    if (lobbies.state(lobby) == LobbyTable::State::Playing) {
+        if (lobbies.playerCount(lobby) == 0) {
+            resetLobby(lobby);
+        } else if (lobbies.allChosen(lobby)) {
+            resolveRound(lobby);
+        }
+        return;
+    }
+
+    announceLobby(lobby);
+}
+
+/**
+ * @brief Routes a message to the join handshake or to the sender's lobby.
+ * @param player The sender of the message.
+ * @param msg The message content.
+ */
+void DedicatedServer::onMessageReceived(const PlayerConnection &player, const QByteArray &msg) {
+    TRACE_SCOPE("lobby", "DedicatedServer::onMessageReceived");
+    Protocol::Message message;
+    if (!Protocol::decode(msg, message)) return;
+
+    switch (message.opcode) {
+    case Protocol::Opcode::Identify:
+        if (message.value != 0) identityOfSession.insert(player.sessionId, message.value);
+        break;
+    case Protocol::Opcode::Join:
+        joinLobby(player, message.value);
+        break;
+    case Protocol::Opcode::Choice:
+        playerMove(player, static_cast<int>(message.value));
+        break;
+    case Protocol::Opcode::Pong:
+        playerPong(player, message.value);
+        break;
+    case Protocol::Opcode::Spectate:
+        watchLobby(player, message.value);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Frees the seat of a player and reindexes the player moved into it.
+ * @param seatRef The seat to free.
+ */
+void DedicatedServer::removeFromSeat(const SeatRef &seatRef) {
+    const quint32 movedSession = lobbies.removePlayer(seatRef.lobby, seatRef.seat);
+    if (movedSession != 0) {
+        seatOfSession[movedSession].seat = seatRef.seat;
+    }
+    if (lobbies.playerCount(seatRef.lobby) == 0) fillStartUs[seatRef.lobby] = -1;
+}
+
+/**
+ * @brief Seats a player in the requested lobby.
+ * @param player The player who sent the handshake.
+ * @param lobbyId The requested lobby ID; 0 selects any open lobby.
+ */
+void DedicatedServer::joinLobby(const PlayerConnection &player, quint32 lobbyId) {
+    if (seatOfSession.contains(player.sessionId)) return; // Already seated
+    spectators->removeSpectator(player.sessionId);
+
+    if (tournamentMode) {
+        registerEntrant(player.sessionId, playerKeyOf(player));
+        return;
+    }
+
+    if (queue) {
+        enqueuePlayer(player);
+        return;
+    }
+
+    const int lobby = lobbyId == 0 ? lobbies.findOpenLobby() : lobbies.indexOf(lobbyId);
+    if (lobby < 0 || !lobbies.isOpen(lobby)) {
+        server->disconnectPlayer(player);
+        return;
+    }
+
+    SeatRef seatRef;
+    seatRef.lobby = lobby;
+    seatRef.seat = lobbies.addPlayer(lobby, player.sessionId);
+    seatRef.playerKey = playerKeyOf(player);
+    seatOfSession.insert(player.sessionId, seatRef);
+    if (metrics && lobbies.playerCount(lobby) == 1) fillStartUs[lobby] = elapsedUs();
+
+    if (lobbies.isFull(lobby)) {
+        startRound(lobby);
+    }
+    announceLobby(lobby);
+}
+
+/**
+ * @brief Makes a connection that is not playing a spectator of a lobby.
+ *
+ * Seated, queued and registered players keep their place and are not
+ * streamed to, while players who are out of a tournament may watch its
+ * remaining matches. An unknown lobby ID disconnects the connection.
+ *
+ * @param player The connection that sent the request.
+ * @param lobbyId The ID of the lobby to watch.
+ */
+void DedicatedServer::watchLobby(const PlayerConnection &player, quint32 lobbyId) {
+    const quint32 sessionId = player.sessionId;
+    const auto entrant = entrantOfSession.constFind(sessionId);
+    const bool inEvent = entrant != entrantOfSession.constEnd() && (!bracket || !bracket->isOut(*entrant));
+    if (seatOfSession.contains(sessionId) || (queue && queue->contains(sessionId))
+        || inEvent || waitingSessions.contains(sessionId)) {
+        return;
+    }
+
+    const int lobby = lobbyId == 0 ? -1 : lobbies.indexOf(lobbyId);
+    if (lobby < 0) {
+        server->disconnectPlayer(player);
+        return;
+    }
+    const bool playing = lobbies.state(lobby) == LobbyTable::State::Playing;
+    spectators->addSpectator(sessionId, lobbyId, playing ? lobbies.playerCount(lobby) : 0);
+}
+
+/**
+ * @brief Puts a player into the matchmaking queue.
+ *
+ * The Ping carries the low 32 bits of the server clock, so the Pong alone
+ * yields the round-trip time without any per-player probe state.
+ *
+ * @param player The player who sent the handshake.
+ */
+void DedicatedServer::enqueuePlayer(const PlayerConnection &player) {
+    const quint32 playerKey = playerKeyOf(player);
+    const double rating = ratings ? ratings->rating(playerKey).rating : RatingService::INITIAL_RATING;
+    const qint64 now = clock.elapsed();
+    if (!queue->enqueue(player.sessionId, rating, now)) return; // Already queued
+
+    queuedKeys.insert(player.sessionId, playerKey);
+    server->sendMessageToPlayer(player.sessionId, Protocol::encode(Protocol::Opcode::Ping, static_cast<quint32>(now)));
+}
+
+/**
+ * @brief Records the round-trip time of a queued player.
+ * @param player The player who answered.
+ * @param sentMs The send time of the Ping, echoed by the player.
+ */
+void DedicatedServer::playerPong(const PlayerConnection &player, quint32 sentMs) {
+    if (!queue) return;
+
+    const quint32 rtt = static_cast<quint32>(clock.elapsed()) - sentMs; // Wraps correctly
+    queue->setRtt(player.sessionId, static_cast<int>(qMin<quint32>(rtt, std::numeric_limits<int>::max())));
+}
+
+/**
+ * @brief Seats the groups found by one matchmaking pass.
+ *
+ * A pass never places more groups than there are free lobbies; the remaining
+ * players keep waiting for the next pass.
+ */
+void DedicatedServer::onMatchTick() {
+    TRACE_SCOPE("lobby", "DedicatedServer::onMatchTick");
+    const qint64 now = clock.elapsed();
+
+    matchedSessions.resize(0);
+    const int groups = queue->match(now, freeLobbies.size(), matchedSessions);
+    const int seats = lobbies.seatsPerLobby();
+    for (int group = 0; group < groups; ++group) {
+        seatGroup(matchedSessions.constData() + group * seats);
+    }
+
+    if (now - lastStatsMs >= STATS_INTERVAL_MS) {
+        lastStatsMs = now;
+        const MatchmakingQueue::Stats stats = queue->stats(now);
+        if (stats.depth > 0 || stats.placed > 0) {
+            qDebug().noquote() << QString("Matchmaking: depth=%1 oldest_wait_ms=%2 placed=%3 mean_wait_ms=%4 max_wait_ms=%5")
+                                      .arg(stats.depth).arg(stats.oldestWaitMs).arg(stats.placed)
+                                      .arg(stats.placed > 0 ? stats.totalWaitMs / stats.placed : 0)
+                                      .arg(stats.maxWaitMs);
+        }
+    }
+}
+
+/**
+ * @brief Seats a matched group in a free lobby and starts its round.
+ * @param sessions The session IDs of the group, one per seat.
+ */
+void DedicatedServer::seatGroup(const quint32 *sessions) {
+    const int lobby = freeLobbies.takeLast();
+
+    for (int i = 0; i < lobbies.seatsPerLobby(); ++i) {
+        SeatRef seatRef;
+        seatRef.lobby = lobby;
+        seatRef.seat = lobbies.addPlayer(lobby, sessions[i]);
+        seatRef.playerKey = queuedKeys.take(sessions[i]);
+        seatOfSession.insert(sessions[i], seatRef);
+    }
+    startRound(lobby);
+}
+
+/**
+ * @brief Registers a player for the next event.
+ *
+ * While an event runs, players who are not in it, or are already out of it,
+ * wait for the next one.
+ *
+ * @param sessionId The session ID of the player.
+ * @param playerKey The player key of the player.
+ */
+void DedicatedServer::registerEntrant(quint32 sessionId, quint32 playerKey) {
+    if (bracket) {
+        const auto it = entrantOfSession.constFind(sessionId);
+        if ((it != entrantOfSession.constEnd() && !bracket->isOut(*it)) || waitingSessions.contains(sessionId)) return;
+
+        waitingSessions.append(sessionId);
+        waitingKeys.append(playerKey);
+        return;
+    }
+
+    if (entrantOfSession.contains(sessionId)) return; // Already registered
+
+    entrantOfSession.insert(sessionId, entrantSessions.size());
+    entrantSessions.append(sessionId);
+    entrantKeys.append(playerKey);
+
+    if (entrantSessions.size() >= tournamentConfig.players) {
+        startTournament();
+    }
+    announceTournament();
+}
+
+/**
+ * @brief Seeds the registered players and starts the event.
+ *
+ * Entrants are seeded by rating, best first, so the strongest players meet
+ * as late as possible; ties keep the registration order.
+ */
+void DedicatedServer::startTournament() {
+    if (ratings) {
+        QVector<int> order(entrantSessions.size());
+        for (int i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        QVector<double> rating(entrantKeys.size());
+        for (int i = 0; i < rating.size(); ++i) {
+            rating[i] = ratings->rating(entrantKeys[i]).rating;
+        }
+        std::stable_sort(order.begin(), order.end(), [&rating](int a, int b) { return rating[a] > rating[b]; });
+
+        const QVector<quint32> sessions = entrantSessions;
+        const QVector<quint32> keys = entrantKeys;
+        for (int seed = 0; seed < order.size(); ++seed) {
+            entrantSessions[seed] = sessions[order[seed]];
+            entrantKeys[seed] = keys[order[seed]];
+            entrantOfSession[entrantSessions[seed]] = seed;
+        }
+    }
+
+    bracket = std::make_unique<TournamentBracket>(tournamentConfig.format, entrantSessions.size(),
+                                                  tournamentConfig.bestOf);
+    qDebug() << "Tournament started with" << bracket->playerCount() << "players and"
+             << bracket->matchCount() << "matches";
+    seatTournamentMatches();
+}
+
+/**
+ * @brief Seats as many ready bracket matches as there are free lobbies.
+ *
+ * Matches that find no lobby stay ready and are seated as soon as another
+ * match ends.
+ */
+void DedicatedServer::seatTournamentMatches() {
+    readyMatches.resize(0);
+    bracket->takeReadyMatches(freeLobbies.size(), readyMatches);
+
+    for (const int match : std::as_const(readyMatches)) {
+        const int lobby = freeLobbies.takeLast();
+        matchOfLobby[lobby] = match;
+
+        for (int slot = 0; slot < 2; ++slot) {
+            const int entrant = bracket->player(match, slot);
+            SeatRef seatRef;
+            seatRef.lobby = lobby;
+            seatRef.seat = lobbies.addPlayer(lobby, entrantSessions[entrant]);
+            seatRef.playerKey = entrantKeys[entrant];
+            seatOfSession.insert(entrantSessions[entrant], seatRef);
+        }
+        startRound(lobby);
+    }
+}
+
+/**
+ * @brief Records a game of a bracket match.
+ *
+ * Draws and undecided matches are replayed in the same lobby right away;
+ * a decided match frees its lobby for the next ready match.
+ *
+ * @param lobby The lobby index.
+ */
+void DedicatedServer::finishTournamentGame(int lobby) {
+    const int match = matchOfLobby[lobby];
+    const int players = lobbies.playerCount(lobby);
+    const quint32 *sessions = lobbies.playerData(lobby);
+
+    int winnerSlot = -1;
+    const quint8 win = static_cast<quint8>(Protocol::Opcode::Win);
+    for (int seat = 0; seat < players; ++seat) {
+        if (outcomes[seat] == win) {
+            winnerSlot = slotOf(match, sessions[seat]);
+        }
+    }
+
+    const TournamentBracket::GameOutcome outcome = bracket->recordGame(match, winnerSlot);
+    const bool decided = outcome == TournamentBracket::GameOutcome::MatchDecided;
+    for (int seat = 0; seat < players; ++seat) {
+        const bool continues = !decided || !bracket->isOut(entrantOfSession.value(sessions[seat]));
+        sendTournamentResult(sessions[seat], match, static_cast<Protocol::Opcode>(outcomes[seat]), continues);
+    }
+
+    if (!decided) {
+        lobbies.clearChoices(lobby);
+        startRound(lobby);
+        return;
+    }
+
+    resetLobby(lobby);
+    advanceTournament();
+}
+
+/**
+ * @brief Removes a disconnected player from a tournament.
+ *
+ * A player who leaves a running match forfeits it; a player who leaves
+ * between matches withdraws, and the opponents of its later matches get byes.
+ *
+ * @param sessionId The session ID of the player.
+ * @return True if the player took part in a tournament.
+ */
+bool DedicatedServer::leaveTournament(quint32 sessionId) {
+    const int waiting = waitingSessions.indexOf(sessionId);
+    if (waiting >= 0) {
+        waitingSessions.remove(waiting);
+        waitingKeys.remove(waiting);
+        return true;
+    }
+
+    const auto it = entrantOfSession.constFind(sessionId);
+    if (it == entrantOfSession.constEnd()) return false;
+    const int entrant = *it;
+
+    if (!bracket) {
+        // The last registered player takes the free place
+        entrantOfSession.remove(sessionId);
+        const int last = entrantSessions.size() - 1;
+        if (entrant != last) {
+            entrantSessions[entrant] = entrantSessions[last];
+            entrantKeys[entrant] = entrantKeys[last];
+            entrantOfSession[entrantSessions[entrant]] = entrant;
+        }
+        entrantSessions.removeLast();
+        entrantKeys.removeLast();
+        announceTournament();
+        return true;
+    }
+    if (bracket->isOut(entrant)) return true;
+
+    const SeatRef seatRef = seatOfSession.take(sessionId);
+    if (seatRef.lobby >= 0) {
+        const int lobby = seatRef.lobby;
+        const int match = matchOfLobby[lobby];
+        bracket->forfeit(match, slotOf(match, sessionId));
+        removeFromSeat(seatRef);
+
+        for (int seat = 0; seat < lobbies.playerCount(lobby); ++seat) {
+            const quint32 opponent = lobbies.player(lobby, seat);
+            sendTournamentResult(opponent, match, Protocol::Opcode::Win,
+                                 !bracket->isOut(entrantOfSession.value(opponent)));
+        }
+        resetLobby(lobby);
+    } else {
+        bracket->withdraw(entrant);
+    }
+
+    advanceTournament();
+    return true;
+}
+
+/**
+ * @brief Returns the bracket slot of a player in a match.
+ * @param match The match index.
+ * @param sessionId The session ID of the player.
+ * @return 0 or 1.
+ */
+int DedicatedServer::slotOf(int match, quint32 sessionId) const {
+    const int first = bracket->player(match, 0);
+    return first != TournamentBracket::NONE && entrantSessions[first] == sessionId ? 0 : 1;
+}
+
+/**
+ * @brief Sends a player the result of a tournament game.
+ *
+ * A player with games left first receives a Next carrying the match score,
+ * so the client waits for the next start instead of ending the session.
+ *
+ * @param sessionId The session ID of the player.
+ * @param match The match index.
+ * @param outcome The Win, Lose or Draw opcode of the game.
+ * @param continues True if the player has games left in the event.
+ */
+void DedicatedServer::sendTournamentResult(quint32 sessionId, int match, Protocol::Opcode outcome, bool continues) {
+    if (continues) {
+        const int slot = slotOf(match, sessionId);
+        const quint32 score = (static_cast<quint32>(bracket->wins(match, slot)) << 16)
+                              | static_cast<quint32>(bracket->wins(match, 1 - slot));
+        server->sendMessageToPlayer(sessionId, Protocol::encode(Protocol::Opcode::Next, score));
+    }
+    server->sendMessageToPlayer(sessionId, Protocol::encode(outcome));
+}
+
+/**
+ * @brief Seats the next matches, or ends the event once its final is decided.
+ */
+void DedicatedServer::advanceTournament() {
+    if (bracket->isFinished()) {
+        endTournament();
+    } else {
+        seatTournamentMatches();
+    }
+}
+
+/**
+ * @brief Reports the champion and registers the waiting players for the next event.
+ */
+void DedicatedServer::endTournament() {
+    const int champion = bracket->champion();
+    if (champion == TournamentBracket::NONE) {
+        qDebug() << "Tournament ended without a champion";
+    } else {
+        qDebug().noquote() << QString("Tournament won by seed %1 (player %2)")
+                                  .arg(champion + 1).arg(entrantKeys[champion], 8, 16, QChar('0'));
+    }
+
+    bracket.reset();
+    entrantSessions.clear();
+    entrantKeys.clear();
+    entrantOfSession.clear();
+
+    const QVector<quint32> sessions = waitingSessions;
+    const QVector<quint32> keys = waitingKeys;
+    waitingSessions.clear();
+    waitingKeys.clear();
+    for (int i = 0; i < sessions.size(); ++i) {
+        registerEntrant(sessions[i], keys[i]);
+    }
+    announceTournament();
+}
+
+/**
+ * @brief Announces the registration of the next event.
+ *
+ * The entry shows as full while an event runs; lobby 0 means any lobby.
+ */
+void DedicatedServer::announceTournament() {
+    const int registered = bracket ? tournamentConfig.players : entrantSessions.size();
+    broadcaster->updateLobby(LobbyInfo(namePrefix, tournamentConfig.players, registered, tcpPort, 0));
+}
+
+/**
+ * @brief Records a player's move.
+ * @param player The player who made the move.
+ * @param choice The move (1 = Rock, 2 = Paper, 3 = Scissors).
+ */
+void DedicatedServer::playerMove(const PlayerConnection &player, int choice) {
+    if (!GameRules::isValidChoice(choice)) return;
+
+    const auto it = seatOfSession.constFind(player.sessionId);
+    if (it == seatOfSession.constEnd()) return;
+
+    const int lobby = it->lobby;
+    if (lobbies.state(lobby) != LobbyTable::State::Playing) return;
+
+    lobbies.setChoice(lobby, it->seat, choice);
+    server->fulfilMessage(player.sessionId);
+    if (lobbies.allChosen(lobby)) {
+        if (metrics && roundStartUs[lobby] >= 0) {
+            metrics->observe(Metrics::Histogram::MoveWait, elapsedUs() - roundStartUs[lobby]);
+        }
+        resolveRound(lobby);
+    }
+}
+
+/**
+ * @brief Starts the round of a full lobby.
+ *
+ * The move deadline is armed before the start is sent, so no move can arrive
+ * ahead of it.
+ *
+ * @param lobby The lobby index.
+ */
+void DedicatedServer::startRound(int lobby) {
+    TRACE_SCOPE("lobby", "DedicatedServer::startRound");
+    lobbies.setState(lobby, LobbyTable::State::Playing);
+
+    QVector<quint32> sessions;
+    sessions.reserve(lobbies.playerCount(lobby));
+    for (int seat = 0; seat < lobbies.playerCount(lobby); ++seat) {
+        sessions.append(lobbies.player(lobby, seat));
+    }
+    server->expectMessage(sessions, server->timeouts().moveTimeoutMs);
+    server->sendMessageToPlayers(sessions, Protocol::encode(Protocol::Opcode::Start));
+    spectators->roundStarted(lobbies.lobbyId(lobby), lobbies.playerCount(lobby));
+
+    // Lobbies seated as a whole by the matchmaker or the bracket have no fill time
+    if (metrics) {
+        roundStartUs[lobby] = elapsedUs();
+        if (fillStartUs[lobby] >= 0) metrics->observe(Metrics::Histogram::LobbyFill, roundStartUs[lobby] - fillStartUs[lobby]);
+        fillStartUs[lobby] = -1;
+    }
+}
+
+/**
+ * @brief Sends the results of a round and reopens the lobby.
+ * @param lobby The lobby index.
+ */
+void DedicatedServer::resolveRound(int lobby) {
+    TRACE_SCOPE("lobby", "DedicatedServer::resolveRound");
+    const qint64 startUs = metrics ? elapsedUs() : 0;
+    const int players = lobbies.playerCount(lobby);
+    const quint32 *sessions = lobbies.playerData(lobby);
+
+    outcomes.resize(players);
+    const RoundResolver::Result result = RoundResolver::resolve(lobbies.choiceData(lobby), players, outcomes.data());
+    spectators->roundResolved(lobbies.lobbyId(lobby), result);
+
+    if (matchLog || ratings) {
+        playerKeys.resize(players);
+        for (int seat = 0; seat < players; ++seat) {
+            playerKeys[seat] = seatOfSession.value(sessions[seat]).playerKey;
+        }
+    }
+    if (matchLog) {
+        matchLog->recordRound(lobbies.lobbyId(lobby), players, sessions, playerKeys.constData(),
+                              lobbies.choiceData(lobby), outcomes.constData());
+    }
+    if (ratings) {
+        ratings->recordRound(players, playerKeys.constData(), outcomes.constData());
+    }
+
+    if (metrics) {
+        metrics->add(Metrics::Counter::RoundsResolved);
+        roundStartUs[lobby] = -1;
+    }
+
+    if (tournamentMode && matchOfLobby[lobby] >= 0) {
+        finishTournamentGame(lobby);
+        if (metrics) metrics->observe(Metrics::Histogram::RoundResolution, elapsedUs() - startUs);
+        return;
+    }
+
+    if (result.winningChoice == GameRules::None) {
+        server->sendMessageToPlayers(QVector<quint32>(sessions, sessions + players),
+                                     Protocol::encode(Protocol::Opcode::Draw));
+    } else {
+        // Group the seats by outcome so each result is encoded and framed once
+        QVector<quint32> winners;
+        QVector<quint32> losers;
+        winners.reserve(result.winners);
+        losers.reserve(players - result.winners);
+        const quint8 win = static_cast<quint8>(Protocol::Opcode::Win);
+        for (int seat = 0; seat < players; ++seat) {
+            (outcomes[seat] == win ? winners : losers).append(sessions[seat]);
+        }
+
+        server->sendMessageToPlayers(winners, Protocol::encode(Protocol::Opcode::Win));
+        server->sendMessageToPlayers(losers, Protocol::encode(Protocol::Opcode::Lose));
+    }
+
+    resetLobby(lobby);
+    if (metrics) metrics->observe(Metrics::Histogram::RoundResolution, elapsedUs() - startUs);
+}
+
+/**
+ * @brief Returns the time on the server clock in microseconds.
+ * @return The elapsed time.
+ */
+qint64 DedicatedServer::elapsedUs() const {
+    return clock.nsecsElapsed() / 1000;
+}
+
+/**
+ * @brief Returns the stable key of a player for the ratings and the match log.
+ * @param player The player.
+ * @return The key sent by its Identify handshake, or the key of its address.
+ */
+quint32 DedicatedServer::playerKeyOf(const PlayerConnection &player) const {
+    return MatchLog::playerKey(identityOfSession.value(player.sessionId), player.ipAddress);
+}
+
+/**
+ * @brief Empties a lobby and announces it again.
+ *
+ * A lobby reset mid-round still owes moves to the move deadlines of its
+ * players; those deadlines are met here so nobody is disconnected for a
+ * round that no longer exists.
+ *
+ * @param lobby The lobby index.
+ */
+void DedicatedServer::resetLobby(int lobby) {
+    const bool playing = lobbies.state(lobby) == LobbyTable::State::Playing;
+    for (int seat = 0; seat < lobbies.playerCount(lobby); ++seat) {
+        const quint32 sessionId = lobbies.player(lobby, seat);
+        if (playing && lobbies.choice(lobby, seat) == GameRules::None) server->fulfilMessage(sessionId);
+        seatOfSession.remove(sessionId);
+    }
+    lobbies.clearLobby(lobby);
+
+    if (tournamentMode) {
+        matchOfLobby[lobby] = -1;
+        freeLobbies.append(lobby);
+        return;
+    }
+    if (queue) {
+        freeLobbies.append(lobby);
+        return;
+    }
+    announceLobby(lobby);
+}
+
+/**
+ * @brief Announces an open lobby or withdraws the announcement of an unavailable one.
+ * @param lobby The lobby index.
+ */
+void DedicatedServer::announceLobby(int lobby) {
+    const quint32 id = lobbies.lobbyId(lobby);
+
+    if (!lobbies.isOpen(lobby)) {
+        broadcaster->removeLobby(id);
+        return;
+    }
+
+    const QString name = QString("%1 #%2").arg(namePrefix).arg(id);
+    broadcaster->updateLobby(LobbyInfo(name, lobbies.seatsPerLobby(), lobbies.playerCount(lobby), tcpPort, id));
+}
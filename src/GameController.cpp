@@ -1,4 +1,6 @@
 #include "GameController.h"
+#include "Trace.h"
+#include <QCoreApplication>
 
 /**
  * @brief Constructs the GameController and connects menu signals to controller slots.
@@ -16,11 +18,46 @@ GameController::GameController(IMainMenu *menu, IGameActionMenu *actionMenu, QOb
 
     // Connect game action menu signals to controller slots
     connect(gameActionMenu, &IGameActionMenu::playerMadeChoice, this, &GameController::onPlayerMadeChoice);
+    connect(gameActionMenu, &IGameActionMenu::playerSentChat, this, &GameController::onPlayerSentChat);
     connect(gameActionMenu, &IGameActionMenu::closeGame, this, &GameController::onCloseGame);
 
     // Connect lobby client signals to controller slots
     connect(&lobbyClient, &LobbyClient::invokeGameActionMenu, this, &GameController::onInvokeGameActionMenu);
     connect(&lobbyClient, &LobbyClient::invokeResults, this, &GameController::onInvokeResult);
+    connect(&lobbyClient, &LobbyClient::invokeRoundResults, this, &GameController::onInvokeRoundResult);
+    connect(&lobbyClient, &LobbyClient::invokeChat, this, &GameController::onInvokeChat);
+}
+
+/**
+ * @brief Selects the channels used to discover and announce lobbies.
+ * @param config The discovery settings.
+ */
+void GameController::setDiscoveryConfig(const DiscoveryConfig &config) {
+    lobbyClient.setDiscoveryConfig(config);
+}
+
+/**
+ * @brief Records the rounds of hosted lobbies in a match history log.
+ * @param log The log.
+ */
+void GameController::setMatchLog(MatchLog *log) {
+    lobbyClient.setMatchLog(log);
+}
+
+/**
+ * @brief Rates the players of hosted lobbies.
+ * @param service The rating service.
+ */
+void GameController::setRatingService(RatingService *service) {
+    lobbyClient.setRatingService(service);
+}
+
+/**
+ * @brief Records the traffic and round timing of hosted lobbies.
+ * @param metrics The metrics.
+ */
+void GameController::setMetrics(Metrics *metrics) {
+    lobbyClient.setMetrics(metrics);
 }
 
 /**
@@ -45,11 +82,13 @@ void GameController::onHostOwnLocalTcpServer() {
 }
 
 /**
- * @brief Handles closing the game by calling the lobby client and exiting the application.
+ * @brief Handles closing the game by calling the lobby client and leaving the event loop.
+ *
+ * main() then returns normally, so the trace, ratings and match log are written.
  */
 void GameController::onCloseGame() {
     lobbyClient.onCloseGame();
-    exit(0); // Terminates the application
+    QCoreApplication::quit();
 }
 
 /**
@@ -57,13 +96,23 @@ void GameController::onCloseGame() {
  * @param choice The player's choice (1 = Rock, 2 = Paper, 3 = Scissors).
  */
 void GameController::onPlayerMadeChoice(int choice) {
+    TRACE_SCOPE("ui", "GameController::onPlayerMadeChoice");
     lobbyClient.onPlayerMadeChoice(choice);
 }
 
+/**
+ * @brief Sends the player's chat message to the lobby.
+ * @param text The message text.
+ */
+void GameController::onPlayerSentChat(QString text) {
+    lobbyClient.onPlayerSentChat(text);
+}
+
 /**
  * @brief Displays the game action menu when the server requests it.
  */
 void GameController::onInvokeGameActionMenu() {
+    TRACE_SCOPE("ui", "GameController::onInvokeGameActionMenu");
     gameActionMenu->showMenu();
 }
 
@@ -72,5 +121,24 @@ void GameController::onInvokeGameActionMenu() {
  * @param result The result message (Win/Lose/Draw).
  */
 void GameController::onInvokeResult(QString result) {
+    TRACE_SCOPE("ui", "GameController::onInvokeResult");
     gameActionMenu->showResult(result);
 }
+
+/**
+ * @brief Displays the result of a tournament game that is followed by another one.
+ * @param result The result message, including the match score.
+ */
+void GameController::onInvokeRoundResult(QString result) {
+    TRACE_SCOPE("ui", "GameController::onInvokeRoundResult");
+    gameActionMenu->showRoundResult(result);
+}
+
+/**
+ * @brief Displays a chat message received from the lobby.
+ * @param sender The name of the sender.
+ * @param text The message text.
+ */
+void GameController::onInvokeChat(QString sender, QString text) {
+    gameActionMenu->showChat(sender, text);
+}
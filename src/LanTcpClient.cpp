@@ -1,4 +1,5 @@
 #include "LanTcpClient.h"
+#include "Trace.h"
 #include <QDebug>
 
 /**
@@ -16,6 +17,9 @@ LanTcpClient::LanTcpClient(QObject *parent) : QObject(parent), socket(new QTcpSo
     // Handle incoming messages
     connect(socket, &QTcpSocket::readyRead, this, &LanTcpClient::onReadyRead);
 
+    // Keep the connection alive and detect a silent server
+    connect(&heartbeatTimer, &QTimer::timeout, this, &LanTcpClient::onHeartbeat);
+
     // Handle connection errors
     connect(socket, &QTcpSocket::errorOccurred, this, [this](QAbstractSocket::SocketError) {
         emit connectionError(socket->errorString());
@@ -38,11 +42,13 @@ LanTcpClient::~LanTcpClient() {
  *
  * @param hostAdress The IP address of the server.
  * @param info The lobby information containing the TCP port.
+ * @return True if a connection attempt was started.
  */
-void LanTcpClient::connectToServer(const QHostAddress &hostAdress, const LobbyInfo &info) {
-    if (socket->state() == QAbstractSocket::UnconnectedState) {
-        socket->connectToHost(hostAdress, info.tcpPort);
-    }
+bool LanTcpClient::connectToServer(const QHostAddress &hostAdress, const LobbyInfo &info) {
+    if (socket->state() != QAbstractSocket::UnconnectedState) return false;
+
+    socket->connectToHost(hostAdress, info.tcpPort);
+    return true;
 }
 
 /**
@@ -56,43 +62,121 @@ void LanTcpClient::disconnectFromServer() {
     }
 }
 
+/**
+ * @brief Checks whether the client is connected or connecting.
+ * @return True unless the socket is unconnected.
+ */
+bool LanTcpClient::isBusy() const {
+    return socket->state() != QAbstractSocket::UnconnectedState;
+}
+
 /**
  * @brief Sends a message to the server.
  *
- * The message is only sent if the client is connected.
+ * The message is framed and only sent if the client is connected.
  *
  * @param message The data to be sent.
+ * @return False if the message is empty or the client is not connected.
  */
-void LanTcpClient::sendMessage(const QByteArray &message) {
-    if (socket->state() == QAbstractSocket::ConnectedState) {
-        socket->write(message);
+bool LanTcpClient::sendMessage(const QByteArray &message) {
+    TRACE_SCOPE("net", "LanTcpClient::sendMessage");
+    if (message.isEmpty() || socket->state() != QAbstractSocket::ConnectedState) return false;
+
+    socket->write(MessageFramer::frame(message));
+    return true;
+}
+
+/**
+ * @brief Sends several messages to the server in a single write.
+ *
+ * @param messages The messages to be sent.
+ */
+void LanTcpClient::sendMessages(const QList<QByteArray> &messages) {
+    if (socket->state() != QAbstractSocket::ConnectedState) return;
+
+    QByteArray batch;
+    for (const QByteArray &message : messages) {
+        if (!message.isEmpty()) MessageFramer::appendFrame(batch, message); // An empty frame is a heartbeat
     }
+    socket->write(batch);
+}
+
+/**
+ * @brief Sets the heartbeat interval and the idle timeout.
+ * @param newTimeouts The connection timeouts.
+ */
+void LanTcpClient::setTimeouts(const ConnectionTimeouts &newTimeouts) {
+    timeouts = newTimeouts;
 }
 
 /**
  * @brief Handles a successful connection event.
  *
- * Emits the `connected` signal.
+ * Starts the heartbeats and emits the `connected` signal.
  */
 void LanTcpClient::onConnected() {
+    lastReceive.start();
+
+    // Without heartbeats the timer still checks for silence
+    const int interval = timeouts.heartbeatIntervalMs > 0 ? timeouts.heartbeatIntervalMs : timeouts.idleTimeoutMs;
+    if (interval > 0) {
+        heartbeatTimer.start(interval);
+    }
+
     emit connected();
 }
 
 /**
  * @brief Handles a disconnection event.
  *
- * Emits the `disconnected` signal.
+ * Drops any partially received frame and emits the `disconnected` signal.
  */
 void LanTcpClient::onDisconnected() {
+    heartbeatTimer.stop();
+    framer.clear();
     emit disconnected();
 }
 
 /**
- * @brief Reads incoming messages from the server.
+ * @brief Reads incoming data from the server.
  *
- * Emits the `messageReceived` signal with the received data.
+ * Emits the `messageReceived` signal once for every complete frame;
+ * heartbeats are consumed silently.
+ * If the server sends an oversized frame, the connection is closed.
  */
 void LanTcpClient::onReadyRead() {
-    QByteArray data = socket->readAll();
-    emit messageReceived(data);
+    TRACE_SCOPE("net", "LanTcpClient::onReadyRead");
+    if (!framer.readFrom(socket)) {
+        socket->disconnectFromHost();
+        return;
+    }
+    lastReceive.restart();
+
+    QByteArray message;
+    while (framer.nextFrame(message)) {
+        if (message.isEmpty()) continue;
+        emit messageReceived(message);
+    }
+
+    if (framer.hasError()) {
+        emit connectionError("Received an oversized frame");
+        socket->disconnectFromHost();
+    }
+}
+
+/**
+ * @brief Sends a heartbeat and closes the connection if the server went silent.
+ */
+void LanTcpClient::onHeartbeat() {
+    if (socket->state() != QAbstractSocket::ConnectedState) return;
+
+    if (timeouts.idleTimeoutMs > 0 && lastReceive.elapsed() > timeouts.idleTimeoutMs) {
+        emit connectionError("The server stopped responding");
+        socket->abort();
+        return;
+    }
+
+    if (timeouts.heartbeatIntervalMs > 0) {
+        socket->write(MessageFramer::heartbeatFrame());
+    }
 }
@@ -1,24 +1,101 @@
 #include "LanTcpServer.h"
+#include "Trace.h"
 #include <QDebug>
-#include <QDataStream>
 #include <QHostAddress>
+#include <QMetaObject>
+
+namespace {
 
 /**
- * @brief Constructs the LAN TCP server.
+ * @brief Checks that a message can be framed.
+ *
+ * An empty frame is a heartbeat, so an empty message would reach the peer as
+ * one; it comes from an encoder that does not support the message type.
+ *
+ * @param message The message to be sent.
+ * @return False if the message is empty.
+ */
+bool isSendable(const QByteArray &message) {
+    if (!message.isEmpty()) return true;
+    qWarning() << "Refusing to send an empty message";
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Constructs the LAN TCP server with a single in-thread socket worker.
  *
  * @param port The port on which the server will listen.
  * @param parent The parent QObject.
  */
 LanTcpServer::LanTcpServer(quint16 port, QObject *parent)
-    : QTcpServer(parent), serverPort(port) {}
+    : LanTcpServer(port, 0, parent) {}
+
+/**
+ * @brief Constructs the LAN TCP server.
+ *
+ * @param port The port on which the server will listen.
+ * @param workerThreads The number of socket worker threads; 0 keeps sockets in the server's thread.
+ * @param parent The parent QObject.
+ */
+LanTcpServer::LanTcpServer(quint16 port, int workerThreads, QObject *parent)
+    : QTcpServer(parent), listenPort(port) {
+    // Player connections travel between threads through queued signals
+    qRegisterMetaType<PlayerConnection>("PlayerConnection");
+
+    createWorkers(workerThreads);
+}
 
 /**
  * @brief Destructor for the LAN TCP server.
  *
- * Stops the server and disconnects all clients.
+ * Stops the server, disconnects all clients and joins the worker threads.
  */
 LanTcpServer::~LanTcpServer() {
-    stopListening();
+    close();
+
+    // Close sockets inside their own threads before the event loops stop
+    for (LanTcpWorker *worker : std::as_const(workers)) {
+        if (worker->thread() == thread()) {
+            worker->closeAll();
+        } else {
+            QMetaObject::invokeMethod(worker, [worker] { worker->closeAll(); }, Qt::BlockingQueuedConnection);
+        }
+    }
+
+    for (QThread *workerThread : std::as_const(workerThreads)) {
+        workerThread->quit();
+        workerThread->wait();
+    }
+}
+
+/**
+ * @brief Creates the socket workers and forwards their signals.
+ *
+ * @param threadCount The number of worker threads; 0 creates one worker in the server's thread.
+ */
+void LanTcpServer::createWorkers(int threadCount) {
+    const int workerCount = qMax(threadCount, 1);
+
+    for (int i = 0; i < workerCount; ++i) {
+        auto *worker = new LanTcpWorker(threadCount > 0 ? nullptr : this);
+
+        connect(worker, &LanTcpWorker::playerConnected, this, &LanTcpServer::onWorkerPlayerConnected);
+        connect(worker, &LanTcpWorker::playerDisconnected, this, &LanTcpServer::onWorkerPlayerDisconnected);
+        connect(worker, &LanTcpWorker::messageReceived, this, &LanTcpServer::messageReceived);
+
+        if (threadCount > 0) {
+            auto *workerThread = new QThread(this);
+            workerThread->setObjectName(QString("LanTcpWorker_%1").arg(i));
+            worker->moveToThread(workerThread);
+            connect(workerThread, &QThread::finished, worker, &QObject::deleteLater);
+            workerThread->start();
+            workerThreads.append(workerThread);
+        }
+
+        workers.append(worker);
+    }
 }
 
 /**
@@ -28,25 +105,19 @@ LanTcpServer::~LanTcpServer() {
  */
 bool LanTcpServer::startListening() {
     setAcceptingPlayers(true);
-    return listen(QHostAddress::Any, serverPort);
+    return listen(QHostAddress::Any, listenPort);
 }
 
 /**
  * @brief Stops the server and disconnects all clients.
  */
 void LanTcpServer::stopListening() {
-    // Get a list of all connected player sockets
-    const QList<QTcpSocket *> sockets = players.keys();
+    close();
+    workerOfSession.clear();
 
-    // Disconnect each client and schedule them for deletion
-    for (QTcpSocket *socket : sockets) {
-        socket->disconnectFromHost();
-        socket->deleteLater();
+    for (LanTcpWorker *worker : std::as_const(workers)) {
+        QMetaObject::invokeMethod(worker, [worker] { worker->closeAll(); });
     }
-
-    // Close the server and clear the player list
-    close();
-    players.clear();
 }
 
 /**
@@ -58,64 +129,63 @@ void LanTcpServer::setAcceptingPlayers(bool allowNewPlayers) {
 }
 
 /**
- * @brief Handles an incoming player connection.
+ * @brief Selects the worker with the fewest connections.
  *
- * @param socketDescriptor The descriptor of the new connection.
+ * The scan starts at a rotating index, so equally loaded workers are used round-robin.
+ *
+ * @return The selected worker.
  */
-void LanTcpServer::incomingConnection(qintptr socketDescriptor) {
-    if (!acceptingPlayers) return;
-
-    auto *socket = new QTcpSocket(this);
-    if (!socket->setSocketDescriptor(socketDescriptor)) {
-        socket->deleteLater();
-        return;
+LanTcpWorker *LanTcpServer::selectWorker() {
+    LanTcpWorker *selected = workers[nextWorker];
+    for (int i = 1; i < workers.size(); ++i) {
+        LanTcpWorker *candidate = workers[(nextWorker + i) % workers.size()];
+        if (candidate->connectionCount() < selected->connectionCount()) {
+            selected = candidate;
+        }
     }
 
-    connect(socket, &QTcpSocket::readyRead, this, &LanTcpServer::onReadyRead);
-    connect(socket, &QTcpSocket::disconnected, this, &LanTcpServer::onClientDisconnected);
-
-    PlayerConnection player = createPlayerFromSocket(socket);
-    players.insert(socket, player);
-
-    emit playerConnected(player);
+    nextWorker = (nextWorker + 1) % workers.size();
+    return selected;
 }
 
 /**
- * @brief Creates a PlayerConnection object from a socket.
+ * @brief Handles an incoming player connection by handing it to a worker.
  *
- * @param socket The socket associated with the player.
- * @return The generated PlayerConnection object.
+ * @param socketDescriptor The descriptor of the new connection.
  */
-PlayerConnection LanTcpServer::createPlayerFromSocket(QTcpSocket *socket) {
-    QHostAddress ip = socket->peerAddress();
-    QString playerName = QString("Player_%1").arg(ip.toString().right(5));
-    return PlayerConnection(playerName, ip, false);
+void LanTcpServer::incomingConnection(qintptr socketDescriptor) {
+    TRACE_SCOPE("net", "LanTcpServer::incomingConnection");
+    if (!acceptingPlayers) return;
+
+    const quint32 sessionId = nextSessionId++;
+    if (nextSessionId == 0) nextSessionId = 1; // 0 is reserved for "unassigned"
+
+    LanTcpWorker *worker = selectWorker();
+    worker->reserveConnection();
+    QMetaObject::invokeMethod(worker, [worker, socketDescriptor, sessionId] {
+        worker->addConnection(socketDescriptor, sessionId);
+    });
 }
 
 /**
- * @brief Reads incoming messages from clients.
+ * @brief Indexes a connection accepted by a worker and announces the player.
+ * @param player The connected player.
  */
-void LanTcpServer::onReadyRead() {
-    auto *socket = qobject_cast<QTcpSocket*>(sender());
-    if (!socket) return;
+void LanTcpServer::onWorkerPlayerConnected(const PlayerConnection &player) {
+    auto *worker = qobject_cast<LanTcpWorker*>(sender());
+    if (!worker) return;
 
-    QByteArray data = socket->readAll();
-    PlayerConnection player = players.value(socket);
-    emit messageReceived(player, data);
+    workerOfSession.insert(player.sessionId, worker);
+    emit playerConnected(player);
 }
 
 /**
- * @brief Handles player disconnections.
+ * @brief Drops the index entry of a closed connection and announces the disconnect.
+ * @param player The disconnected player.
  */
-void LanTcpServer::onClientDisconnected() {
-    auto *socket = qobject_cast<QTcpSocket*>(sender());
-    if (!socket) return;
-
-    PlayerConnection player = players.value(socket);
-    players.remove(socket);
+void LanTcpServer::onWorkerPlayerDisconnected(const PlayerConnection &player) {
+    workerOfSession.remove(player.sessionId);
     emit playerDisconnected(player);
-
-    socket->deleteLater();
 }
 
 /**
@@ -124,22 +194,35 @@ void LanTcpServer::onClientDisconnected() {
  * @param player The player to be disconnected.
  */
 void LanTcpServer::disconnectPlayer(const PlayerConnection &player) {
-    for (auto it = players.begin(); it != players.end(); ++it) {
-        if (it.value().playerName == player.playerName) {
-            it.key()->disconnectFromHost();
-            return;
-        }
-    }
+    disconnectPlayer(player.sessionId);
+}
+
+/**
+ * @brief Disconnects the player of a session.
+ *
+ * @param sessionId The session ID of the player.
+ */
+void LanTcpServer::disconnectPlayer(quint32 sessionId) {
+    LanTcpWorker *worker = workerOfSession.value(sessionId);
+    if (!worker) return;
+
+    QMetaObject::invokeMethod(worker, [worker, sessionId] { worker->disconnectPlayer(sessionId); });
 }
 
 /**
  * @brief Sends a message to all connected players.
  *
+ * The message is framed once and the same buffer is shared by every worker.
+ *
  * @param message The message to be sent.
  */
 void LanTcpServer::sendMessageToAll(const QByteArray &message) {
-    for (auto it = players.constBegin(); it != players.constEnd(); ++it) {
-        it.key()->write(message);
+    TRACE_SCOPE("net", "LanTcpServer::sendMessageToAll");
+    if (!isSendable(message)) return;
+    if (metrics) metrics->countMessage(Metrics::Direction::Sent, message, static_cast<quint64>(workerOfSession.size()));
+    const QByteArray frame = MessageFramer::frame(message);
+    for (LanTcpWorker *worker : std::as_const(workers)) {
+        QMetaObject::invokeMethod(worker, [worker, frame] { worker->sendFrameToAll(frame); });
     }
 }
 
@@ -150,10 +233,187 @@ void LanTcpServer::sendMessageToAll(const QByteArray &message) {
  * @param message The message to send.
  */
 void LanTcpServer::sendMessageToPlayer(const PlayerConnection &player, const QByteArray &message) {
-    for (auto it = players.constBegin(); it != players.constEnd(); ++it) {
-        if (it.value().playerName == player.playerName) {
-            it.key()->write(message);
-            break;
+    sendMessageToPlayer(player.sessionId, message);
+}
+
+/**
+ * @brief Sends a message to the player of a session.
+ *
+ * @param sessionId The session ID of the recipient.
+ * @param message The message to send.
+ */
+void LanTcpServer::sendMessageToPlayer(quint32 sessionId, const QByteArray &message) {
+    TRACE_SCOPE("net", "LanTcpServer::sendMessageToPlayer");
+    if (!isSendable(message)) return;
+    LanTcpWorker *worker = workerOfSession.value(sessionId);
+    if (!worker) return;
+
+    if (metrics) metrics->countMessage(Metrics::Direction::Sent, message);
+    const QByteArray frame = MessageFramer::frame(message);
+    QMetaObject::invokeMethod(worker, [worker, sessionId, frame] { worker->sendFrameToPlayer(sessionId, frame); });
+}
+
+/**
+ * @brief Sends the same message to the players of several sessions.
+ *
+ * Recipients are grouped by their owning worker, so each worker receives a
+ * single call carrying its sessions and a reference to the shared frame.
+ *
+ * @param sessionIds The session IDs of the recipients.
+ * @param message The message to send.
+ */
+void LanTcpServer::sendMessageToPlayers(const QVector<quint32> &sessionIds, const QByteArray &message) {
+    TRACE_SCOPE("net", "LanTcpServer::sendMessageToPlayers");
+    if (!isSendable(message)) return;
+    if (sessionIds.isEmpty()) return;
+
+    if (metrics) metrics->countMessage(Metrics::Direction::Sent, message, static_cast<quint64>(sessionIds.size()));
+    const QHash<LanTcpWorker*, QVector<quint32>> sessionsOfWorker = groupByWorker(sessionIds);
+    const QByteArray frame = MessageFramer::frame(message);
+    for (auto it = sessionsOfWorker.constBegin(); it != sessionsOfWorker.constEnd(); ++it) {
+        LanTcpWorker *worker = it.key();
+        const QVector<quint32> sessions = it.value();
+        QMetaObject::invokeMethod(worker, [worker, sessions, frame] { worker->sendFrameToPlayers(sessions, frame); });
+    }
+}
+
+/**
+ * @brief Sends a state snapshot to the players of several sessions.
+ * @param sessionIds The session IDs of the recipients.
+ * @param message The snapshot to send.
+ */
+void LanTcpServer::sendSnapshotToPlayers(const QVector<quint32> &sessionIds, const QByteArray &message) {
+    TRACE_SCOPE("net", "LanTcpServer::sendSnapshotToPlayers");
+    if (!isSendable(message)) return;
+    if (sessionIds.isEmpty()) return;
+
+    if (metrics) metrics->countMessage(Metrics::Direction::Sent, message, static_cast<quint64>(sessionIds.size()));
+    const QHash<LanTcpWorker*, QVector<quint32>> sessionsOfWorker = groupByWorker(sessionIds);
+    const QByteArray frame = MessageFramer::frame(message);
+    for (auto it = sessionsOfWorker.constBegin(); it != sessionsOfWorker.constEnd(); ++it) {
+        LanTcpWorker *worker = it.key();
+        const QVector<quint32> sessions = it.value();
+        QMetaObject::invokeMethod(worker, [worker, sessions, frame] { worker->sendSnapshotToPlayers(sessions, frame); });
+    }
+}
+
+/**
+ * @brief Sends a low-priority message to the players of several sessions.
+ * @param sessionIds The session IDs of the recipients.
+ * @param message The message to send.
+ */
+void LanTcpServer::sendLowPriorityToPlayers(const QVector<quint32> &sessionIds, const QByteArray &message) {
+    TRACE_SCOPE("net", "LanTcpServer::sendLowPriorityToPlayers");
+    if (!isSendable(message)) return;
+    if (sessionIds.isEmpty()) return;
+
+    if (metrics) metrics->countMessage(Metrics::Direction::Sent, message, static_cast<quint64>(sessionIds.size()));
+    const QHash<LanTcpWorker*, QVector<quint32>> sessionsOfWorker = groupByWorker(sessionIds);
+    const QByteArray frame = MessageFramer::frame(message);
+    for (auto it = sessionsOfWorker.constBegin(); it != sessionsOfWorker.constEnd(); ++it) {
+        LanTcpWorker *worker = it.key();
+        const QVector<quint32> sessions = it.value();
+        QMetaObject::invokeMethod(worker, [worker, sessions, frame] { worker->sendLowPriorityToPlayers(sessions, frame); });
+    }
+}
+
+/**
+ * @brief Sets the heartbeat, idle and move timeouts.
+ * @param newTimeouts The connection timeouts.
+ */
+void LanTcpServer::setTimeouts(const ConnectionTimeouts &newTimeouts) {
+    connectionTimeouts = newTimeouts;
+    for (LanTcpWorker *worker : std::as_const(workers)) {
+        QMetaObject::invokeMethod(worker, [worker, newTimeouts] { worker->setTimeouts(newTimeouts); });
+    }
+}
+
+/**
+ * @brief Returns the connection timeouts.
+ * @return The current timeouts.
+ */
+const ConnectionTimeouts &LanTcpServer::timeouts() const {
+    return connectionTimeouts;
+}
+
+/**
+ * @brief Sets the limits of the per-connection send queues.
+ * @param limits The send queue limits.
+ */
+void LanTcpServer::setSendQueueLimits(const SendQueueLimits &limits) {
+    for (LanTcpWorker *worker : std::as_const(workers)) {
+        QMetaObject::invokeMethod(worker, [worker, limits] { worker->setSendQueueLimits(limits); });
+    }
+}
+
+/**
+ * @brief Records connection, traffic and per-opcode message counters.
+ * @param newMetrics The metrics; nullptr stops recording.
+ */
+void LanTcpServer::setMetrics(Metrics *newMetrics) {
+    metrics = newMetrics;
+    for (LanTcpWorker *worker : std::as_const(workers)) {
+        QMetaObject::invokeMethod(worker, [worker, newMetrics] { worker->setMetrics(newMetrics); });
+    }
+}
+
+/**
+ * @brief Returns the depth and loss counters of the send queues of all workers.
+ * @return The counters.
+ */
+SendQueue::Stats LanTcpServer::sendQueueStats() const {
+    SendQueue::Stats total;
+    for (const LanTcpWorker *worker : std::as_const(workers)) {
+        const SendQueue::Stats stats = worker->sendQueueStats();
+        total.queuedBytes += stats.queuedBytes;
+        total.queuedFrames += stats.queuedFrames;
+        total.droppedFrames += stats.droppedFrames;
+        total.slowConsumerDisconnects += stats.slowConsumerDisconnects;
+    }
+    return total;
+}
+
+/**
+ * @brief Requires a message from each of several sessions within a deadline.
+ *
+ * Each worker receives a single call carrying its sessions.
+ *
+ * @param sessionIds The session IDs of the players.
+ * @param timeoutMs The deadline in milliseconds.
+ */
+void LanTcpServer::expectMessage(const QVector<quint32> &sessionIds, int timeoutMs) {
+    if (sessionIds.isEmpty() || timeoutMs <= 0) return;
+
+    const QHash<LanTcpWorker*, QVector<quint32>> sessionsOfWorker = groupByWorker(sessionIds);
+    for (auto it = sessionsOfWorker.constBegin(); it != sessionsOfWorker.constEnd(); ++it) {
+        LanTcpWorker *worker = it.key();
+        const QVector<quint32> sessions = it.value();
+        QMetaObject::invokeMethod(worker, [worker, sessions, timeoutMs] { worker->expectMessage(sessions, timeoutMs); });
+    }
+}
+
+/**
+ * @brief Meets the pending deadline of a session.
+ * @param sessionId The session ID of the player.
+ */
+void LanTcpServer::fulfilMessage(quint32 sessionId) {
+    LanTcpWorker *worker = workerOfSession.value(sessionId);
+    if (!worker) return;
+
+    QMetaObject::invokeMethod(worker, [worker, sessionId] { worker->fulfilMessage(sessionId); });
+}
+
+/**
+ * @brief Groups sessions by the worker that owns them.
+ * @param sessionIds The session IDs; unknown sessions are skipped.
+ * @return The sessions of every involved worker.
+ */
+QHash<LanTcpWorker*, QVector<quint32>> LanTcpServer::groupByWorker(const QVector<quint32> &sessionIds) const {
+    QHash<LanTcpWorker*, QVector<quint32>> sessionsOfWorker;
+    for (quint32 sessionId : sessionIds) {
+        if (LanTcpWorker *worker = workerOfSession.value(sessionId)) {
+            sessionsOfWorker[worker].append(sessionId);
         }
     }
+    return sessionsOfWorker;
 }
@@ -0,0 +1,490 @@
+#include "LanTcpWorker.h"
+#include "Trace.h"
+#include <QDebug>
+#include <QHostAddress>
+#include <QMetaObject>
+
+/**
+ * @brief Constructs a socket worker.
+ * @param parent The parent QObject.
+ */
+LanTcpWorker::LanTcpWorker(QObject *parent)
+    : QObject(parent), timers(TIMER_TICK_MS), tickTimer(this) {
+    // The timer is a child so it follows the worker into its thread
+    connect(&tickTimer, &QTimer::timeout, this, &LanTcpWorker::onTimerTick);
+    clock.start();
+}
+
+/**
+ * @brief Returns the number of connections assigned to this worker.
+ * @return The number of assigned connections.
+ */
+int LanTcpWorker::connectionCount() const {
+    return connections.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Reserves a connection slot for a descriptor that is about to be handed over.
+ */
+void LanTcpWorker::reserveConnection() {
+    connections.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the depth and loss counters of the send queues of this worker.
+ * @return The counters.
+ */
+SendQueue::Stats LanTcpWorker::sendQueueStats() const {
+    SendQueue::Stats stats;
+    stats.queuedBytes = sendCounters.queuedBytes.load(std::memory_order_relaxed);
+    stats.queuedFrames = sendCounters.queuedFrames.load(std::memory_order_relaxed);
+    stats.droppedFrames = sendCounters.droppedFrames.load(std::memory_order_relaxed);
+    stats.slowConsumerDisconnects = sendCounters.slowConsumerDisconnects.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * @brief Wraps an accepted descriptor into a socket owned by this worker.
+ *
+ * @param socketDescriptor The descriptor of the new connection.
+ * @param sessionId The session ID assigned to the connection by the server.
+ */
+void LanTcpWorker::addConnection(qintptr socketDescriptor, quint32 sessionId) {
+    auto *socket = new QTcpSocket(this);
+    if (!socket->setSocketDescriptor(socketDescriptor)) {
+        connections.fetch_sub(1, std::memory_order_relaxed);
+        socket->deleteLater();
+        return;
+    }
+
+    connect(socket, &QTcpSocket::readyRead, this, &LanTcpWorker::onReadyRead);
+    connect(socket, &QTcpSocket::disconnected, this, &LanTcpWorker::onClientDisconnected);
+    connect(socket, &QTcpSocket::bytesWritten, this, &LanTcpWorker::onBytesWritten);
+
+    Connection connection;
+    connection.player = createPlayerFromSocket(socket, sessionId);
+    connection.sendQueue = SendQueue(&sendLimits, &sendCounters);
+    connection.lastReceiveMs = clock.elapsed();
+    connectionsBySocket.insert(socket, connection);
+    socketsBySession.insert(sessionId, socket);
+    startTimers(sessionId);
+    if (metrics) metrics->add(Metrics::Counter::ConnectionsAccepted);
+
+    emit playerConnected(connection.player);
+}
+
+/**
+ * @brief Creates a PlayerConnection object from a socket.
+ *
+ * @param socket The socket associated with the player.
+ * @param sessionId The session ID assigned to the connection.
+ * @return The generated PlayerConnection object.
+ */
+PlayerConnection LanTcpWorker::createPlayerFromSocket(QTcpSocket *socket, quint32 sessionId) {
+    QHostAddress ip = socket->peerAddress();
+    QString playerName = QString("Player_%1").arg(ip.toString().right(5));
+    return PlayerConnection(playerName, ip, false, sessionId);
+}
+
+/**
+ * @brief Reads incoming data from a client and emits one message per complete frame.
+ *
+ * Partial frames stay in the socket's reassembly buffer until the rest arrives.
+ * Empty frames are heartbeats: they only keep the connection alive.
+ * A client that sends an oversized frame is disconnected.
+ */
+void LanTcpWorker::onReadyRead() {
+    TRACE_SCOPE("net", "LanTcpWorker::onReadyRead");
+    auto *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    auto it = connectionsBySocket.find(socket);
+    if (it == connectionsBySocket.end()) return;
+
+    if (metrics) metrics->add(Metrics::Counter::BytesReceived, static_cast<quint64>(qMax<qint64>(0, socket->bytesAvailable())));
+    if (!it->framer.readFrom(socket)) {
+        socket->disconnectFromHost();
+        return;
+    }
+    it->lastReceiveMs = clock.elapsed();
+
+    const PlayerConnection player = it->player;
+    QByteArray message;
+    while (true) {
+        // A receiver may disconnect the player synchronously, so look the socket up again
+        it = connectionsBySocket.find(socket);
+        if (it == connectionsBySocket.end()) return;
+
+        if (!it->framer.nextFrame(message)) break;
+        if (message.isEmpty()) continue;
+
+        if (metrics) metrics->countMessage(Metrics::Direction::Received, message);
+        emit messageReceived(player, message);
+    }
+
+    if (it->framer.hasError()) {
+        qDebug() << "Oversized frame from" << player.playerName << "- disconnecting";
+        socket->disconnectFromHost();
+    }
+}
+
+/**
+ * @brief Handles player disconnections.
+ */
+void LanTcpWorker::onClientDisconnected() {
+    auto *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    auto it = connectionsBySocket.find(socket);
+    if (it == connectionsBySocket.end()) return;
+
+    const PlayerConnection player = it.value().player;
+    it->sendQueue.clear();
+    connectionsBySocket.erase(it);
+    socketsBySession.remove(player.sessionId);
+    cancelTimers(player.sessionId);
+    connections.fetch_sub(1, std::memory_order_relaxed);
+    if (metrics) metrics->add(Metrics::Counter::ConnectionsClosed);
+    if (connectionsBySocket.isEmpty()) tickTimer.stop();
+    emit playerDisconnected(player);
+
+    socket->deleteLater();
+}
+
+/**
+ * @brief Counts the written bytes and writes queued frames once a socket's backlog drains.
+ * @param bytes The number of bytes written.
+ */
+void LanTcpWorker::onBytesWritten(qint64 bytes) {
+    if (metrics) metrics->add(Metrics::Counter::BytesSent, static_cast<quint64>(bytes));
+
+    auto *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    auto it = connectionsBySocket.find(socket);
+    if (it == connectionsBySocket.end() || it->sendQueue.isEmpty()) return;
+
+    flush(socket, it.value());
+}
+
+/**
+ * @brief Writes a frame to a socket, or queues it while the socket's backlog is too large.
+ *
+ * Frames bypass the queue while it is empty and the backlog is small; bulk
+ * frames only while the socket is idle. A control frame that overflows the
+ * queue under the Disconnect policy aborts the connection and discards its
+ * unsent data.
+ *
+ * @param socket The socket.
+ * @param connection The state of the socket.
+ * @param priority The priority class of the frame.
+ * @param frame The framed message.
+ */
+void LanTcpWorker::send(QTcpSocket *socket, Connection &connection, SendQueue::Priority priority,
+                        const QByteArray &frame) {
+    if (connection.overflowed) return;
+
+    const qint64 backlog = socket->bytesToWrite();
+    if (connection.sendQueue.isEmpty() && backlog < WRITE_WATERMARK_BYTES
+        && (priority != SendQueue::Priority::Bulk || backlog == 0)) {
+        socket->write(frame);
+        return;
+    }
+
+    if (connection.sendQueue.push(priority, frame) != SendQueue::Result::Overflow) return;
+
+    qDebug() << connection.player.playerName << "reads too slowly - disconnecting";
+    connection.overflowed = true;
+    connection.sendQueue.clear();
+    sendCounters.slowConsumerDisconnects.fetch_add(1, std::memory_order_relaxed);
+
+    // A stalled peer would never let a graceful close finish. The abort is
+    // queued because it reports the disconnection synchronously.
+    QMetaObject::invokeMethod(socket, [socket] { socket->abort(); }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief Writes queued frames to a socket until its backlog reaches the watermark.
+ *
+ * Bulk frames are written one at a time and only to an idle socket, so a
+ * frame of round traffic waits behind at most one of them.
+ *
+ * @param socket The socket.
+ * @param connection The state of the socket.
+ */
+void LanTcpWorker::flush(QTcpSocket *socket, Connection &connection) {
+    TRACE_SCOPE("net", "LanTcpWorker::flush");
+    QByteArray frame;
+    qint64 backlog = socket->bytesToWrite();
+    while (backlog < WRITE_WATERMARK_BYTES && connection.sendQueue.pop(frame, backlog == 0)) {
+        socket->write(frame);
+        backlog = socket->bytesToWrite();
+    }
+}
+
+/**
+ * @brief Disconnects the player of a session.
+ *
+ * @param sessionId The session ID of the player.
+ */
+void LanTcpWorker::disconnectPlayer(quint32 sessionId) {
+    if (QTcpSocket *socket = socketsBySession.value(sessionId)) {
+        socket->disconnectFromHost();
+    }
+}
+
+/**
+ * @brief Sends a framed message to all players of this worker.
+ *
+ * @param frame The framed message.
+ */
+void LanTcpWorker::sendFrameToAll(const QByteArray &frame) {
+    for (auto it = connectionsBySocket.begin(); it != connectionsBySocket.end(); ++it) {
+        send(it.key(), it.value(), SendQueue::Priority::Control, frame);
+    }
+}
+
+/**
+ * @brief Sends a framed message to the player of a session.
+ *
+ * @param sessionId The session ID of the recipient.
+ * @param frame The framed message.
+ */
+void LanTcpWorker::sendFrameToPlayer(quint32 sessionId, const QByteArray &frame) {
+    QTcpSocket *socket = socketsBySession.value(sessionId);
+    auto it = connectionsBySocket.find(socket);
+    if (it != connectionsBySocket.end()) {
+        send(socket, it.value(), SendQueue::Priority::Control, frame);
+    }
+}
+
+/**
+ * @brief Sends a framed message to the players of several sessions.
+ *
+ * @param sessionIds The session IDs of the recipients.
+ * @param frame The framed message.
+ */
+void LanTcpWorker::sendFrameToPlayers(const QVector<quint32> &sessionIds, const QByteArray &frame) {
+    for (quint32 sessionId : sessionIds) {
+        sendFrameToPlayer(sessionId, frame);
+    }
+}
+
+/**
+ * @brief Sends a framed snapshot to the players of several sessions.
+ *
+ * A recipient with a backlog keeps only the newest queued snapshot, so
+ * skipped snapshots cost no memory.
+ *
+ * @param sessionIds The session IDs of the recipients.
+ * @param frame The framed snapshot.
+ */
+void LanTcpWorker::sendSnapshotToPlayers(const QVector<quint32> &sessionIds, const QByteArray &frame) {
+    for (quint32 sessionId : sessionIds) {
+        QTcpSocket *socket = socketsBySession.value(sessionId);
+        auto it = connectionsBySocket.find(socket);
+        if (it != connectionsBySocket.end()) {
+            send(socket, it.value(), SendQueue::Priority::Snapshot, frame);
+        }
+    }
+}
+
+/**
+ * @brief Sends a framed low-priority message to the players of several sessions.
+ *
+ * The frame is written at once to idle sockets and queued as bulk traffic
+ * for the others.
+ *
+ * @param sessionIds The session IDs of the recipients.
+ * @param frame The framed message.
+ */
+void LanTcpWorker::sendLowPriorityToPlayers(const QVector<quint32> &sessionIds, const QByteArray &frame) {
+    for (quint32 sessionId : sessionIds) {
+        QTcpSocket *socket = socketsBySession.value(sessionId);
+        auto it = connectionsBySocket.find(socket);
+        if (it != connectionsBySocket.end()) {
+            send(socket, it.value(), SendQueue::Priority::Bulk, frame);
+        }
+    }
+}
+
+/**
+ * @brief Disconnects every client of this worker and schedules their sockets for deletion.
+ */
+void LanTcpWorker::closeAll() {
+    const QList<QTcpSocket *> sockets = connectionsBySocket.keys();
+
+    // Forget the sockets first so their disconnected signals are ignored
+    if (metrics) metrics->add(Metrics::Counter::ConnectionsClosed, static_cast<quint64>(sockets.size()));
+    connectionsBySocket.clear();
+    socketsBySession.clear();
+    connections.store(0, std::memory_order_relaxed);
+    sendCounters.queuedBytes.store(0, std::memory_order_relaxed);
+    sendCounters.queuedFrames.store(0, std::memory_order_relaxed);
+    timers.clear();
+    tickTimer.stop();
+
+    for (QTcpSocket *socket : sockets) {
+        socket->disconnectFromHost();
+        socket->deleteLater();
+    }
+}
+
+/**
+ * @brief Applies new heartbeat and idle settings.
+ * @param newTimeouts The connection timeouts.
+ */
+void LanTcpWorker::setTimeouts(const ConnectionTimeouts &newTimeouts) {
+    timeouts = newTimeouts;
+}
+
+/**
+ * @brief Applies new send queue limits to every connection.
+ *
+ * The queues refer to the worker's limits, so frames already queued beyond
+ * new, lower limits are written rather than discarded.
+ *
+ * @param limits The limits.
+ */
+void LanTcpWorker::setSendQueueLimits(const SendQueueLimits &limits) {
+    sendLimits = limits;
+}
+
+/**
+ * @brief Records connection, traffic and message counters.
+ * @param newMetrics The metrics; nullptr stops recording.
+ */
+void LanTcpWorker::setMetrics(Metrics *newMetrics) {
+    metrics = newMetrics;
+}
+
+/**
+ * @brief Requires a message from each of several sessions within a deadline.
+ *
+ * @param sessionIds The session IDs owned by this worker.
+ * @param timeoutMs The deadline in milliseconds.
+ */
+void LanTcpWorker::expectMessage(const QVector<quint32> &sessionIds, int timeoutMs) {
+    for (quint32 sessionId : sessionIds) {
+        auto it = connectionsBySocket.find(socketsBySession.value(sessionId));
+        if (it == connectionsBySocket.end()) continue;
+
+        it->awaitingMessage = true;
+        timers.schedule(timerKey(TimerKind::Deadline, sessionId), timeoutMs);
+    }
+}
+
+/**
+ * @brief Marks the expected message of a session as received and cancels its deadline.
+ * @param sessionId The session ID owned by this worker.
+ */
+void LanTcpWorker::fulfilMessage(quint32 sessionId) {
+    auto it = connectionsBySocket.find(socketsBySession.value(sessionId));
+    if (it == connectionsBySocket.end() || !it->awaitingMessage) return;
+
+    it->awaitingMessage = false;
+    timers.cancel(timerKey(TimerKind::Deadline, sessionId));
+}
+
+/**
+ * @brief Builds the timer wheel key of a connection timer.
+ *
+ * The kind occupies the upper half of the key, the session ID the lower half.
+ *
+ * @param kind The kind of timer.
+ * @param sessionId The session ID of the connection.
+ * @return The key.
+ */
+quint64 LanTcpWorker::timerKey(TimerKind kind, quint32 sessionId) {
+    return (quint64(kind) << 32) | sessionId;
+}
+
+/**
+ * @brief Starts the heartbeat and idle timers of a new connection.
+ * @param sessionId The session ID of the connection.
+ */
+void LanTcpWorker::startTimers(quint32 sessionId) {
+    if (!tickTimer.isActive()) {
+        // Catch the idle wheel up with the clock before scheduling relative to it
+        timers.advanceTo(clock.elapsed(), expiredKeys);
+        tickTimer.start(TIMER_TICK_MS);
+    }
+
+    if (timeouts.heartbeatIntervalMs > 0) {
+        timers.schedule(timerKey(TimerKind::Heartbeat, sessionId), timeouts.heartbeatIntervalMs);
+    }
+    if (timeouts.idleTimeoutMs > 0) {
+        timers.schedule(timerKey(TimerKind::Idle, sessionId), timeouts.idleTimeoutMs);
+    }
+}
+
+/**
+ * @brief Cancels every timer of a connection.
+ * @param sessionId The session ID of the connection.
+ */
+void LanTcpWorker::cancelTimers(quint32 sessionId) {
+    timers.cancel(timerKey(TimerKind::Heartbeat, sessionId));
+    timers.cancel(timerKey(TimerKind::Idle, sessionId));
+    timers.cancel(timerKey(TimerKind::Deadline, sessionId));
+}
+
+/**
+ * @brief Advances the timer wheel and handles the expired connection timers.
+ */
+void LanTcpWorker::onTimerTick() {
+    expiredKeys.resize(0);
+    timers.advanceTo(clock.elapsed(), expiredKeys);
+
+    for (quint64 key : std::as_const(expiredKeys)) {
+        handleTimer(key);
+    }
+}
+
+/**
+ * @brief Handles one expired connection timer.
+ *
+ * Received data does not touch the wheel; an expired idle timer compares the
+ * time of the last received data and is rescheduled for the remaining time
+ * if the peer was heard from in the meantime. Idle time is not held against
+ * a player whose move deadline is pending.
+ *
+ * @param key The key of the expired timer.
+ */
+void LanTcpWorker::handleTimer(quint64 key) {
+    const auto kind = static_cast<TimerKind>(key >> 32);
+    const auto sessionId = static_cast<quint32>(key);
+
+    QTcpSocket *socket = socketsBySession.value(sessionId);
+    auto it = connectionsBySocket.find(socket);
+    if (it == connectionsBySocket.end()) return;
+
+    switch (kind) {
+    case TimerKind::Heartbeat:
+        if (timeouts.heartbeatIntervalMs <= 0) return;
+        send(socket, it.value(), SendQueue::Priority::Control, MessageFramer::heartbeatFrame());
+        timers.schedule(key, timeouts.heartbeatIntervalMs);
+        break;
+    case TimerKind::Idle: {
+        if (timeouts.idleTimeoutMs <= 0) return;
+        // The move deadline governs a player who is expected to answer, and
+        // data still waiting to be read means the peer was heard from
+        if (it->awaitingMessage || socket->bytesAvailable() > 0) {
+            timers.schedule(key, timeouts.idleTimeoutMs);
+            return;
+        }
+        const qint64 silentMs = clock.elapsed() - it->lastReceiveMs;
+        if (silentMs < timeouts.idleTimeoutMs) {
+            timers.schedule(key, timeouts.idleTimeoutMs - silentMs);
+            return;
+        }
+        qDebug() << it->player.playerName << "timed out after" << silentMs << "ms of silence";
+        socket->disconnectFromHost();
+        break;
+    }
+    case TimerKind::Deadline:
+        if (!it->awaitingMessage) return;
+        qDebug() << it->player.playerName << "missed its message deadline";
+        socket->disconnectFromHost();
+        break;
+    }
+}
@@ -0,0 +1,123 @@
+#include "LoadBot.h"
+#include "GameRules.h"
+#include "Protocol.h"
+#include <QRandomGenerator>
+#include <QTimer>
+#include <limits>
+
+/**
+ * @brief Constructs a bot.
+ * @param host The address of the server.
+ * @param port The TCP port of the server.
+ * @param lobbyId The lobby to join; 0 joins any open lobby.
+ * @param thinkTimeMs The maximum delay before a move.
+ * @param rounds The number of rounds to play; 0 plays until stopped.
+ * @param parent The parent QObject.
+ */
+LoadBot::LoadBot(const QHostAddress &host, quint16 port, quint32 lobbyId, int thinkTimeMs, int rounds,
+                 QObject *parent)
+    : QObject(parent), client(std::make_unique<LanTcpClient>(this)),
+      serverAddress(host), serverPort(port), joinLobbyId(lobbyId),
+      playerKey(QRandomGenerator::global()->bounded(1u, std::numeric_limits<quint32>::max())),
+      thinkTime(qMax(0, thinkTimeMs)), roundsLeft(rounds > 0 ? rounds : -1) {
+
+    connect(client.get(), &LanTcpClient::connected, this, &LoadBot::onConnected);
+    connect(client.get(), &LanTcpClient::disconnected, this, &LoadBot::onDisconnected);
+    connect(client.get(), &LanTcpClient::messageReceived, this, &LoadBot::onMessageReceived);
+    connect(client.get(), &LanTcpClient::connectionError, this, [this](const QString &error) {
+        if (stopping || done) return;
+        emit failed(error);
+        finish();
+    });
+}
+
+/**
+ * @brief Connects to the server and starts playing.
+ */
+void LoadBot::start() {
+    connectTimer.start();
+    client->connectToServer(serverAddress, LobbyInfo(QString(), 0, 0, serverPort, joinLobbyId));
+}
+
+/**
+ * @brief Disconnects from the server.
+ */
+void LoadBot::stop() {
+    stopping = true; // A requested stop is not reported as a failure
+    client->disconnectFromServer();
+}
+
+/**
+ * @brief Sends the join handshake and reports the connection time.
+ */
+void LoadBot::onConnected() {
+    emit connected(connectTimer.nsecsElapsed() / 1000);
+    client->sendMessages({Protocol::encode(Protocol::Opcode::Identify, playerKey),
+                          Protocol::encode(Protocol::Opcode::Join, joinLobbyId)});
+}
+
+/**
+ * @brief Answers a round start with a move and a result with a new join.
+ * @param msg The received message.
+ */
+void LoadBot::onMessageReceived(const QByteArray &msg) {
+    Protocol::Message message;
+    if (!Protocol::decode(msg, message)) return;
+
+    switch (message.opcode) {
+    case Protocol::Opcode::Start:
+        if (thinkTime == 0) {
+            makeChoice();
+        } else {
+            QTimer::singleShot(QRandomGenerator::global()->bounded(thinkTime + 1), this, &LoadBot::makeChoice);
+        }
+        break;
+    case Protocol::Opcode::Win:
+    case Protocol::Opcode::Lose:
+    case Protocol::Opcode::Draw:
+        emit roundFinished(choiceTimer.nsecsElapsed() / 1000);
+
+        if (roundsLeft > 0 && --roundsLeft == 0) {
+            stop();
+            finish();
+            return;
+        }
+
+        // The dedicated server empties a lobby after every round, so join again
+        client->sendMessage(Protocol::encode(Protocol::Opcode::Join, joinLobbyId));
+        break;
+    case Protocol::Opcode::Ping:
+        client->sendMessage(Protocol::encode(Protocol::Opcode::Pong, message.value));
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Reports the end of the bot's session.
+ */
+void LoadBot::onDisconnected() {
+    if (!stopping && !done) {
+        emit failed("Disconnected by the server");
+    }
+    finish();
+}
+
+/**
+ * @brief Sends a random move to the server.
+ */
+void LoadBot::makeChoice() {
+    const int choice = QRandomGenerator::global()->bounded(GameRules::Rock, GameRules::Scissors + 1);
+    choiceTimer.start();
+    client->sendMessage(Protocol::encode(Protocol::Opcode::Choice, static_cast<quint32>(choice)));
+}
+
+/**
+ * @brief Marks the bot as finished and emits finished() once.
+ */
+void LoadBot::finish() {
+    if (done) return;
+    done = true;
+    emit finished();
+}
@@ -0,0 +1,153 @@
+#include "LoadGenerator.h"
+#include <QDebug>
+#include <algorithm>
+
+/**
+ * @brief Constructs a load generator.
+ * @param config The settings of the run.
+ * @param parent The parent QObject.
+ */
+LoadGenerator::LoadGenerator(const Config &config, QObject *parent)
+    : QObject(parent), config(config) {
+    connect(&spawnTimer, &QTimer::timeout, this, &LoadGenerator::onSpawnBots);
+    connect(&reportTimer, &QTimer::timeout, this, &LoadGenerator::onReport);
+
+    durationTimer.setSingleShot(true);
+    connect(&durationTimer, &QTimer::timeout, this, &LoadGenerator::stop);
+}
+
+/**
+ * @brief Starts spawning bots and reporting.
+ */
+void LoadGenerator::start() {
+    running = true;
+    bots.reserve(config.bots);
+
+    runTimer.start();
+    intervalTimer.start();
+
+    // Spawn in ten batches per second so the ramp-up is smooth
+    spawnTimer.start(100);
+    onSpawnBots();
+
+    reportTimer.start(config.reportIntervalMs);
+    if (config.durationSec > 0) {
+        durationTimer.start(config.durationSec * 1000);
+    }
+
+    qDebug().noquote() << QString("Starting %1 bots against %2:%3")
+                              .arg(config.bots).arg(config.host.toString()).arg(config.port);
+}
+
+/**
+ * @brief Stops every bot and prints the summary of the run.
+ */
+void LoadGenerator::stop() {
+    if (!running) return;
+    running = false;
+
+    spawnTimer.stop();
+    reportTimer.stop();
+    durationTimer.stop();
+
+    for (LoadBot *bot : std::as_const(bots)) {
+        bot->stop();
+    }
+
+    printStats("total", runTimer.elapsed() / 1000.0, totalConnects, totalRounds, totalLatencies);
+    qDebug().noquote() << QString("bots=%1 failures=%2").arg(bots.size()).arg(failures);
+
+    emit finished();
+}
+
+/**
+ * @brief Starts the next batch of bots.
+ */
+void LoadGenerator::onSpawnBots() {
+    const int batch = qMax(1, config.spawnRate / 10);
+
+    for (int i = 0; i < batch && bots.size() < config.bots; ++i) {
+        auto *bot = new LoadBot(config.host, config.port, config.lobbyId, config.thinkTimeMs, config.rounds, this);
+
+        connect(bot, &LoadBot::connected, this, [this](qint64) {
+            ++intervalConnects;
+            ++totalConnects;
+        });
+        connect(bot, &LoadBot::roundFinished, this, [this](qint64 latencyUs) {
+            ++intervalRounds;
+            ++totalRounds;
+            intervalLatencies.append(latencyUs);
+            totalLatencies.append(latencyUs);
+        });
+        connect(bot, &LoadBot::failed, this, [this](const QString &) {
+            ++failures;
+        });
+        connect(bot, &LoadBot::finished, this, &LoadGenerator::onBotFinished);
+
+        bots.append(bot);
+        bot->start();
+    }
+
+    if (bots.size() >= config.bots) {
+        spawnTimer.stop();
+    }
+}
+
+/**
+ * @brief Prints the statistics of the last report interval.
+ */
+void LoadGenerator::onReport() {
+    const double seconds = intervalTimer.restart() / 1000.0;
+    printStats(QString("t=%1s").arg(runTimer.elapsed() / 1000), seconds,
+               intervalConnects, intervalRounds, intervalLatencies);
+
+    intervalConnects = 0;
+    intervalRounds = 0;
+    intervalLatencies.clear();
+}
+
+/**
+ * @brief Counts a finished bot and ends the run when the last one is done.
+ */
+void LoadGenerator::onBotFinished() {
+    ++finishedBots;
+    if (finishedBots == config.bots && running) {
+        stop();
+    }
+}
+
+/**
+ * @brief Prints one line of statistics.
+ * @param label The label of the line.
+ * @param seconds The length of the measured period.
+ * @param connects The number of connects in the period.
+ * @param rounds The number of rounds in the period.
+ * @param latencies The move-to-result latencies of the period.
+ */
+void LoadGenerator::printStats(const QString &label, double seconds, qint64 connects, qint64 rounds,
+                               QVector<qint64> &latencies) const {
+    if (seconds <= 0) seconds = 1;
+
+    qDebug().noquote() << QString("%1 connects/s=%2 rounds/s=%3 latency_us p50=%4 p90=%5 p99=%6 max=%7")
+                              .arg(label)
+                              .arg(connects / seconds, 0, 'f', 1)
+                              .arg(rounds / seconds, 0, 'f', 1)
+                              .arg(percentile(latencies, 0.50))
+                              .arg(percentile(latencies, 0.90))
+                              .arg(percentile(latencies, 0.99))
+                              .arg(percentile(latencies, 1.0));
+}
+
+/**
+ * @brief Returns a percentile of a set of samples.
+ * @param samples The samples; they are partially reordered.
+ * @param fraction The percentile as a fraction between 0 and 1.
+ * @return The sample at the percentile, or 0 if there are no samples.
+ */
+qint64 LoadGenerator::percentile(QVector<qint64> &samples, double fraction) {
+    if (samples.isEmpty()) return 0;
+
+    const int index = qBound(0, static_cast<int>(fraction * (samples.size() - 1) + 0.5), int(samples.size()) - 1);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
@@ -0,0 +1,103 @@
+#include "LobbyAnnouncement.h"
+#include "WireFormat.h"
+
+namespace LobbyAnnouncement {
+
+namespace {
+
+/**
+ * @brief Starts a merged datagram with a placeholder record count.
+ * @param datagram The empty datagram.
+ */
+void beginDatagram(QByteArray &datagram) {
+    datagram.reserve(MAX_DATAGRAM_SIZE);
+    WireFormat::Writer out(datagram, HEADER_SIZE);
+    out.writeU32(BATCH_MARKER);
+    out.writeU8(VERSION);
+    out.writeU16(0);
+}
+
+/**
+ * @brief Writes the final record count into the header of a merged datagram.
+ * @param datagram The datagram.
+ * @param count The number of records.
+ */
+void finishDatagram(QByteArray &datagram, quint16 count) {
+    qToBigEndian<quint16>(count, datagram.data() + 5);
+}
+
+} // namespace
+
+/**
+ * @brief Packs serialized lobby announcements into merged datagrams.
+ * @param records The serialized LobbyInfo of every announced lobby.
+ * @return The datagrams to send.
+ */
+QList<QByteArray> pack(const QMap<quint32, QByteArray> &records) {
+    QList<QByteArray> datagrams;
+    QByteArray current;
+    quint16 count = 0;
+
+    for (const QByteArray &record : records) {
+        const int recordSize = 2 + static_cast<int>(record.size());
+
+        if (count > 0 && current.size() + recordSize > MAX_DATAGRAM_SIZE) {
+            finishDatagram(current, count);
+            datagrams.append(current);
+            current.clear();
+            count = 0;
+        }
+        if (count == 0) {
+            beginDatagram(current);
+        }
+
+        WireFormat::Writer out(current, 2);
+        out.writeU16(static_cast<quint16>(record.size()));
+        current.append(record);
+        ++count;
+    }
+
+    if (count > 0) {
+        finishDatagram(current, count);
+        datagrams.append(current);
+    }
+    return datagrams;
+}
+
+/**
+ * @brief Decodes a received announcement datagram.
+ * @param datagram The datagram payload.
+ * @param lobbies Receives the announced lobbies.
+ * @return False if the datagram is malformed.
+ */
+bool unpack(const QByteArray &datagram, QVector<LobbyInfo> &lobbies) {
+    lobbies.clear();
+
+    WireFormat::Reader in(datagram.constData(), datagram.size());
+    if (in.readU32() != BATCH_MARKER) {
+        // A single bare LobbyInfo from an older host
+        LobbyInfo info;
+        if (!info.deserialize(datagram.constData(), datagram.size())) return false;
+        lobbies.append(info);
+        return true;
+    }
+
+    if (in.readU8() != VERSION) return false;
+    const quint16 count = in.readU16();
+    lobbies.reserve(count);
+
+    qsizetype offset = HEADER_SIZE;
+    for (quint16 i = 0; i < count; ++i) {
+        WireFormat::Reader lengthReader(datagram.constData() + offset, datagram.size() - offset);
+        const quint16 size = lengthReader.readU16();
+        if (!lengthReader.ok() || offset + 2 + size > datagram.size()) return false;
+
+        LobbyInfo info;
+        if (!info.deserialize(datagram.constData() + offset + 2, size)) return false;
+        lobbies.append(info);
+        offset += 2 + size;
+    }
+    return in.ok();
+}
+
+} // namespace LobbyAnnouncement
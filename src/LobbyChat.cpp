@@ -0,0 +1,166 @@
+#include "LobbyChat.h"
+#include "ChatMessage.h"
+#include "Protocol.h"
+
+/**
+ * @brief Constructs a chat sending through a server.
+ * @param server The server of the member connections.
+ * @param parent The parent QObject.
+ */
+LobbyChat::LobbyChat(LanTcpServer *server, QObject *parent)
+    : QObject(parent), server(server), history(HISTORY_SIZE) {
+    connect(&tickTimer, &QTimer::timeout, this, &LobbyChat::onTick);
+    clock.start();
+}
+
+/**
+ * @brief Makes a connection a member of the chat and sends it the history.
+ *
+ * Messages still waiting for the next tick are left out of the history
+ * frame; the new member receives them with the tick like everyone else.
+ *
+ * @param sessionId The session ID of the new member.
+ */
+void LobbyChat::addMember(quint32 sessionId) {
+    if (members.contains(sessionId)) return;
+
+    Member member;
+    member.index = memberSessions.size();
+    member.refilledMs = clock.elapsed();
+    members.insert(sessionId, member);
+    memberSessions.append(sessionId);
+
+    const int sent = historyCount - pendingCount;
+    if (sent <= 0) return;
+
+    QByteArray records;
+    for (int i = 0; i < sent; ++i) {
+        records.append(history[(historyStart + i) % HISTORY_SIZE]);
+    }
+    server->sendLowPriorityToPlayers({sessionId}, Protocol::encodeChatRecords(records));
+}
+
+/**
+ * @brief Removes a connection from the chat.
+ *
+ * The last member takes the freed index, so only one index entry changes.
+ *
+ * @param sessionId The session ID of the member.
+ * @return True if the connection was a member.
+ */
+bool LobbyChat::removeMember(quint32 sessionId) {
+    const auto it = members.constFind(sessionId);
+    if (it == members.constEnd()) return false;
+
+    const int index = it->index;
+    members.erase(it);
+
+    const quint32 moved = memberSessions.takeLast();
+    if (moved != sessionId) {
+        memberSessions[index] = moved;
+        members[moved].index = index;
+    }
+    return true;
+}
+
+/**
+ * @brief Returns the number of members.
+ * @return The number of members.
+ */
+int LobbyChat::memberCount() const {
+    return memberSessions.size();
+}
+
+/**
+ * @brief Accepts the chat messages of a received chat frame.
+ *
+ * The sender name is replaced by the name of the connection and the text is
+ * trimmed to MAX_TEXT_LENGTH characters. Empty messages, messages of
+ * non-members and messages beyond the sender's rate limit are dropped.
+ *
+ * @param player The sender.
+ * @param frame The payload of the received chat frame.
+ */
+void LobbyChat::post(const PlayerConnection &player, const QByteArray &frame) {
+    const auto it = members.find(player.sessionId);
+    if (it == members.end()) return;
+
+    QVector<ChatMessage> messages;
+    if (!Protocol::decodeChat(frame, messages)) return;
+
+    for (ChatMessage &message : messages) {
+        message.message = message.message.trimmed().left(MAX_TEXT_LENGTH);
+        if (message.message.isEmpty()) continue;
+        if (!takeToken(it.value())) return;
+
+        message.sender = player.playerName;
+        QByteArray record;
+        message.serializeInto(record);
+        pending.append(record);
+        ++pendingCount;
+        remember(record);
+    }
+
+    if (pendingCount > 0 && !tickTimer.isActive()) tickTimer.start(TICK_MS);
+}
+
+/**
+ * @brief Removes every member and forgets the history.
+ */
+void LobbyChat::clear() {
+    tickTimer.stop();
+    members.clear();
+    memberSessions.clear();
+    historyStart = 0;
+    historyCount = 0;
+    pending.clear();
+    pendingCount = 0;
+}
+
+/**
+ * @brief Sends the messages posted since the last tick to every member.
+ *
+ * The messages are framed once and shared by all members.
+ */
+void LobbyChat::onTick() {
+    tickTimer.stop();
+    if (pendingCount == 0) return;
+
+    server->sendLowPriorityToPlayers(memberSessions, Protocol::encodeChatRecords(pending));
+    pending.clear();
+    pendingCount = 0;
+}
+
+/**
+ * @brief Takes one token of a member's bucket.
+ *
+ * Tokens are refilled lazily for the whole intervals since the last refill.
+ *
+ * @param member The member.
+ * @return False if the bucket is empty.
+ */
+bool LobbyChat::takeToken(Member &member) {
+    const qint64 now = clock.elapsed();
+    const qint64 earned = (now - member.refilledMs) / REFILL_MS;
+    if (earned > 0) {
+        member.tokens = static_cast<int>(qMin<qint64>(BURST_MESSAGES, member.tokens + earned));
+        member.refilledMs = member.tokens == BURST_MESSAGES ? now : member.refilledMs + earned * REFILL_MS;
+    }
+
+    if (member.tokens == 0) return false;
+    --member.tokens;
+    return true;
+}
+
+/**
+ * @brief Appends a serialized message to the history, replacing the oldest one when full.
+ * @param record The serialized message.
+ */
+void LobbyChat::remember(const QByteArray &record) {
+    if (historyCount < HISTORY_SIZE) {
+        history[(historyStart + historyCount++) % HISTORY_SIZE] = record;
+    } else {
+        history[historyStart] = record;
+        historyStart = (historyStart + 1) % HISTORY_SIZE;
+    }
+}
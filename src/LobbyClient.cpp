@@ -1,28 +1,100 @@
 #include "LobbyClient.h"
+#include "Protocol.h"
+#include "Trace.h"
 #include <QDebug>
+#include <QNetworkInterface>
+#include <QRandomGenerator>
+#include <QSettings>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief Returns the stable key of the local player, creating it on first use.
+ *
+ * The key is stored in the user's settings, so ratings and the match log of
+ * a host follow the player across sessions and addresses.
+ *
+ * @return The key; never 0.
+ */
+quint32 localPlayerKey() {
+    QSettings settings("Quick-Rock-Paper-Scissors", "client");
+    quint32 key = settings.value("player/key").toUInt();
+    if (key == 0) {
+        key = QRandomGenerator::global()->bounded(1u, std::numeric_limits<quint32>::max());
+        settings.setValue("player/key", key);
+    }
+    return key;
+}
+
+} // namespace
 
 /**
  * @brief Constructs a LobbyClient instance.
  * @param parent The parent QObject.
  */
-LobbyClient::LobbyClient(QObject *parent) : QObject(parent) {}
+LobbyClient::LobbyClient(QObject *parent) : QObject(parent), playerKey(localPlayerKey()) {
+    selectionTimer.setSingleShot(true);
+    connect(&selectionTimer, &QTimer::timeout, this, &LobbyClient::onSelectionWindowClosed);
+}
+
+/**
+ * @brief Selects the channels used to discover and announce lobbies.
+ * @param config The discovery settings.
+ */
+void LobbyClient::setDiscoveryConfig(const DiscoveryConfig &config) {
+    discovery = config;
+}
+
+/**
+ * @brief Records the rounds of hosted lobbies in a match history log.
+ * @param log The log; nullptr stops recording.
+ */
+void LobbyClient::setMatchLog(MatchLog *log) {
+    matchLog = log;
+    if (serverLobby) serverLobby->setMatchLog(log);
+}
+
+/**
+ * @brief Rates the players of hosted lobbies.
+ * @param service The rating service; nullptr stops rating.
+ */
+void LobbyClient::setRatingService(RatingService *service) {
+    ratings = service;
+    if (serverLobby) serverLobby->setRatingService(service);
+}
+
+/**
+ * @brief Records the traffic and round timing of hosted lobbies.
+ * @param newMetrics The metrics; nullptr stops recording.
+ */
+void LobbyClient::setMetrics(Metrics *newMetrics) {
+    metrics = newMetrics;
+    if (serverLobby) serverLobby->setMetrics(metrics);
+}
 
 /**
  * @brief Creates and starts hosting a local TCP server for players to join.
  *        Once hosted, the client automatically connects to the newly created server.
  */
 void LobbyClient::onHostOwnLocalTcpServer() {
-    serverLobby = std::make_unique<ServerLobby>(LOBBY_NAME, MAX_PLAYERS, SERVER_PORT, BROADCAST_PORT, this);
+    serverLobby = std::make_unique<ServerLobby>(LOBBY_NAME, MAX_PLAYERS, SERVER_PORT, BROADCAST_PORT, discovery, this);
+    serverLobby->setMatchLog(matchLog);
+    serverLobby->setRatingService(ratings);
+    serverLobby->setMetrics(metrics);
     onConnectToFirstFindedServer();  // Auto-connect to the hosted server
 }
 
 /**
- * @brief Searches for an available lobby and connects to the first one found.
+ * @brief Searches for available lobbies and connects to the best one found.
  *        Starts a UDP broadcast listener to discover available game lobbies.
  */
 void LobbyClient::onConnectToFirstFindedServer() {
     initClient();
+    candidates.clear();
     broadcastListener = std::make_unique<UdpBroadcastListener>(BROADCAST_PORT, this);
+    broadcastListener->setDiscoveryConfig(discovery);
     broadcastListener->startListening();
     connect(broadcastListener.get(), &UdpBroadcastListener::lobbyFound, this, &LobbyClient::onLobbyFinded);
 }
@@ -40,6 +112,9 @@ void LobbyClient::onCloseGame() {
         broadcastListener->stopListening();
         broadcastListener.reset();
     }
+    selectionTimer.stop();
+    candidates.clear();
+    if (prober) prober->cancel();
 }
 
 /**
@@ -52,6 +127,10 @@ void LobbyClient::initClient() {
 
     connect(client.get(), &LanTcpClient::connected, this, [this] {
         if (broadcastListener) broadcastListener->stopListening();
+
+        // Tell the host who is joining and which of its lobbies to join
+        client->sendMessages({Protocol::encode(Protocol::Opcode::Identify, playerKey),
+                              Protocol::encode(Protocol::Opcode::Join, joinLobbyId)});
         qDebug() << "Connected to the lobby!";
     });
 
@@ -61,16 +140,41 @@ void LobbyClient::initClient() {
 
     // Handles incoming messages from the server
     connect(client.get(), &LanTcpClient::messageReceived, this, [this](const QByteArray &msg) {
-        QString message = QString::fromUtf8(msg).trimmed();
+        TRACE_SCOPE("client", "LobbyClient::onMessageReceived");
+        if (Protocol::isChat(msg)) {
+            QVector<ChatMessage> chatMessages;
+            if (!Protocol::decodeChat(msg, chatMessages)) return;
+            for (const ChatMessage &chatMessage : std::as_const(chatMessages)) {
+                emit invokeChat(chatMessage.sender, chatMessage.message);
+            }
+            return;
+        }
+
+        Protocol::Message message;
+        if (!Protocol::decode(msg, message)) return;
 
-        if (message == "/start") {
+        switch (message.opcode) {
+        case Protocol::Opcode::Start:
             emit invokeGameActionMenu();
-        } else if (message == "/draw") {
-            emit invokeResults("No one won this game");
-        } else if (message == "/win") {
-            emit invokeResults("Congratulations, you won this game");
-        } else if (message == "/lose") {
-            emit invokeResults("Sorry, you lost this game");
+            break;
+        case Protocol::Opcode::Next:
+            resultContinues = true;
+            matchScore = message.value;
+            break;
+        case Protocol::Opcode::Draw:
+            showResult("No one won this game");
+            break;
+        case Protocol::Opcode::Win:
+            showResult("Congratulations, you won this game");
+            break;
+        case Protocol::Opcode::Lose:
+            showResult("Sorry, you lost this game");
+            break;
+        case Protocol::Opcode::Ping:
+            client->sendMessage(Protocol::encode(Protocol::Opcode::Pong, message.value));
+            break;
+        default:
+            break;
         }
     });
 
@@ -80,12 +184,110 @@ void LobbyClient::initClient() {
 }
 
 /**
- * @brief Connects to a found lobby using its address and information.
+ * @brief Adds a found lobby to the candidates of the selection window.
+ *
+ * The first lobby found opens the window; a lobby announced again replaces
+ * its earlier entry.
+ *
  * @param hostAdress The IP address of the found lobby.
  * @param info The lobby's information.
  */
 void LobbyClient::onLobbyFinded(const QHostAddress &hostAdress, const LobbyInfo &info) {
-    client->connectToServer(hostAdress, info);
+    if (client->isBusy() || (prober && prober->isRunning())) return;
+    if (info.currentPlayers >= info.maxPlayers) return;
+
+    auto it = std::find_if(candidates.begin(), candidates.end(), [&](const Candidate &candidate) {
+        return candidate.host == hostAdress && candidate.info.tcpPort == info.tcpPort
+               && candidate.info.lobbyId == info.lobbyId;
+    });
+    if (it != candidates.end()) {
+        it->info = info;
+    } else {
+        candidates.append({hostAdress, info});
+    }
+
+    if (!selectionTimer.isActive()) {
+        selectionTimer.start(SELECTION_WINDOW_MS);
+    }
+}
+
+/**
+ * @brief Probes every host of the collected lobbies once.
+ */
+void LobbyClient::onSelectionWindowClosed() {
+    if (candidates.isEmpty()) return;
+
+    QVector<LobbyProber::Target> targets;
+    for (const Candidate &candidate : std::as_const(candidates)) {
+        const bool known = std::any_of(targets.cbegin(), targets.cend(), [&](const LobbyProber::Target &target) {
+            return target.host == candidate.host && target.port == candidate.info.tcpPort;
+        });
+        if (known) continue;
+
+        LobbyProber::Target target;
+        target.host = candidate.host;
+        target.port = candidate.info.tcpPort;
+        targets.append(target);
+    }
+
+    if (!prober) {
+        prober = std::make_unique<LobbyProber>(this);
+        connect(prober.get(), &LobbyProber::finished, this, &LobbyClient::onProbeFinished);
+    }
+    prober->probe(targets);
+}
+
+/**
+ * @brief Joins the best-scoring lobby once the probe is done.
+ *
+ * Hosts that did not answer are scored with the probe timeout as their
+ * round-trip time, so lobbies of hosts without a responder remain eligible.
+ *
+ * @param targets The probed hosts with their round-trip times.
+ */
+void LobbyClient::onProbeFinished(const QVector<LobbyProber::Target> &targets) {
+    const QList<QHostAddress> localAddresses = serverLobby ? QNetworkInterface::allAddresses() : QList<QHostAddress>();
+    const qint64 unanswered = qint64(LobbyProber::TIMEOUT_MS + LobbyProber::PROBE_COUNT * LobbyProber::PROBE_SPACING_MS) * 1000;
+
+    int best = -1;
+    qint64 bestScore = std::numeric_limits<qint64>::max();
+    qint64 bestRtt = -1;
+    for (int i = 0; i < candidates.size(); ++i) {
+        const Candidate &candidate = candidates[i];
+
+        qint64 rtt = -1;
+        for (const LobbyProber::Target &target : targets) {
+            if (target.host == candidate.host && target.port == candidate.info.tcpPort) {
+                rtt = target.rttUs;
+                break;
+            }
+        }
+
+        // A hosting player joins their own lobby before any other
+        const bool own = serverLobby && candidate.info.tcpPort == SERVER_PORT
+                         && (candidate.host.isLoopback() || localAddresses.contains(candidate.host));
+        const int seatsToFill = candidate.info.maxPlayers - candidate.info.currentPlayers - 1;
+        const qint64 score = own ? -1 : (rtt < 0 ? unanswered : rtt) + seatsToFill * FREE_SEAT_COST_US;
+
+        if (score < bestScore) {
+            best = i;
+            bestScore = score;
+            bestRtt = rtt;
+        }
+    }
+    if (best < 0) return;
+
+    const Candidate chosen = candidates[best];
+    qDebug().noquote() << QString("Joining \"%1\" at %2: %3, %4 of %5 seats taken, best of %6 lobbies")
+                              .arg(chosen.info.lobbyName, chosen.host.toString(),
+                                   bestRtt < 0 ? QString("no ping answer")
+                                               : QString("round trip %1 ms").arg(bestRtt / 1000.0, 0, 'f', 2))
+                              .arg(chosen.info.currentPlayers).arg(chosen.info.maxPlayers).arg(candidates.size());
+    candidates.clear();
+
+    if (client->connectToServer(chosen.host, chosen.info)) {
+        joinLobbyId = chosen.info.lobbyId;
+    }
 }
 
 /**
@@ -93,7 +295,38 @@ void LobbyClient::onLobbyFinded(const QHostAddress &hostAdress, const LobbyInfo
  * @param choice The player's choice: 1 - Rock, 2 - Paper, 3 - Scissors.
  */
 void LobbyClient::onPlayerMadeChoice(int choice) {
-    QString message = "/choice " + QString::number(choice);
-    client->sendMessage(message.toUtf8());
+    TRACE_SCOPE("client", "LobbyClient::onPlayerMadeChoice");
+    client->sendMessage(Protocol::encode(Protocol::Opcode::Choice, static_cast<quint32>(choice)));
+}
+
+/**
+ * @brief Sends a chat message to the lobby.
+ *
+ * The host fills in the sender name, so it is left empty here.
+ *
+ * @param text The message text.
+ */
+void LobbyClient::onPlayerSentChat(const QString &text) {
+    if (!client) return;
+
+    const QByteArray frame = Protocol::encodeChat(ChatMessage(QString(), text));
+    if (frame.isEmpty()) {
+        qDebug() << "Chat is not supported by the text protocol";
+        return;
+    }
+    if (!client->sendMessage(frame)) qDebug() << "Chat message not sent: not connected";
 }
 
+/**
+ * @brief Reports a result as final or, after a Next message, as one game of a longer session.
+ * @param result The result message.
+ */
+void LobbyClient::showResult(const QString &result) {
+    if (!resultContinues) {
+        emit invokeResults(result);
+        return;
+    }
+
+    resultContinues = false;
+    emit invokeRoundResults(QString("%1 (match score %2-%3)").arg(result).arg(matchScore >> 16).arg(matchScore & 0xFFFF));
+}
@@ -0,0 +1,156 @@
+#include "LobbyDirectory.h"
+#include <algorithm>
+
+/**
+ * @brief Constructs an empty directory.
+ * @param ttlMs Time after the last announcement at which a lobby expires.
+ * @param parent The parent QObject.
+ */
+LobbyDirectory::LobbyDirectory(int ttlMs, QObject *parent)
+    : QObject(parent), ttl(qMax(1, ttlMs)) {
+    clock.start();
+    connect(&expiryTimer, &QTimer::timeout, this, &LobbyDirectory::onExpire);
+}
+
+/**
+ * @brief Records an announcement.
+ * @param host The address of the announcing host.
+ * @param info The announced lobby information.
+ * @return True if the lobby is new or changed.
+ */
+bool LobbyDirectory::update(const QHostAddress &host, const LobbyInfo &info) {
+    const qint64 now = clock.elapsed();
+    const QByteArray key = keyOf(host, info);
+
+    auto it = lobbies.find(key);
+    if (it == lobbies.end()) {
+        Entry entry;
+        entry.host = host;
+        entry.info = info;
+        entry.firstSeenMs = now;
+        entry.lastSeenMs = now;
+        lobbies.insert(key, entry);
+
+        // Sweep a few times per time-to-live while there is something to expire
+        if (!expiryTimer.isActive()) {
+            expiryTimer.start(qMax(250, ttl / 4));
+        }
+
+        emit lobbyAdded(host, info);
+        return true;
+    }
+
+    it->lastSeenMs = now;
+    if (it->info == info) return false; // A repeat only refreshes the age
+
+    it->info = info;
+    emit lobbyChanged(host, info);
+    return true;
+}
+
+/**
+ * @brief Drops every entry without emitting signals.
+ */
+void LobbyDirectory::clear() {
+    lobbies.clear();
+    expiryTimer.stop();
+}
+
+/**
+ * @brief Returns the number of known lobbies.
+ * @return The number of entries.
+ */
+int LobbyDirectory::size() const {
+    return static_cast<int>(lobbies.size());
+}
+
+/**
+ * @brief Returns every known lobby.
+ * @return The entries.
+ */
+QList<LobbyDirectory::Entry> LobbyDirectory::entries() const {
+    return lobbies.values();
+}
+
+/**
+ * @brief Returns the lobbies with at least one free seat.
+ * @return The entries, fullest lobby first.
+ */
+QList<LobbyDirectory::Entry> LobbyDirectory::openLobbies() const {
+    QList<Entry> open;
+    for (const Entry &entry : lobbies) {
+        if (entry.freeSlots() > 0) {
+            open.append(entry);
+        }
+    }
+
+    std::sort(open.begin(), open.end(), [](const Entry &a, const Entry &b) {
+        return a.freeSlots() < b.freeSlots();
+    });
+    return open;
+}
+
+/**
+ * @brief Returns the lobbies whose name contains a text.
+ * @param text The text to search for.
+ * @return The matching entries.
+ */
+QList<LobbyDirectory::Entry> LobbyDirectory::findByName(const QString &text) const {
+    QList<Entry> found;
+    for (const Entry &entry : lobbies) {
+        if (entry.info.lobbyName.contains(text, Qt::CaseInsensitive)) {
+            found.append(entry);
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Returns the time since an entry was last announced.
+ * @param entry An entry returned by this directory.
+ * @return The age in milliseconds.
+ */
+qint64 LobbyDirectory::ageOf(const Entry &entry) const {
+    return clock.elapsed() - entry.lastSeenMs;
+}
+
+/**
+ * @brief Removes entries older than the time-to-live.
+ */
+void LobbyDirectory::onExpire() {
+    const qint64 deadline = clock.elapsed() - ttl;
+
+    QList<Entry> expired;
+    for (auto it = lobbies.begin(); it != lobbies.end();) {
+        if (it->lastSeenMs < deadline) {
+            expired.append(it.value());
+            it = lobbies.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (lobbies.isEmpty()) {
+        expiryTimer.stop();
+    }
+
+    // Emit after the sweep, so receivers may query or clear the directory
+    for (const Entry &entry : std::as_const(expired)) {
+        emit lobbyExpired(entry.host, entry.info);
+    }
+}
+
+/**
+ * @brief Builds the key of a lobby from its host, TCP port and lobby ID.
+ * @param host The address of the announcing host.
+ * @param info The lobby information.
+ * @return The key.
+ */
+QByteArray LobbyDirectory::keyOf(const QHostAddress &host, const LobbyInfo &info) {
+    QByteArray key;
+    WireFormat::Writer out(key, WireFormat::addressSize(host) + 2 + 4);
+    out.writeAddress(host);
+    out.writeU16(info.tcpPort);
+    out.writeU32(info.lobbyId);
+    return key;
+}
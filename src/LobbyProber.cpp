@@ -0,0 +1,137 @@
+#include "LobbyProber.h"
+#include "PingResponder.h"
+#include <QtEndian>
+
+namespace {
+
+constexpr int INDEX_BITS = 20;                                  ///< Bits of the nonce holding the probe index.
+constexpr quint32 INDEX_MASK = (quint32(1) << INDEX_BITS) - 1;  ///< Mask of the probe index.
+
+} // namespace
+
+/**
+ * @brief Constructs an idle prober.
+ * @param parent The parent QObject.
+ */
+LobbyProber::LobbyProber(QObject *parent) : QObject(parent) {
+    connect(&udpSocket, &QUdpSocket::readyRead, this, &LobbyProber::onReadyRead);
+    connect(&roundTimer, &QTimer::timeout, this, &LobbyProber::onSendRound);
+
+    timeoutTimer.setSingleShot(true);
+    connect(&timeoutTimer, &QTimer::timeout, this, &LobbyProber::finish);
+}
+
+/**
+ * @brief Starts probing; a probe that is still running is cancelled.
+ * @param newTargets The hosts to probe.
+ */
+void LobbyProber::probe(const QVector<Target> &newTargets) {
+    cancel();
+
+    targets = newTargets.mid(0, MAX_TARGETS);
+    for (Target &target : targets) {
+        target.rttUs = -1;
+    }
+    sentNs.fill(-1, targets.size() * PROBE_COUNT);
+    round = 0;
+    answers = 0;
+    ++generation;
+    running = true;
+
+    if (targets.isEmpty() || !udpSocket.bind(QHostAddress::AnyIPv4, 0)) {
+        finish();
+        return;
+    }
+
+    clock.start();
+    onSendRound();
+    roundTimer.start(PROBE_SPACING_MS);
+}
+
+/**
+ * @brief Stops a running probe without reporting it.
+ */
+void LobbyProber::cancel() {
+    running = false;
+    roundTimer.stop();
+    timeoutTimer.stop();
+    udpSocket.close();
+}
+
+/**
+ * @brief Checks whether a probe is running.
+ * @return True between probe() and finished().
+ */
+bool LobbyProber::isRunning() const {
+    return running;
+}
+
+/**
+ * @brief Sends the next round of probes to every target.
+ */
+void LobbyProber::onSendRound() {
+    char packet[PingResponder::PACKET_SIZE];
+    qToBigEndian<quint32>(PingResponder::MAGIC, packet);
+
+    const quint32 tag = (generation << INDEX_BITS);
+    for (int i = 0; i < targets.size(); ++i) {
+        const int index = i * PROBE_COUNT + round;
+        qToBigEndian<quint32>(tag | static_cast<quint32>(index), packet + 4);
+
+        sentNs[index] = clock.nsecsElapsed();
+        udpSocket.writeDatagram(packet, sizeof(packet), targets[i].host, targets[i].port);
+    }
+
+    if (++round == PROBE_COUNT) {
+        roundTimer.stop();
+        timeoutTimer.start(TIMEOUT_MS);
+    }
+}
+
+/**
+ * @brief Records the answers to the probes.
+ *
+ * Answers are matched by their nonce, so each probe counts once and answers
+ * to an earlier probe are ignored.
+ */
+void LobbyProber::onReadyRead() {
+    char packet[PingResponder::PACKET_SIZE + 1];
+
+    while (udpSocket.hasPendingDatagrams()) {
+        const qint64 size = udpSocket.readDatagram(packet, sizeof(packet));
+        if (!running || size != PingResponder::PACKET_SIZE
+            || qFromBigEndian<quint32>(packet) != PingResponder::MAGIC) {
+            continue;
+        }
+
+        const quint32 nonce = qFromBigEndian<quint32>(packet + 4);
+        const int index = static_cast<int>(nonce & INDEX_MASK);
+        if ((nonce >> INDEX_BITS) != (generation & (0xFFFFFFFFu >> INDEX_BITS))
+            || index >= sentNs.size() || sentNs[index] < 0) {
+            continue;
+        }
+
+        const qint64 rttUs = (clock.nsecsElapsed() - sentNs[index]) / 1000;
+        sentNs[index] = -1; // Duplicated answers do not count twice
+
+        Target &target = targets[index / PROBE_COUNT];
+        if (target.rttUs < 0 || rttUs < target.rttUs) {
+            target.rttUs = rttUs;
+        }
+
+        if (++answers == targets.size() * PROBE_COUNT) {
+            finish();
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Reports the probe, including unanswered targets.
+ */
+void LobbyProber::finish() {
+    if (!running) return;
+
+    cancel();
+    emit finished(targets);
+}
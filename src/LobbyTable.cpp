@@ -0,0 +1,291 @@
+#include "LobbyTable.h"
+
+/**
+ * @brief Constructs a table of empty lobbies.
+ * @param lobbyCount The number of lobbies.
+ * @param seatsPerLobby The number of players in a full lobby.
+ */
+LobbyTable::LobbyTable(int lobbyCount, int seatsPerLobby)
+    : seatCount(seatsPerLobby), rows(lobbyCount),
+      seats(lobbyCount * seatsPerLobby, 0), choices(lobbyCount * seatsPerLobby, 0), openHead(seatsPerLobby, -1) {
+    // Linked back to front, so the lowest lobby index is taken first
+    for (int lobby = lobbyCount - 1; lobby >= 0; --lobby) {
+        linkOpen(lobby);
+    }
+}
+
+/**
+ * @brief Returns the number of lobbies in the table.
+ * @return The number of lobbies.
+ */
+int LobbyTable::lobbyCount() const {
+    return rows.size();
+}
+
+/**
+ * @brief Returns the number of players in a full lobby.
+ * @return The number of seats per lobby.
+ */
+int LobbyTable::seatsPerLobby() const {
+    return seatCount;
+}
+
+/**
+ * @brief Converts a lobby index into its ID.
+ * @param lobby The lobby index.
+ * @return The lobby ID.
+ */
+quint32 LobbyTable::lobbyId(int lobby) const {
+    return static_cast<quint32>(lobby) + 1;
+}
+
+/**
+ * @brief Converts a lobby ID into a lobby index.
+ * @param lobbyId The lobby ID.
+ * @return The lobby index, or -1 if the ID is unknown.
+ */
+int LobbyTable::indexOf(quint32 lobbyId) const {
+    if (lobbyId == 0 || lobbyId > static_cast<quint32>(rows.size())) return -1;
+    return static_cast<int>(lobbyId - 1);
+}
+
+/**
+ * @brief Finds a waiting lobby with a free seat.
+ *
+ * Filling the fullest lobby first gets matches started sooner. Only the
+ * heads of the open lists are looked at.
+ *
+ * @return The lobby index, or -1 if none is open.
+ */
+int LobbyTable::findOpenLobby() const {
+    for (int players = seatCount - 1; players >= 0; --players) {
+        if (openHead[players] >= 0) return openHead[players];
+    }
+    return -1;
+}
+
+/**
+ * @brief Returns the state of a lobby.
+ * @param lobby The lobby index.
+ * @return The lobby state.
+ */
+LobbyTable::State LobbyTable::state(int lobby) const {
+    return rows[lobby].state;
+}
+
+/**
+ * @brief Changes the state of a lobby.
+ * @param lobby The lobby index.
+ * @param newState The new state.
+ */
+void LobbyTable::setState(int lobby, State newState) {
+    unlinkOpen(lobby);
+    rows[lobby].state = newState;
+    linkOpen(lobby);
+}
+
+/**
+ * @brief Returns the number of seated players in a lobby.
+ * @param lobby The lobby index.
+ * @return The number of players.
+ */
+int LobbyTable::playerCount(int lobby) const {
+    return rows[lobby].players;
+}
+
+/**
+ * @brief Checks whether a lobby can take another player.
+ * @param lobby The lobby index.
+ * @return True if the lobby is waiting and has a free seat.
+ */
+bool LobbyTable::isOpen(int lobby) const {
+    return rows[lobby].state == State::Waiting && !isFull(lobby);
+}
+
+/**
+ * @brief Checks whether every seat of a lobby is taken.
+ * @param lobby The lobby index.
+ * @return True if the lobby is full.
+ */
+bool LobbyTable::isFull(int lobby) const {
+    return rows[lobby].players >= seatCount;
+}
+
+/**
+ * @brief Seats a player in the first free seat of a lobby.
+ * @param lobby The lobby index.
+ * @param sessionId The session ID of the player to seat.
+ * @return The seat index, or -1 if the lobby is full.
+ */
+int LobbyTable::addPlayer(int lobby, quint32 sessionId) {
+    Row &row = rows[lobby];
+    if (row.players >= seatCount) return -1;
+
+    unlinkOpen(lobby);
+    const int seat = row.players++;
+    seats[slot(lobby, seat)] = sessionId;
+    choices[slot(lobby, seat)] = 0;
+    linkOpen(lobby);
+    return seat;
+}
+
+/**
+ * @brief Removes a player, keeping occupied seats packed.
+ * @param lobby The lobby index.
+ * @param seat The seat to free.
+ * @return The session ID of the player moved into the freed seat, or 0 if no one moved.
+ */
+quint32 LobbyTable::removePlayer(int lobby, int seat) {
+    Row &row = rows[lobby];
+    if (seat < 0 || seat >= row.players) return 0;
+
+    if (choices[slot(lobby, seat)] != 0) --row.choices;
+
+    quint32 movedSession = 0;
+    const int last = row.players - 1;
+    if (seat != last) {
+        movedSession = seats[slot(lobby, last)];
+        seats[slot(lobby, seat)] = movedSession;
+        choices[slot(lobby, seat)] = choices[slot(lobby, last)];
+    }
+
+    seats[slot(lobby, last)] = 0;
+    choices[slot(lobby, last)] = 0;
+    unlinkOpen(lobby);
+    --row.players;
+    linkOpen(lobby);
+    return movedSession;
+}
+
+/**
+ * @brief Returns the session ID of the player in a seat.
+ * @param lobby The lobby index.
+ * @param seat The seat index.
+ * @return The session ID of the seated player.
+ */
+quint32 LobbyTable::player(int lobby, int seat) const {
+    return seats[slot(lobby, seat)];
+}
+
+/**
+ * @brief Records the move of a seated player.
+ * @param lobby The lobby index.
+ * @param seat The seat index.
+ * @param choice The move.
+ */
+void LobbyTable::setChoice(int lobby, int seat, int choice) {
+    quint8 &stored = choices[slot(lobby, seat)];
+    if (stored == 0 && choice != 0) ++rows[lobby].choices;
+    stored = static_cast<quint8>(choice);
+}
+
+/**
+ * @brief Returns the move of a seated player.
+ * @param lobby The lobby index.
+ * @param seat The seat index.
+ * @return The move, or 0 if none was made.
+ */
+int LobbyTable::choice(int lobby, int seat) const {
+    return choices[slot(lobby, seat)];
+}
+
+/**
+ * @brief Returns the packed moves of a lobby.
+ * @param lobby The lobby index.
+ * @return Pointer to the moves of the occupied seats.
+ */
+const quint8 *LobbyTable::choiceData(int lobby) const {
+    return choices.constData() + slot(lobby, 0);
+}
+
+/**
+ * @brief Returns the session IDs of a lobby.
+ * @param lobby The lobby index.
+ * @return Pointer to the session IDs of the occupied seats.
+ */
+const quint32 *LobbyTable::playerData(int lobby) const {
+    return seats.constData() + slot(lobby, 0);
+}
+
+/**
+ * @brief Checks whether every seated player has made a move.
+ * @param lobby The lobby index.
+ * @return True if all moves are in.
+ */
+bool LobbyTable::allChosen(int lobby) const {
+    const Row &row = rows[lobby];
+    return row.players > 0 && row.choices == row.players;
+}
+
+/**
+ * @brief Forgets the moves of a lobby, keeping its players seated.
+ * @param lobby The lobby index.
+ */
+void LobbyTable::clearChoices(int lobby) {
+    Row &row = rows[lobby];
+    for (int seat = 0; seat < row.players; ++seat) {
+        choices[slot(lobby, seat)] = 0;
+    }
+    row.choices = 0;
+}
+
+/**
+ * @brief Empties a lobby and puts it back into the waiting state.
+ * @param lobby The lobby index.
+ */
+void LobbyTable::clearLobby(int lobby) {
+    unlinkOpen(lobby);
+    Row &row = rows[lobby];
+    for (int seat = 0; seat < row.players; ++seat) {
+        seats[slot(lobby, seat)] = 0;
+        choices[slot(lobby, seat)] = 0;
+    }
+    row = Row();
+    linkOpen(lobby);
+}
+
+/**
+ * @brief Removes a lobby from its open list, if it is in one.
+ * @param lobby The lobby index.
+ */
+void LobbyTable::unlinkOpen(int lobby) {
+    Row &row = rows[lobby];
+    if (!row.linked) return;
+
+    if (row.prevOpen >= 0) {
+        rows[row.prevOpen].nextOpen = row.nextOpen;
+    } else {
+        openHead[row.players] = row.nextOpen;
+    }
+    if (row.nextOpen >= 0) rows[row.nextOpen].prevOpen = row.prevOpen;
+
+    row.prevOpen = -1;
+    row.nextOpen = -1;
+    row.linked = false;
+}
+
+/**
+ * @brief Adds a lobby to the front of the open list of its player count if it is open.
+ * @param lobby The lobby index.
+ */
+void LobbyTable::linkOpen(int lobby) {
+    Row &row = rows[lobby];
+    if (row.linked || !isOpen(lobby)) return;
+
+    const int head = openHead[row.players];
+    row.prevOpen = -1;
+    row.nextOpen = head;
+    if (head >= 0) rows[head].prevOpen = lobby;
+    openHead[row.players] = lobby;
+    row.linked = true;
+}
+
+/**
+ * @brief Returns the flat index of a seat.
+ * @param lobby The lobby index.
+ * @param seat The seat index.
+ * @return The index into the seat and move arrays.
+ */
+int LobbyTable::slot(int lobby, int seat) const {
+    return lobby * seatCount + seat;
+}
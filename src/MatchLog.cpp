@@ -0,0 +1,210 @@
+#include "MatchLog.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QMetaObject>
+#include <cstring>
+#include <memory>
+
+using MatchLogFormat::FileHeader;
+using MatchLogFormat::MatchRecord;
+
+/**
+ * @brief Owns the log file and appends record batches in the writer thread.
+ */
+class MatchLogWriter : public QObject {
+public:
+    /**
+     * @brief Constructs a writer for an open file.
+     * @param file The file; ownership is taken.
+     */
+    explicit MatchLogWriter(QFile *file) : log(file) {}
+
+    /**
+     * @brief Appends a batch of records and pushes it to the operating system.
+     * @param batch The serialized records.
+     */
+    void write(const QByteArray &batch) {
+        if (log->write(batch) != batch.size()) {
+            qWarning() << "Match log write failed:" << log->errorString();
+        }
+        log->flush();
+    }
+
+private:
+    std::unique_ptr<QFile> log; ///< The open log file.
+};
+
+/**
+ * @brief Constructs a closed log.
+ * @param parent The parent QObject.
+ */
+MatchLog::MatchLog(QObject *parent) : QObject(parent) {
+    writerThread.setObjectName("MatchLogWriter");
+    flushTimer.setSingleShot(true);
+    connect(&flushTimer, &QTimer::timeout, this, &MatchLog::flush);
+}
+
+/**
+ * @brief Flushes the pending records and stops the writer thread.
+ */
+MatchLog::~MatchLog() {
+    close();
+}
+
+/**
+ * @brief Opens a log for appending, creating it if needed.
+ * @param path The file path.
+ * @return False if the file cannot be opened or is not a match log.
+ */
+bool MatchLog::open(const QString &path) {
+    if (writer) return false;
+
+    auto file = std::make_unique<QFile>(path);
+    if (!file->open(QIODevice::ReadWrite)) {
+        qWarning() << "Cannot open match log" << path << ":" << file->errorString();
+        return false;
+    }
+
+    FileHeader header;
+    if (file->size() == 0) {
+        header.recordSize = sizeof(MatchRecord);
+        header.createdMs = QDateTime::currentMSecsSinceEpoch();
+        file->write(reinterpret_cast<const char *>(&header), sizeof(header));
+    } else {
+        if (file->read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header)
+            || header.magic != MatchLogFormat::MAGIC || header.version != MatchLogFormat::VERSION
+            || header.recordSize != sizeof(MatchRecord)) {
+            qWarning() << path << "is not a match log";
+            return false;
+        }
+
+        // Drop a record torn by a crash and continue the round numbering
+        const qint64 records = (file->size() - qint64(sizeof(header))) / qint64(sizeof(MatchRecord));
+        const qint64 end = qint64(sizeof(header)) + records * qint64(sizeof(MatchRecord));
+        file->resize(end);
+        if (records > 0) {
+            MatchRecord last;
+            file->seek(end - qint64(sizeof(MatchRecord)));
+            if (file->read(reinterpret_cast<char *>(&last), sizeof(last)) == sizeof(last)) {
+                nextRound = last.round + 1;
+            }
+        }
+    }
+    file->seek(file->size());
+
+    writer = new MatchLogWriter(file.release());
+    writer->moveToThread(&writerThread);
+    connect(&writerThread, &QThread::finished, writer, &QObject::deleteLater);
+    writerThread.start();
+
+    pending.reserve(FLUSH_THRESHOLD + 256 * int(sizeof(MatchRecord)));
+    return true;
+}
+
+/**
+ * @brief Writes the pending records and closes the file.
+ *
+ * Blocks until the writer thread has written everything.
+ */
+void MatchLog::close() {
+    if (!writer) return;
+
+    flush();
+
+    // Wait until every queued batch is written, then stop the thread
+    QMetaObject::invokeMethod(writer, [] {}, Qt::BlockingQueuedConnection);
+    writerThread.quit();
+    writerThread.wait();
+    writer = nullptr;    // Deleted by the thread's finished signal
+}
+
+/**
+ * @brief Checks whether the log is open.
+ * @return True between a successful open() and close().
+ */
+bool MatchLog::isOpen() const {
+    return writer != nullptr;
+}
+
+/**
+ * @brief Appends the records of one resolved round.
+ * @param lobbyId The lobby the round was played in.
+ * @param count The number of players.
+ * @param sessions The session IDs of the players.
+ * @param playerKeys The stable keys of the players.
+ * @param choices The moves of the players.
+ * @param outcomes The results as Protocol::Opcode values.
+ */
+void MatchLog::recordRound(quint32 lobbyId, int count, const quint32 *sessions, const quint32 *playerKeys,
+                           const quint8 *choices, const quint8 *outcomes) {
+    if (!writer || count <= 0) return;
+
+    MatchRecord record;
+    record.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    record.round = nextRound++;
+    record.lobbyId = lobbyId;
+    record.playerCount = static_cast<quint16>(qMin(count, 0xFFFF));
+
+    // Write the records straight into the pending buffer
+    const qsizetype offset = pending.size();
+    pending.resize(offset + qsizetype(count) * qsizetype(sizeof(MatchRecord)));
+    char *out = pending.data() + offset;
+    for (int i = 0; i < count; ++i) {
+        record.sessionId = sessions[i];
+        record.playerKey = playerKeys[i];
+        record.choice = choices[i];
+        record.outcome = outcomes[i];
+        std::memcpy(out + i * sizeof(MatchRecord), &record, sizeof(MatchRecord));
+    }
+
+    if (pending.size() >= FLUSH_THRESHOLD) {
+        flush();
+    } else if (!flushTimer.isActive()) {
+        flushTimer.start(FLUSH_INTERVAL_MS);
+    }
+}
+
+/**
+ * @brief Hands the pending records to the writer thread.
+ */
+void MatchLog::flush() {
+    flushTimer.stop();
+    if (!writer || pending.isEmpty()) return;
+
+    // The batch moves to the writer thread; a fresh buffer collects the next records
+    const QByteArray batch = std::move(pending);
+    pending = QByteArray();
+    pending.reserve(FLUSH_THRESHOLD + 256 * int(sizeof(MatchRecord)));
+
+    MatchLogWriter *target = writer;
+    QMetaObject::invokeMethod(target, [target, batch] { target->write(batch); });
+}
+
+/**
+ * @brief Derives the stable key of a player from its address.
+ * @param address The player's address.
+ * @return The key.
+ */
+quint32 MatchLog::playerKey(const QHostAddress &address) {
+    bool isIPv4 = false;
+    const quint32 ipv4 = address.toIPv4Address(&isIPv4);
+    if (isIPv4) return ipv4;
+
+    const Q_IPV6ADDR ipv6 = address.toIPv6Address();
+    quint32 hash = 2166136261u;
+    for (int i = 0; i < 16; ++i) {
+        hash = (hash ^ ipv6[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Returns the stable key of a player.
+ * @param identity The key sent by the client; 0 if none.
+ * @param address The player's address.
+ * @return The identity, or the key of the address if the client sent none.
+ */
+quint32 MatchLog::playerKey(quint32 identity, const QHostAddress &address) {
+    return identity != 0 ? identity : playerKey(address);
+}
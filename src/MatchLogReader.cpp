@@ -0,0 +1,141 @@
+#include "MatchLogReader.h"
+#include "Protocol.h"
+
+using MatchLogFormat::FileHeader;
+using MatchLogFormat::MatchRecord;
+
+/**
+ * @brief Unmaps the log.
+ */
+MatchLogReader::~MatchLogReader() {
+    close();
+}
+
+/**
+ * @brief Maps a log into memory.
+ *
+ * The log is written in little-endian order, which is also the layout of the
+ * mapped structs on every supported platform.
+ *
+ * @param path The file path.
+ * @return False if the file cannot be mapped or is not a match log.
+ */
+bool MatchLogReader::open(const QString &path) {
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    Q_UNUSED(path);
+    return false;
+#else
+    close();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 size = file.size();
+    if (size < qint64(sizeof(FileHeader))) {
+        file.close();
+        return false;
+    }
+
+    mapped = file.map(0, size);
+    if (!mapped) {
+        file.close();
+        return false;
+    }
+
+    header = reinterpret_cast<const FileHeader *>(mapped);
+    if (header->magic != MatchLogFormat::MAGIC || header->version != MatchLogFormat::VERSION
+        || header->recordSize != sizeof(MatchRecord)) {
+        close();
+        return false;
+    }
+
+    first = reinterpret_cast<const MatchRecord *>(mapped + sizeof(FileHeader));
+    count = (size - qint64(sizeof(FileHeader))) / qint64(sizeof(MatchRecord));
+    return true;
+#endif
+}
+
+/**
+ * @brief Unmaps the log.
+ */
+void MatchLogReader::close() {
+    if (mapped) {
+        file.unmap(mapped);
+        mapped = nullptr;
+    }
+    file.close();
+    header = nullptr;
+    first = nullptr;
+    count = 0;
+}
+
+/**
+ * @brief Returns the number of complete records.
+ * @return The record count.
+ */
+qint64 MatchLogReader::recordCount() const {
+    return count;
+}
+
+/**
+ * @brief Returns the mapped records.
+ * @return Pointer to recordCount() records, or nullptr without a log.
+ */
+const MatchRecord *MatchLogReader::records() const {
+    return first;
+}
+
+/**
+ * @brief Returns the creation time of the log.
+ * @return Milliseconds since the Unix epoch, or 0 without a log.
+ */
+qint64 MatchLogReader::createdMs() const {
+    return header ? header->createdMs : 0;
+}
+
+/**
+ * @brief Aggregates the results of every player within a time range.
+ * @param fromMs The start of the range, inclusive.
+ * @param toMs The end of the range, exclusive.
+ * @return The statistics keyed by player key.
+ */
+QHash<quint32, MatchLogReader::PlayerStats> MatchLogReader::playerStats(qint64 fromMs, qint64 toMs) const {
+    QHash<quint32, PlayerStats> stats;
+    const auto win = static_cast<quint8>(Protocol::Opcode::Win);
+    const auto lose = static_cast<quint8>(Protocol::Opcode::Lose);
+
+    for (const MatchRecord *record = first, *end = first + count; record != end; ++record) {
+        if (record->timestampMs < fromMs || record->timestampMs >= toMs) continue;
+
+        PlayerStats &player = stats[record->playerKey];
+        ++player.rounds;
+        if (record->outcome == win) {
+            ++player.wins;
+        } else if (record->outcome == lose) {
+            ++player.losses;
+        } else {
+            ++player.draws;
+        }
+    }
+    return stats;
+}
+
+/**
+ * @brief Counts the moves and winning moves within a time range.
+ * @param fromMs The start of the range, inclusive.
+ * @param toMs The end of the range, exclusive.
+ * @return The distribution of moves.
+ */
+MatchLogReader::ChoiceStats MatchLogReader::choiceStats(qint64 fromMs, qint64 toMs) const {
+    ChoiceStats stats;
+    const auto win = static_cast<quint8>(Protocol::Opcode::Win);
+
+    for (const MatchRecord *record = first, *end = first + count; record != end; ++record) {
+        if (record->timestampMs < fromMs || record->timestampMs >= toMs) continue;
+
+        const int choice = record->choice < 4 ? record->choice : 0;
+        ++stats.picks[choice];
+        if (record->outcome == win) ++stats.wins[choice];
+    }
+    return stats;
+}
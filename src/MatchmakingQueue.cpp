@@ -0,0 +1,233 @@
+#include "MatchmakingQueue.h"
+#include <algorithm>
+#include <limits>
+
+/**
+ * @brief Constructs an empty queue.
+ * @param groupSize The number of players in a match.
+ * @param config The matching tolerances.
+ */
+MatchmakingQueue::MatchmakingQueue(int groupSize, const MatchmakingConfig &config)
+    : groupSize(qMax(1, groupSize)), config(config) {}
+
+/**
+ * @brief Returns the number of queued players.
+ * @return The queue depth.
+ */
+int MatchmakingQueue::size() const {
+    return entries.size();
+}
+
+/**
+ * @brief Checks whether a player is queued.
+ * @param sessionId The session ID of the player.
+ * @return True if the player is waiting for a match.
+ */
+bool MatchmakingQueue::contains(quint32 sessionId) const {
+    return indexOfSession.contains(sessionId);
+}
+
+/**
+ * @brief Adds a player to the queue.
+ * @param sessionId The session ID of the player.
+ * @param rating The rating of the player.
+ * @param nowMs The current time in milliseconds.
+ * @return False if the player is already queued.
+ */
+bool MatchmakingQueue::enqueue(quint32 sessionId, double rating, qint64 nowMs) {
+    if (indexOfSession.contains(sessionId)) return false;
+
+    Entry entry;
+    entry.sessionId = sessionId;
+    entry.rating = static_cast<float>(rating);
+    entry.enqueuedMs = nowMs;
+
+    indexOfSession.insert(sessionId, entries.size());
+    entries.append(entry);
+    return true;
+}
+
+/**
+ * @brief Removes a player from the queue.
+ *
+ * The last entry is moved into the freed slot.
+ *
+ * @param sessionId The session ID of the player.
+ * @return True if the player was queued.
+ */
+bool MatchmakingQueue::remove(quint32 sessionId) {
+    const auto it = indexOfSession.constFind(sessionId);
+    if (it == indexOfSession.constEnd()) return false;
+
+    const int index = it.value();
+    indexOfSession.erase(it);
+
+    const int last = entries.size() - 1;
+    if (index != last) {
+        entries[index] = entries[last];
+        indexOfSession[entries[index].sessionId] = index;
+    }
+    entries.removeLast();
+    return true;
+}
+
+/**
+ * @brief Records the measured round-trip time of a queued player.
+ * @param sessionId The session ID of the player.
+ * @param rttMs The round-trip time in milliseconds.
+ */
+void MatchmakingQueue::setRtt(quint32 sessionId, int rttMs) {
+    const auto it = indexOfSession.constFind(sessionId);
+    if (it == indexOfSession.constEnd()) return;
+
+    entries[it.value()].rttMs = qMax(0, rttMs);
+}
+
+/**
+ * @brief Places as many groups as possible and removes them from the queue.
+ *
+ * The queue is sorted by rating once per pass and the unplaced players are
+ * linked in that order, so placed players are skipped in constant time.
+ * Starting with the longest-waiting player, every unplaced player collects the
+ * closest-rated partners within its rating window whose round-trip time is
+ * within its RTT window, examining at most MAX_SCAN candidates.
+ *
+ * @param nowMs The current time in milliseconds.
+ * @param maxGroups The largest number of groups to place.
+ * @param groups Receives groupSize session IDs per placed group.
+ * @return The number of placed groups.
+ */
+int MatchmakingQueue::match(qint64 nowMs, int maxGroups, QVector<quint32> &groups) {
+    const int n = entries.size();
+    if (n < groupSize || maxGroups <= 0) return 0;
+
+    byRating.resize(n);
+    byWait.resize(n);
+    for (int i = 0; i < n; ++i) {
+        byRating[i] = i;
+        byWait[i] = i;
+    }
+    std::sort(byRating.begin(), byRating.end(), [this](int a, int b) {
+        if (entries[a].rating != entries[b].rating) return entries[a].rating < entries[b].rating;
+        return entries[a].enqueuedMs < entries[b].enqueuedMs;
+    });
+    std::sort(byWait.begin(), byWait.end(), [this](int a, int b) {
+        return entries[a].enqueuedMs < entries[b].enqueuedMs;
+    });
+
+    positionOf.resize(n);
+    prev.resize(n);
+    next.resize(n);
+    placed.fill(0, n);
+    for (int pos = 0; pos < n; ++pos) {
+        positionOf[byRating[pos]] = pos;
+        prev[pos] = pos - 1;
+        next[pos] = pos + 1;
+    }
+
+    constexpr double unlimited = std::numeric_limits<double>::infinity();
+    int matched = 0;
+
+    for (const int anchorIndex : std::as_const(byWait)) {
+        if (matched == maxGroups) break;
+        if (placed[anchorIndex]) continue;
+
+        // Tolerances widen with the wait; overdue players accept anyone
+        const Entry &anchor = entries[anchorIndex];
+        const qint64 waited = nowMs - anchor.enqueuedMs;
+        const bool overdue = waited >= config.maxWaitMs;
+        const double ratingWindow = overdue ? unlimited
+                                            : config.ratingWindow + config.ratingWindowGrowth * (waited / 1000.0);
+        const qint64 rttWindow = overdue ? std::numeric_limits<qint64>::max()
+                                         : config.rttWindowMs + config.rttWindowGrowthMs * waited / 1000;
+
+        // Walk outwards from the anchor, always to the closer-rated side
+        const int anchorPos = positionOf[anchorIndex];
+        group.resize(0);
+        group.append(anchorPos);
+        int left = prev[anchorPos];
+        int right = next[anchorPos];
+        int scanned = 0;
+
+        while (group.size() < groupSize && scanned < MAX_SCAN && (left >= 0 || right < n)) {
+            const double leftGap = left >= 0 ? anchor.rating - entries[byRating[left]].rating : unlimited;
+            const double rightGap = right < n ? entries[byRating[right]].rating - anchor.rating : unlimited;
+            const bool takeLeft = leftGap <= rightGap;
+            if ((takeLeft ? leftGap : rightGap) > ratingWindow) break;
+
+            const int pos = takeLeft ? left : right;
+            if (takeLeft) left = prev[left];
+            else right = next[right];
+            ++scanned;
+
+            if (rttCompatible(anchor, entries[byRating[pos]], rttWindow)) {
+                group.append(pos);
+            }
+        }
+        if (group.size() < groupSize) continue;
+
+        // Unlink the group from the rating order and hand it out
+        for (const int pos : std::as_const(group)) {
+            const int index = byRating[pos];
+            placed[index] = 1;
+            if (prev[pos] >= 0) next[prev[pos]] = next[pos];
+            if (next[pos] < n) prev[next[pos]] = prev[pos];
+
+            const qint64 wait = nowMs - entries[index].enqueuedMs;
+            waitTotalMs += wait;
+            waitMaxMs = qMax(waitMaxMs, wait);
+            groups.append(entries[index].sessionId);
+        }
+        placedTotal += groupSize;
+        ++matched;
+    }
+
+    if (matched > 0) compact();
+    return matched;
+}
+
+/**
+ * @brief Returns the queue depth and wait time counters.
+ * @param nowMs The current time in milliseconds.
+ * @return The counters.
+ */
+MatchmakingQueue::Stats MatchmakingQueue::stats(qint64 nowMs) const {
+    Stats result;
+    result.depth = entries.size();
+    result.placed = placedTotal;
+    result.totalWaitMs = waitTotalMs;
+    result.maxWaitMs = waitMaxMs;
+
+    for (const Entry &entry : entries) {
+        result.oldestWaitMs = qMax(result.oldestWaitMs, nowMs - entry.enqueuedMs);
+    }
+    return result;
+}
+
+/**
+ * @brief Checks whether two players may share a match.
+ * @param anchor The longest-waiting player of the candidate group.
+ * @param candidate The candidate partner.
+ * @param rttWindow The accepted round-trip time difference.
+ * @return True if the round-trip times are compatible or one of them is unknown.
+ */
+bool MatchmakingQueue::rttCompatible(const Entry &anchor, const Entry &candidate, qint64 rttWindow) {
+    if (anchor.rttMs < 0 || candidate.rttMs < 0) return true;
+    return qAbs(anchor.rttMs - candidate.rttMs) <= rttWindow;
+}
+
+/**
+ * @brief Removes the placed entries and rebuilds the session index.
+ */
+void MatchmakingQueue::compact() {
+    int kept = 0;
+    for (int i = 0; i < entries.size(); ++i) {
+        if (!placed[i]) entries[kept++] = entries[i];
+    }
+    entries.resize(kept);
+
+    indexOfSession.clear();
+    for (int i = 0; i < kept; ++i) {
+        indexOfSession.insert(entries[i].sessionId, i);
+    }
+}
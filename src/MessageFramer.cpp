@@ -0,0 +1,130 @@
+#include "MessageFramer.h"
+#include <QtEndian>
+#include <cstring>
+
+/**
+ * @brief Constructs an empty framer.
+ *
+ * Reserving the buffer marks its capacity as reserved, so shrinking it after
+ * a frame has been consumed does not release the memory.
+ */
+MessageFramer::MessageFramer() {
+    buffer.reserve(INITIAL_CAPACITY);
+}
+
+/**
+ * @brief Wraps a single payload into a frame.
+ * @param payload The message to frame.
+ * @return The framed message.
+ */
+QByteArray MessageFramer::frame(const QByteArray &payload) {
+    QByteArray out;
+    out.reserve(HEADER_SIZE + payload.size());
+    appendFrame(out, payload);
+    return out;
+}
+
+/**
+ * @brief Appends a length prefix followed by the payload to an output buffer.
+ * @param out The buffer receiving the frame.
+ * @param payload The message to frame.
+ */
+void MessageFramer::appendFrame(QByteArray &out, const QByteArray &payload) {
+    char header[HEADER_SIZE];
+    qToBigEndian<quint32>(static_cast<quint32>(payload.size()), header);
+    out.append(header, HEADER_SIZE);
+    out.append(payload);
+}
+
+/**
+ * @brief Returns the heartbeat frame, a frame with an empty payload.
+ * @return The shared framed heartbeat.
+ */
+const QByteArray &MessageFramer::heartbeatFrame() {
+    static const QByteArray heartbeat = frame(QByteArray());
+    return heartbeat;
+}
+
+/**
+ * @brief Reads the available bytes of a device directly into the reassembly buffer.
+ * @param device The device to read from.
+ * @return False if reading failed, otherwise true.
+ */
+bool MessageFramer::readFrom(QIODevice *device) {
+    const qint64 available = device->bytesAvailable();
+    if (available <= 0) return true;
+
+    compact();
+
+    const qsizetype oldSize = buffer.size();
+    buffer.resize(oldSize + available);
+    const qint64 bytesRead = device->read(buffer.data() + oldSize, available);
+    buffer.resize(oldSize + qMax<qint64>(bytesRead, 0));
+
+    return bytesRead >= 0;
+}
+
+/**
+ * @brief Appends raw bytes to the reassembly buffer.
+ * @param data The received bytes.
+ */
+void MessageFramer::append(const QByteArray &data) {
+    compact();
+    buffer.append(data);
+}
+
+/**
+ * @brief Extracts the next complete frame.
+ * @param payload Receives the payload of the frame.
+ * @return True if a complete frame was extracted, otherwise false.
+ */
+bool MessageFramer::nextFrame(QByteArray &payload) {
+    if (error) return false;
+
+    const qsizetype available = buffer.size() - readPos;
+    if (available < HEADER_SIZE) return false;
+
+    const char *data = buffer.constData() + readPos;
+    const quint32 length = qFromBigEndian<quint32>(data);
+    if (length > MAX_FRAME_SIZE) {
+        error = true;
+        return false;
+    }
+
+    if (available < HEADER_SIZE + static_cast<qsizetype>(length)) return false;
+
+    payload = QByteArray(data + HEADER_SIZE, static_cast<int>(length));
+    readPos += HEADER_SIZE + length;
+    return true;
+}
+
+/**
+ * @brief Indicates whether the stream contained an oversized frame.
+ * @return True if the stream is corrupted.
+ */
+bool MessageFramer::hasError() const {
+    return error;
+}
+
+/**
+ * @brief Discards all buffered data and resets the error state.
+ */
+void MessageFramer::clear() {
+    buffer.resize(0);
+    readPos = 0;
+    error = false;
+}
+
+/**
+ * @brief Moves unread bytes to the front of the buffer.
+ */
+void MessageFramer::compact() {
+    if (readPos == 0) return;
+
+    const qsizetype remaining = buffer.size() - readPos;
+    if (remaining > 0) {
+        std::memmove(buffer.data(), buffer.constData() + readPos, remaining);
+    }
+    buffer.resize(remaining);
+    readPos = 0;
+}
@@ -0,0 +1,154 @@
+#include "Metrics.h"
+#include "Protocol.h"
+#include <iterator>
+
+namespace {
+
+/**
+ * @brief Name, type and help text of an exported metric.
+ */
+struct MetricInfo {
+    const char *name; ///< Metric name.
+    const char *type; ///< Prometheus type.
+    const char *help; ///< Help text.
+};
+
+const MetricInfo COUNTER_INFO[] = {
+    {"rps_connections_accepted_total", "counter", "TCP connections accepted."},
+    {"rps_connections_closed_total", "counter", "TCP connections closed."},
+    {"rps_received_bytes_total", "counter", "Bytes read from player sockets."},
+    {"rps_sent_bytes_total", "counter", "Bytes written to player sockets."},
+    {"rps_broadcast_datagrams_total", "counter", "Lobby announcement datagrams sent."},
+    {"rps_rounds_resolved_total", "counter", "Rounds resolved."},
+};
+
+const MetricInfo GAUGE_INFO[] = {
+    {"rps_seated_players", "gauge", "Players seated in a lobby."},
+    {"rps_spectators", "gauge", "Connections watching a lobby."},
+    {"rps_matchmaking_queued_players", "gauge", "Players waiting in the matchmaking queue."},
+    {"rps_send_queue_bytes", "gauge", "Bytes waiting in per-connection send queues."},
+    {"rps_send_queue_frames", "gauge", "Frames waiting in per-connection send queues."},
+    {"rps_send_queue_dropped_frames_total", "counter", "Frames dropped or superseded in send queues."},
+    {"rps_slow_consumer_disconnects_total", "counter", "Connections closed for reading too slowly."},
+};
+
+const MetricInfo HISTOGRAM_INFO[] = {
+    {"rps_round_resolution_seconds", "histogram", "Time to resolve a round and send its results."},
+    {"rps_move_wait_seconds", "histogram", "Time from a round start to the last move."},
+    {"rps_lobby_fill_seconds", "histogram", "Time from the first seated player to a full lobby."},
+};
+
+static_assert(std::size(COUNTER_INFO) == static_cast<size_t>(Metrics::Counter::Count), "Counter names");
+static_assert(std::size(GAUGE_INFO) == static_cast<size_t>(Metrics::Gauge::Count), "Gauge names");
+static_assert(std::size(HISTOGRAM_INFO) == static_cast<size_t>(Metrics::Histogram::Count), "Histogram names");
+
+/**
+ * @brief Appends the HELP and TYPE lines of a metric.
+ * @param out The output buffer.
+ * @param info The metric.
+ */
+void appendHeader(QByteArray &out, const MetricInfo &info) {
+    out.append("# HELP ").append(info.name).append(' ').append(info.help).append('\n');
+    out.append("# TYPE ").append(info.name).append(' ').append(info.type).append('\n');
+}
+
+/**
+ * @brief Formats microseconds as seconds.
+ * @param micros The duration in microseconds.
+ * @return The duration in seconds.
+ */
+QByteArray seconds(quint64 micros) {
+    return QByteArray::number(static_cast<double>(micros) / 1e6, 'g', 12);
+}
+
+} // namespace
+
+const qint64 Metrics::BUCKET_BOUNDS_US[BUCKET_COUNT] = {
+    10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000, 10000000, 60000000,
+};
+
+/**
+ * @brief Counts a protocol message by its opcode.
+ * @param direction Whether the message was received or sent.
+ * @param payload The payload of the frame.
+ * @param recipients The number of copies sent.
+ */
+void Metrics::countMessage(Direction direction, const QByteArray &payload, quint64 recipients) {
+    Protocol::Opcode opcode;
+    if (!Protocol::peekOpcode(payload, opcode)) return;
+    messages[static_cast<int>(direction)][static_cast<quint8>(opcode)].fetch_add(recipients, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Records a duration in a histogram.
+ *
+ * The buckets are few and sorted, so a linear scan is the fastest search.
+ *
+ * @param histogram The histogram.
+ * @param micros The duration in microseconds.
+ */
+void Metrics::observe(Histogram histogram, qint64 micros) {
+    HistogramData &data = histograms[static_cast<int>(histogram)];
+    micros = qMax<qint64>(micros, 0);
+
+    int bucket = 0;
+    while (bucket < BUCKET_COUNT && micros > BUCKET_BOUNDS_US[bucket]) ++bucket;
+
+    data.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    data.sumMicros.fetch_add(static_cast<quint64>(micros), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Renders every metric in the Prometheus text exposition format.
+ *
+ * Values are read one by one while other threads keep recording. The count
+ * of a histogram is its +Inf bucket, so only its sum may be slightly off.
+ *
+ * @return The rendered metrics.
+ */
+QByteArray Metrics::render() const {
+    QByteArray out;
+    out.reserve(8192);
+
+    for (int i = 0; i < static_cast<int>(Counter::Count); ++i) {
+        appendHeader(out, COUNTER_INFO[i]);
+        out.append(COUNTER_INFO[i].name).append(' ')
+            .append(QByteArray::number(counters[i].value.load(std::memory_order_relaxed))).append('\n');
+    }
+
+    for (int i = 0; i < static_cast<int>(Gauge::Count); ++i) {
+        appendHeader(out, GAUGE_INFO[i]);
+        out.append(GAUGE_INFO[i].name).append(' ')
+            .append(QByteArray::number(gauges[i].load(std::memory_order_relaxed))).append('\n');
+    }
+
+    const char *const messageNames[] = {"rps_received_messages_total", "rps_sent_messages_total"};
+    const char *const messageHelp[] = {"Protocol messages received, by opcode.", "Protocol messages sent, by opcode."};
+    for (int direction = 0; direction < 2; ++direction) {
+        appendHeader(out, MetricInfo{messageNames[direction], "counter", messageHelp[direction]});
+        for (int opcode = 0; opcode < 256; ++opcode) {
+            const quint64 value = messages[direction][opcode].load(std::memory_order_relaxed);
+            if (value == 0) continue;
+            out.append(messageNames[direction]).append("{opcode=\"")
+                .append(Protocol::opcodeName(static_cast<Protocol::Opcode>(opcode))).append("\"} ")
+                .append(QByteArray::number(value)).append('\n');
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(Histogram::Count); ++i) {
+        const HistogramData &data = histograms[i];
+        const QByteArray name(HISTOGRAM_INFO[i].name);
+        appendHeader(out, HISTOGRAM_INFO[i]);
+
+        quint64 cumulative = 0;
+        for (int bucket = 0; bucket <= BUCKET_COUNT; ++bucket) {
+            cumulative += data.buckets[bucket].load(std::memory_order_relaxed);
+            const QByteArray bound = bucket < BUCKET_COUNT ? seconds(BUCKET_BOUNDS_US[bucket]) : QByteArray("+Inf");
+            out.append(name).append("_bucket{le=\"").append(bound).append("\"} ")
+                .append(QByteArray::number(cumulative)).append('\n');
+        }
+        out.append(name).append("_sum ").append(seconds(data.sumMicros.load(std::memory_order_relaxed))).append('\n');
+        out.append(name).append("_count ").append(QByteArray::number(cumulative)).append('\n');
+    }
+    return out;
+}
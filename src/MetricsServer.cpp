@@ -0,0 +1,114 @@
+#include "MetricsServer.h"
+#include "Trace.h"
+#include <QDebug>
+
+/**
+ * @brief Constructs a server exporting a set of metrics.
+ * @param metrics The metrics.
+ * @param port The local TCP port to listen on.
+ * @param parent The parent QObject.
+ */
+MetricsServer::MetricsServer(Metrics *metrics, quint16 port, QObject *parent)
+    : QObject(parent), metrics(metrics), port(port) {
+    connect(&tcpServer, &QTcpServer::newConnection, this, &MetricsServer::onNewConnection);
+}
+
+/**
+ * @brief Starts listening for scrapes on the loopback interface.
+ * @return False if the port could not be bound.
+ */
+bool MetricsServer::start() {
+    if (tcpServer.isListening()) return true;
+
+    if (!tcpServer.listen(QHostAddress::LocalHost, port)) {
+        qDebug() << "Metrics server not started:" << tcpServer.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stops listening and closes every open connection.
+ */
+void MetricsServer::stop() {
+    tcpServer.close();
+
+    const QList<QTcpSocket *> sockets = requests.keys();
+    requests.clear();
+    for (QTcpSocket *socket : sockets) {
+        socket->abort();
+        socket->deleteLater();
+    }
+}
+
+/**
+ * @brief Accepts the pending scrape connections.
+ */
+void MetricsServer::onNewConnection() {
+    while (QTcpSocket *socket = tcpServer.nextPendingConnection()) {
+        socket->setParent(this);
+        requests.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, &MetricsServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket] {
+            requests.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+/**
+ * @brief Reads a request and answers it once its header is complete.
+ *
+ * Only the request line is interpreted; headers and bodies are ignored.
+ */
+void MetricsServer::onReadyRead() {
+    auto *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    const auto it = requests.find(socket);
+    if (it == requests.end()) return;
+
+    it->append(socket->readAll());
+    if (!it->contains("\r\n\r\n") && !it->contains("\n\n")) {
+        if (it->size() > MAX_REQUEST_BYTES) socket->abort();
+        return;
+    }
+
+    const QByteArray requestLine = it->left(it->indexOf('\n')).trimmed();
+    requests.erase(it);
+    disconnect(socket, &QTcpSocket::readyRead, this, &MetricsServer::onReadyRead);
+
+    const QList<QByteArray> parts = requestLine.split(' ');
+    const QByteArray path = parts.size() >= 2 ? parts[1].left(parts[1].indexOf('?')) : QByteArray();
+    if (parts.value(0) == "GET" && path == "/trace") {
+        respond(socket, "200 OK", "application/json", Trace::exportChromeJson());
+        return;
+    }
+    if (parts.value(0) != "GET" || path != "/metrics") {
+        respond(socket, "404 Not Found", "text/plain", "Not found\n");
+        return;
+    }
+
+    emit scrapeRequested();
+    respond(socket, "200 OK", "text/plain; version=0.0.4; charset=utf-8", metrics->render());
+}
+
+/**
+ * @brief Writes an HTTP response and closes the connection.
+ * @param socket The connection.
+ * @param status The status line after the protocol version.
+ * @param contentType The content type of the body.
+ * @param body The body.
+ */
+void MetricsServer::respond(QTcpSocket *socket, const char *status, const char *contentType, const QByteArray &body) {
+    QByteArray response;
+    response.reserve(body.size() + 128);
+    response.append("HTTP/1.0 ").append(status).append("\r\n");
+    response.append("Content-Type: ").append(contentType).append("\r\n");
+    response.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+    response.append("Connection: close\r\n\r\n");
+    response.append(body);
+
+    socket->write(response);
+    socket->disconnectFromHost();
+}
@@ -0,0 +1,50 @@
+#include "PingResponder.h"
+#include <QtEndian>
+#include <QDebug>
+
+/**
+ * @brief Constructs a responder.
+ * @param port The UDP port to answer on.
+ * @param parent The parent QObject.
+ */
+PingResponder::PingResponder(quint16 port, QObject *parent)
+    : QObject(parent), port(port) {
+    connect(&udpSocket, &QUdpSocket::readyRead, this, &PingResponder::onReadyRead);
+}
+
+/**
+ * @brief Starts answering probes.
+ * @return False if the port could not be bound.
+ */
+bool PingResponder::start() {
+    if (udpSocket.state() == QAbstractSocket::BoundState) return true;
+
+    if (!udpSocket.bind(QHostAddress::AnyIPv4, port)) {
+        qDebug() << "Ping responder not started:" << udpSocket.errorString();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stops answering probes.
+ */
+void PingResponder::stop() {
+    udpSocket.close();
+}
+
+/**
+ * @brief Echoes every pending well-formed probe to its sender.
+ */
+void PingResponder::onReadyRead() {
+    char packet[PACKET_SIZE + 1]; // One spare byte exposes oversized datagrams
+    QHostAddress sender;
+    quint16 senderPort = 0;
+
+    while (udpSocket.hasPendingDatagrams()) {
+        const qint64 size = udpSocket.readDatagram(packet, sizeof(packet), &sender, &senderPort);
+        if (size != PACKET_SIZE || qFromBigEndian<quint32>(packet) != MAGIC) continue;
+
+        udpSocket.writeDatagram(packet, PACKET_SIZE, sender, senderPort);
+    }
+}
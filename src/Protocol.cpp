@@ -0,0 +1,342 @@
+#include "Protocol.h"
+#include <QtEndian>
+
+namespace Protocol {
+
+namespace {
+
+/**
+ * @brief Checks whether a byte is a known opcode.
+ * @param opcode The received byte.
+ * @return True if the opcode is supported.
+ */
+bool isKnownOpcode(quint8 opcode) {
+    switch (static_cast<Opcode>(opcode)) {
+    case Opcode::Join:
+    case Opcode::Choice:
+    case Opcode::Pong:
+    case Opcode::Spectate:
+    case Opcode::Chat:
+    case Opcode::Identify:
+    case Opcode::Start:
+    case Opcode::Win:
+    case Opcode::Lose:
+    case Opcode::Draw:
+    case Opcode::Ping:
+    case Opcode::Next:
+    case Opcode::Round:
+    case Opcode::Moves:
+    case Opcode::Result:
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Checks whether a byte is the opcode of a fixed-size message.
+ * @param opcode The received byte.
+ * @return True if the opcode is supported and not Chat, which has its own frame shape.
+ */
+bool isMessageOpcode(quint8 opcode) {
+    return isKnownOpcode(opcode) && static_cast<Opcode>(opcode) != Opcode::Chat;
+}
+
+#ifdef RPS_TEXT_PROTOCOL
+/**
+ * @brief Encodes a message as a legacy text command.
+ * @param opcode The message type.
+ * @param value The payload.
+ * @return The text command.
+ */
+QByteArray encodeText(Opcode opcode, quint32 value) {
+    switch (opcode) {
+    case Opcode::Join: return "/join " + QByteArray::number(value);
+    case Opcode::Choice: return "/choice " + QByteArray::number(value);
+    case Opcode::Pong: return "/pong " + QByteArray::number(value);
+    case Opcode::Spectate: return "/spectate " + QByteArray::number(value);
+    case Opcode::Chat: return QByteArray(); // Not supported by text peers
+    case Opcode::Identify: return "/identify " + QByteArray::number(value);
+    case Opcode::Start: return "/start";
+    case Opcode::Win: return "/win";
+    case Opcode::Lose: return "/lose";
+    case Opcode::Draw: return "/draw";
+    case Opcode::Ping: return "/ping " + QByteArray::number(value);
+    case Opcode::Next: return "/next " + QByteArray::number(value);
+    case Opcode::Round: return "/round " + QByteArray::number(value);
+    case Opcode::Moves: return "/moves " + QByteArray::number(value);
+    case Opcode::Result: return "/result " + QByteArray::number(value);
+    }
+    return QByteArray();
+}
+
+/**
+ * @brief Decodes a legacy text command.
+ * @param data The received command.
+ * @param message Receives the decoded message.
+ * @return False if the command is unknown.
+ */
+bool decodeText(const QByteArray &data, Message &message) {
+    const QByteArray command = data.trimmed();
+    const int space = command.indexOf(' ');
+    const QByteArray name = space < 0 ? command : command.left(space);
+
+    bool valueOk = true;
+    message.value = space < 0 ? 0 : command.mid(space + 1).toUInt(&valueOk);
+    if (!valueOk) return false;
+
+    if (name == "/join") message.opcode = Opcode::Join;
+    else if (name == "/choice") message.opcode = Opcode::Choice;
+    else if (name == "/pong") message.opcode = Opcode::Pong;
+    else if (name == "/spectate") message.opcode = Opcode::Spectate;
+    else if (name == "/identify") message.opcode = Opcode::Identify;
+    else if (name == "/start") message.opcode = Opcode::Start;
+    else if (name == "/win") message.opcode = Opcode::Win;
+    else if (name == "/lose") message.opcode = Opcode::Lose;
+    else if (name == "/draw") message.opcode = Opcode::Draw;
+    else if (name == "/ping") message.opcode = Opcode::Ping;
+    else if (name == "/next") message.opcode = Opcode::Next;
+    else if (name == "/round") message.opcode = Opcode::Round;
+    else if (name == "/moves") message.opcode = Opcode::Moves;
+    else if (name == "/result") message.opcode = Opcode::Result;
+    else return false;
+
+    return true;
+}
+#endif
+
+} // namespace
+
+/**
+ * @brief Encodes a message.
+ * @param opcode The message type.
+ * @param value The payload.
+ * @return The encoded message; empty for Chat, which has its own encoders.
+ */
+QByteArray encode(Opcode opcode, quint32 value) {
+    // Chat has its own frame shape, and an empty payload would go out as a heartbeat
+    if (opcode == Opcode::Chat) return QByteArray();
+
+#ifdef RPS_TEXT_PROTOCOL
+    return encodeText(opcode, value);
+#else
+    QByteArray data(MESSAGE_SIZE, Qt::Uninitialized);
+    char *out = data.data();
+    out[0] = static_cast<char>(VERSION);
+    out[1] = static_cast<char>(opcode);
+    qToBigEndian<quint32>(value, out + 2);
+    return data;
+#endif
+}
+
+/**
+ * @brief Decodes a message.
+ * @param data The payload of a received frame.
+ * @param message Receives the decoded message.
+ * @return False if the data is not a valid message.
+ */
+bool decode(const QByteArray &data, Message &message) {
+#ifdef RPS_TEXT_PROTOCOL
+    if (data.startsWith('/')) {
+        return decodeText(data, message);
+    }
+#endif
+
+    if (data.size() != MESSAGE_SIZE) return false;
+
+    const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+    if (bytes[0] != VERSION || !isMessageOpcode(bytes[1])) return false;
+
+    message.opcode = static_cast<Opcode>(bytes[1]);
+    message.value = qFromBigEndian<quint32>(bytes + 2);
+    return true;
+}
+
+/**
+ * @brief Encodes several messages into the payload of one frame.
+ *
+ * Binary messages are concatenated; text commands are separated by newlines.
+ *
+ * @param messages The messages.
+ * @param count The number of messages.
+ * @return The encoded messages.
+ */
+QByteArray encodeBatch(const Message *messages, int count) {
+    QByteArray data;
+#ifdef RPS_TEXT_PROTOCOL
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) data.append('\n');
+        data.append(encodeText(messages[i].opcode, messages[i].value));
+    }
+#else
+    data.resize(count * MESSAGE_SIZE);
+    char *out = data.data();
+    for (int i = 0; i < count; ++i, out += MESSAGE_SIZE) {
+        out[0] = static_cast<char>(VERSION);
+        out[1] = static_cast<char>(messages[i].opcode);
+        qToBigEndian<quint32>(messages[i].value, out + 2);
+    }
+#endif
+    return data;
+}
+
+/**
+ * @brief Decodes the payload of a frame holding one or more messages.
+ * @param data The payload of a received frame.
+ * @param messages Receives the decoded messages.
+ * @return False if any message is invalid.
+ */
+bool decodeBatch(const QByteArray &data, QVector<Message> &messages) {
+    messages.resize(0);
+    Message message;
+
+#ifdef RPS_TEXT_PROTOCOL
+    if (data.startsWith('/')) {
+        for (const QByteArray &line : data.split('\n')) {
+            if (!decodeText(line, message)) return false;
+            messages.append(message);
+        }
+        return true;
+    }
+#endif
+
+    if (data.isEmpty() || data.size() % MESSAGE_SIZE != 0) return false;
+
+    const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+    for (int offset = 0; offset < data.size(); offset += MESSAGE_SIZE) {
+        if (bytes[offset] != VERSION || !isMessageOpcode(bytes[offset + 1])) return false;
+
+        message.opcode = static_cast<Opcode>(bytes[offset + 1]);
+        message.value = qFromBigEndian<quint32>(bytes + offset + 2);
+        messages.append(message);
+    }
+    return true;
+}
+
+/**
+ * @brief Reads the opcode of the first message of a frame payload without decoding the rest.
+ * @param data The payload of a frame.
+ * @param opcode Receives the opcode.
+ * @return False if the payload does not start with a known message.
+ */
+bool peekOpcode(const QByteArray &data, Opcode &opcode) {
+#ifdef RPS_TEXT_PROTOCOL
+    if (data.startsWith('/')) {
+        Message message;
+        const int end = data.indexOf('\n');
+        if (!decodeText(end < 0 ? data : data.left(end), message)) return false;
+        opcode = message.opcode;
+        return true;
+    }
+#endif
+
+    if (data.size() < 2 || static_cast<quint8>(data[0]) != VERSION) return false;
+    const auto byte = static_cast<quint8>(data[1]);
+    if (!isKnownOpcode(byte)) return false;
+
+    opcode = static_cast<Opcode>(byte);
+    return true;
+}
+
+/**
+ * @brief Returns the lowercase name of an opcode.
+ * @param opcode The opcode.
+ * @return The name; "unknown" for unsupported values.
+ */
+const char *opcodeName(Opcode opcode) {
+    switch (opcode) {
+    case Opcode::Join: return "join";
+    case Opcode::Choice: return "choice";
+    case Opcode::Pong: return "pong";
+    case Opcode::Spectate: return "spectate";
+    case Opcode::Chat: return "chat";
+    case Opcode::Identify: return "identify";
+    case Opcode::Start: return "start";
+    case Opcode::Win: return "win";
+    case Opcode::Lose: return "lose";
+    case Opcode::Draw: return "draw";
+    case Opcode::Ping: return "ping";
+    case Opcode::Next: return "next";
+    case Opcode::Round: return "round";
+    case Opcode::Moves: return "moves";
+    case Opcode::Result: return "result";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Checks whether a frame payload is a chat frame.
+ * @param data The payload of a received frame.
+ * @return True if the payload starts with the chat header.
+ */
+bool isChat(const QByteArray &data) {
+    return data.size() > 2 && static_cast<quint8>(data[0]) == VERSION
+           && static_cast<quint8>(data[1]) == static_cast<quint8>(Opcode::Chat);
+}
+
+/**
+ * @brief Encodes one chat message as a chat frame payload.
+ * @param message The chat message.
+ * @return The encoded frame payload; empty if the build does not support chat.
+ */
+QByteArray encodeChat(const ChatMessage &message) {
+#ifdef RPS_TEXT_PROTOCOL
+    Q_UNUSED(message);
+    return QByteArray();
+#else
+    QByteArray data;
+    data.reserve(2 + message.serializedSize());
+    data.append(static_cast<char>(VERSION));
+    data.append(static_cast<char>(Opcode::Chat));
+    message.serializeInto(data);
+    return data;
+#endif
+}
+
+/**
+ * @brief Encodes already serialized chat messages as one chat frame payload.
+ * @param records Concatenated ChatMessage records.
+ * @return The encoded frame payload; empty if the build does not support chat.
+ */
+QByteArray encodeChatRecords(const QByteArray &records) {
+#ifdef RPS_TEXT_PROTOCOL
+    Q_UNUSED(records);
+    return QByteArray();
+#else
+    QByteArray data;
+    data.reserve(2 + records.size());
+    data.append(static_cast<char>(VERSION));
+    data.append(static_cast<char>(Opcode::Chat));
+    data.append(records);
+    return data;
+#endif
+}
+
+/**
+ * @brief Decodes a chat frame payload.
+ *
+ * Records are read back to back; each one is exactly serializedSize() bytes long.
+ *
+ * @param data The payload of a received frame.
+ * @param messages Receives the chat messages.
+ * @return False if the payload is not a well-formed chat frame or the build does not support chat.
+ */
+bool decodeChat(const QByteArray &data, QVector<ChatMessage> &messages) {
+    messages.resize(0);
+#ifdef RPS_TEXT_PROTOCOL
+    Q_UNUSED(data);
+    return false;
+#else
+    if (!isChat(data)) return false;
+
+    qsizetype offset = 2;
+    while (offset < data.size()) {
+        ChatMessage message;
+        if (!message.deserialize(data.constData() + offset, data.size() - offset)) return false;
+        offset += message.serializedSize();
+        messages.append(message);
+    }
+    return true;
+#endif
+}
+
+} // namespace Protocol
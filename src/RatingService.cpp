@@ -0,0 +1,445 @@
+#include "RatingService.h"
+#include "Protocol.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr quint32 SNAPSHOT_MAGIC = 0x52535052; ///< "RPSR" read as a little-endian integer.
+constexpr quint16 SNAPSHOT_VERSION = 1;        ///< Version of the snapshot layout.
+
+/**
+ * @brief Header of a rating snapshot; followed by `count` SnapshotRecord entries.
+ */
+struct SnapshotHeader {
+    quint32 magic = SNAPSHOT_MAGIC;     ///< Identifies a rating snapshot.
+    quint16 version = SNAPSHOT_VERSION; ///< Version of the layout.
+    quint16 recordSize = 0;             ///< Size of one record in bytes.
+    quint32 count = 0;                  ///< Number of records.
+    quint32 reserved = 0;               ///< Padding; always 0.
+    qint64 savedMs = 0;                 ///< Time of the snapshot in milliseconds since the Unix epoch.
+};
+
+/**
+ * @brief One player in a rating snapshot.
+ */
+struct SnapshotRecord {
+    double rating = 0;     ///< The Elo rating.
+    quint32 playerKey = 0; ///< The stable key of the player.
+    quint32 rounds = 0;    ///< Rounds played.
+    quint32 wins = 0;      ///< Rounds won.
+    quint32 losses = 0;    ///< Rounds lost.
+    quint32 draws = 0;     ///< Rounds drawn.
+    quint32 reserved = 0;  ///< Padding; always 0.
+};
+
+static_assert(sizeof(SnapshotHeader) == 24, "SnapshotHeader layout must stay fixed");
+static_assert(sizeof(SnapshotRecord) == 32, "SnapshotRecord layout must stay fixed");
+
+/**
+ * @brief Returns the expected Elo score of a player against an opponent.
+ * @param rating The player's rating.
+ * @param opponent The opponent's rating.
+ * @return The expected score between 0 and 1.
+ */
+double expectedScore(double rating, double opponent) {
+    return 1.0 / (1.0 + std::pow(10.0, (opponent - rating) / 400.0));
+}
+
+/**
+ * @brief Writes a serialized snapshot and atomically replaces the old file.
+ * @param path The snapshot file.
+ * @param data The serialized snapshot.
+ */
+void writeSnapshotFile(const QString &path, const QByteArray &data) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "Cannot write rating snapshot" << path << ":" << file.errorString();
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Constructs an empty rating service.
+ * @param parent The parent QObject.
+ */
+RatingService::RatingService(QObject *parent)
+    : QObject(parent), buckets(RATING_BUCKETS), tree(RATING_BUCKETS + 1, 0) {
+    connect(&snapshotTimer, &QTimer::timeout, this, &RatingService::onSnapshotTimer);
+}
+
+/**
+ * @brief Saves a final snapshot if snapshots are enabled.
+ *
+ * The final snapshot is written synchronously after any snapshot in flight.
+ */
+RatingService::~RatingService() {
+    if (snapshotThread) {
+        snapshotThread->wait();
+        delete snapshotThread;
+    }
+    if (!snapshotPath.isEmpty() && dirty) {
+        writeSnapshotFile(snapshotPath, serializeSnapshot());
+    }
+}
+
+/**
+ * @brief Updates the ratings after a round.
+ *
+ * All players are scored against the ratings from before the round, so the
+ * order of the players does not matter. With two players this is plain Elo.
+ *
+ * @param count The number of players.
+ * @param playerKeys The stable keys of the players.
+ * @param outcomes The results as Protocol::Opcode values.
+ */
+void RatingService::recordRound(int count, const quint32 *playerKeys, const quint8 *outcomes) {
+    if (count < 2) return;
+
+    const auto win = static_cast<quint8>(Protocol::Opcode::Win);
+    const auto lose = static_cast<quint8>(Protocol::Opcode::Lose);
+
+    // Snapshot the ratings and the averages of every side
+    scratchRatings.resize(count);
+    double winSum = 0, loseSum = 0, allSum = 0;
+    int winners = 0, losers = 0;
+    for (int i = 0; i < count; ++i) {
+        const double rating = entryOf(playerKeys[i]).player.rating;
+        scratchRatings[i] = rating;
+        allSum += rating;
+        if (outcomes[i] == win) {
+            winSum += rating;
+            ++winners;
+        } else if (outcomes[i] == lose) {
+            loseSum += rating;
+            ++losers;
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        Entry &entry = entryOf(playerKeys[i]);
+        const double rating = scratchRatings[i];
+        ++entry.player.rounds;
+
+        // Each side is weighted by its share of the opponents, which keeps a round close to zero-sum
+        double opponent = 0;
+        double score = 0;
+        double weight = 1.0;
+        if (outcomes[i] == win && losers > 0) {
+            opponent = loseSum / losers;
+            score = 1.0;
+            weight = double(losers) / (count - 1);
+            ++entry.player.wins;
+        } else if (outcomes[i] == lose && winners > 0) {
+            opponent = winSum / winners;
+            score = 0.0;
+            weight = double(winners) / (count - 1);
+            ++entry.player.losses;
+        } else {
+            opponent = (allSum - rating) / (count - 1);
+            score = 0.5;
+            ++entry.player.draws;
+        }
+
+        const double change = K_FACTOR * weight * (score - expectedScore(rating, opponent));
+        entry.player.rating = qBound(0.0, rating + change, double(RATING_BUCKETS - 1));
+        reindex(entry);
+    }
+
+    dirty = true;
+}
+
+/**
+ * @brief Returns the number of rated players.
+ * @return The player count.
+ */
+int RatingService::playerCount() const {
+    return static_cast<int>(entries.size());
+}
+
+/**
+ * @brief Returns the rating of a player.
+ * @param playerKey The key of the player.
+ * @return The rating; a new player's rating if the player is unknown.
+ */
+RatingService::PlayerRating RatingService::rating(quint32 playerKey) const {
+    const auto it = entries.constFind(playerKey);
+    if (it == entries.constEnd()) {
+        PlayerRating unknown;
+        unknown.playerKey = playerKey;
+        return unknown;
+    }
+    return it->player;
+}
+
+/**
+ * @brief Returns the rank of a player.
+ *
+ * The rank is one more than the number of players in higher buckets.
+ *
+ * @param playerKey The key of the player.
+ * @return 1 for the best player, or 0 if the player is unknown.
+ */
+int RatingService::rank(quint32 playerKey) const {
+    const auto it = entries.constFind(playerKey);
+    if (it == entries.constEnd()) return 0;
+
+    return playerCount() - countUpTo(it->bucket) + 1;
+}
+
+/**
+ * @brief Returns the best players.
+ *
+ * Buckets are visited from the top with one Fenwick descent each; the players
+ * of the visited buckets are then ordered by their exact ratings.
+ *
+ * @param k The number of players.
+ * @return Up to k players, best first.
+ */
+QVector<RatingService::PlayerRating> RatingService::top(int k) const {
+    QVector<PlayerRating> best;
+    k = qMin(k, playerCount());
+    if (k <= 0) return best;
+
+    int collected = 0;
+    while (collected < k) {
+        // The bucket holding the highest player not collected yet
+        const int bucket = findBucket(playerCount() - collected);
+        for (quint32 playerKey : buckets[bucket]) {
+            best.append(entries.value(playerKey).player);
+        }
+        collected += static_cast<int>(buckets[bucket].size());
+    }
+
+    std::sort(best.begin(), best.end(), [](const PlayerRating &a, const PlayerRating &b) {
+        return a.rating > b.rating;
+    });
+    best.resize(k);
+    return best;
+}
+
+/**
+ * @brief Replaces all ratings with the contents of a snapshot.
+ * @param path The snapshot file.
+ * @return False if the file is missing or not a rating snapshot.
+ */
+bool RatingService::loadSnapshot(const QString &path) {
+#if Q_BYTE_ORDER != Q_LITTLE_ENDIAN
+    Q_UNUSED(path);
+    return false;
+#else
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const QByteArray data = file.readAll();
+
+    SnapshotHeader header;
+    if (data.size() < qsizetype(sizeof(header))) return false;
+    std::memcpy(&header, data.constData(), sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION
+        || header.recordSize != sizeof(SnapshotRecord)
+        || data.size() < qsizetype(sizeof(header) + qsizetype(header.count) * sizeof(SnapshotRecord))) {
+        return false;
+    }
+
+    clear();
+    entries.reserve(header.count);
+
+    const char *in = data.constData() + sizeof(header);
+    for (quint32 i = 0; i < header.count; ++i, in += sizeof(SnapshotRecord)) {
+        SnapshotRecord record;
+        std::memcpy(&record, in, sizeof(record));
+
+        Entry &entry = entryOf(record.playerKey);
+        entry.player.rating = qBound(0.0, record.rating, double(RATING_BUCKETS - 1));
+        entry.player.rounds = record.rounds;
+        entry.player.wins = record.wins;
+        entry.player.losses = record.losses;
+        entry.player.draws = record.draws;
+        reindex(entry);
+    }
+
+    dirty = false;
+    return true;
+#endif
+}
+
+/**
+ * @brief Writes a snapshot of all ratings.
+ * @param path The snapshot file.
+ * @return False if a snapshot is already being written.
+ */
+bool RatingService::saveSnapshot(const QString &path) {
+    if (snapshotThread) return false;
+
+    snapshotThread = QThread::create(writeSnapshotFile, path, serializeSnapshot());
+    connect(snapshotThread, &QThread::finished, this, [this] {
+        snapshotThread->deleteLater();
+        snapshotThread = nullptr;
+    });
+    snapshotThread->start();
+    return true;
+}
+
+/**
+ * @brief Serializes all ratings into the snapshot layout.
+ *
+ * Clears the dirty flag.
+ *
+ * @return The serialized snapshot.
+ */
+QByteArray RatingService::serializeSnapshot() {
+    SnapshotHeader header;
+    header.recordSize = sizeof(SnapshotRecord);
+    header.count = static_cast<quint32>(entries.size());
+    header.savedMs = QDateTime::currentMSecsSinceEpoch();
+
+    QByteArray data(qsizetype(sizeof(header) + entries.size() * sizeof(SnapshotRecord)), Qt::Uninitialized);
+    std::memcpy(data.data(), &header, sizeof(header));
+    char *out = data.data() + sizeof(header);
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it, out += sizeof(SnapshotRecord)) {
+        SnapshotRecord record;
+        record.rating = it->player.rating;
+        record.playerKey = it->player.playerKey;
+        record.rounds = it->player.rounds;
+        record.wins = it->player.wins;
+        record.losses = it->player.losses;
+        record.draws = it->player.draws;
+        std::memcpy(out, &record, sizeof(record));
+    }
+
+    dirty = false;
+    return data;
+}
+
+/**
+ * @brief Saves a snapshot periodically while ratings change.
+ * @param path The snapshot file; empty disables snapshots.
+ * @param intervalMs The interval between snapshots.
+ */
+void RatingService::setSnapshotFile(const QString &path, int intervalMs) {
+    snapshotPath = path;
+    if (path.isEmpty()) {
+        snapshotTimer.stop();
+    } else {
+        snapshotTimer.start(qMax(1000, intervalMs));
+    }
+}
+
+/**
+ * @brief Saves a snapshot if ratings changed since the last one.
+ */
+void RatingService::onSnapshotTimer() {
+    if (dirty) {
+        saveSnapshot(snapshotPath);
+    }
+}
+
+/**
+ * @brief Returns the bucket of a rating.
+ * @param rating The rating.
+ * @return The bucket index.
+ */
+int RatingService::bucketOf(double rating) {
+    return qBound(0, static_cast<int>(std::lround(rating)), RATING_BUCKETS - 1);
+}
+
+/**
+ * @brief Returns the entry of a player, creating it if needed.
+ * @param playerKey The key of the player.
+ * @return The entry.
+ */
+RatingService::Entry &RatingService::entryOf(quint32 playerKey) {
+    auto it = entries.find(playerKey);
+    if (it == entries.end()) {
+        it = entries.insert(playerKey, Entry());
+        it->player.playerKey = playerKey;
+        reindex(*it);
+    }
+    return *it;
+}
+
+/**
+ * @brief Moves an entry into the bucket matching its rating.
+ *
+ * Buckets are unordered; a removed player's place is taken by the last
+ * player of the bucket.
+ *
+ * @param entry The entry.
+ */
+void RatingService::reindex(Entry &entry) {
+    const int bucket = bucketOf(entry.player.rating);
+    if (bucket == entry.bucket) return;
+
+    if (entry.bucket >= 0) {
+        QVector<quint32> &old = buckets[entry.bucket];
+        const quint32 moved = old.last();
+        old[entry.position] = moved;
+        old.removeLast();
+        if (moved != entry.player.playerKey) {
+            entries[moved].position = entry.position;
+        }
+        addToIndex(entry.bucket, -1);
+    }
+
+    entry.bucket = bucket;
+    entry.position = static_cast<int>(buckets[bucket].size());
+    buckets[bucket].append(entry.player.playerKey);
+    addToIndex(bucket, 1);
+}
+
+/**
+ * @brief Adds to the player count of a bucket.
+ * @param bucket The bucket index.
+ * @param delta The change of the count.
+ */
+void RatingService::addToIndex(int bucket, int delta) {
+    for (int i = bucket + 1; i <= RATING_BUCKETS; i += i & -i) {
+        tree[i] += delta;
+    }
+}
+
+/**
+ * @brief Counts the players in buckets up to and including a bucket.
+ * @param bucket The bucket index.
+ * @return The number of players.
+ */
+int RatingService::countUpTo(int bucket) const {
+    int count = 0;
+    for (int i = bucket + 1; i > 0; i -= i & -i) {
+        count += tree[i];
+    }
+    return count;
+}
+
+/**
+ * @brief Finds the lowest bucket whose cumulative player count reaches a target.
+ * @param target The cumulative count, between 1 and playerCount().
+ * @return The bucket index.
+ */
+int RatingService::findBucket(int target) const {
+    int position = 0;
+    for (int step = RATING_BUCKETS; step > 0; step >>= 1) {
+        if (position + step <= RATING_BUCKETS && tree[position + step] < target) {
+            position += step;
+            target -= tree[position];
+        }
+    }
+    return position; // The 1-based tree index position + 1 is bucket `position`
+}
+
+/**
+ * @brief Removes all players.
+ */
+void RatingService::clear() {
+    entries.clear();
+    for (QVector<quint32> &bucket : buckets) {
+        bucket.clear();
+    }
+    tree.fill(0);
+}
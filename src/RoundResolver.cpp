@@ -0,0 +1,66 @@
+#include "RoundResolver.h"
+#include <cstring>
+
+namespace RoundResolver {
+
+/**
+ * @brief Counts the moves of a round.
+ *
+ * Each count is a sum of byte comparisons, which compiles to vector compares
+ * and adds instead of a data-dependent histogram update.
+ *
+ * @param choices The packed moves.
+ * @param count The number of player slots.
+ * @return The move counts and the winning move.
+ */
+Result tally(const quint8 *choices, int count) {
+    Result result;
+
+    int rock = 0;
+    int paper = 0;
+    int scissors = 0;
+    for (int i = 0; i < count; ++i) {
+        const quint8 choice = choices[i];
+        rock += choice == GameRules::Rock;
+        paper += choice == GameRules::Paper;
+        scissors += choice == GameRules::Scissors;
+    }
+
+    result.rock = rock;
+    result.paper = paper;
+    result.scissors = scissors;
+    result.winningChoice = GameRules::winningChoice(rock > 0, paper > 0, scissors > 0);
+    return result;
+}
+
+/**
+ * @brief Resolves a round and writes the outcome of every player slot.
+ * @param choices The packed moves.
+ * @param count The number of player slots.
+ * @param outcomes Receives one Protocol::Opcode byte per slot.
+ * @return The summary of the round.
+ */
+Result resolve(const quint8 *choices, int count, quint8 *outcomes) {
+    Result result = tally(choices, count);
+
+    if (result.winningChoice == GameRules::None) {
+        std::memset(outcomes, static_cast<int>(Protocol::Opcode::Draw), static_cast<size_t>(count));
+        return result;
+    }
+
+    const quint8 winning = static_cast<quint8>(result.winningChoice);
+    const quint8 win = static_cast<quint8>(Protocol::Opcode::Win);
+    const quint8 lose = static_cast<quint8>(Protocol::Opcode::Lose);
+    for (int i = 0; i < count; ++i) {
+        outcomes[i] = choices[i] == winning ? win : lose;
+    }
+
+    switch (result.winningChoice) {
+    case GameRules::Rock: result.winners = result.rock; break;
+    case GameRules::Paper: result.winners = result.paper; break;
+    default: result.winners = result.scissors; break;
+    }
+    return result;
+}
+
+} // namespace RoundResolver
@@ -0,0 +1,171 @@
+#include "SendQueue.h"
+
+/**
+ * @brief Constructs an empty queue.
+ * @param limits The limits; nullptr leaves the queue unbounded.
+ * @param counters The shared counters; nullptr counts nothing.
+ */
+SendQueue::SendQueue(const SendQueueLimits *limits, Counters *counters) : limits(limits), counters(counters) {}
+
+/**
+ * @brief Queues a frame.
+ *
+ * A new snapshot always replaces the queued one. Lower priority classes are
+ * shed before the policy applies. Control frames are never discarded: one
+ * that does not fit overflows the queue whatever the policy.
+ *
+ * @param priority The priority class of the frame.
+ * @param frame The framed message.
+ * @return Whether the frame was queued, discarded or overflowed the queue.
+ */
+SendQueue::Result SendQueue::push(Priority priority, const QByteArray &frame) {
+    if (priority == Priority::Snapshot && !snapshot.isEmpty()) {
+        account(-snapshot.size(), -1);
+        countDropped(1);
+        snapshot.clear();
+    }
+
+    const qint64 size = frame.size();
+    while (!fits(size) && shedBelow(priority)) {}
+
+    if (!fits(size)) {
+        if (priority == Priority::Control || limits->policy == SendQueueLimits::Policy::Disconnect) {
+            return Result::Overflow;
+        }
+
+        // The snapshot was already replaced, so only bulk frames can coalesce
+        if (limits->policy == SendQueueLimits::Policy::Coalesce && priority == Priority::Bulk) {
+            while (!bulk.isEmpty() && !fits(size)) dropOldest(bulk);
+        }
+        if (!fits(size)) {
+            countDropped(1); // Also a frame larger than the limits on its own
+            return Result::Dropped;
+        }
+    }
+
+    switch (priority) {
+    case Priority::Control: control.enqueue(frame); break;
+    case Priority::Snapshot: snapshot = frame; break;
+    case Priority::Bulk: bulk.enqueue(frame); break;
+    }
+    account(size, 1);
+    return Result::Queued;
+}
+
+/**
+ * @brief Takes the next frame to write, highest priority first.
+ * @param frame Receives the frame.
+ * @param socketIdle True if the socket has no unsent data.
+ * @return False if no frame may be written now.
+ */
+bool SendQueue::pop(QByteArray &frame, bool socketIdle) {
+    if (!control.isEmpty()) {
+        frame = control.dequeue();
+    } else if (!snapshot.isEmpty()) {
+        frame = snapshot;
+        snapshot.clear();
+    } else if (!bulk.isEmpty() && socketIdle) {
+        frame = bulk.dequeue();
+    } else {
+        return false;
+    }
+
+    account(-frame.size(), -1);
+    return true;
+}
+
+/**
+ * @brief Checks whether the queue is empty.
+ * @return True if no frame is queued.
+ */
+bool SendQueue::isEmpty() const {
+    return queuedFrames == 0;
+}
+
+/**
+ * @brief Returns the number of queued bytes.
+ * @return The total size of the queued frames.
+ */
+qint64 SendQueue::bytes() const {
+    return queuedBytes;
+}
+
+/**
+ * @brief Returns the number of queued frames.
+ * @return The number of queued frames.
+ */
+int SendQueue::frames() const {
+    return queuedFrames;
+}
+
+/**
+ * @brief Discards every queued frame without counting it as dropped.
+ */
+void SendQueue::clear() {
+    account(-queuedBytes, -queuedFrames);
+    control.clear();
+    snapshot.clear();
+    bulk.clear();
+}
+
+/**
+ * @brief Checks whether a frame fits within the limits.
+ * @param size The size of the frame.
+ * @return True if the frame can be queued without exceeding a limit.
+ */
+bool SendQueue::fits(qint64 size) const {
+    return !limits || (queuedBytes + size <= limits->maxBytes && queuedFrames < limits->maxFrames);
+}
+
+/**
+ * @brief Discards the oldest queued frame of a lower priority class.
+ *
+ * Bulk frames go before the snapshot.
+ *
+ * @param priority The priority class of the frame that needs room.
+ * @return False if there was no such frame.
+ */
+bool SendQueue::shedBelow(Priority priority) {
+    if (priority != Priority::Bulk && !bulk.isEmpty()) {
+        dropOldest(bulk);
+        return true;
+    }
+    if (priority == Priority::Control && !snapshot.isEmpty()) {
+        account(-snapshot.size(), -1);
+        countDropped(1);
+        snapshot.clear();
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Discards the oldest frame of a queue and counts it as dropped.
+ * @param queue The queue.
+ */
+void SendQueue::dropOldest(QQueue<QByteArray> &queue) {
+    account(-queue.dequeue().size(), -1);
+    countDropped(1);
+}
+
+/**
+ * @brief Adds to the depth of this queue and of the shared counters.
+ * @param bytes The change of the queued bytes.
+ * @param frames The change of the queued frames.
+ */
+void SendQueue::account(qint64 bytes, int frames) {
+    queuedBytes += bytes;
+    queuedFrames += frames;
+    if (counters) {
+        counters->queuedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        counters->queuedFrames.fetch_add(frames, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Counts discarded frames in the shared counters.
+ * @param frames The number of discarded frames.
+ */
+void SendQueue::countDropped(int frames) {
+    if (counters) counters->droppedFrames.fetch_add(frames, std::memory_order_relaxed);
+}
@@ -1,6 +1,11 @@
 #include "ServerLobby.h"
+#include "GameRules.h"
+#include "RoundResolver.h"
+#include "Protocol.h"
+#include "Trace.h"
 #include <QDebug>
 #include <QNetworkInterface>
+#include <QVector>
 
 /**
  * @brief Constructs a ServerLobby instance, starts the server, and begins broadcasting lobby information.
@@ -8,13 +13,16 @@
  * @param maxPlayers The maximum number of players allowed.
  * @param serverPort The TCP port for player connections.
  * @param broadcastPort The UDP port for lobby broadcasting.
+ * @param discovery The channels used to announce the lobby.
  * @param parent The parent QObject.
  */
-ServerLobby::ServerLobby(QString lobbyName, int maxPlayers, quint16 serverPort, quint16 broadcastPort, QObject *parent)
-    : QObject(parent), maxPlayers(maxPlayers), tcpPort(serverPort), udpPort(broadcastPort) {
+ServerLobby::ServerLobby(QString lobbyName, int maxPlayers, quint16 serverPort, quint16 broadcastPort,
+                         const DiscoveryConfig &discovery, QObject *parent)
+    : QObject(parent), maxPlayers(maxPlayers), tcpPort(serverPort), udpPort(broadcastPort), discovery(discovery) {
 
     // Initialize lobby information
     lobbyInfo = LobbyInfo(lobbyName, maxPlayers, 0, tcpPort);
+    clock.start();
 
     // Attempt to start the server, otherwise throw an error
     if (!startServer()) {
@@ -36,6 +44,7 @@ bool ServerLobby::startServer() {
     connect(server.get(), &LanTcpServer::playerConnected, this, &ServerLobby::onPlayerConnected);
     connect(server.get(), &LanTcpServer::playerDisconnected, this, &ServerLobby::onPlayerDisconnected);
     connect(server.get(), &LanTcpServer::messageReceived, this, &ServerLobby::onMessageRecived);
+    server->setMetrics(metrics);
 
     // Start the server
     if (!server->startListening()) {
@@ -43,6 +52,13 @@ bool ServerLobby::startServer() {
         return false;
     }
 
+    // Probes are optional for clients, so a busy UDP port is not fatal
+    pingResponder = std::make_unique<PingResponder>(tcpPort, this);
+    pingResponder->start();
+
+    spectators = std::make_unique<SpectatorHub>(server.get(), this);
+    chat = std::make_unique<LobbyChat>(server.get(), this);
+
     refreshLobbyInfo();
     return true;
 }
@@ -51,16 +67,26 @@ bool ServerLobby::startServer() {
  * @brief Stops the server and clears the player list.
  */
 void ServerLobby::stopServer() {
+    spectators.reset(); // Sends through the server, so it goes first
+    chat.reset();
     server.reset();
+    pingResponder.reset();
     players.clear();
+    playerIdOfSession.clear();
+    identityOfSession.clear();
+    playerChoices.clear();
+    chosenCount = 0;
+    roundInProgress = false;
 }
 
 /**
- * @brief Pauses lobby search by stopping new player connections and broadcasts.
+ * @brief Pauses lobby search by stopping the broadcast.
+ *
+ * Connections are still accepted so spectators can join a full lobby;
+ * seatPlayer() turns away players who join it.
  */
 void ServerLobby::pauseLobbySearch() {
     if (server) {
-        server->setAcceptingPlayers(false);
         stopBroadcast();
     }
 }
@@ -84,6 +110,8 @@ bool ServerLobby::resumeLobbySearch() {
 void ServerLobby::startBroadcast() {
     if (!broadcaster) {
         broadcaster = std::make_unique<UdpBroadcaster>(udpPort, this);
+        broadcaster->setDiscoveryConfig(discovery);
+        broadcaster->setMetrics(metrics);
         connect(this, &ServerLobby::lobbyInfoUpdated, broadcaster.get(), &UdpBroadcaster::onRefreshLobbyInfo);
     }
 
@@ -100,10 +128,22 @@ void ServerLobby::stopBroadcast() {
 }
 
 /**
- * @brief Handles a new player connection.
+ * @brief Handles a new connection.
+ *
+ * The connection is seated only by its join handshake, so a spectator never
+ * takes a seat.
+ *
  * @param player The connected player.
  */
 void ServerLobby::onPlayerConnected(const PlayerConnection &player) {
+    qDebug() << player.playerName << "@" << player.ipAddress.toString() << "connected";
+}
+
+/**
+ * @brief Seats a player who sent the join handshake.
+ * @param player The player.
+ */
+void ServerLobby::seatPlayer(const PlayerConnection &player) {
     if (!server) return;
 
     // Check if there is space in the lobby
@@ -112,29 +152,60 @@ void ServerLobby::onPlayerConnected(const PlayerConnection &player) {
         return;
     }
 
-    // Check if the player is already connected
-    auto it = std::find_if(players.begin(), players.end(), [&](const PlayerConnection &p) {
-        return p.playerName == player.playerName && p.ipAddress == player.ipAddress;
-    });
-
-    if (it != players.end()) {
+    // Check if the player's session is already seated
+    if (playerIdOfSession.contains(player.sessionId)) {
         server->disconnectPlayer(player);
         return;
     }
 
+    playerIdOfSession.insert(player.sessionId, players.size());
     players.append(player); // Add the player to the list
+    playerChoices.append(GameRules::None);
+    chat->addMember(player.sessionId);
+    if (players.size() == 1) fillStartUs = clock.nsecsElapsed() / 1000;
     refreshLobbyInfo();
 }
 
 /**
  * @brief Handles player disconnection by removing them from the list.
+ *
+ * The last player takes over the freed ID, so only one index entry changes.
+ *
  * @param player The player who disconnected.
  */
 void ServerLobby::onPlayerDisconnected(const PlayerConnection &player) {
-    auto it = std::remove_if(players.begin(), players.end(), [&](const PlayerConnection &p) {
-        return p.ipAddress == player.ipAddress;
-    });
-    players.erase(it, players.end());
+    identityOfSession.remove(player.sessionId);
+    if (spectators && spectators->removeSpectator(player.sessionId)) {
+        updateGauges();
+        return;
+    }
+
+    const auto it = playerIdOfSession.constFind(player.sessionId);
+    if (it == playerIdOfSession.constEnd()) return; // Rejected connections were never seated
+
+    const int playerId = it.value();
+    const int lastId = players.size() - 1;
+    playerIdOfSession.erase(it);
+    chat->removeMember(player.sessionId);
+
+    if (playerChoices[playerId] != GameRules::None) --chosenCount;
+
+    if (playerId != lastId) {
+        players[playerId] = players[lastId];
+        playerChoices[playerId] = playerChoices[lastId];
+        playerIdOfSession.insert(players[playerId].sessionId, playerId);
+    }
+    players.removeLast();
+    playerChoices.removeLast();
+    if (players.isEmpty()) {
+        fillStartUs = -1;
+        roundInProgress = false;
+    }
+
+    // A player who timed out must not stall the others' round
+    if (chosenCount > 0 && chosenCount == players.size()) {
+        calculateWinners();
+    }
 
     refreshLobbyInfo();
 }
@@ -145,35 +216,61 @@ void ServerLobby::onPlayerDisconnected(const PlayerConnection &player) {
  * @param msg The message content.
  */
 void ServerLobby::onMessageRecived(const PlayerConnection &player, const QByteArray &msg) {
-    QString message = QString::fromUtf8(msg).trimmed();
+    TRACE_SCOPE("lobby", "ServerLobby::onMessageRecived");
+    if (Protocol::isChat(msg)) {
+        if (chat) chat->post(player, msg);
+        return;
+    }
 
-    if (message.startsWith("/choice")) {
-        QStringList parts = message.split(" ");
-        if (parts.size() == 2) {
-            int choice = parts[1].toInt();
+    Protocol::Message message;
+    if (!Protocol::decode(msg, message)) return;
 
-            int playerId = getPlayerId(player);
-            playerMove(playerId, choice);
+    switch (message.opcode) {
+    case Protocol::Opcode::Choice: {
+        const int choice = static_cast<int>(message.value);
 
-            if (playerChoices.size() == players.size()) {
-                calculateWinners();
+        int playerId = getPlayerId(player);
+        if (playerId < 0 || !GameRules::isValidChoice(choice)) return;
+        playerMove(playerId, choice);
+
+        if (chosenCount == players.size()) {
+            if (metrics && roundStartUs >= 0) {
+                metrics->observe(Metrics::Histogram::MoveWait, clock.nsecsElapsed() / 1000 - roundStartUs);
             }
+            calculateWinners();
+
+            // Seats freed during the round reopen once it is resolved
+            if (players.size() < maxPlayers) refreshLobbyInfo();
         }
+        break;
+    }
+    case Protocol::Opcode::Identify:
+        if (message.value != 0) identityOfSession.insert(player.sessionId, message.value);
+        break;
+    case Protocol::Opcode::Join:
+        // A single-lobby host has one lobby, so the requested lobby ID does not matter
+        if (spectators) spectators->removeSpectator(player.sessionId);
+        seatPlayer(player);
+        break;
+    case Protocol::Opcode::Spectate:
+        if (spectators && !playerIdOfSession.contains(player.sessionId)) {
+            spectators->addSpectator(player.sessionId, lobbyInfo.lobbyId,
+                                     roundInProgress ? static_cast<int>(players.size()) : 0);
+            updateGauges();
+        }
+        break;
+    default:
+        break;
     }
 }
 
 /**
- * @brief Gets the player ID based on their IP address.
+ * @brief Gets the player ID based on their session ID.
  * @param player The player.
  * @return The player's ID or -1 if not found.
  */
-int ServerLobby::getPlayerId(const PlayerConnection &player) {
-    for (int i = 0; i < players.size(); ++i) {
-        if (players[i].ipAddress == player.ipAddress) {
-            return i;
-        }
-    }
-    return -1;
+int ServerLobby::getPlayerId(const PlayerConnection &player) const {
+    return playerIdOfSession.value(player.sessionId, -1);
 }
 
 /**
@@ -182,25 +279,38 @@ int ServerLobby::getPlayerId(const PlayerConnection &player) {
  * @param choice The player's choice (1 - rock, 2 - paper, 3 - scissors).
  */
 void ServerLobby::playerMove(int playerId, int choice) {
-    playerChoices[playerId] = choice;
+    if (playerChoices[playerId] == GameRules::None) {
+        ++chosenCount;
+        server->fulfilMessage(players[playerId].sessionId);
+    }
+    playerChoices[playerId] = static_cast<quint8>(choice);
 }
 
 /**
  * @brief Checks if there is room available in the lobby.
+ *
+ * Seats left by players during a round stay closed until it is resolved.
+ *
  * @return True if space is available, otherwise false.
  */
 bool ServerLobby::isRoomAvailable() const {
-    return players.size() < maxPlayers;
+    return !roundInProgress && players.size() < maxPlayers;
 }
 
 /**
  * @brief Updates the lobby information and starts the game if the lobby is full.
+ *
+ * While a round is in progress the lobby stays hidden and no round starts,
+ * even if players left it.
  */
 void ServerLobby::refreshLobbyInfo() {
     lobbyInfo.currentPlayers = players.size();
     emit lobbyInfoUpdated(lobbyInfo);
+    updateGauges();
 
-    if (players.size() >= maxPlayers) {
+    if (roundInProgress) {
+        pauseLobbySearch();
+    } else if (players.size() >= maxPlayers) {
         pauseLobbySearch();
 
         if (players.size() == maxPlayers) {
@@ -213,65 +323,137 @@ void ServerLobby::refreshLobbyInfo() {
 
 /**
  * @brief Starts the game when the lobby is full.
+ *
+ * Every player must answer with a move within the move timeout.
  */
 void ServerLobby::startGame() {
-    QString startMessage = "/start";
+    TRACE_SCOPE("lobby", "ServerLobby::startGame");
+    const QByteArray startMessage = Protocol::encode(Protocol::Opcode::Start);
+    QVector<quint32> sessions;
+    sessions.reserve(players.size());
     for (const PlayerConnection &player : std::as_const(players)) {
         qDebug() << player.playerName << "@" << player.ipAddress.toString();
+        sessions.append(player.sessionId);
+    }
+    server->expectMessage(sessions, server->timeouts().moveTimeoutMs);
+    server->sendMessageToPlayers(sessions, startMessage);
+    roundInProgress = true;
+    spectators->roundStarted(lobbyInfo.lobbyId, static_cast<int>(players.size()));
+
+    if (metrics) {
+        roundStartUs = clock.nsecsElapsed() / 1000;
+        if (fillStartUs >= 0) metrics->observe(Metrics::Histogram::LobbyFill, roundStartUs - fillStartUs);
+        fillStartUs = -1;
     }
-    server->sendMessageToAll(startMessage.toUtf8());
+}
+
+/**
+ * @brief Records every resolved round in a match history log.
+ * @param log The log; nullptr stops recording.
+ */
+void ServerLobby::setMatchLog(MatchLog *log) {
+    matchLog = log;
+}
+
+/**
+ * @brief Updates player ratings after every resolved round.
+ * @param service The rating service; nullptr stops rating.
+ */
+void ServerLobby::setRatingService(RatingService *service) {
+    ratings = service;
+}
+
+/**
+ * @brief Records traffic, round timing and lobby metrics.
+ * @param newMetrics The metrics; nullptr stops recording.
+ */
+void ServerLobby::setMetrics(Metrics *newMetrics) {
+    metrics = newMetrics;
+    if (server) server->setMetrics(metrics);
+    if (broadcaster) broadcaster->setMetrics(metrics);
+    updateGauges();
+}
+
+/**
+ * @brief Updates the seated player and spectator gauges.
+ */
+void ServerLobby::updateGauges() {
+    if (!metrics) return;
+    metrics->set(Metrics::Gauge::SeatedPlayers, players.size());
+    metrics->set(Metrics::Gauge::Spectators, spectators ? spectators->spectatorCount() : 0);
 }
 
 /**
  * @brief Determines the winners of the game.
  */
 void ServerLobby::calculateWinners() {
-    QMap<int, int> choiceCount; // {1 (rock) -> count, 2 (paper) -> count, 3 (scissors) -> count}
-    for (const auto &choice : playerChoices) {
-        choiceCount[choice]++;
-    }
-
-    QList<int> winners;
-    if (choiceCount.size() == 3 || choiceCount.size() == 1) {
-        // Draw
-    } else {
-        int winningChoice = (choiceCount.contains(1) && choiceCount.contains(3)) ? 1 :
-                                (choiceCount.contains(2) && choiceCount.contains(1)) ? 2 : 3;
+    TRACE_SCOPE("lobby", "ServerLobby::calculateWinners");
+    const qint64 startUs = metrics ? clock.nsecsElapsed() / 1000 : 0;
+
+    // Player IDs index the packed moves, so the outcomes line up with the player list
+    outcomes.resize(playerChoices.size());
+    const RoundResolver::Result result = RoundResolver::resolve(playerChoices.constData(),
+                                                                static_cast<int>(playerChoices.size()),
+                                                                outcomes.data());
+
+    if (matchLog || ratings) {
+        QVector<quint32> sessions;
+        QVector<quint32> playerKeys;
+        sessions.reserve(players.size());
+        playerKeys.reserve(players.size());
+        for (const PlayerConnection &player : std::as_const(players)) {
+            sessions.append(player.sessionId);
+            playerKeys.append(MatchLog::playerKey(identityOfSession.value(player.sessionId), player.ipAddress));
+        }
 
-        for (auto it = playerChoices.begin(); it != playerChoices.end(); ++it) {
-            if (it.value() == winningChoice) {
-                winners.append(it.key());
-            }
+        const int count = static_cast<int>(players.size());
+        if (matchLog) {
+            matchLog->recordRound(lobbyInfo.lobbyId, count, sessions.constData(), playerKeys.constData(),
+                                  playerChoices.constData(), outcomes.constData());
+        }
+        if (ratings) {
+            ratings->recordRound(count, playerKeys.constData(), outcomes.constData());
         }
     }
 
-    sendWinnersAndLosers(winners);
+    sendWinnersAndLosers(result);
+    spectators->roundResolved(lobbyInfo.lobbyId, result);
+
+    // The round is over, so a later disconnect must not resolve it again
+    playerChoices.fill(GameRules::None);
+    chosenCount = 0;
+    roundInProgress = false;
+
+    if (metrics) {
+        metrics->add(Metrics::Counter::RoundsResolved);
+        metrics->observe(Metrics::Histogram::RoundResolution, clock.nsecsElapsed() / 1000 - startUs);
+        roundStartUs = -1;
+    }
 }
 
 /**
  * @brief Sends game results (win/loss/draw) to players.
+ * @param result The summary of the resolved round; per-player outcomes are in `outcomes`.
  */
-void ServerLobby::sendWinnersAndLosers(const QList<int> &winners) {
-    QString drawMessage = "/draw";
-    QString winMessage = "/win";
-    QString loseMessage = "/lose";
-
-    if (winners.isEmpty()) {
+void ServerLobby::sendWinnersAndLosers(const RoundResolver::Result &result) {
+    // Each result is encoded once and fanned out to its recipients
+    QVector<quint32> winnerSessions;
+    QVector<quint32> loserSessions;
+    winnerSessions.reserve(result.winners);
+    loserSessions.reserve(players.size() - result.winners);
+
+    const quint8 win = static_cast<quint8>(Protocol::Opcode::Win);
+    for (int playerId = 0; playerId < players.size(); ++playerId) {
+        (outcomes[playerId] == win ? winnerSessions : loserSessions).append(players[playerId].sessionId);
+    }
 
-        for (const auto &player : players) {
-            server->sendMessageToPlayer(player,drawMessage.toUtf8());
-        }
+    if (result.winningChoice == GameRules::None) {
+        server->sendMessageToPlayers(loserSessions, Protocol::encode(Protocol::Opcode::Draw));
         return;
     }
 
-    for (const auto &player : players) {
-        int playerId = getPlayerId(player);
-        if (winners.contains(playerId)) {
-            server->sendMessageToPlayer(player, winMessage.toUtf8());
-        } else {
-            server->sendMessageToPlayer(player, loseMessage.toUtf8());
-        }
-    }
+    server->sendMessageToPlayers(winnerSessions, Protocol::encode(Protocol::Opcode::Win));
+    server->sendMessageToPlayers(loserSessions, Protocol::encode(Protocol::Opcode::Lose));
 }
 
 
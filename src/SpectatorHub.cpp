@@ -0,0 +1,191 @@
+#include "SpectatorHub.h"
+#include "GameRules.h"
+#include "Protocol.h"
+
+/**
+ * @brief Constructs a hub sending through a server.
+ * @param server The server of the spectator connections.
+ * @param parent The parent QObject.
+ */
+SpectatorHub::SpectatorHub(LanTcpServer *server, QObject *parent) : QObject(parent), server(server) {
+    connect(&tickTimer, &QTimer::timeout, this, &SpectatorHub::onTick);
+}
+
+/**
+ * @brief Makes a connection a spectator of a lobby.
+ * @param sessionId The session ID of the spectator.
+ * @param lobbyId The ID of the watched lobby.
+ * @param roundPlayers The seated players of the round in progress; 0 if no round is running.
+ */
+void SpectatorHub::addSpectator(quint32 sessionId, quint32 lobbyId, int roundPlayers) {
+    removeSpectator(sessionId);
+
+    const bool watched = channels.contains(lobbyId);
+    Channel &channel = channels[lobbyId];
+    if (!watched && roundPlayers > 0) {
+        channel.round = 1;
+        channel.players = roundPlayers;
+    }
+    channel.newSpectators.append(sessionId);
+    spectatorOfSession.insert(sessionId, SpectatorRef{lobbyId, -1});
+    markPending(lobbyId, channel);
+}
+
+/**
+ * @brief Stops streaming to a connection.
+ *
+ * The last spectator of the lobby takes the freed index, so only one index
+ * entry changes. The state of a lobby is dropped with its last spectator.
+ *
+ * @param sessionId The session ID of the spectator.
+ * @return True if the connection was a spectator.
+ */
+bool SpectatorHub::removeSpectator(quint32 sessionId) {
+    const auto it = spectatorOfSession.constFind(sessionId);
+    if (it == spectatorOfSession.constEnd()) return false;
+
+    const SpectatorRef ref = it.value();
+    spectatorOfSession.erase(it);
+
+    const auto channelIt = channels.find(ref.lobbyId);
+    Channel &channel = channelIt.value();
+    if (ref.index < 0) {
+        channel.newSpectators.removeOne(sessionId);
+    } else {
+        const quint32 moved = channel.spectators.takeLast();
+        if (moved != sessionId) {
+            channel.spectators[ref.index] = moved;
+            spectatorOfSession[moved].index = ref.index;
+        }
+    }
+
+    if (channel.spectators.isEmpty() && channel.newSpectators.isEmpty()) {
+        if (channel.queued) pendingChannels.removeOne(ref.lobbyId);
+        channels.erase(channelIt);
+    }
+    return true;
+}
+
+/**
+ * @brief Checks whether a connection is a spectator.
+ * @param sessionId The session ID of the connection.
+ * @return True if the connection watches a lobby.
+ */
+bool SpectatorHub::isSpectator(quint32 sessionId) const {
+    return spectatorOfSession.contains(sessionId);
+}
+
+/**
+ * @brief Returns the number of spectators.
+ * @return The number of spectators of all lobbies.
+ */
+int SpectatorHub::spectatorCount() const {
+    return spectatorOfSession.size();
+}
+
+/**
+ * @brief Records the start of a round.
+ * @param lobbyId The ID of the lobby.
+ * @param players The number of seated players.
+ */
+void SpectatorHub::roundStarted(quint32 lobbyId, int players) {
+    const auto it = channels.find(lobbyId);
+    if (it == channels.end()) return;
+
+    ++it->round;
+    it->players = players;
+    it->resolved = false;
+    it->changed = true;
+    markPending(lobbyId, it.value());
+}
+
+/**
+ * @brief Records the moves and the result of a round.
+ * @param lobbyId The ID of the lobby.
+ * @param result The resolved round.
+ */
+void SpectatorHub::roundResolved(quint32 lobbyId, const RoundResolver::Result &result) {
+    const auto it = channels.find(lobbyId);
+    if (it == channels.end()) return;
+
+    it->result = result;
+    it->resolved = true;
+    it->changed = true;
+    markPending(lobbyId, it.value());
+}
+
+/**
+ * @brief Stops streaming to every spectator.
+ */
+void SpectatorHub::clear() {
+    tickTimer.stop();
+    channels.clear();
+    spectatorOfSession.clear();
+    pendingChannels.clear();
+}
+
+/**
+ * @brief Queues a channel for the next tick.
+ * @param lobbyId The ID of the lobby.
+ * @param channel The channel of the lobby.
+ */
+void SpectatorHub::markPending(quint32 lobbyId, Channel &channel) {
+    if (channel.queued) return;
+
+    channel.queued = true;
+    pendingChannels.append(lobbyId);
+    if (!tickTimer.isActive()) tickTimer.start(TICK_MS);
+}
+
+/**
+ * @brief Sends one snapshot of every changed lobby and of every lobby with new spectators.
+ *
+ * Each snapshot is encoded once per lobby. New spectators of an unchanged
+ * lobby receive it alone; otherwise they join the lobby's fan-out.
+ */
+void SpectatorHub::onTick() {
+    for (const quint32 lobbyId : std::as_const(pendingChannels)) {
+        Channel &channel = channels[lobbyId];
+        channel.queued = false;
+
+        for (const quint32 sessionId : std::as_const(channel.newSpectators)) {
+            spectatorOfSession[sessionId].index = channel.spectators.size();
+            channel.spectators.append(sessionId);
+        }
+
+        const QByteArray message = snapshot(channel);
+        if (channel.changed) {
+            server->sendSnapshotToPlayers(channel.spectators, message);
+        } else {
+            server->sendSnapshotToPlayers(channel.newSpectators, message);
+        }
+        channel.newSpectators.clear();
+        channel.changed = false;
+    }
+    pendingChannels.clear();
+    tickTimer.stop();
+}
+
+/**
+ * @brief Encodes the snapshot of a channel.
+ * @param channel The channel.
+ * @return The encoded snapshot.
+ */
+QByteArray SpectatorHub::snapshot(const Channel &channel) {
+    Protocol::Message messages[5];
+    int count = 0;
+
+    messages[count++] = {Protocol::Opcode::Round,
+                         ((channel.round & 0xFFFF) << 16) | static_cast<quint32>(qMin(channel.players, 0xFFFF))};
+    if (channel.resolved) {
+        const int moves[] = {channel.result.rock, channel.result.paper, channel.result.scissors};
+        for (int choice = GameRules::Rock; choice <= GameRules::Scissors; ++choice) {
+            messages[count++] = {Protocol::Opcode::Moves,
+                                 (static_cast<quint32>(choice) << 24) | static_cast<quint32>(moves[choice - 1])};
+        }
+        messages[count++] = {Protocol::Opcode::Result,
+                             (static_cast<quint32>(channel.result.winningChoice) << 24)
+                                 | static_cast<quint32>(channel.result.winners)};
+    }
+    return Protocol::encodeBatch(messages, count);
+}
@@ -0,0 +1,194 @@
+#include "TimerWheel.h"
+
+/**
+ * @brief Constructs an empty wheel.
+ * @param tickMs The resolution of the wheel in milliseconds.
+ */
+TimerWheel::TimerWheel(int tickMs) : tick(qMax(1, tickMs)), heads(LEVELS * SLOTS, -1) {}
+
+/**
+ * @brief Returns the resolution of the wheel.
+ * @return The length of one tick in milliseconds.
+ */
+int TimerWheel::tickMs() const {
+    return tick;
+}
+
+/**
+ * @brief Returns the number of pending timers.
+ * @return The number of scheduled keys.
+ */
+int TimerWheel::size() const {
+    return static_cast<int>(nodeOfKey.size());
+}
+
+/**
+ * @brief Checks whether a timer is pending.
+ * @param key The key of the timer.
+ * @return True if the key is scheduled.
+ */
+bool TimerWheel::contains(quint64 key) const {
+    return nodeOfKey.contains(key);
+}
+
+/**
+ * @brief Schedules a timer, replacing a pending timer with the same key.
+ * @param key The key of the timer.
+ * @param delayMs The delay in milliseconds.
+ */
+void TimerWheel::schedule(quint64 key, qint64 delayMs) {
+    // Round up so a timer never fires before its delay has passed
+    const qint64 ticks = qMax<qint64>(1, (delayMs + tick - 1) / tick);
+
+    int index = nodeOfKey.value(key, -1);
+    if (index >= 0) {
+        unlink(index);
+    } else if (freeList >= 0) {
+        index = freeList;
+        freeList = nodes[index].next;
+        nodeOfKey.insert(key, index);
+    } else {
+        index = static_cast<int>(nodes.size());
+        nodes.append(Node());
+        nodeOfKey.insert(key, index);
+    }
+
+    nodes[index].key = key;
+    nodes[index].expiry = currentTick + ticks;
+    link(index);
+}
+
+/**
+ * @brief Cancels a pending timer.
+ * @param key The key of the timer.
+ * @return True if the timer was pending.
+ */
+bool TimerWheel::cancel(quint64 key) {
+    const auto it = nodeOfKey.constFind(key);
+    if (it == nodeOfKey.constEnd()) return false;
+
+    const int index = it.value();
+    nodeOfKey.erase(it);
+    unlink(index);
+    release(index);
+    return true;
+}
+
+/**
+ * @brief Cancels every pending timer.
+ */
+void TimerWheel::clear() {
+    heads.fill(-1);
+    nodes.clear();
+    freeList = -1;
+    nodeOfKey.clear();
+}
+
+/**
+ * @brief Advances the wheel to a point in time and collects the expired timers.
+ * @param nowMs The current time in milliseconds.
+ * @param expired Receives the keys of the expired timers.
+ */
+void TimerWheel::advanceTo(qint64 nowMs, QVector<quint64> &expired) {
+    const qint64 target = nowMs / tick;
+
+    // Nothing can expire or cascade in an empty wheel
+    if (nodeOfKey.isEmpty()) {
+        currentTick = qMax(currentTick, target);
+        return;
+    }
+
+    while (currentTick < target) {
+        ++currentTick;
+
+        // When a level wraps around, the next slot of the level above is due for a closer look
+        for (int level = 1; level < LEVELS; ++level) {
+            const int shift = level * SLOT_BITS;
+            if ((currentTick & ((qint64(1) << shift) - 1)) != 0) break;
+            cascade(level, static_cast<int>((currentTick >> shift) & (SLOTS - 1)));
+        }
+
+        // Detach the due slot first; nodes beyond the wheel's range are linked again
+        const int slot = static_cast<int>(currentTick & (SLOTS - 1));
+        int index = heads[slot];
+        heads[slot] = -1;
+        while (index >= 0) {
+            const int next = nodes[index].next;
+            if (nodes[index].expiry <= currentTick) {
+                expired.append(nodes[index].key);
+                nodeOfKey.remove(nodes[index].key);
+                release(index);
+            } else {
+                link(index);
+            }
+            index = next;
+        }
+    }
+}
+
+/**
+ * @brief Links a node into the slot matching its expiry.
+ * @param index The node index.
+ */
+void TimerWheel::link(int index) {
+    Node &node = nodes[index];
+
+    // Timers beyond the range of the top level wait in its farthest slot and are placed again later
+    const qint64 range = qint64(1) << (LEVELS * SLOT_BITS);
+    const qint64 delta = qBound<qint64>(0, node.expiry - currentTick, range - 1);
+    const qint64 due = currentTick + delta;
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (qint64(1) << ((level + 1) * SLOT_BITS))) {
+        ++level;
+    }
+
+    node.slot = level * SLOTS + static_cast<int>((due >> (level * SLOT_BITS)) & (SLOTS - 1));
+    node.prev = -1;
+    node.next = heads[node.slot];
+    if (node.next >= 0) nodes[node.next].prev = index;
+    heads[node.slot] = index;
+}
+
+/**
+ * @brief Removes a node from its slot.
+ * @param index The node index.
+ */
+void TimerWheel::unlink(int index) {
+    Node &node = nodes[index];
+    if (node.prev >= 0) {
+        nodes[node.prev].next = node.next;
+    } else {
+        heads[node.slot] = node.next;
+    }
+    if (node.next >= 0) nodes[node.next].prev = node.prev;
+    node.prev = node.next = -1;
+}
+
+/**
+ * @brief Moves every node of a slot down to the levels matching its remaining time.
+ * @param level The level of the slot.
+ * @param slot The slot within the level.
+ */
+void TimerWheel::cascade(int level, int slot) {
+    const int head = level * SLOTS + slot;
+    int index = heads[head];
+    heads[head] = -1;
+
+    while (index >= 0) {
+        const int next = nodes[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+/**
+ * @brief Returns a node to the free list.
+ * @param index The node index.
+ */
+void TimerWheel::release(int index) {
+    nodes[index].slot = -1;
+    nodes[index].prev = -1;
+    nodes[index].next = freeList;
+    freeList = index;
+}
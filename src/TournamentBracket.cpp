@@ -0,0 +1,330 @@
+#include "TournamentBracket.h"
+
+/**
+ * @brief Builds the bracket of an event.
+ *
+ * The winners' bracket has one round per halving of the field. In double
+ * elimination, the losers' bracket alternates between rounds that bring in
+ * the losers of the next winners' round (in reverse order, which postpones
+ * rematches) and rounds that pair its own survivors. The grand final and its
+ * reset match come last.
+ *
+ * @param format The bracket format.
+ * @param playerCount The number of players.
+ * @param bestOf The maximum number of decided games per match.
+ */
+TournamentBracket::TournamentBracket(Format format, int playerCount, int bestOf)
+    : bracketFormat(format), winsNeeded(qMax(1, bestOf) / 2 + 1),
+      players(qMax(2, playerCount), PlayerState::Active) {
+
+    int size = 2;
+    int levels = 1;
+    while (size < players.size()) {
+        size *= 2;
+        ++levels;
+    }
+
+    // Winners' bracket
+    QVector<QVector<int>> upper(levels);
+    for (int round = 0; round < levels; ++round) {
+        for (int i = 0; i < (size >> (round + 1)); ++i) {
+            upper[round].append(addMatch());
+        }
+    }
+    for (int round = 0; round + 1 < levels; ++round) {
+        for (int i = 0; i < upper[round].size(); ++i) {
+            matches[upper[round][i]].winnerTo = upper[round + 1][i / 2] * 2 + i % 2;
+        }
+    }
+    const int upperFinal = upper[levels - 1][0];
+
+    if (format == Format::DoubleElimination) {
+        // Losers' bracket: rounds 2j - 1 and 2j both have size / 2^(j + 1) matches
+        QVector<QVector<int>> lower(2 * (levels - 1));
+        for (int round = 0; round < lower.size(); ++round) {
+            for (int i = 0; i < (size >> (round / 2 + 2)); ++i) {
+                lower[round].append(addMatch());
+            }
+        }
+
+        if (!lower.isEmpty()) {
+            for (int i = 0; i < upper[0].size(); ++i) {
+                matches[upper[0][i]].loserTo = lower[0][i / 2] * 2 + i % 2;
+            }
+        }
+        for (int round = 0; round < lower.size(); round += 2) {
+            const QVector<int> &dropIns = upper[round / 2 + 1];
+            const int count = lower[round + 1].size();
+            for (int i = 0; i < count; ++i) {
+                matches[lower[round][i]].winnerTo = lower[round + 1][i] * 2;
+                matches[dropIns[i]].loserTo = lower[round + 1][count - 1 - i] * 2 + 1;
+            }
+            if (round + 2 < lower.size()) {
+                for (int i = 0; i < count; ++i) {
+                    matches[lower[round + 1][i]].winnerTo = lower[round + 2][i / 2] * 2 + i % 2;
+                }
+            }
+        }
+
+        // Grand final, replayed once if the losers' bracket champion wins it
+        const int grandFinal = addMatch();
+        const int reset = addMatch();
+        matches[upperFinal].winnerTo = grandFinal * 2;
+        if (lower.isEmpty()) {
+            matches[upperFinal].loserTo = grandFinal * 2 + 1;
+        } else {
+            matches[lower.last()[0]].winnerTo = grandFinal * 2 + 1;
+        }
+        matches[grandFinal].winnerTo = reset * 2;
+        matches[grandFinal].loserTo = reset * 2 + 1;
+        matches[reset].resetMatch = true;
+    }
+
+    // Seed the first round; missing players become byes for the top seeds
+    const QVector<int> order = seedOrder(size);
+    for (int slot = 0; slot < size; ++slot) {
+        const int seed = order[slot];
+        place(upper[0][slot / 2] * 2 + slot % 2, seed < players.size() ? seed : NONE);
+    }
+}
+
+/**
+ * @brief Returns the bracket format.
+ * @return The format.
+ */
+TournamentBracket::Format TournamentBracket::format() const {
+    return bracketFormat;
+}
+
+/**
+ * @brief Returns the number of players.
+ * @return The number of players in the bracket.
+ */
+int TournamentBracket::playerCount() const {
+    return players.size();
+}
+
+/**
+ * @brief Returns the number of matches, including byes.
+ * @return The number of matches.
+ */
+int TournamentBracket::matchCount() const {
+    return matches.size();
+}
+
+/**
+ * @brief Hands out matches whose players are known and marks them as playing.
+ *
+ * A match whose player withdrew while it waited is resolved as a bye instead.
+ *
+ * @param maxMatches The largest number of matches to hand out.
+ * @param out Receives the match indices.
+ * @return The number of matches handed out.
+ */
+int TournamentBracket::takeReadyMatches(int maxMatches, QVector<int> &out) {
+    int taken = 0;
+    while (taken < maxMatches && !readyMatches.isEmpty()) {
+        const int index = readyMatches.dequeue();
+        if (resolveWithoutPlay(index)) continue;
+
+        matches[index].state = State::Playing;
+        out.append(index);
+        ++taken;
+    }
+    return taken;
+}
+
+/**
+ * @brief Returns a player of a match.
+ * @param match The match index.
+ * @param slot The slot, 0 or 1.
+ * @return The player index, or NONE.
+ */
+int TournamentBracket::player(int match, int slot) const {
+    return matches[match].players[slot];
+}
+
+/**
+ * @brief Returns the games a player has won in a match.
+ * @param match The match index.
+ * @param slot The slot, 0 or 1.
+ * @return The number of won games.
+ */
+int TournamentBracket::wins(int match, int slot) const {
+    return matches[match].wins[slot];
+}
+
+/**
+ * @brief Records the result of a game of a playing match.
+ * @param match The match index.
+ * @param winnerSlot The slot of the game's winner, or -1 for a draw.
+ * @return The effect of the game on the match.
+ */
+TournamentBracket::GameOutcome TournamentBracket::recordGame(int match, int winnerSlot) {
+    Match &current = matches[match];
+    if (current.state != State::Playing) return GameOutcome::MatchDecided;
+    if (winnerSlot < 0) return GameOutcome::Rematch;
+
+    if (++current.wins[winnerSlot] < winsNeeded) return GameOutcome::NextGame;
+
+    decide(match, winnerSlot);
+    return GameOutcome::MatchDecided;
+}
+
+/**
+ * @brief Ends a playing match in favour of the opponent of a player who left.
+ * @param match The match index.
+ * @param slot The slot of the player who left.
+ */
+void TournamentBracket::forfeit(int match, int slot) {
+    Match &current = matches[match];
+    if (current.state != State::Playing) return;
+
+    withdraw(current.players[slot]);
+    current.players[slot] = NONE; // Keeps the leaver out of the losers' bracket
+    decide(match, 1 - slot);
+}
+
+/**
+ * @brief Removes a player who is not in a playing match from the event.
+ * @param player The player index.
+ */
+void TournamentBracket::withdraw(int player) {
+    if (player == NONE || players[player] != PlayerState::Active) return;
+    players[player] = PlayerState::Withdrawn;
+}
+
+/**
+ * @brief Checks whether a player has no matches left.
+ * @param player The player index.
+ * @return True if the player is out or the event is over.
+ */
+bool TournamentBracket::isOut(int player) const {
+    return finished || players[player] != PlayerState::Active;
+}
+
+/**
+ * @brief Checks whether the final match has been decided.
+ * @return True if the event is over.
+ */
+bool TournamentBracket::isFinished() const {
+    return finished;
+}
+
+/**
+ * @brief Returns the winner of the event.
+ * @return The player index, or NONE.
+ */
+int TournamentBracket::champion() const {
+    return winner;
+}
+
+/**
+ * @brief Appends an unwired match.
+ * @return The new match index.
+ */
+int TournamentBracket::addMatch() {
+    matches.append(Match());
+    return matches.size() - 1;
+}
+
+/**
+ * @brief Places a player into a match slot.
+ *
+ * Once both slots are known, the match is resolved right away if it needs no
+ * play, or queued to be handed out otherwise.
+ *
+ * @param target match * 2 + slot.
+ * @param player The player index, or NONE.
+ */
+void TournamentBracket::place(int target, int player) {
+    const int index = target / 2;
+    Match &match = matches[index];
+    match.players[target % 2] = player;
+
+    if (++match.filled < 2) return;
+    if (!resolveWithoutPlay(index)) {
+        match.state = State::Ready;
+        readyMatches.enqueue(index);
+    }
+}
+
+/**
+ * @brief Resolves a match without playing it if a slot is empty or the reset is not needed.
+ * @param index The match index.
+ * @return True if the match was resolved.
+ */
+bool TournamentBracket::resolveWithoutPlay(int index) {
+    Match &match = matches[index];
+
+    // Withdrawn players give their opponents a bye
+    for (qint32 &slotPlayer : match.players) {
+        if (slotPlayer != NONE && players[slotPlayer] == PlayerState::Withdrawn) {
+            slotPlayer = NONE;
+        }
+    }
+
+    // The reset match is needed only if the winners' bracket champion lost the grand final
+    if (match.resetMatch && match.players[0] != NONE && match.players[0] == matches[index - 1].players[0]) {
+        decide(index, 0);
+        return true;
+    }
+
+    if (match.players[0] == NONE || match.players[1] == NONE) {
+        decide(index, match.players[0] == NONE ? 1 : 0);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Decides a match and moves its players on.
+ * @param index The match index.
+ * @param winnerSlot The slot of the winner.
+ */
+void TournamentBracket::decide(int index, int winnerSlot) {
+    Match &match = matches[index];
+    match.state = State::Done;
+
+    const int matchWinner = match.players[winnerSlot];
+    const int matchLoser = match.players[1 - winnerSlot];
+    const int winnerTo = match.winnerTo;
+    const int loserTo = match.loserTo;
+
+    if (loserTo >= 0) {
+        place(loserTo, matchLoser);
+    } else if (matchLoser != NONE && players[matchLoser] == PlayerState::Active) {
+        players[matchLoser] = PlayerState::Eliminated;
+    }
+
+    if (winnerTo >= 0) {
+        place(winnerTo, matchWinner);
+    } else {
+        winner = matchWinner;
+        finished = true;
+    }
+}
+
+/**
+ * @brief Returns the standard seed order of a bracket.
+ *
+ * Every doubling pairs each seed s with seed n - 1 - s, so the strongest
+ * seeds meet as late as possible.
+ *
+ * @param size The number of first-round slots, a power of two.
+ * @return The seed placed in every slot.
+ */
+QVector<int> TournamentBracket::seedOrder(int size) {
+    QVector<int> order{0};
+    while (order.size() < size) {
+        const int count = order.size() * 2;
+        QVector<int> next;
+        next.reserve(count);
+        for (const int seed : std::as_const(order)) {
+            next.append(seed);
+            next.append(count - 1 - seed);
+        }
+        order = next;
+    }
+    return order;
+}
@@ -0,0 +1,195 @@
+#include "Trace.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+std::atomic<bool> Trace::enabled{false};
+
+namespace {
+
+/**
+ * @brief One span slot of a ring buffer.
+ *
+ * The slot is guarded by a sequence number: it is 0 while the owning thread
+ * writes the slot, and the event index plus one once the slot is complete.
+ * A reader keeps a copy only if it saw the same complete sequence number
+ * before and after reading the fields.
+ */
+struct Event {
+    std::atomic<quint64> sequence{0};            ///< Event index plus one; 0 while being written.
+    std::atomic<const char *> category{nullptr}; ///< Category of the span.
+    std::atomic<const char *> name{nullptr};     ///< Name of the span.
+    std::atomic<qint64> startUs{0};              ///< Start of the span on the trace clock.
+    std::atomic<qint64> durationUs{0};           ///< Duration of the span.
+};
+
+/**
+ * @brief Spans recorded by one thread; written only by that thread.
+ */
+struct ThreadBuffer {
+    Event events[Trace::BUFFER_EVENTS]; ///< Ring of the latest spans.
+    std::atomic<quint64> head{0};       ///< Index of the next span.
+    int threadId = 0;                   ///< Trace ID of the thread.
+    QByteArray threadName;              ///< Name of the thread in the trace.
+};
+
+QMutex registryMutex;                                ///< Guards the registry.
+std::vector<std::unique_ptr<ThreadBuffer>> registry; ///< Buffers of all threads that recorded a span; never freed.
+thread_local ThreadBuffer *localBuffer = nullptr;    ///< Buffer of the calling thread.
+
+/**
+ * @brief Allocates and registers the buffer of the calling thread.
+ * @return The buffer.
+ */
+ThreadBuffer *registerThread() {
+    auto buffer = std::make_unique<ThreadBuffer>();
+
+    QThread *thread = QThread::currentThread();
+    QCoreApplication *application = QCoreApplication::instance();
+    QString threadName = thread->objectName();
+    if (threadName.isEmpty() && application && thread == application->thread()) threadName = "main";
+
+    QMutexLocker locker(&registryMutex);
+    buffer->threadId = static_cast<int>(registry.size()) + 1;
+    if (threadName.isEmpty()) threadName = QString("thread_%1").arg(buffer->threadId);
+    buffer->threadName = threadName.toUtf8();
+
+    localBuffer = buffer.get();
+    registry.push_back(std::move(buffer));
+    return localBuffer;
+}
+
+/**
+ * @brief Appends a JSON string literal.
+ * @param json The document.
+ * @param text The unescaped text.
+ */
+void appendJsonString(QByteArray &json, const char *text) {
+    json.append('"');
+    for (const char *c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            json.append('\\').append(*c);
+        } else if (static_cast<unsigned char>(*c) >= 0x20) {
+            json.append(*c);
+        }
+    }
+    json.append('"');
+}
+
+} // namespace
+
+/**
+ * @brief Starts or stops recording spans.
+ *
+ * Spans already recorded are kept, so tracing can be paused around the
+ * interesting part of a match.
+ *
+ * @param enable True to record spans.
+ */
+void Trace::setEnabled(bool enable) {
+    nowUs(); // Fix the clock origin before the first span
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Returns the time on the trace clock.
+ * @return Microseconds since the first use of the clock.
+ */
+qint64 Trace::nowUs() {
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+/**
+ * @brief Records a finished span in the buffer of the calling thread.
+ *
+ * The span overwrites the oldest one once the buffer is full.
+ *
+ * @param category The category of the span.
+ * @param name The name of the span.
+ * @param startUs The start of the span on the trace clock.
+ * @param durationUs The duration of the span in microseconds.
+ */
+void Trace::record(const char *category, const char *name, qint64 startUs, qint64 durationUs) {
+    ThreadBuffer *buffer = localBuffer ? localBuffer : registerThread();
+
+    const quint64 index = buffer->head.load(std::memory_order_relaxed);
+    Event &event = buffer->events[index % BUFFER_EVENTS];
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.category.store(category, std::memory_order_relaxed);
+    event.name.store(name, std::memory_order_relaxed);
+    event.startUs.store(startUs, std::memory_order_relaxed);
+    event.durationUs.store(durationUs, std::memory_order_relaxed);
+    event.sequence.store(index + 1, std::memory_order_release);
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Exports the recorded spans of all threads.
+ *
+ * Spans are copied while their threads keep recording; a span overwritten
+ * during the copy is left out. Every thread is named by a metadata event.
+ *
+ * @return A Chrome trace event JSON document.
+ */
+QByteArray Trace::exportChromeJson() {
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+
+    QByteArray json;
+    json.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+
+    QMutexLocker locker(&registryMutex);
+    for (const std::unique_ptr<ThreadBuffer> &buffer : registry) {
+        const QByteArray tid = QByteArray::number(buffer->threadId);
+
+        if (!first) json.append(',');
+        first = false;
+        json.append("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":").append(pid);
+        json.append(",\"tid\":").append(tid).append(",\"args\":{\"name\":");
+        appendJsonString(json, buffer->threadName.constData());
+        json.append("}}");
+
+        const quint64 head = buffer->head.load(std::memory_order_acquire);
+        const quint64 oldest = head > BUFFER_EVENTS ? head - BUFFER_EVENTS : 0;
+        for (quint64 index = oldest; index < head; ++index) {
+            const Event &event = buffer->events[index % BUFFER_EVENTS];
+            if (event.sequence.load(std::memory_order_acquire) != index + 1) continue;
+            const char *category = event.category.load(std::memory_order_relaxed);
+            const char *name = event.name.load(std::memory_order_relaxed);
+            const qint64 startUs = event.startUs.load(std::memory_order_relaxed);
+            const qint64 durationUs = event.durationUs.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (event.sequence.load(std::memory_order_relaxed) != index + 1) continue;
+
+            json.append(",{\"ph\":\"X\",\"cat\":");
+            appendJsonString(json, category);
+            json.append(",\"name\":");
+            appendJsonString(json, name);
+            json.append(",\"ts\":").append(QByteArray::number(startUs));
+            json.append(",\"dur\":").append(QByteArray::number(durationUs));
+            json.append(",\"pid\":").append(pid).append(",\"tid\":").append(tid).append('}');
+        }
+    }
+
+    json.append("]}\n");
+    return json;
+}
+
+/**
+ * @brief Writes the recorded spans of all threads to a file.
+ * @param fileName The path of the JSON file.
+ * @return False if the file could not be written.
+ */
+bool Trace::writeChromeJson(const QString &fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    const QByteArray json = exportChromeJson();
+    return file.write(json) == json.size();
+}
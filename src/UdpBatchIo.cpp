@@ -0,0 +1,185 @@
+#include "UdpBatchIo.h"
+
+#ifdef Q_OS_LINUX
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <vector>
+
+/**
+ * @brief Message headers, addresses and receive buffers reused by every batch.
+ */
+struct UdpBatchIo::Buffers {
+    std::vector<char> data = std::vector<char>(BATCH_SIZE * MAX_DATAGRAM_SIZE); ///< Receive buffer ring.
+    std::vector<mmsghdr> messages = std::vector<mmsghdr>(BATCH_SIZE);           ///< Message headers of one batch.
+    std::vector<iovec> vectors = std::vector<iovec>(BATCH_SIZE);                ///< Payload vectors of one batch.
+    std::vector<sockaddr_storage> peers = std::vector<sockaddr_storage>(BATCH_SIZE); ///< Sender or destination addresses.
+
+    sockaddr_storage lastSender{};  ///< Raw address of the previous sender.
+    socklen_t lastSenderLength = 0; ///< Length of lastSender; 0 if none.
+    QHostAddress lastSenderAddress; ///< Converted address of the previous sender.
+};
+#else
+/**
+ * @brief Placeholder on platforms without batched socket calls.
+ */
+struct UdpBatchIo::Buffers {};
+#endif
+
+/**
+ * @brief Checks whether batched I/O is available on this platform.
+ * @return True on Linux.
+ */
+bool UdpBatchIo::isSupported() {
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Preallocates the buffer ring and message headers.
+ */
+UdpBatchIo::UdpBatchIo() : d(std::make_unique<Buffers>()) {}
+
+/**
+ * @brief Releases the buffer ring.
+ */
+UdpBatchIo::~UdpBatchIo() = default;
+
+/**
+ * @brief Reads every pending datagram from a non-blocking socket.
+ *
+ * Batches are read until the socket has no more data. Truncated datagrams
+ * are skipped. Consecutive datagrams from the same sender share one
+ * converted QHostAddress.
+ *
+ * @param socketDescriptor The descriptor of a bound UDP socket.
+ * @param handler Called once for every datagram.
+ * @return The number of datagrams delivered, or -1 if batched receive failed.
+ */
+int UdpBatchIo::receiveAll(qintptr socketDescriptor, const DatagramHandler &handler) {
+#ifdef Q_OS_LINUX
+    int delivered = 0;
+
+    for (;;) {
+        for (int i = 0; i < BATCH_SIZE; ++i) {
+            d->vectors[i].iov_base = d->data.data() + i * MAX_DATAGRAM_SIZE;
+            d->vectors[i].iov_len = MAX_DATAGRAM_SIZE;
+
+            msghdr &header = d->messages[i].msg_hdr;
+            std::memset(&header, 0, sizeof(header));
+            header.msg_name = &d->peers[i];
+            header.msg_namelen = sizeof(sockaddr_storage);
+            header.msg_iov = &d->vectors[i];
+            header.msg_iovlen = 1;
+        }
+
+        const int received = recvmmsg(static_cast<int>(socketDescriptor), d->messages.data(), BATCH_SIZE,
+                                      MSG_DONTWAIT, nullptr);
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+            return delivered > 0 ? delivered : -1;
+        }
+
+        for (int i = 0; i < received; ++i) {
+            const msghdr &header = d->messages[i].msg_hdr;
+            if (header.msg_flags & MSG_TRUNC) continue;
+
+            // Reuse the converted address while the sender stays the same
+            if (header.msg_namelen != d->lastSenderLength
+                || std::memcmp(&d->peers[i], &d->lastSender, header.msg_namelen) != 0) {
+                std::memcpy(&d->lastSender, &d->peers[i], header.msg_namelen);
+                d->lastSenderLength = header.msg_namelen;
+                d->lastSenderAddress = QHostAddress(reinterpret_cast<const sockaddr *>(&d->peers[i]));
+            }
+
+            handler(static_cast<const char *>(d->vectors[i].iov_base), static_cast<int>(d->messages[i].msg_len),
+                    d->lastSenderAddress);
+            ++delivered;
+        }
+
+        if (received < BATCH_SIZE) break; // The socket is drained
+    }
+    return delivered;
+#else
+    Q_UNUSED(socketDescriptor);
+    Q_UNUSED(handler);
+    return -1;
+#endif
+}
+
+/**
+ * @brief Sends every datagram to every IPv4 address.
+ *
+ * All (datagram, address) pairs are queued into message headers, address by
+ * address, and sent with one sendmmsg call per BATCH_SIZE pairs. sendmmsg
+ * stops at the first pair it cannot send; the pairs from there on are left to
+ * the caller, so a full socket buffer or a failing destination loses nothing
+ * that the per-datagram path could still deliver.
+ *
+ * @param socketDescriptor The descriptor of a bound IPv4 UDP socket.
+ * @param datagrams The datagrams to send.
+ * @param addresses The IPv4 destination addresses.
+ * @param port The destination port.
+ * @return The number of (datagram, address) pairs sent.
+ */
+int UdpBatchIo::sendToAll(qintptr socketDescriptor, const QList<QByteArray> &datagrams,
+                          const QList<QHostAddress> &addresses, quint16 port) {
+#ifdef Q_OS_LINUX
+    for (const QHostAddress &address : addresses) {
+        if (address.protocol() != QAbstractSocket::IPv4Protocol) return 0;
+    }
+
+    int total = 0;
+    int queued = 0;
+    auto flush = [&]() -> bool {
+        int offset = 0;
+        while (offset < queued) {
+            const int sent = sendmmsg(static_cast<int>(socketDescriptor), d->messages.data() + offset,
+                                      static_cast<unsigned int>(queued - offset), MSG_DONTWAIT);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) break;
+            offset += sent;
+        }
+        total += offset;
+        const bool complete = offset == queued;
+        queued = 0;
+        return complete;
+    };
+
+    for (const QHostAddress &address : addresses) {
+        for (const QByteArray &data : datagrams) {
+            auto *destination = reinterpret_cast<sockaddr_in *>(&d->peers[queued]);
+            std::memset(destination, 0, sizeof(sockaddr_in));
+            destination->sin_family = AF_INET;
+            destination->sin_port = htons(port);
+            destination->sin_addr.s_addr = htonl(address.toIPv4Address());
+
+            // The payload is only read by the kernel, so the shared QByteArray data is used directly
+            d->vectors[queued].iov_base = const_cast<char *>(data.constData());
+            d->vectors[queued].iov_len = static_cast<size_t>(data.size());
+
+            msghdr &header = d->messages[queued].msg_hdr;
+            std::memset(&header, 0, sizeof(header));
+            header.msg_name = destination;
+            header.msg_namelen = sizeof(sockaddr_in);
+            header.msg_iov = &d->vectors[queued];
+            header.msg_iovlen = 1;
+
+            if (++queued == BATCH_SIZE && !flush()) return total;
+        }
+    }
+    flush();
+    return total;
+#else
+    Q_UNUSED(socketDescriptor);
+    Q_UNUSED(datagrams);
+    Q_UNUSED(addresses);
+    Q_UNUSED(port);
+    return 0;
+#endif
+}
@@ -1,5 +1,5 @@
 #include "UdpBroadcastListener.h"
-#include <QDataStream>
+#include "LobbyAnnouncement.h"
 #include <QNetworkDatagram>
 #include <QDebug>
 
@@ -10,18 +10,56 @@
  * @param parent The parent QObject (default is nullptr).
  */
 UdpBroadcastListener::UdpBroadcastListener(quint16 listenPort, QObject *parent)
-    : QObject(parent), port(listenPort) {}
+    : QObject(parent), port(listenPort) {
+    if (UdpBatchIo::isSupported()) {
+        batchIo = std::make_unique<UdpBatchIo>();
+    }
+
+    connect(&directory, &LobbyDirectory::lobbyAdded, this, &UdpBroadcastListener::lobbyFound);
+    connect(&directory, &LobbyDirectory::lobbyChanged, this, &UdpBroadcastListener::lobbyFound);
+    connect(&directory, &LobbyDirectory::lobbyExpired, this, &UdpBroadcastListener::lobbyLost);
+}
+
+/**
+ * @brief Selects the discovery channels.
+ * @param config The discovery settings.
+ */
+void UdpBroadcastListener::setDiscoveryConfig(const DiscoveryConfig &config) {
+    discovery = config;
+}
 
 /**
  * @brief Starts listening for UDP broadcast messages.
  *
  * Binds the UDP socket to the specified port with address sharing enabled.
+ * In multicast mode the socket joins the group only on the chosen interfaces,
+ * so other interfaces do not receive the announcements.
  * Connects the socket’s `readyRead` signal to handle incoming data.
  */
 void UdpBroadcastListener::startListening() {
-    if (udpSocket.bind(QHostAddress::Any, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)) {
-        connect(&udpSocket, &QUdpSocket::readyRead, this, &UdpBroadcastListener::onProcessPendingDatagrams);
+    // IPv4 multicast groups can only be joined on an IPv4 socket
+    const QHostAddress bindAddress = discovery.usesMulticast() ? QHostAddress(QHostAddress::AnyIPv4)
+                                                               : QHostAddress(QHostAddress::Any);
+    if (!udpSocket.bind(bindAddress, port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)) {
+        return;
+    }
+
+    if (discovery.usesMulticast()) {
+        const QList<QNetworkInterface> interfaces = discovery.multicastInterfaces();
+        bool joined = false;
+        if (interfaces.isEmpty()) {
+            joined = udpSocket.joinMulticastGroup(discovery.multicastGroup);
+        }
+        for (const QNetworkInterface &interface : interfaces) {
+            joined = udpSocket.joinMulticastGroup(discovery.multicastGroup, interface) || joined;
+        }
+        if (!joined) {
+            qDebug() << "Could not join multicast group" << discovery.multicastGroup.toString();
+        }
     }
+
+    connect(&udpSocket, &QUdpSocket::readyRead, this, &UdpBroadcastListener::onProcessPendingDatagrams,
+            Qt::UniqueConnection);
 }
 
 /**
@@ -31,27 +69,61 @@ void UdpBroadcastListener::startListening() {
  */
 void UdpBroadcastListener::stopListening() {
     udpSocket.close();
+    directory.clear();
+}
+
+/**
+ * @brief Returns the lobbies currently announced on the network.
+ * @return The lobby directory.
+ */
+const LobbyDirectory &UdpBroadcastListener::lobbyDirectory() const {
+    return directory;
 }
 
 /**
  * @brief Processes incoming UDP datagrams.
  *
  * Reads all available datagrams from the socket. For each datagram:
+ * - Decodes the merged lobby announcements, skipping malformed datagrams.
  * - Extracts the sender's IP address.
- * - Deserializes the data into a `LobbyInfo` object.
- * - Emits the `lobbyFound` signal with the extracted information.
+ * - Records every announced lobby in the directory, which emits `lobbyFound`
+ *   only for new or changed lobbies.
+ *
+ * The first datagram is always read through QUdpSocket, which re-arms its read
+ * notification; the rest are drained in batches when UdpBatchIo is available.
  */
 void UdpBroadcastListener::onProcessPendingDatagrams() {
-    while (udpSocket.hasPendingDatagrams()) {
-        QNetworkDatagram datagram = udpSocket.receiveDatagram();
+    if (batchIo && udpSocket.hasPendingDatagrams()) {
+        const QNetworkDatagram datagram = udpSocket.receiveDatagram();
+        handleDatagram(datagram.data(), datagram.senderAddress());
 
-        QHostAddress senderIp = datagram.senderAddress();
-        QByteArray data = datagram.data();
+        const int drained = batchIo->receiveAll(udpSocket.socketDescriptor(),
+                                                [this](const char *data, int size, const QHostAddress &sender) {
+            // Decode straight from the batch buffer without copying the payload
+            handleDatagram(QByteArray::fromRawData(data, size), sender);
+        });
+        if (drained >= 0) return;
 
-        LobbyInfo info;
-        info.deserialize(data);
+        // Batched receive is unavailable on this socket; fall back for good
+        batchIo.reset();
+    }
 
-        emit lobbyFound(senderIp, info);
+    while (udpSocket.hasPendingDatagrams()) {
+        const QNetworkDatagram datagram = udpSocket.receiveDatagram();
+        handleDatagram(datagram.data(), datagram.senderAddress());
     }
 }
 
+/**
+ * @brief Decodes one announcement datagram and records its lobbies.
+ * @param data The datagram payload.
+ * @param senderIp The address of the sender.
+ */
+void UdpBroadcastListener::handleDatagram(const QByteArray &data, const QHostAddress &senderIp) {
+    // Parse straight from the datagram payload and skip malformed announcements
+    if (!LobbyAnnouncement::unpack(data, lobbies)) return;
+
+    for (const LobbyInfo &info : std::as_const(lobbies)) {
+        directory.update(senderIp, info);
+    }
+}
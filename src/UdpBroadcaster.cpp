@@ -1,5 +1,5 @@
 #include "UdpBroadcaster.h"
-#include <QDataStream>
+#include "LobbyAnnouncement.h"
 #include <QNetworkDatagram>
 #include <QDebug>
 #include <QNetworkInterface>
@@ -10,7 +10,7 @@
  *
  * This constructor sets up the UDP broadcaster by:
  * - Retrieving the list of available broadcast addresses.
- * - Connecting a timer to periodically send broadcast messages.
+ * - Connecting a single-shot timer that schedules the announcements.
  *
  * @param broadcastPort The port used for broadcasting messages.
  * @param parent The parent QObject (default is nullptr).
@@ -18,6 +18,10 @@
 UdpBroadcaster::UdpBroadcaster(const quint16 broadcastPort, QObject *parent)
     : QObject(parent), port(broadcastPort) {
     updateAddresses();
+    if (UdpBatchIo::isSupported()) {
+        batchIo = std::make_unique<UdpBatchIo>();
+    }
+    broadcastTimer.setSingleShot(true);
     connect(&broadcastTimer, &QTimer::timeout, this, &UdpBroadcaster::onSendBroadcast);
 }
 
@@ -50,35 +54,143 @@ void UdpBroadcaster::updateAddresses() {
 }
 
 /**
- * @brief Sends the stored UDP broadcast message.
+ * @brief Sends the merged announcement datagrams.
  *
- * Attempts to transmit the current lobby data to all detected broadcast addresses.
+ * Attempts to transmit the current lobby data to all detected broadcast addresses,
+ * then schedules the next repeat with a doubled interval.
  * If sending fails for any address, the list of broadcast addresses is updated.
  */
 void UdpBroadcaster::onSendBroadcast() {
-    bool validBroadcastAddresses = true;
+    if (!active) return;
 
-    // Iterate through all known broadcast addresses and send data
-    for (const auto &address : std::as_const(broadcastAddresses)) {
-        if (udpSocket.writeDatagram(currentData, address, port) == -1) {
-            validBroadcastAddresses = false;
-        }
+    // Merge the announcements of all lobbies only when something changed
+    if (changed) {
+        datagrams = LobbyAnnouncement::pack(announcements);
+        changed = false;
+    }
+
+    if (discovery.usesMulticast() && !sendMulticast()) {
+        qDebug() << "Multicast announcement failed:" << udpSocket.errorString();
     }
 
     // If any transmission failed, refresh the list of broadcast addresses
-    if (!validBroadcastAddresses) {
+    if (discovery.usesBroadcast() && !sendDatagrams(broadcastAddresses)) {
         updateAddresses();
     }
+
+    // Back off while the lobby set stays the same
+    broadcastTimer.start(interval);
+    interval = qMin(interval * 2, MAX_INTERVAL_MS);
+}
+
+/**
+ * @brief Sends the announcement datagrams to the multicast group.
+ * @return False if a datagram could not be sent.
+ */
+bool UdpBroadcaster::sendMulticast() {
+    if (!ensureBound()) return false;
+
+    const QList<QHostAddress> group{discovery.multicastGroup};
+    bool sent = true;
+    const int passes = qMax(1, static_cast<int>(multicastInterfaces.size()));
+    for (int i = 0; i < passes; ++i) {
+        if (!multicastInterfaces.isEmpty()) {
+            udpSocket.setMulticastInterface(multicastInterfaces[i]);
+        }
+        sent = sendDatagrams(group) && sent;
+    }
+    return sent;
+}
+
+/**
+ * @brief Sends every announcement datagram to every address.
+ *
+ * Batched sends need a bound IPv4 descriptor. The pairs the batched call did
+ * not send, all of them if binding fails, are written one by one through
+ * QUdpSocket, so no address receives a datagram twice.
+ *
+ * @param addresses The destination addresses.
+ * @return False if a datagram could not be sent.
+ */
+bool UdpBroadcaster::sendDatagrams(const QList<QHostAddress> &addresses) {
+    const int total = static_cast<int>(datagrams.size() * addresses.size());
+    int batched = 0;
+    if (batchIo && ensureBound()) {
+        batched = batchIo->sendToAll(udpSocket.socketDescriptor(), datagrams, addresses, port);
+    }
+
+    // Pairs are ordered address by address, every address receiving all datagrams
+    bool sent = true;
+    quint64 count = static_cast<quint64>(batched);
+    for (int pair = batched; pair < total; ++pair) {
+        const QHostAddress &address = addresses[pair / datagrams.size()];
+        const QByteArray &data = datagrams[pair % datagrams.size()];
+        if (udpSocket.writeDatagram(data, address, port) == -1) {
+            sent = false;
+        } else {
+            ++count;
+        }
+    }
+    if (metrics) metrics->add(Metrics::Counter::BroadcastDatagrams, count);
+    return sent;
+}
+
+/**
+ * @brief Binds the socket to IPv4 and applies the multicast TTL if it is not bound yet.
+ * @return False if the socket could not be bound.
+ */
+bool UdpBroadcaster::ensureBound() {
+    if (udpSocket.state() == QAbstractSocket::BoundState) return true;
+
+    // The TTL and the outgoing interface are options of a socket bound to IPv4
+    if (!udpSocket.bind(QHostAddress::AnyIPv4, 0)) return false;
+    if (discovery.usesMulticast()) {
+        udpSocket.setSocketOption(QAbstractSocket::MulticastTtlOption, discovery.multicastTtl);
+    }
+    return true;
+}
+
+/**
+ * @brief Selects the announcement channels.
+ * @param config The discovery settings.
+ */
+void UdpBroadcaster::setDiscoveryConfig(const DiscoveryConfig &config) {
+    discovery = config;
+    multicastInterfaces = config.multicastInterfaces();
+
+    // A bound socket keeps the old TTL; rebind on the next multicast send
+    if (udpSocket.state() == QAbstractSocket::BoundState) {
+        udpSocket.close();
+    }
+}
+
+/**
+ * @brief Counts the sent announcement datagrams.
+ * @param newMetrics The metrics; nullptr stops counting.
+ */
+void UdpBroadcaster::setMetrics(Metrics *newMetrics) {
+    metrics = newMetrics;
+}
+
+/**
+ * @brief Schedules a prompt announcement after a change and resets the backoff.
+ */
+void UdpBroadcaster::scheduleChange() {
+    changed = true;
+    interval = MIN_INTERVAL_MS;
+
+    if (!active) return;
+    if (!broadcastTimer.isActive() || broadcastTimer.remainingTime() > CHANGE_DELAY_MS) {
+        broadcastTimer.start(CHANGE_DELAY_MS);
+    }
 }
 
 /**
- * @brief Updates the broadcast data and restarts the timer.
+ * @brief Updates the broadcast data; the change is announced right away.
  * @param  lobbyInfo The new lobby information to be broadcasted.
  */
 void UdpBroadcaster::onRefreshLobbyInfo(const LobbyInfo &lobbyInfo) {
-    broadcastTimer.stop();  // Остановить отправку, пока обновляем данные
-    currentData = lobbyInfo.serialize();
-    broadcastTimer.start(1000);  // Перезапустить отправку
+    updateLobby(lobbyInfo);
 }
 
 /**
@@ -90,11 +202,49 @@ void UdpBroadcaster::onRefreshLobbyInfo(const LobbyInfo &lobbyInfo) {
  * @param lobbyInfo The lobby information to be broadcasted.
  */
 void UdpBroadcaster::startBroadcast(const LobbyInfo &lobbyInfo) {
-    currentData = lobbyInfo.serialize();
+    updateLobby(lobbyInfo);
+    startBroadcast();
+}
+
+/**
+ * @brief Starts broadcasting all stored lobby announcements.
+ */
+void UdpBroadcaster::startBroadcast() {
+    if (active) return;
+    active = true;
+
+    // Announce right away, then back off
+    interval = MIN_INTERVAL_MS;
+    broadcastTimer.start(0);
+}
+
+/**
+ * @brief Adds or replaces the announcement of a lobby.
+ * @param lobbyInfo The lobby information, identified by its lobby ID.
+ */
+void UdpBroadcaster::updateLobby(const LobbyInfo &lobbyInfo) {
+    // Serialize into a scratch buffer that keeps its capacity between updates
+    scratch.reserve(lobbyInfo.serializedSize()); // Marks the capacity as reserved so resize(0) keeps it
+    scratch.resize(0);
+    lobbyInfo.serializeInto(scratch);
 
-    // Start the timer if it's not already running
-    if (!broadcastTimer.isActive()) {
-        broadcastTimer.start(1000); // Send messages every second
+    QByteArray &data = announcements[lobbyInfo.lobbyId];
+    if (data == scratch) return; // Unchanged lobbies do not reset the backoff
+
+    // Reuse the buffer of the previous announcement so frequent updates do not allocate
+    data.reserve(scratch.size());
+    data.resize(0);
+    data.append(scratch);
+    scheduleChange();
+}
+
+/**
+ * @brief Stops announcing a lobby.
+ * @param lobbyId The ID of the lobby to remove.
+ */
+void UdpBroadcaster::removeLobby(quint32 lobbyId) {
+    if (announcements.remove(lobbyId) > 0) {
+        scheduleChange();
     }
 }
 
@@ -105,5 +255,6 @@ void UdpBroadcaster::startBroadcast(const LobbyInfo &lobbyInfo) {
  * This prevents further transmissions until restarted.
  */
 void UdpBroadcaster::stopBroadcast() {
+    active = false;
     broadcastTimer.stop();
 }
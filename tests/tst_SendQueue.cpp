@@ -0,0 +1,197 @@
+#include <QTest>
+#include <QVector>
+#include "SendQueue.h"
+
+Q_DECLARE_METATYPE(SendQueueLimits::Policy)
+
+/**
+ * @brief Behaviour tests of SendQueue: write order, shedding by priority and overflow under every policy.
+ */
+class TestSendQueue : public QObject {
+    Q_OBJECT
+
+private:
+    /**
+     * @brief Builds a frame whose content names it.
+     * @param name The content.
+     * @return The frame.
+     */
+    static QByteArray frame(const char *name) { return QByteArray(name); }
+
+    /**
+     * @brief Takes every frame the queue releases for an idle socket.
+     * @param queue The queue.
+     * @return The frames in write order.
+     */
+    static QVector<QByteArray> drain(SendQueue &queue) {
+        QVector<QByteArray> frames;
+        QByteArray next;
+        while (queue.pop(next, true)) frames.append(next);
+        return frames;
+    }
+
+    /**
+     * @brief Adds one row per slow-consumer policy.
+     */
+    static void addPolicyRows() {
+        QTest::addColumn<SendQueueLimits::Policy>("policy");
+
+        QTest::newRow("drop") << SendQueueLimits::Policy::Drop;
+        QTest::newRow("coalesce") << SendQueueLimits::Policy::Coalesce;
+        QTest::newRow("disconnect") << SendQueueLimits::Policy::Disconnect;
+    }
+
+private slots:
+    void writesByPriority();
+    void bulkWaitsForAnIdleSocket();
+    void newSnapshotSupersedesTheQueuedOne();
+    void shedsLowerPrioritiesOldestFirst_data();
+    void shedsLowerPrioritiesOldestFirst();
+    void controlOverflowsUnderEveryPolicy_data();
+    void controlOverflowsUnderEveryPolicy();
+    void bulkOverflowFollowsThePolicy_data();
+    void bulkOverflowFollowsThePolicy();
+    void byteLimitCountsQueuedBytes();
+};
+
+void TestSendQueue::writesByPriority() {
+    SendQueue queue;
+    QCOMPARE(queue.push(SendQueue::Priority::Bulk, frame("b1")), SendQueue::Result::Queued);
+    QCOMPARE(queue.push(SendQueue::Priority::Snapshot, frame("s1")), SendQueue::Result::Queued);
+    QCOMPARE(queue.push(SendQueue::Priority::Control, frame("c1")), SendQueue::Result::Queued);
+    QCOMPARE(queue.push(SendQueue::Priority::Bulk, frame("b2")), SendQueue::Result::Queued);
+    QCOMPARE(queue.push(SendQueue::Priority::Control, frame("c2")), SendQueue::Result::Queued);
+    QCOMPARE(queue.frames(), 5);
+
+    const QVector<QByteArray> expected{frame("c1"), frame("c2"), frame("s1"), frame("b1"), frame("b2")};
+    QCOMPARE(drain(queue), expected);
+    QVERIFY(queue.isEmpty());
+    QCOMPARE(queue.bytes(), qint64(0));
+}
+
+void TestSendQueue::bulkWaitsForAnIdleSocket() {
+    SendQueue queue;
+    queue.push(SendQueue::Priority::Bulk, frame("b1"));
+    queue.push(SendQueue::Priority::Control, frame("c1"));
+
+    QByteArray next;
+    QVERIFY(queue.pop(next, false));
+    QCOMPARE(next, frame("c1"));
+    QVERIFY(!queue.pop(next, false));
+    QVERIFY(queue.pop(next, true));
+    QCOMPARE(next, frame("b1"));
+}
+
+void TestSendQueue::newSnapshotSupersedesTheQueuedOne() {
+    SendQueue::Counters counters;
+    SendQueue queue(nullptr, &counters);
+    queue.push(SendQueue::Priority::Snapshot, frame("s1"));
+    queue.push(SendQueue::Priority::Snapshot, frame("s2"));
+
+    QCOMPARE(queue.frames(), 1);
+    QCOMPARE(counters.droppedFrames.load(), qint64(1));
+    QCOMPARE(counters.queuedFrames.load(), qint64(1));
+    QCOMPARE(drain(queue), QVector<QByteArray>{frame("s2")});
+    QCOMPARE(counters.queuedFrames.load(), qint64(0));
+}
+
+void TestSendQueue::shedsLowerPrioritiesOldestFirst_data() {
+    addPolicyRows();
+}
+
+void TestSendQueue::shedsLowerPrioritiesOldestFirst() {
+    QFETCH(SendQueueLimits::Policy, policy);
+
+    SendQueueLimits limits;
+    limits.maxFrames = 4;
+    limits.policy = policy;
+    SendQueue::Counters counters;
+    SendQueue queue(&limits, &counters);
+
+    queue.push(SendQueue::Priority::Bulk, frame("b1"));
+    queue.push(SendQueue::Priority::Bulk, frame("b2"));
+    queue.push(SendQueue::Priority::Snapshot, frame("s1"));
+    queue.push(SendQueue::Priority::Control, frame("c1"));
+
+    // Bulk goes first, oldest first, then the snapshot; the policy is not involved yet
+    QCOMPARE(queue.push(SendQueue::Priority::Control, frame("c2")), SendQueue::Result::Queued);
+    QCOMPARE(queue.push(SendQueue::Priority::Snapshot, frame("s2")), SendQueue::Result::Queued);
+    QCOMPARE(queue.push(SendQueue::Priority::Control, frame("c3")), SendQueue::Result::Queued);
+    QCOMPARE(queue.push(SendQueue::Priority::Control, frame("c4")), SendQueue::Result::Queued);
+    QCOMPARE(counters.droppedFrames.load(), qint64(4));
+
+    const QVector<QByteArray> expected{frame("c1"), frame("c2"), frame("c3"), frame("c4")};
+    QCOMPARE(drain(queue), expected);
+}
+
+void TestSendQueue::controlOverflowsUnderEveryPolicy_data() {
+    addPolicyRows();
+}
+
+void TestSendQueue::controlOverflowsUnderEveryPolicy() {
+    QFETCH(SendQueueLimits::Policy, policy);
+
+    SendQueueLimits limits;
+    limits.maxFrames = 2;
+    limits.policy = policy;
+    SendQueue::Counters counters;
+    SendQueue queue(&limits, &counters);
+
+    queue.push(SendQueue::Priority::Control, frame("c1"));
+    queue.push(SendQueue::Priority::Control, frame("c2"));
+    QCOMPARE(queue.push(SendQueue::Priority::Control, frame("c3")), SendQueue::Result::Overflow);
+
+    // No game message was lost on the way
+    QCOMPARE(counters.droppedFrames.load(), qint64(0));
+    const QVector<QByteArray> expected{frame("c1"), frame("c2")};
+    QCOMPARE(drain(queue), expected);
+}
+
+void TestSendQueue::bulkOverflowFollowsThePolicy_data() {
+    addPolicyRows();
+}
+
+void TestSendQueue::bulkOverflowFollowsThePolicy() {
+    QFETCH(SendQueueLimits::Policy, policy);
+
+    SendQueueLimits limits;
+    limits.maxFrames = 3;
+    limits.policy = policy;
+    SendQueue queue(&limits);
+
+    queue.push(SendQueue::Priority::Control, frame("c1"));
+    queue.push(SendQueue::Priority::Bulk, frame("b1"));
+    queue.push(SendQueue::Priority::Bulk, frame("b2"));
+    const SendQueue::Result result = queue.push(SendQueue::Priority::Bulk, frame("b3"));
+
+    switch (policy) {
+    case SendQueueLimits::Policy::Drop:
+        QCOMPARE(result, SendQueue::Result::Dropped);
+        QCOMPARE(drain(queue), (QVector<QByteArray>{frame("c1"), frame("b1"), frame("b2")}));
+        break;
+    case SendQueueLimits::Policy::Coalesce:
+        QCOMPARE(result, SendQueue::Result::Queued);
+        QCOMPARE(drain(queue), (QVector<QByteArray>{frame("c1"), frame("b2"), frame("b3")}));
+        break;
+    case SendQueueLimits::Policy::Disconnect:
+        QCOMPARE(result, SendQueue::Result::Overflow);
+        break;
+    }
+}
+
+void TestSendQueue::byteLimitCountsQueuedBytes() {
+    SendQueueLimits limits;
+    limits.maxBytes = 8;
+    limits.policy = SendQueueLimits::Policy::Drop;
+    SendQueue queue(&limits);
+
+    QCOMPARE(queue.push(SendQueue::Priority::Bulk, QByteArray(6, 'b')), SendQueue::Result::Queued);
+    QCOMPARE(queue.push(SendQueue::Priority::Control, QByteArray(4, 'c')), SendQueue::Result::Queued);
+    QCOMPARE(queue.bytes(), qint64(4)); // The bulk frame made room
+    QCOMPARE(queue.push(SendQueue::Priority::Snapshot, QByteArray(5, 's')), SendQueue::Result::Dropped);
+    QCOMPARE(queue.push(SendQueue::Priority::Control, QByteArray(9, 'c')), SendQueue::Result::Overflow);
+    QCOMPARE(queue.bytes(), qint64(4));
+}
+
+QTEST_APPLESS_MAIN(TestSendQueue)
+#include "tst_SendQueue.moc"
@@ -0,0 +1,164 @@
+#include <QTest>
+#include "TimerWheel.h"
+
+/**
+ * @brief Behaviour tests of TimerWheel: expiry at level boundaries, cascading, rescheduling and cancelling.
+ */
+class TestTimerWheel : public QObject {
+    Q_OBJECT
+
+private:
+    /**
+     * @brief Advances a wheel one tick at a time and records when every timer fires.
+     * @param wheel The wheel, with a 1 ms tick.
+     * @param fromMs The time the wheel was last advanced to.
+     * @param toMs The time to advance to.
+     * @param firedAtMs Receives the firing time of every expired key.
+     */
+    static void runUntil(TimerWheel &wheel, qint64 fromMs, qint64 toMs, QHash<quint64, qint64> &firedAtMs) {
+        QVector<quint64> expired;
+        for (qint64 now = fromMs + 1; now <= toMs; ++now) {
+            expired.clear();
+            wheel.advanceTo(now, expired);
+            for (quint64 key : std::as_const(expired)) firedAtMs.insert(key, now);
+        }
+    }
+
+private slots:
+    void firesExactlyAtLevelBoundaries_data();
+    void firesExactlyAtLevelBoundaries();
+    void largeJumpsCascadeEveryLevel();
+    void rescheduleMovesATimerBetweenLevels();
+    void rescheduleAfterCascade();
+    void cancelAfterCascade();
+    void delaysRoundUpToWholeTicks();
+};
+
+void TestTimerWheel::firesExactlyAtLevelBoundaries_data() {
+    QTest::addColumn<qint64>("startMs");
+
+    QTest::newRow("aligned") << qint64(0);
+    QTest::newRow("mid-slot") << qint64(37);
+    QTest::newRow("before a level 1 wrap") << qint64(TimerWheel::SLOTS - 1);
+    QTest::newRow("before a level 2 wrap") << qint64(TimerWheel::SLOTS * TimerWheel::SLOTS - 1);
+}
+
+void TestTimerWheel::firesExactlyAtLevelBoundaries() {
+    QFETCH(qint64, startMs);
+
+    TimerWheel wheel(1);
+    QVector<quint64> expired;
+    wheel.advanceTo(startMs, expired);
+    QVERIFY(expired.isEmpty());
+
+    // Delays on both sides of the first three level boundaries
+    const qint64 level1 = TimerWheel::SLOTS;
+    const qint64 level2 = level1 * TimerWheel::SLOTS;
+    const qint64 level3 = level2 * TimerWheel::SLOTS;
+    const QVector<qint64> delays{1, 2, level1 - 1, level1, level1 + 1, 2 * level1, level2 - 1, level2, level2 + 1,
+                                 level2 + level1, level3 - 1, level3, level3 + 1};
+    for (int i = 0; i < delays.size(); ++i) {
+        wheel.schedule(quint64(i), delays[i]);
+    }
+    QCOMPARE(wheel.size(), int(delays.size()));
+
+    QHash<quint64, qint64> firedAtMs;
+    runUntil(wheel, startMs, startMs + level3 + 2, firedAtMs);
+
+    QCOMPARE(wheel.size(), 0);
+    for (int i = 0; i < delays.size(); ++i) {
+        QCOMPARE(firedAtMs.value(quint64(i), -1), startMs + delays[i]);
+    }
+}
+
+void TestTimerWheel::largeJumpsCascadeEveryLevel() {
+    TimerWheel wheel(1);
+    const qint64 level2 = qint64(TimerWheel::SLOTS) * TimerWheel::SLOTS;
+    wheel.schedule(1, 10);
+    wheel.schedule(2, level2 + 5);
+    wheel.schedule(3, level2 * TimerWheel::SLOTS + 5);
+
+    // One call crosses many boundaries, and every timer due by then is reported
+    QVector<quint64> expired;
+    wheel.advanceTo(level2 + 4, expired);
+    QCOMPARE(expired, QVector<quint64>{1});
+
+    expired.clear();
+    wheel.advanceTo(level2 + 5, expired);
+    QCOMPARE(expired, QVector<quint64>{2});
+
+    expired.clear();
+    wheel.advanceTo(level2 * TimerWheel::SLOTS + 4, expired);
+    QVERIFY(expired.isEmpty());
+    QVERIFY(wheel.contains(3));
+    wheel.advanceTo(level2 * TimerWheel::SLOTS + 5, expired);
+    QCOMPARE(expired, QVector<quint64>{3});
+}
+
+void TestTimerWheel::rescheduleMovesATimerBetweenLevels() {
+    TimerWheel wheel(1);
+    QHash<quint64, qint64> firedAtMs;
+
+    // Level 1 to level 0: the earlier expiry wins
+    wheel.schedule(1, TimerWheel::SLOTS + 10);
+    runUntil(wheel, 0, 10, firedAtMs);
+    wheel.schedule(1, 20);
+
+    // Level 0 to level 1: the old slot no longer fires it
+    wheel.schedule(2, 5);
+    runUntil(wheel, 10, 12, firedAtMs);
+    wheel.schedule(2, TimerWheel::SLOTS * 2);
+    QCOMPARE(wheel.size(), 2);
+
+    runUntil(wheel, 12, 12 + TimerWheel::SLOTS * 2, firedAtMs);
+    QCOMPARE(firedAtMs.value(1, -1), qint64(30));
+    QCOMPARE(firedAtMs.value(2, -1), qint64(12 + TimerWheel::SLOTS * 2));
+    QCOMPARE(wheel.size(), 0);
+}
+
+void TestTimerWheel::rescheduleAfterCascade() {
+    TimerWheel wheel(1);
+    QHash<quint64, qint64> firedAtMs;
+
+    // The timer cascades to level 0 when the first level wraps, then is pushed back out
+    wheel.schedule(7, 100);
+    runUntil(wheel, 0, TimerWheel::SLOTS, firedAtMs);
+    QVERIFY(wheel.contains(7));
+    wheel.schedule(7, 200);
+
+    runUntil(wheel, TimerWheel::SLOTS, TimerWheel::SLOTS + 200, firedAtMs);
+    QCOMPARE(firedAtMs.value(7, -1), qint64(TimerWheel::SLOTS + 200));
+}
+
+void TestTimerWheel::cancelAfterCascade() {
+    TimerWheel wheel(1);
+    QHash<quint64, qint64> firedAtMs;
+
+    wheel.schedule(1, 100);
+    wheel.schedule(2, 101);
+    runUntil(wheel, 0, TimerWheel::SLOTS, firedAtMs);
+    QVERIFY(wheel.cancel(1));
+    QVERIFY(!wheel.cancel(1));
+
+    runUntil(wheel, TimerWheel::SLOTS, 200, firedAtMs);
+    QVERIFY(!firedAtMs.contains(1));
+    QCOMPARE(firedAtMs.value(2, -1), qint64(101));
+    QCOMPARE(wheel.size(), 0);
+}
+
+void TestTimerWheel::delaysRoundUpToWholeTicks() {
+    TimerWheel wheel(100);
+    QVector<quint64> expired;
+
+    wheel.schedule(1, 150);
+    wheel.schedule(2, 0);
+    wheel.advanceTo(199, expired);
+    QCOMPARE(expired, QVector<quint64>{2}); // Even a zero delay waits for the next tick
+
+    expired.clear();
+    wheel.advanceTo(200, expired);
+    QCOMPARE(expired, QVector<quint64>{1});
+}
+
+QTEST_APPLESS_MAIN(TestTimerWheel)
+#include "tst_TimerWheel.moc"
@@ -0,0 +1,204 @@
+#include <QTest>
+#include <algorithm>
+#include "TournamentBracket.h"
+
+/**
+ * @brief Behaviour tests of TournamentBracket: seeding, byes, match play and players who leave.
+ */
+class TestTournamentBracket : public QObject {
+    Q_OBJECT
+
+private:
+    /**
+     * @brief Hands out every ready match and lets slot 0 win each of them.
+     * @param bracket The bracket.
+     * @return The number of matches played.
+     */
+    static int playReadyMatches(TournamentBracket &bracket) {
+        QVector<int> ready;
+        bracket.takeReadyMatches(bracket.matchCount(), ready);
+        for (int match : std::as_const(ready)) {
+            while (bracket.recordGame(match, 0) != TournamentBracket::GameOutcome::MatchDecided) {}
+        }
+        return ready.size();
+    }
+
+private slots:
+    void byesGoToTopSeeds_data();
+    void byesGoToTopSeeds();
+    void topSeedWinsWhenSlotZeroAlwaysWins();
+    void drawsAreReplayedUntilAMatchIsDecided();
+    void forfeitAdvancesTheOpponent();
+    void withdrawalBetweenMatchesGivesAWaitingOpponentABye();
+    void withdrawalBeforeAReadyMatchIsHandedOutGivesABye();
+    void forfeitKeepsTheLeaverOutOfTheLosersBracket();
+};
+
+void TestTournamentBracket::byesGoToTopSeeds_data() {
+    QTest::addColumn<int>("players");
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("3 of 4") << 3 << 4;
+    QTest::newRow("5 of 8") << 5 << 8;
+    QTest::newRow("6 of 8") << 6 << 8;
+    QTest::newRow("7 of 8") << 7 << 8;
+    QTest::newRow("9 of 16") << 9 << 16;
+    QTest::newRow("8 of 8") << 8 << 8;
+}
+
+void TestTournamentBracket::byesGoToTopSeeds() {
+    QFETCH(int, players);
+    QFETCH(int, size);
+
+    TournamentBracket bracket(TournamentBracket::Format::SingleElimination, players, 1);
+    QCOMPARE(bracket.playerCount(), players);
+    QCOMPARE(bracket.matchCount(), size - 1);
+
+    // First-round matches come first; the seeds without an opponent are the best ones
+    const int byes = size - players;
+    QVector<int> seedsWithBye;
+    for (int match = 0; match < size / 2; ++match) {
+        const int first = bracket.player(match, 0);
+        const int second = bracket.player(match, 1);
+        QVERIFY(first != TournamentBracket::NONE || second != TournamentBracket::NONE);
+        if (first == TournamentBracket::NONE) seedsWithBye.append(second);
+        if (second == TournamentBracket::NONE) seedsWithBye.append(first);
+    }
+    std::sort(seedsWithBye.begin(), seedsWithBye.end());
+
+    QVector<int> expected;
+    for (int seed = 0; seed < byes; ++seed) expected.append(seed);
+    QCOMPARE(seedsWithBye, expected);
+
+    // Nobody is out before a match is played, and only the real first-round matches are handed out
+    for (int player = 0; player < players; ++player) QVERIFY(!bracket.isOut(player));
+    QVector<int> ready;
+    bracket.takeReadyMatches(size, ready);
+    for (int match : std::as_const(ready)) {
+        QVERIFY(bracket.player(match, 0) != TournamentBracket::NONE);
+        QVERIFY(bracket.player(match, 1) != TournamentBracket::NONE);
+    }
+}
+
+void TestTournamentBracket::topSeedWinsWhenSlotZeroAlwaysWins() {
+    TournamentBracket bracket(TournamentBracket::Format::SingleElimination, 5, 1);
+
+    int played = 0;
+    for (int pass = 0; pass < 8 && !bracket.isFinished(); ++pass) {
+        played += playReadyMatches(bracket);
+    }
+
+    QVERIFY(bracket.isFinished());
+    QCOMPARE(bracket.champion(), 0);
+    QCOMPARE(played, 4); // Five players need four played matches
+    for (int player = 0; player < 5; ++player) QVERIFY(bracket.isOut(player));
+}
+
+void TestTournamentBracket::drawsAreReplayedUntilAMatchIsDecided() {
+    TournamentBracket bracket(TournamentBracket::Format::SingleElimination, 2, 3);
+
+    QVector<int> ready;
+    QCOMPARE(bracket.takeReadyMatches(4, ready), 1);
+    const int match = ready.first();
+
+    QCOMPARE(bracket.recordGame(match, -1), TournamentBracket::GameOutcome::Rematch);
+    QCOMPARE(bracket.recordGame(match, 1), TournamentBracket::GameOutcome::NextGame);
+    QCOMPARE(bracket.recordGame(match, -1), TournamentBracket::GameOutcome::Rematch);
+    QCOMPARE(bracket.recordGame(match, 0), TournamentBracket::GameOutcome::NextGame);
+    QCOMPARE(bracket.wins(match, 0), 1);
+    QCOMPARE(bracket.wins(match, 1), 1);
+    QCOMPARE(bracket.recordGame(match, 1), TournamentBracket::GameOutcome::MatchDecided);
+
+    QVERIFY(bracket.isFinished());
+    QCOMPARE(bracket.champion(), bracket.player(match, 1));
+
+    // A decided match takes no more games
+    QCOMPARE(bracket.recordGame(match, 0), TournamentBracket::GameOutcome::MatchDecided);
+    QCOMPARE(bracket.wins(match, 0), 1);
+}
+
+void TestTournamentBracket::forfeitAdvancesTheOpponent() {
+    TournamentBracket bracket(TournamentBracket::Format::SingleElimination, 4, 3);
+
+    QVector<int> ready;
+    QCOMPARE(bracket.takeReadyMatches(4, ready), 2);
+    const int left = ready[0];
+    const int right = ready[1];
+    const int leaver = bracket.player(left, 0);
+    const int opponent = bracket.player(left, 1);
+
+    QCOMPARE(bracket.recordGame(left, 0), TournamentBracket::GameOutcome::NextGame);
+    bracket.forfeit(left, 0);
+    QVERIFY(bracket.isOut(leaver));
+    QVERIFY(!bracket.isOut(opponent));
+
+    while (bracket.recordGame(right, 0) != TournamentBracket::GameOutcome::MatchDecided) {}
+
+    ready.clear();
+    QCOMPARE(bracket.takeReadyMatches(4, ready), 1);
+    const int finalMatch = ready.first();
+    QVERIFY(bracket.player(finalMatch, 0) == opponent || bracket.player(finalMatch, 1) == opponent);
+    QVERIFY(bracket.player(finalMatch, 0) != leaver && bracket.player(finalMatch, 1) != leaver);
+}
+
+void TestTournamentBracket::withdrawalBetweenMatchesGivesAWaitingOpponentABye() {
+    TournamentBracket bracket(TournamentBracket::Format::SingleElimination, 4, 1);
+
+    QVector<int> ready;
+    QCOMPARE(bracket.takeReadyMatches(4, ready), 2);
+
+    // The winner of the first match leaves while the other match is still played
+    bracket.recordGame(ready[0], 0);
+    const int leaver = bracket.player(ready[0], 0);
+    bracket.withdraw(leaver);
+    QVERIFY(bracket.isOut(leaver));
+
+    bracket.recordGame(ready[1], 0);
+    const int survivor = bracket.player(ready[1], 0);
+
+    // The final is resolved as a bye instead of being handed out
+    ready.clear();
+    QCOMPARE(bracket.takeReadyMatches(4, ready), 0);
+    QVERIFY(bracket.isFinished());
+    QCOMPARE(bracket.champion(), survivor);
+}
+
+void TestTournamentBracket::withdrawalBeforeAReadyMatchIsHandedOutGivesABye() {
+    TournamentBracket bracket(TournamentBracket::Format::SingleElimination, 4, 1);
+    QCOMPARE(playReadyMatches(bracket), 2);
+    QVERIFY(!bracket.isFinished());
+
+    // Both finalists are known, but the final waits for a lobby
+    bracket.withdraw(1);
+
+    QVector<int> ready;
+    QCOMPARE(bracket.takeReadyMatches(4, ready), 0);
+    QVERIFY(bracket.isFinished());
+    QCOMPARE(bracket.champion(), 0);
+}
+
+void TestTournamentBracket::forfeitKeepsTheLeaverOutOfTheLosersBracket() {
+    TournamentBracket bracket(TournamentBracket::Format::DoubleElimination, 4, 1);
+
+    QVector<int> ready;
+    QCOMPARE(bracket.takeReadyMatches(4, ready), 2);
+    const int leaver = bracket.player(ready[0], 1);
+    bracket.forfeit(ready[0], 1);
+    bracket.recordGame(ready[1], 0);
+    const int dropped = bracket.player(ready[1], 1);
+
+    // The loser of the other match gets a bye through the losers' bracket
+    for (int match = 0; match < bracket.matchCount(); ++match) {
+        QVERIFY(bracket.player(match, 0) != leaver || match == ready[0]);
+        QVERIFY(bracket.player(match, 1) != leaver || match == ready[0]);
+    }
+    QVERIFY(bracket.isOut(leaver));
+    QVERIFY(!bracket.isOut(dropped));
+
+    for (int pass = 0; pass < 8 && !bracket.isFinished(); ++pass) playReadyMatches(bracket);
+    QVERIFY(bracket.isFinished());
+    QCOMPARE(bracket.champion(), 0);
+}
+
+QTEST_APPLESS_MAIN(TestTournamentBracket)
+#include "tst_TournamentBracket.moc"
@@ -0,0 +1,367 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QTimer>
+#include <QDebug>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "ChatMessage.h"
+#include "GameAction.h"
+#include "GameRules.h"
+#include "LanTcpClient.h"
+#include "LanTcpServer.h"
+#include "LobbyInfo.h"
+#include "LobbyTable.h"
+#include "MessageFramer.h"
+#include "PlayerConnection.h"
+#include "PlayerProfile.h"
+#include "Protocol.h"
+#include "RoundResolver.h"
+
+namespace {
+
+volatile quint64 sink = 0; ///< Consumes benchmark results so the work cannot be optimized away.
+
+/**
+ * @brief Settings shared by every benchmark.
+ */
+struct BenchConfig {
+    qint64 minTimeNs = 200000000; ///< Minimum measured time of a benchmark.
+    QString filter;               ///< Only benchmarks whose name contains this text are run.
+};
+
+/**
+ * @brief Collects the results of the benchmarks as JSON objects.
+ */
+class BenchRunner {
+public:
+    /**
+     * @brief Constructs a runner.
+     * @param config The shared settings.
+     */
+    explicit BenchRunner(const BenchConfig &config) : config(config) {}
+
+    /**
+     * @brief Checks whether a benchmark passes the name filter.
+     * @param name The benchmark name.
+     * @return True if the benchmark should run.
+     */
+    bool selected(const QString &name) const {
+        return config.filter.isEmpty() || name.contains(config.filter);
+    }
+
+    /**
+     * @brief Runs an operation in growing batches until the minimum time is reached.
+     * @param name The benchmark name.
+     * @param params Parameters of the benchmark, recorded with the result.
+     * @param op The measured operation; one call is one iteration.
+     */
+    void run(const QString &name, const QJsonObject &params, const std::function<void()> &op) {
+        if (!selected(name)) return;
+
+        // Warm up caches and lazily allocated buffers
+        for (int i = 0; i < 100; ++i) op();
+
+        qint64 iterations = 0;
+        qint64 elapsedNs = 0;
+        qint64 batch = 1;
+        QElapsedTimer timer;
+        while (elapsedNs < config.minTimeNs) {
+            timer.start();
+            for (qint64 i = 0; i < batch; ++i) op();
+            elapsedNs += timer.nsecsElapsed();
+            iterations += batch;
+            batch *= 2;
+        }
+
+        record(name, params, iterations, elapsedNs);
+    }
+
+    /**
+     * @brief Records the result of a benchmark that measured itself.
+     * @param name The benchmark name.
+     * @param params Parameters of the benchmark.
+     * @param iterations The number of measured operations.
+     * @param elapsedNs The total measured time.
+     */
+    void record(const QString &name, const QJsonObject &params, qint64 iterations, qint64 elapsedNs) {
+        const double nsPerOp = iterations > 0 ? double(elapsedNs) / double(iterations) : 0.0;
+
+        QJsonObject result;
+        result["name"] = name;
+        result["params"] = params;
+        result["iterations"] = iterations;
+        result["ns_per_op"] = nsPerOp;
+        result["ops_per_sec"] = nsPerOp > 0 ? 1e9 / nsPerOp : 0.0;
+        results.append(result);
+
+        qDebug().noquote() << QString("%1 %2 %3 ns/op")
+                                  .arg(name, -40)
+                                  .arg(QString::fromUtf8(QJsonDocument(params).toJson(QJsonDocument::Compact)), -24)
+                                  .arg(nsPerOp, 0, 'f', 1);
+    }
+
+    /**
+     * @brief Returns the collected results.
+     * @return The results as a JSON array.
+     */
+    const QJsonArray &json() const { return results; }
+
+private:
+    BenchConfig config;  ///< Shared settings.
+    QJsonArray results;  ///< Results of the benchmarks that ran.
+};
+
+/**
+ * @brief Benchmarks serializeInto and the view-based deserialize of one serializable type.
+ * @param runner The benchmark runner.
+ * @param type The name of the serialized type.
+ * @param value A populated instance.
+ * @param scratch An instance receiving the deserialized data.
+ */
+void benchSerializable(BenchRunner &runner, const QString &type, const INetworkSerializable &value,
+                       INetworkSerializable &scratch) {
+    QByteArray buffer;
+    buffer.reserve(value.serializedSize());
+
+    runner.run("serialize/" + type, {}, [&] {
+        buffer.resize(0);
+        value.serializeInto(buffer);
+        sink = sink + buffer.size();
+    });
+
+    const QByteArray data = value.serialize();
+    runner.run("deserialize/" + type, {}, [&] {
+        sink = sink + scratch.deserialize(data.constData(), data.size());
+    });
+}
+
+/**
+ * @brief Benchmarks the serialization of every INetworkSerializable type.
+ * @param runner The benchmark runner.
+ */
+void benchSerialization(BenchRunner &runner) {
+    LobbyInfo lobby("Lobby #42", 2, 1, 50505, 42);
+    LobbyInfo lobbyScratch;
+    benchSerializable(runner, "LobbyInfo", lobby, lobbyScratch);
+
+    PlayerConnection player("Player_0.101", QHostAddress("192.168.0.101"), false, 7);
+    PlayerConnection playerScratch;
+    benchSerializable(runner, "PlayerConnection", player, playerScratch);
+
+    GameAction action(ActionType::Paper, "Player_0.101");
+    GameAction actionScratch;
+    benchSerializable(runner, "GameAction", action, actionScratch);
+
+    ChatMessage chat("Player_0.101", "Good game, rematch?");
+    ChatMessage chatScratch;
+    benchSerializable(runner, "ChatMessage", chat, chatScratch);
+
+    PlayerProfile profile("Player_0.101");
+    PlayerProfile profileScratch(QString());
+    benchSerializable(runner, "PlayerProfile", profile, profileScratch);
+}
+
+/**
+ * @brief Benchmarks round resolution over a lobby with random moves.
+ *
+ * Measures RoundResolver alone and together with the split of the seats into
+ * winner and loser session lists that DedicatedServer feeds into the fan-out.
+ *
+ * @param runner The benchmark runner.
+ */
+void benchRoundResolution(BenchRunner &runner) {
+    for (int players : {2, 8, 128, 4096, 65535}) {
+        LobbyTable table(1, players);
+        for (int seat = 0; seat < players; ++seat) {
+            table.addPlayer(0, static_cast<quint32>(seat + 1));
+            // Two moves only, so every round has winners and losers
+            table.setChoice(0, seat, QRandomGenerator::global()->bounded(GameRules::Rock, GameRules::Paper + 1));
+        }
+
+        QVector<quint8> outcomes(players);
+        runner.run("round_resolution/resolve", {{"players", players}}, [&] {
+            sink = sink + RoundResolver::resolve(table.choiceData(0), players, outcomes.data()).winners;
+        });
+
+        QVector<quint32> winners;
+        QVector<quint32> losers;
+        winners.reserve(players);
+        losers.reserve(players);
+        const quint8 win = static_cast<quint8>(Protocol::Opcode::Win);
+        const quint32 *sessions = table.playerData(0);
+
+        runner.run("round_resolution/split", {{"players", players}}, [&] {
+            RoundResolver::resolve(table.choiceData(0), players, outcomes.data());
+            winners.resize(0);
+            losers.resize(0);
+            for (int seat = 0; seat < players; ++seat) {
+                (outcomes[seat] == win ? winners : losers).append(sessions[seat]);
+            }
+            sink = sink + winners.size();
+        });
+    }
+}
+
+/**
+ * @brief Benchmarks message decoding and framing on the receive path.
+ * @param runner The benchmark runner.
+ */
+void benchDispatch(BenchRunner &runner) {
+    const QByteArray choice = Protocol::encode(Protocol::Opcode::Choice, GameRules::Paper);
+    runner.run("protocol/decode", {}, [&] {
+        Protocol::Message message;
+        sink = sink + (Protocol::decode(choice, message) ? message.value : 0);
+    });
+
+    runner.run("protocol/encode", {}, [&] {
+        sink = sink + Protocol::encode(Protocol::Opcode::Choice, GameRules::Rock).size();
+    });
+
+    for (int batch : {1, 16, 256}) {
+        QByteArray stream;
+        for (int i = 0; i < batch; ++i) {
+            MessageFramer::appendFrame(stream, choice);
+        }
+
+        MessageFramer framer;
+        QByteArray payload;
+        runner.run("framer/split", {{"frames", batch}}, [&] {
+            framer.append(stream);
+            while (framer.nextFrame(payload)) {
+                sink = sink + payload.size();
+            }
+        });
+    }
+}
+
+/**
+ * @brief Benchmarks LanTcpServer fan-out to clients connected over loopback.
+ *
+ * Measures the time from the first sendMessageToAll call until every client
+ * has received every message, and reports it per delivered message.
+ *
+ * @param runner The benchmark runner.
+ */
+void benchFanOut(BenchRunner &runner) {
+    constexpr int MESSAGES = 200;
+
+    for (int clients : {8, 64}) {
+        const QString name = "fanout/loopback";
+        const QJsonObject params{{"clients", clients}, {"messages", MESSAGES}};
+        if (!runner.selected(name)) continue;
+
+        LanTcpServer server(0);
+        if (!server.startListening()) {
+            qWarning() << "Fan-out benchmark skipped:" << server.errorString();
+            return;
+        }
+
+        const LobbyInfo info("bench", clients, 0, server.serverPort());
+        std::vector<std::unique_ptr<LanTcpClient>> peers;
+        int connectedPeers = 0;
+        int received = 0;
+        QEventLoop loop;
+
+        QObject::connect(&server, &LanTcpServer::playerConnected, &loop, [&] {
+            if (++connectedPeers == clients) loop.quit();
+        });
+
+        for (int i = 0; i < clients; ++i) {
+            peers.push_back(std::make_unique<LanTcpClient>());
+            QObject::connect(peers.back().get(), &LanTcpClient::messageReceived, &loop, [&] {
+                if (++received == clients * MESSAGES) loop.quit();
+            });
+            peers.back()->connectToServer(QHostAddress::LocalHost, info);
+        }
+
+        QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+        loop.exec();
+        if (connectedPeers != clients) {
+            qWarning() << "Fan-out benchmark skipped: only" << connectedPeers << "clients connected";
+            return;
+        }
+
+        const QByteArray message = Protocol::encode(Protocol::Opcode::Start);
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < MESSAGES; ++i) {
+            server.sendMessageToAll(message);
+        }
+        QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+        loop.exec();
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        if (received != clients * MESSAGES) {
+            qWarning() << "Fan-out benchmark incomplete:" << received << "of" << clients * MESSAGES << "messages";
+        }
+
+        runner.record(name, params, received, elapsedNs);
+        peers.clear();
+        server.stopListening();
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Entry point of the benchmark suite.
+ *
+ * Runs the microbenchmarks of the hot paths and writes the results as JSON,
+ * so runs before and after a change can be compared by a script.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Microbenchmarks of the Quick-Rock-Paper-Scissors hot paths.");
+    parser.addHelpOption();
+    QCommandLineOption outputOption("output", "Write the JSON results to a file instead of stdout.", "file");
+    QCommandLineOption filterOption("filter", "Only run benchmarks whose name contains the text.", "text");
+    QCommandLineOption minTimeOption("min-time", "Minimum measured time per benchmark, in milliseconds.", "ms", "200");
+    parser.addOptions({outputOption, filterOption, minTimeOption});
+    parser.process(a);
+
+    BenchConfig config;
+    config.filter = parser.value(filterOption);
+    config.minTimeNs = qMax<qint64>(1, parser.value(minTimeOption).toLongLong()) * 1000000;
+
+    BenchRunner runner(config);
+    benchSerialization(runner);
+    benchRoundResolution(runner);
+    benchDispatch(runner);
+    benchFanOut(runner);
+
+    QJsonObject report;
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["qt_version"] = QString(qVersion());
+#ifdef RPS_TEXT_PROTOCOL
+    report["protocol"] = "text";
+#else
+    report["protocol"] = "binary";
+#endif
+    report["benchmarks"] = runner.json();
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical() << "Cannot write" << file.fileName() << ":" << file.errorString();
+            return 1;
+        }
+        file.write(json);
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    return 0;
+}
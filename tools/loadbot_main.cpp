@@ -0,0 +1,64 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include "LoadGenerator.h"
+#include "LobbyClient.h"
+
+/**
+ * @brief Entry point of the load generator.
+ *
+ * Spins up many simulated players in one process against a running
+ * (typically dedicated) server and reports its throughput and latency.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    LoadGenerator::Config config;
+    config.port = LobbyClient::SERVER_PORT;
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless load generator for Quick-Rock-Paper-Scissors servers.");
+    parser.addHelpOption();
+    QCommandLineOption hostOption("host", "Address of the server under test.", "address", config.host.toString());
+    QCommandLineOption portOption("port", "TCP port of the server under test.", "port", QString::number(config.port));
+    QCommandLineOption lobbyOption("lobby", "Lobby joined by every bot; 0 joins any open lobby.", "id", "0");
+    QCommandLineOption botsOption("bots", "Number of simulated players.", "count", QString::number(config.bots));
+    QCommandLineOption spawnRateOption("spawn-rate", "New bots started per second.", "count",
+                                       QString::number(config.spawnRate));
+    QCommandLineOption thinkOption("think", "Maximum delay before a bot's move, in milliseconds.", "ms",
+                                   QString::number(config.thinkTimeMs));
+    QCommandLineOption roundsOption("rounds", "Rounds played by every bot; 0 plays until the run ends.", "count", "0");
+    QCommandLineOption durationOption("duration", "Length of the run in seconds; 0 runs until every bot finished.",
+                                      "seconds", QString::number(config.durationSec));
+    QCommandLineOption reportOption("report", "Interval between progress reports, in milliseconds.", "ms",
+                                    QString::number(config.reportIntervalMs));
+    parser.addOptions({hostOption, portOption, lobbyOption, botsOption, spawnRateOption,
+                       thinkOption, roundsOption, durationOption, reportOption});
+    parser.process(a);
+
+    config.host = QHostAddress(parser.value(hostOption));
+    if (config.host.isNull()) {
+        qCritical() << "Invalid host address:" << parser.value(hostOption);
+        return 1;
+    }
+    config.port = static_cast<quint16>(parser.value(portOption).toUInt());
+    config.lobbyId = parser.value(lobbyOption).toUInt();
+    config.bots = qMax(1, parser.value(botsOption).toInt());
+    config.spawnRate = qMax(1, parser.value(spawnRateOption).toInt());
+    config.thinkTimeMs = qMax(0, parser.value(thinkOption).toInt());
+    config.rounds = qMax(0, parser.value(roundsOption).toInt());
+    config.durationSec = qMax(0, parser.value(durationOption).toInt());
+    config.reportIntervalMs = qMax(100, parser.value(reportOption).toInt());
+
+    if (config.rounds == 0 && config.durationSec == 0) {
+        qCritical() << "Either --rounds or --duration must be positive";
+        return 1;
+    }
+
+    LoadGenerator generator(config);
+    QObject::connect(&generator, &LoadGenerator::finished, &a, &QCoreApplication::quit, Qt::QueuedConnection);
+    generator.start();
+
+    return a.exec();
+}
@@ -0,0 +1,87 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+#include "MatchLogReader.h"
+
+/**
+ * @brief Entry point of the match log analyser.
+ *
+ * Maps a match history log written by a server and prints the move
+ * distribution and the players with the highest win rates. Players are
+ * listed by their key in hex, since most keys are client-generated IDs
+ * rather than addresses.
+ */
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Prints statistics of a Quick-Rock-Paper-Scissors match log.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("log", "The match log file.");
+    QCommandLineOption topOption("top", "Number of players listed.", "count", "10");
+    QCommandLineOption minRoundsOption("min-rounds", "Rounds a player needs to be listed.", "count", "10");
+    QCommandLineOption sinceOption("since", "Only count rounds of the last N minutes; 0 counts all.", "minutes", "0");
+    parser.addOptions({topOption, minRoundsOption, sinceOption});
+    parser.process(a);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 1) {
+        parser.showHelp(1);
+    }
+
+    MatchLogReader reader;
+    if (!reader.open(arguments.first())) {
+        qCritical() << "Cannot read match log" << arguments.first();
+        return 1;
+    }
+
+    const qint64 sinceMinutes = qMax(0, parser.value(sinceOption).toInt());
+    const qint64 fromMs = sinceMinutes > 0 ? QDateTime::currentMSecsSinceEpoch() - sinceMinutes * 60 * 1000 : 0;
+
+    qInfo().noquote() << QString("records=%1 created=%2")
+                             .arg(reader.recordCount())
+                             .arg(QDateTime::fromMSecsSinceEpoch(reader.createdMs()).toString(Qt::ISODate));
+
+    // Move distribution and how often each move won
+    const MatchLogReader::ChoiceStats choices = reader.choiceStats(fromMs);
+    const char *names[] = {"none", "rock", "paper", "scissors"};
+    qint64 picks = 0;
+    for (qint64 count : choices.picks) picks += count;
+    for (int choice = 0; choice < 4; ++choice) {
+        if (choices.picks[choice] == 0) continue;
+        qInfo().noquote() << QString("%1 picks=%2 share=%3% win_rate=%4%")
+                                 .arg(names[choice])
+                                 .arg(choices.picks[choice])
+                                 .arg(100.0 * choices.picks[choice] / picks, 0, 'f', 1)
+                                 .arg(100.0 * choices.wins[choice] / choices.picks[choice], 0, 'f', 1);
+    }
+
+    // Players with the highest win rates
+    const QHash<quint32, MatchLogReader::PlayerStats> players = reader.playerStats(fromMs);
+    const qint64 minRounds = qMax(1, parser.value(minRoundsOption).toInt());
+    QVector<quint32> ranked;
+    for (auto it = players.constBegin(); it != players.constEnd(); ++it) {
+        if (it->rounds >= minRounds) ranked.append(it.key());
+    }
+    std::sort(ranked.begin(), ranked.end(), [&players](quint32 a, quint32 b) {
+        return players[a].winRate() > players[b].winRate();
+    });
+
+    const int top = qMin(qMax(0, parser.value(topOption).toInt()), int(ranked.size()));
+    qInfo().noquote() << QString("players=%1 listed=%2").arg(players.size()).arg(top);
+    for (int i = 0; i < top; ++i) {
+        const MatchLogReader::PlayerStats &player = players[ranked[i]];
+        qInfo().noquote() << QString("%1 rounds=%2 wins=%3 losses=%4 draws=%5 win_rate=%6%")
+                                 .arg(ranked[i], 8, 16, QLatin1Char('0'))
+                                 .arg(player.rounds)
+                                 .arg(player.wins)
+                                 .arg(player.losses)
+                                 .arg(player.draws)
+                                 .arg(100.0 * player.winRate(), 0, 'f', 1);
+    }
+
+    return 0;
+}